@@ -338,6 +338,7 @@ void Rover::one_second_loop(void)
         }
         if (should_log(MASK_LOG_PM)) {
             Log_Write_Performance();
+            DataFlash.Log_Write_Perf();
         }
         G_Dt_max = 0;
         resetPerfData();
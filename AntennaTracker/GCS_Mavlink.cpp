@@ -273,6 +273,7 @@ bool GCS_MAVLINK_Tracker::try_send_message(enum ap_message id)
     case MSG_POSITION_TARGET_GLOBAL_INT:
     case MSG_AOA_SSA:
     case MSG_LANDING:
+    case MSG_LATENCY:
         break; // just here to prevent a warning
     }
     return true;
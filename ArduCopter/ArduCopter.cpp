@@ -192,8 +192,12 @@ void Copter::barometer_accumulate(void)
 
 void Copter::perf_update(void)
 {
-    if (should_log(MASK_LOG_PM))
+    latency_trace.update();
+    if (should_log(MASK_LOG_PM)) {
         Log_Write_Performance();
+        DataFlash.Log_Write_Latency(latency_trace);
+        DataFlash.Log_Write_Perf();
+    }
     if (scheduler.debug()) {
         gcs_send_text_fmt(MAV_SEVERITY_WARNING, "PERF: %u/%u %lu %lu",
                           (unsigned)perf_info_get_num_long_running(),
@@ -79,6 +79,7 @@
 #include <AC_Fence/AC_Fence.h>           // Arducopter Fence library
 #include <AC_Avoidance/AC_Avoid.h>           // Arducopter stop at fence library
 #include <AP_Scheduler/AP_Scheduler.h>       // main loop scheduler
+#include <AP_Scheduler/LatencyTrace.h>      // main loop latency tracing
 #include <AP_RCMapper/AP_RCMapper.h>        // RC input mapping library
 #include <AP_Notify/AP_Notify.h>          // Notify library
 #include <AP_BattMonitor/AP_BattMonitor.h>     // Battery monitor library
@@ -211,6 +212,9 @@ private:
     CompassLearn compass_learn{ahrs, compass};
     AP_InertialSensor ins;
 
+    // latency of the main loop from IMU and RC input to the motors
+    LatencyTrace latency_trace;
+
     RangeFinder rangefinder {serial_manager, ROTATION_PITCH_270};
     struct {
         bool enabled:1;
@@ -327,6 +327,8 @@ void Copter::motors_output()
 
     // push all channels
     hal.rcout->push();
+
+    latency_trace.output_pushed();
 }
 
 // check for pilot stick input to trigger lost vehicle alarm
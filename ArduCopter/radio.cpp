@@ -90,6 +90,7 @@ void Copter::read_radio()
     if (hal.rcin->new_input()) {
         ap.new_radio_frame = true;
         RC_Channels::set_pwm_all();
+        latency_trace.rc_input(hal.rcin->last_frame_us());
 
         set_throttle_and_failsafe(channel_throttle->get_radio_in());
         set_throttle_zero_flag(channel_throttle->get_control_in());
@@ -390,6 +390,7 @@ void Plane::log_perf_info()
 
     if (should_log(MASK_LOG_PM)) {
         Log_Write_Performance();
+        DataFlash.Log_Write_Perf();
     }
 
     resetPerfData();
@@ -648,6 +648,7 @@ bool GCS_MAVLINK_Plane::try_send_message(enum ap_message id)
         break; // just here to prevent a warning
 
     case MSG_LIMITS_STATUS:
+    case MSG_LATENCY:
         // unused
         break;
 
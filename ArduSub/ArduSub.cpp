@@ -105,6 +105,7 @@ void Sub::perf_update(void)
 {
     if (should_log(MASK_LOG_PM)) {
         Log_Write_Performance();
+        DataFlash.Log_Write_Perf();
     }
     if (scheduler.debug()) {
         gcs_send_text_fmt(MAV_SEVERITY_WARNING, "PERF: %u/%u %lu %lu",
@@ -0,0 +1,1119 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ControlHarness.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <AP_HAL/utility/getopt_cpp.h>
+#include <GCS_MAVLink/GCS.h>
+
+#define streq(x, y) (!strcmp(x, y))
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+ControlHarness harness;
+
+#define ASCALAR(v, name, def) { harness.aparm.v.vtype, name, k_param_ ## v, &harness.aparm.v, {def_value : def} }
+#define GOBJECT(v, name, class) { AP_PARAM_GROUP, name, k_param_ ## v, &harness.v, {group_info : class::var_info} }
+#define GOBJECTPTR(v, name, class) { AP_PARAM_GROUP, name, k_param_ ## v, (const void *)&harness.v, {group_info : class::var_info}, AP_PARAM_FLAG_POINTER }
+
+/*
+  the parameters a run can set, with the same names as in ArduCopter
+ */
+const AP_Param::Info ControlHarness::var_info[] = {
+    ASCALAR(angle_max,      "ANGLE_MAX", 4500),
+    GOBJECT(sitl,           "SIM_",     SITL::SITL),
+    GOBJECTPTR(motors,      "MOT_",     AP_MotorsMatrix),
+    GOBJECTPTR(attitude_control, "ATC_", AC_AttitudeControl_Multi),
+    GOBJECTPTR(pos_control, "PSC",      AC_PosControl),
+    GOBJECTPTR(p_pos_z,     "POS_Z_",   AC_P),
+    GOBJECTPTR(p_vel_z,     "VEL_Z_",   AC_P),
+    GOBJECTPTR(pid_accel_z, "ACCEL_Z_", AC_PID),
+    GOBJECTPTR(p_pos_xy,    "POS_XY_",  AC_P),
+    GOBJECTPTR(pi_vel_xy,   "VEL_XY_",  AC_PI_2D),
+    AP_VAREND
+};
+
+// CMAC, where sim_vehicle.py flies by default, facing north
+#define HARNESS_HOME "-35.363261,149.165230,584,0"
+
+// controller time at the start of each run
+#define HARNESS_START_US 1000000ULL
+
+#define HARNESS_LOOP_US (1000000UL / HARNESS_LOOP_RATE)
+
+// 2 + RC_FEEL_RP/10 for the default RC_FEEL_RP of 25, as get_smoothing_gain() in ArduCopter
+#define HARNESS_SMOOTHING_GAIN 4.5f
+
+// PILOT_VELZ_MAX and PILOT_ACCEL_Z_DEFAULT in ArduCopter
+#define HARNESS_SPEED_Z_CMS 250
+#define HARNESS_ACCEL_Z_CMSS 250
+
+/*
+  the SITL multicopter frames the harness can fly, with the FRAME_CLASS
+  and FRAME_TYPE the SITL copter parameter files give them
+ */
+static const struct {
+    const char *name;
+    AP_Motors::motor_frame_class frame_class;
+    AP_Motors::motor_frame_type frame_type;
+} harness_frames[] = {
+    { "+",           AP_Motors::MOTOR_FRAME_QUAD,       AP_Motors::MOTOR_FRAME_TYPE_PLUS },
+    { "quad",        AP_Motors::MOTOR_FRAME_QUAD,       AP_Motors::MOTOR_FRAME_TYPE_PLUS },
+    { "x",           AP_Motors::MOTOR_FRAME_QUAD,       AP_Motors::MOTOR_FRAME_TYPE_X },
+    { "hexa",        AP_Motors::MOTOR_FRAME_HEXA,       AP_Motors::MOTOR_FRAME_TYPE_PLUS },
+    { "hexax",       AP_Motors::MOTOR_FRAME_HEXA,       AP_Motors::MOTOR_FRAME_TYPE_X },
+    { "octa",        AP_Motors::MOTOR_FRAME_OCTA,       AP_Motors::MOTOR_FRAME_TYPE_PLUS },
+    { "octa-quad",   AP_Motors::MOTOR_FRAME_OCTAQUAD,   AP_Motors::MOTOR_FRAME_TYPE_PLUS },
+    { "dodeca-hexa", AP_Motors::MOTOR_FRAME_DODECAHEXA, AP_Motors::MOTOR_FRAME_TYPE_PLUS },
+    { "y6",          AP_Motors::MOTOR_FRAME_Y6,         AP_Motors::MOTOR_FRAME_TYPE_PLUS },
+};
+
+static const struct {
+    const char *name;
+    float duration;
+} step_types[STEP_NUM_TYPES] = {
+    { "roll",       1.5f },
+    { "pitch",      1.5f },
+    { "yaw",        3.0f },
+    { "roll-rate",  1.0f },
+    { "pitch-rate", 1.0f },
+    { "yaw-rate",   1.5f },
+    { "alt",        5.0f },
+    { "north",      6.0f },
+};
+
+ControlHarness::ControlHarness() :
+    ahrs(nullptr),
+    ahrs_view(nullptr),
+    inertial_nav(nullptr),
+    motors(nullptr),
+    attitude_control(nullptr),
+    pos_control(nullptr),
+    p_pos_z(nullptr),
+    p_vel_z(nullptr),
+    pid_accel_z(nullptr),
+    p_pos_xy(nullptr),
+    pi_vel_xy(nullptr),
+    model(nullptr),
+    time_us(0),
+    physics_offset_us(0)
+{
+    options.frame = "x";
+    options.physics_rate_hz = 1200;
+    options.settle_time = 2;
+    options.band = 0.05f;
+    options.noisy = false;
+
+    // DEFAULT_ANGLE_MAX in ArduCopter
+    aparm.angle_max.set(4500);
+}
+
+void ControlHarness::init()
+{
+    if (!AP_Param::check_var_info()) {
+        AP_HAL::panic("Bad parameter table");
+    }
+
+    // the sensors are fed from the model each loop
+    ins.set_hil_mode();
+    ins.register_gyro(HARNESS_LOOP_RATE, 0);
+    ins.register_accel(HARNESS_LOOP_RATE, 0);
+
+    setup_vehicle();
+}
+
+const char *ControlHarness::step_name(enum step_type type)
+{
+    if (type >= STEP_NUM_TYPES) {
+        return "unknown";
+    }
+    return step_types[type].name;
+}
+
+bool ControlHarness::step_from_name(const char *name, enum step_type &type)
+{
+    for (uint8_t i=0; i<STEP_NUM_TYPES; i++) {
+        if (streq(name, step_types[i].name)) {
+            type = (enum step_type)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+float ControlHarness::default_duration(enum step_type type)
+{
+    if (type >= STEP_NUM_TYPES) {
+        return 0;
+    }
+    return step_types[type].duration;
+}
+
+bool ControlHarness::frame_supported(const char *frame)
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(harness_frames); i++) {
+        if (streq(frame, harness_frames[i].name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+  build the vehicle, with the defaults ArduCopter gives the objects it
+  creates in its Parameters constructor
+ */
+void ControlHarness::setup_vehicle()
+{
+    ahrs = new HarnessAHRS(ins, barometer, gps);
+    ahrs_view = ahrs->create_view(ROTATION_NONE);
+    inertial_nav = new HarnessInertialNav(*ahrs);
+    motors = new HarnessMotors(HARNESS_LOOP_RATE);
+
+    p_pos_z = new AC_P(1.0f);
+    p_vel_z = new AC_P(5.0f);
+    pid_accel_z = new AC_PID(0.5f, 1.0f, 0.0f, 800, 20.0f, HARNESS_LOOP_SECONDS);
+    p_pos_xy = new AC_P(1.0f);
+    // the loiter update time in AC_WPNav
+    pi_vel_xy = new AC_PI_2D(1.0f, 0.5f, 1000, 5.0f, 0.02f);
+
+    attitude_control = new AC_AttitudeControl_Multi(*ahrs_view, aparm, *motors, HARNESS_LOOP_SECONDS);
+    pos_control = new AC_PosControl(*ahrs_view, *inertial_nav, *motors, *attitude_control,
+                                    *p_pos_z, *p_vel_z, *pid_accel_z,
+                                    *p_pos_xy, *pi_vel_xy);
+
+    model = new HarnessCopter(HARNESS_HOME, options.frame, &sitl, options.physics_rate_hz);
+
+    if (ahrs_view == nullptr || attitude_control == nullptr || pos_control == nullptr) {
+        AP_HAL::panic("Unable to allocate harness vehicle");
+    }
+}
+
+/*
+  set a parameter on the vehicle, as Replay does
+ */
+bool ControlHarness::set_parameter(const char *name, float value)
+{
+    enum ap_var_type var_type;
+    AP_Param *vp = AP_Param::find(name, &var_type);
+    if (vp == nullptr) {
+        return false;
+    }
+    if (var_type == AP_PARAM_FLOAT) {
+        ((AP_Float *)vp)->set(value);
+    } else if (var_type == AP_PARAM_INT32) {
+        ((AP_Int32 *)vp)->set(value);
+    } else if (var_type == AP_PARAM_INT16) {
+        ((AP_Int16 *)vp)->set(value);
+    } else if (var_type == AP_PARAM_INT8) {
+        ((AP_Int8 *)vp)->set(value);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ControlHarness::check_parameter(const char *name)
+{
+    enum ap_var_type var_type;
+    return AP_Param::find(name, &var_type) != nullptr;
+}
+
+/*
+  arm the vehicle and set up the controllers as ArduCopter does at
+  startup and when entering AltHold
+ */
+bool ControlHarness::start_vehicle()
+{
+    uint8_t i;
+    for (i=0; i<ARRAY_SIZE(harness_frames); i++) {
+        if (streq(options.frame, harness_frames[i].name)) {
+            break;
+        }
+    }
+    if (i == ARRAY_SIZE(harness_frames)) {
+        return false;
+    }
+    motors->init(harness_frames[i].frame_class, harness_frames[i].frame_type);
+    if (!motors->initialised_ok()) {
+        return false;
+    }
+
+    // the RC3 range in the SITL copter parameters
+    motors->set_throttle_range(1000, 2000);
+
+    motors->enable();
+    motors->output_min();
+    motors->armed(true);
+    motors->set_interlock(true);
+    motors->set_desired_spool_state(AP_Motors::DESIRED_THROTTLE_UNLIMITED);
+
+    attitude_control->parameter_sanity_check();
+    attitude_control->set_throttle_mix_max();
+
+    pos_control->set_dt(HARNESS_LOOP_SECONDS);
+    pos_control->set_speed_z(-HARNESS_SPEED_Z_CMS, HARNESS_SPEED_Z_CMS);
+    pos_control->set_accel_z(HARNESS_ACCEL_Z_CMSS);
+
+    ahrs->set_home(model->get_home());
+    return true;
+}
+
+/*
+  feed the model's state to the sensors and estimators, as
+  Copter::fast_loop() reads the INS, AHRS and inertial nav
+ */
+void ControlHarness::update_sensors()
+{
+    Vector3f gyro = model->get_gyro();
+    Vector3f accel = model->get_accel_body();
+    Vector3f position = model->get_position();
+
+    if (options.noisy) {
+        // the same noise as the SITL INS and barometer drivers add
+        const float gyro_noise = ToRad(0.04f) + ToRad(sitl.gyro_noise);
+        const float accel_noise = 0.01f + sitl.accel_noise;
+        gyro += Vector3f(rand_float(), rand_float(), rand_float()) * gyro_noise;
+        accel += Vector3f(rand_float(), rand_float(), rand_float()) * accel_noise;
+        position.z -= sitl.baro_noise * rand_float();
+    }
+
+    ins.set_gyro(0, gyro);
+    ins.set_accel(0, accel);
+
+    ahrs->set_state(model->get_dcm(), position, model->get_velocity_ef());
+    ahrs->update();
+    ahrs_view->update();
+    inertial_nav->update(HARNESS_LOOP_SECONDS);
+}
+
+/*
+  the flight mode: AltHold with the targets set by the test, Acro
+  style body rates for the rate tests, and the horizontal position
+  controller for position tests
+ */
+void ControlHarness::update_targets()
+{
+    if (!motors->spool_up_complete()) {
+        // as AltHold does while the motors spool up
+        attitude_control->reset_rate_controller_I_terms();
+        attitude_control->set_yaw_target_to_current_heading();
+        attitude_control->input_euler_angle_roll_pitch_euler_rate_yaw(0, 0, 0, HARNESS_SMOOTHING_GAIN);
+        pos_control->relax_alt_hold_controllers(motors->get_throttle_hover());
+        attitude_control->set_throttle_out(motors->get_throttle_hover(), true, 0);
+        return;
+    }
+
+    if (target.rate_control) {
+        attitude_control->input_rate_bf_roll_pitch_yaw(target.rate_cds.x, target.rate_cds.y, target.rate_cds.z);
+    } else if (target.pos_control_xy) {
+        pos_control->set_xy_target(target.pos_cm.x, target.pos_cm.y);
+        pos_control->update_xy_controller(AC_PosControl::XY_MODE_POS_ONLY, 1.0f, false);
+        attitude_control->input_euler_angle_roll_pitch_yaw(pos_control->get_roll(), pos_control->get_pitch(),
+                                                           target.angle_cd.z, true, HARNESS_SMOOTHING_GAIN);
+    } else {
+        attitude_control->input_euler_angle_roll_pitch_yaw(target.angle_cd.x, target.angle_cd.y,
+                                                           target.angle_cd.z, true, HARNESS_SMOOTHING_GAIN);
+    }
+
+    pos_control->set_alt_target(target.alt_cm);
+    pos_control->update_z_controller();
+}
+
+/*
+  learn the hover throttle as Copter::update_throttle_hover() does
+ */
+void ControlHarness::update_throttle_hover()
+{
+    if (!is_zero(pos_control->get_desired_velocity().z)) {
+        return;
+    }
+    const float throttle = motors->get_throttle();
+    if (throttle > 0.0f && fabsf(inertial_nav->get_velocity_z()) < 60 &&
+        labs(ahrs->roll_sensor) < 500 && labs(ahrs->pitch_sensor) < 500) {
+        motors->update_throttle_hover(0.01f);
+    }
+}
+
+/*
+  one pass of the main loop, in the order of Copter::fast_loop()
+ */
+void ControlHarness::control_loop()
+{
+    hal.scheduler->stop_clock(time_us);
+
+    update_sensors();
+    attitude_control->rate_controller_run();
+    motors->output();
+    update_targets();
+
+    // 100Hz, as in the ArduCopter scheduler table
+    if ((time_us / HARNESS_LOOP_US) % (HARNESS_LOOP_RATE / 100) == 0) {
+        update_throttle_hover();
+    }
+
+    time_us += HARNESS_LOOP_US;
+}
+
+/*
+  run the physics up to the controllers' time with the motor outputs
+  of the last loop
+ */
+void ControlHarness::step_physics()
+{
+    struct SITL::Aircraft::sitl_input input {};
+    for (uint8_t i=0; i<ARRAY_SIZE(input.servos); i++) {
+        input.servos[i] = motors->get_pwm(i);
+    }
+    input.wind.speed = sitl.wind_speed;
+    input.wind.direction = sitl.wind_direction;
+    input.wind.turbulence = sitl.wind_turbulance;
+
+    while (model->get_time_us() + physics_offset_us < time_us) {
+        model->update(input);
+    }
+}
+
+/*
+  the value a test measures, from the model's state
+ */
+float ControlHarness::measure(enum step_type type) const
+{
+    float roll, pitch, yaw;
+    model->get_dcm().to_euler(&roll, &pitch, &yaw);
+
+    switch (type) {
+    case STEP_ROLL:
+        return degrees(roll);
+    case STEP_PITCH:
+        return degrees(pitch);
+    case STEP_YAW:
+        return degrees(yaw);
+    case STEP_ROLL_RATE:
+        return degrees(model->get_gyro().x);
+    case STEP_PITCH_RATE:
+        return degrees(model->get_gyro().y);
+    case STEP_YAW_RATE:
+        return degrees(model->get_gyro().z);
+    case STEP_ALT:
+        return -model->get_position().z;
+    case STEP_NORTH:
+        return model->get_position().x;
+    case STEP_NUM_TYPES:
+        break;
+    }
+    return 0;
+}
+
+void ControlHarness::set_step_target(const struct step_test &test, float initial, float target_value)
+{
+    switch (test.type) {
+    case STEP_ROLL:
+        target.angle_cd.x = target_value * 100;
+        break;
+    case STEP_PITCH:
+        target.angle_cd.y = target_value * 100;
+        break;
+    case STEP_YAW:
+        target.angle_cd.z = wrap_360_cd(target_value * 100);
+        break;
+    case STEP_ROLL_RATE:
+        target.rate_control = true;
+        target.rate_cds.x = target_value * 100;
+        break;
+    case STEP_PITCH_RATE:
+        target.rate_control = true;
+        target.rate_cds.y = target_value * 100;
+        break;
+    case STEP_YAW_RATE:
+        target.rate_control = true;
+        target.rate_cds.z = target_value * 100;
+        break;
+    case STEP_ALT:
+        target.alt_cm = target_value * 100;
+        break;
+    case STEP_NORTH:
+        target.pos_cm.x = target_value * 100;
+        break;
+    case STEP_NUM_TYPES:
+        break;
+    }
+}
+
+/*
+  spool up, hover for the settle time, then step the target and
+  record the response
+ */
+bool ControlHarness::fly(const struct step_test &test, StepResponse::metrics &m)
+{
+    if (!start_vehicle()) {
+        return false;
+    }
+
+    StepResponse response;
+    const uint32_t step_loops = test.duration * HARNESS_LOOP_RATE;
+    if (step_loops == 0 || !response.init(step_loops)) {
+        return false;
+    }
+
+    model->set_hover(HARNESS_START_ALT_M, 0);
+    time_us = HARNESS_START_US;
+    physics_offset_us = time_us;
+
+    target.angle_cd.zero();
+    target.rate_cds.zero();
+    target.pos_cm.zero();
+    target.rate_control = false;
+    target.alt_cm = HARNESS_START_ALT_M * 100;
+    target.pos_control_xy = (test.type == STEP_NORTH);
+    if (target.pos_control_xy) {
+        pos_control->set_xy_target(0, 0);
+        pos_control->init_xy_controller();
+    }
+
+    // the vehicle is held still while the motors spool up
+    uint32_t loops = 0;
+    while (!motors->spool_up_complete()) {
+        if (++loops > 5 * HARNESS_LOOP_RATE) {
+            return false;
+        }
+        control_loop();
+        physics_offset_us += HARNESS_LOOP_US;
+    }
+
+    const uint32_t settle_loops = options.settle_time * HARNESS_LOOP_RATE;
+    for (uint32_t i=0; i<settle_loops; i++) {
+        control_loop();
+        step_physics();
+    }
+
+    const float initial = measure(test.type);
+    set_step_target(test, initial, initial + test.size);
+    response.start(initial, initial + test.size, HARNESS_LOOP_SECONDS);
+
+    for (uint32_t i=0; i<step_loops; i++) {
+        control_loop();
+        step_physics();
+        float value = measure(test.type);
+        if (test.type == STEP_YAW) {
+            // keep yaw continuous through +-180
+            value = initial + wrap_180(value - initial);
+        }
+        response.sample(value);
+    }
+
+    return response.compute(options.band, m);
+}
+
+bool ControlHarness::run(const struct step_test &test, uint32_t seed,
+                         const struct harness_param *params, uint16_t num_params,
+                         StepResponse::metrics &m)
+{
+    // the models and the noise use both generators
+    srand(seed);
+    srandom(seed);
+
+    // as the SITL copter parameter file
+    set_parameter("MOT_THST_EXPO", 0.5f);
+    set_parameter("MOT_THST_HOVER", 0.36f);
+
+    for (uint16_t i=0; i<num_params; i++) {
+        if (!set_parameter(params[i].name, params[i].value)) {
+            ::fprintf(stderr, "Unable to set %s\n", params[i].name);
+            return false;
+        }
+    }
+
+    return fly(test, m);
+}
+
+/*
+  the runs a harness invocation makes: every combination of the swept
+  parameter values, for each step test, repeated with successive seeds
+ */
+#define HARNESS_MAX_PARAMS       64
+#define HARNESS_MAX_SWEEPS       4
+#define HARNESS_MAX_SWEEP_VALUES 256
+#define HARNESS_MAX_TESTS        16
+
+struct harness_sweep {
+    char name[AP_MAX_NAME_SIZE+1];
+    uint16_t num_values;
+    float values[HARNESS_MAX_SWEEP_VALUES];
+};
+
+static struct {
+    struct harness_param params[HARNESS_MAX_PARAMS];
+    uint16_t num_params;
+    struct harness_sweep sweeps[HARNESS_MAX_SWEEPS];
+    uint8_t num_sweeps;
+    struct step_test tests[HARNESS_MAX_TESTS];
+    uint8_t num_tests;
+    float duration;
+    uint16_t repeat;
+    uint32_t seed;
+    uint16_t jobs;
+} plan;
+
+enum job_state {
+    JOB_NOT_RUN = 0,
+    JOB_DONE,
+    JOB_FAILED,
+};
+
+// written by the worker processes into shared memory
+struct job_result {
+    uint8_t state;
+    StepResponse::metrics m;
+};
+
+static bool copy_name(char *dest, const char *src, size_t len)
+{
+    if (len == 0 || len > AP_MAX_NAME_SIZE) {
+        return false;
+    }
+    memcpy(dest, src, len);
+    dest[len] = 0;
+    return true;
+}
+
+/*
+  set a parameter for every run, replacing any earlier value
+ */
+static bool add_param(const char *name, size_t name_len, float value)
+{
+    char pname[AP_MAX_NAME_SIZE+1];
+    if (!copy_name(pname, name, name_len)) {
+        return false;
+    }
+    uint16_t i;
+    for (i=0; i<plan.num_params; i++) {
+        if (streq(plan.params[i].name, pname)) {
+            break;
+        }
+    }
+    if (i == plan.num_params) {
+        if (plan.num_params == HARNESS_MAX_PARAMS) {
+            return false;
+        }
+        plan.num_params++;
+    }
+    strcpy(plan.params[i].name, pname);
+    plan.params[i].value = value;
+    return true;
+}
+
+static bool parse_param(const char *arg)
+{
+    const char *eq = strchr(arg, '=');
+    if (eq == nullptr) {
+        return false;
+    }
+    return add_param(arg, eq - arg, atof(eq+1));
+}
+
+static bool parse_param_line(char *line, char **vname, float &value)
+{
+    if (line[0] == '#') {
+        return false;
+    }
+    char *saveptr = nullptr;
+    char *pname = strtok_r(line, ", =\t", &saveptr);
+    if (pname == nullptr) {
+        return false;
+    }
+    if (strlen(pname) > AP_MAX_NAME_SIZE) {
+        return false;
+    }
+    const char *value_s = strtok_r(nullptr, ", =\t", &saveptr);
+    if (value_s == nullptr) {
+        return false;
+    }
+    value = atof(value_s);
+    *vname = pname;
+    return true;
+}
+
+static bool load_param_file(const char *filename)
+{
+    FILE *f = fopen(filename, "r");
+    if (f == nullptr) {
+        return false;
+    }
+    char line[100];
+    bool ret = true;
+    while (fgets(line, sizeof(line)-1, f)) {
+        char *pname;
+        float value;
+        if (!parse_param_line(line, &pname, value)) {
+            continue;
+        }
+        if (!add_param(pname, strlen(pname), value)) {
+            ret = false;
+            break;
+        }
+    }
+    fclose(f);
+    return ret;
+}
+
+/*
+  parse NAME=START:END:STEP or NAME=V1,V2,...
+ */
+static bool parse_sweep(const char *arg)
+{
+    const char *eq = strchr(arg, '=');
+    if (eq == nullptr || plan.num_sweeps == HARNESS_MAX_SWEEPS) {
+        return false;
+    }
+    struct harness_sweep &sweep = plan.sweeps[plan.num_sweeps];
+    if (!copy_name(sweep.name, arg, eq - arg)) {
+        return false;
+    }
+    sweep.num_values = 0;
+
+    const char *values = eq+1;
+    if (strchr(values, ':') != nullptr) {
+        float start, end, step;
+        if (sscanf(values, "%f:%f:%f", &start, &end, &step) != 3 ||
+            step <= 0 || end < start) {
+            return false;
+        }
+        // allow for rounding in the last step
+        const uint32_t n = (uint32_t)((end - start) / step + 1.001f);
+        if (n > HARNESS_MAX_SWEEP_VALUES) {
+            return false;
+        }
+        for (uint32_t i=0; i<n; i++) {
+            sweep.values[sweep.num_values++] = start + i * step;
+        }
+    } else {
+        const char *p = values;
+        while (*p) {
+            if (sweep.num_values == HARNESS_MAX_SWEEP_VALUES) {
+                return false;
+            }
+            char *endp;
+            sweep.values[sweep.num_values++] = strtof(p, &endp);
+            if (endp == p || (*endp != ',' && *endp != 0)) {
+                return false;
+            }
+            p = (*endp == ',') ? endp+1 : endp;
+        }
+    }
+    if (sweep.num_values == 0) {
+        return false;
+    }
+    plan.num_sweeps++;
+    return true;
+}
+
+/*
+  parse TEST=SIZE
+ */
+static bool parse_step(const char *arg)
+{
+    const char *eq = strchr(arg, '=');
+    if (eq == nullptr || plan.num_tests == HARNESS_MAX_TESTS) {
+        return false;
+    }
+    char name[20];
+    if ((size_t)(eq - arg) >= sizeof(name)) {
+        return false;
+    }
+    memcpy(name, arg, eq - arg);
+    name[eq - arg] = 0;
+
+    struct step_test &test = plan.tests[plan.num_tests];
+    if (!ControlHarness::step_from_name(name, test.type)) {
+        return false;
+    }
+    test.size = atof(eq+1);
+    if (is_zero(test.size)) {
+        return false;
+    }
+    test.duration = 0;
+    plan.num_tests++;
+    return true;
+}
+
+static uint32_t num_points()
+{
+    uint32_t n = 1;
+    for (uint8_t i=0; i<plan.num_sweeps; i++) {
+        n *= plan.sweeps[i].num_values;
+    }
+    return n;
+}
+
+// index into the values of sweep s for a point, with the last sweep varying fastest
+static uint16_t point_value_index(uint32_t point, uint8_t s)
+{
+    for (uint8_t i=plan.num_sweeps-1; i>s; i--) {
+        point /= plan.sweeps[i].num_values;
+    }
+    return point % plan.sweeps[s].num_values;
+}
+
+/*
+  the parameters for a point: the fixed ones, then the swept ones so
+  that a sweep overrides a fixed value of the same name
+ */
+static uint16_t point_params(uint32_t point, struct harness_param *params)
+{
+    uint16_t n = 0;
+    for (uint16_t i=0; i<plan.num_params; i++) {
+        params[n++] = plan.params[i];
+    }
+    for (uint8_t s=0; s<plan.num_sweeps; s++) {
+        strcpy(params[n].name, plan.sweeps[s].name);
+        params[n].value = plan.sweeps[s].values[point_value_index(point, s)];
+        n++;
+    }
+    return n;
+}
+
+static void decode_job(uint32_t job, uint32_t &point, uint8_t &test, uint16_t &repeat)
+{
+    repeat = job % plan.repeat;
+    test = (job / plan.repeat) % plan.num_tests;
+    point = job / (plan.repeat * plan.num_tests);
+}
+
+static void run_job(uint32_t job, struct job_result &result)
+{
+    uint32_t point;
+    uint8_t test;
+    uint16_t repeat;
+    decode_job(job, point, test, repeat);
+
+    struct harness_param params[HARNESS_MAX_PARAMS + HARNESS_MAX_SWEEPS];
+    const uint16_t num_params = point_params(point, params);
+
+    if (harness.run(plan.tests[test], plan.seed + repeat, params, num_params, result.m)) {
+        result.state = JOB_DONE;
+    } else {
+        result.state = JOB_FAILED;
+    }
+}
+
+/*
+  run each job in its own process, forked from the freshly built
+  vehicle, so no state from one run can reach another. Up to plan.jobs
+  run at once, and a job whose process dies is left as not run
+ */
+static bool run_jobs(uint32_t num_jobs, struct job_result *results)
+{
+    uint32_t next_job = 0;
+    uint16_t running = 0;
+
+    while (next_job < num_jobs || running > 0) {
+        if (next_job < num_jobs && running < plan.jobs) {
+            const pid_t pid = fork();
+            if (pid == 0) {
+                run_job(next_job, results[next_job]);
+                _exit(0);
+            }
+            if (pid != -1) {
+                next_job++;
+                running++;
+                continue;
+            }
+            if (running == 0) {
+                perror("fork");
+                return false;
+            }
+        }
+        if (waitpid(-1, nullptr, 0) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("waitpid");
+            return false;
+        }
+        running--;
+    }
+    return true;
+}
+
+static void print_results(uint32_t num_jobs, const struct job_result *results)
+{
+    ::printf("run");
+    for (uint8_t s=0; s<plan.num_sweeps; s++) {
+        ::printf(",%s", plan.sweeps[s].name);
+    }
+    ::printf(",test,step,seed,rise_s,overshoot_pct,settle_s,final_err,iae\n");
+
+    for (uint32_t job=0; job<num_jobs; job++) {
+        uint32_t point;
+        uint8_t test;
+        uint16_t repeat;
+        decode_job(job, point, test, repeat);
+
+        ::printf("%u", (unsigned)job);
+        for (uint8_t s=0; s<plan.num_sweeps; s++) {
+            ::printf(",%g", (double)plan.sweeps[s].values[point_value_index(point, s)]);
+        }
+        const struct step_test &t = plan.tests[test];
+        ::printf(",%s,%g,%u", ControlHarness::step_name(t.type), (double)t.size,
+                 (unsigned)(plan.seed + repeat));
+
+        const struct job_result &r = results[job];
+        if (r.state == JOB_DONE) {
+            ::printf(",%.4f,%.2f,%.4f,%.4f,%.4f\n",
+                     (double)r.m.rise_time,
+                     (double)r.m.overshoot,
+                     (double)r.m.settling_time,
+                     (double)r.m.final_error,
+                     (double)r.m.iae);
+        } else {
+            ::printf(",,,,,\n");
+        }
+    }
+}
+
+static void usage(void)
+{
+    ::printf("Options:\n");
+    ::printf("\t--param NAME=VALUE       set parameter NAME to VALUE for every run\n");
+    ::printf("\t--param-file FILENAME    load parameters from a file\n");
+    ::printf("\t--sweep NAME=START:END:STEP\n");
+    ::printf("\t--sweep NAME=V1,V2,...   run every combination of up to %u swept parameters\n", HARNESS_MAX_SWEEPS);
+    ::printf("\t--step TEST=SIZE         step test to run, one of:\n");
+    ::printf("\t                         ");
+    for (uint8_t i=0; i<STEP_NUM_TYPES; i++) {
+        ::printf(" %s", ControlHarness::step_name((enum step_type)i));
+    }
+    ::printf("\n");
+    ::printf("\t                         angles in degrees, rates in degrees/s, alt and north in metres\n");
+    ::printf("\t--duration SECONDS       time recorded after each step\n");
+    ::printf("\t--settle SECONDS         time hovering before each step\n");
+    ::printf("\t--band FRACTION          settling band as a fraction of the step\n");
+    ::printf("\t--noisy                  add sensor noise from the SIM_ parameters\n");
+    ::printf("\t--repeat N               run each test N times with successive seeds\n");
+    ::printf("\t--seed N                 first seed\n");
+    ::printf("\t--jobs N                 number of runs at once\n");
+    ::printf("\t--frame FRAME            SITL multicopter frame\n");
+    ::printf("\t--rate HZ                physics rate\n");
+}
+
+enum {
+    OPT_PARAM_FILE = 128,
+    OPT_SWEEP,
+    OPT_STEP,
+    OPT_DURATION,
+    OPT_SETTLE,
+    OPT_BAND,
+    OPT_NOISY,
+    OPT_REPEAT,
+    OPT_SEED,
+    OPT_FRAME,
+    OPT_RATE,
+};
+
+static void parse_command_line(int argc, char * const argv[])
+{
+    const struct GetOptLong::option options[] = {
+        // name           has_arg flag   val
+        {"param",           true,   0, 'p'},
+        {"param-file",      true,   0, OPT_PARAM_FILE},
+        {"sweep",           true,   0, OPT_SWEEP},
+        {"step",            true,   0, OPT_STEP},
+        {"duration",        true,   0, OPT_DURATION},
+        {"settle",          true,   0, OPT_SETTLE},
+        {"band",            true,   0, OPT_BAND},
+        {"noisy",           false,  0, OPT_NOISY},
+        {"repeat",          true,   0, OPT_REPEAT},
+        {"seed",            true,   0, OPT_SEED},
+        {"jobs",            true,   0, 'j'},
+        {"frame",           true,   0, OPT_FRAME},
+        {"rate",            true,   0, OPT_RATE},
+        {"help",            false,  0, 'h'},
+        {0, false, 0, 0}
+    };
+
+    GetOptLong gopt(argc, argv, "p:j:h", options);
+
+    int opt;
+    while ((opt = gopt.getoption()) != -1) {
+        switch (opt) {
+        case 'p':
+            if (!parse_param(gopt.optarg)) {
+                ::printf("Usage: --param NAME=VALUE\n");
+                exit(1);
+            }
+            break;
+
+        case OPT_PARAM_FILE:
+            if (!load_param_file(gopt.optarg)) {
+                ::printf("Failed to load parameter file: %s\n", gopt.optarg);
+                exit(1);
+            }
+            break;
+
+        case OPT_SWEEP:
+            if (!parse_sweep(gopt.optarg)) {
+                ::printf("Bad sweep: %s\n", gopt.optarg);
+                exit(1);
+            }
+            break;
+
+        case OPT_STEP:
+            if (!parse_step(gopt.optarg)) {
+                ::printf("Bad step: %s\n", gopt.optarg);
+                exit(1);
+            }
+            break;
+
+        case OPT_DURATION:
+            plan.duration = atof(gopt.optarg);
+            break;
+
+        case OPT_SETTLE:
+            harness.options.settle_time = atof(gopt.optarg);
+            break;
+
+        case OPT_BAND:
+            harness.options.band = atof(gopt.optarg);
+            break;
+
+        case OPT_NOISY:
+            harness.options.noisy = true;
+            break;
+
+        case OPT_REPEAT:
+            plan.repeat = MAX(atoi(gopt.optarg), 1);
+            break;
+
+        case OPT_SEED:
+            plan.seed = strtoul(gopt.optarg, nullptr, 0);
+            break;
+
+        case 'j':
+            plan.jobs = MAX(atoi(gopt.optarg), 1);
+            break;
+
+        case OPT_FRAME:
+            if (!ControlHarness::frame_supported(gopt.optarg)) {
+                ::printf("Unsupported frame: %s\n", gopt.optarg);
+                exit(1);
+            }
+            harness.options.frame = gopt.optarg;
+            break;
+
+        case OPT_RATE:
+            harness.options.physics_rate_hz = atof(gopt.optarg);
+            break;
+
+        case 'h':
+        default:
+            usage();
+            exit(0);
+        }
+    }
+}
+
+class GCS_ControlHarness : public GCS
+{
+    void send_statustext(MAV_SEVERITY severity, uint8_t dest_bitmask, const char *text) override {
+        ::fprintf(stderr, "GCS: %s\n", text);
+    }
+};
+GCS_ControlHarness _gcs;
+
+int main(int argc, char *argv[])
+{
+    plan.repeat = 1;
+    plan.seed = 1;
+    const long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    plan.jobs = ncpu > 0 ? ncpu : 1;
+
+    parse_command_line(argc, argv);
+
+    harness.init();
+
+    if (plan.num_tests == 0) {
+        plan.tests[0].type = STEP_ROLL;
+        plan.tests[0].size = 10;
+        plan.num_tests = 1;
+    }
+    for (uint8_t i=0; i<plan.num_tests; i++) {
+        struct step_test &test = plan.tests[i];
+        test.duration = plan.duration > 0 ? plan.duration : ControlHarness::default_duration(test.type);
+    }
+
+    // catch bad names before forking
+    for (uint16_t i=0; i<plan.num_params; i++) {
+        if (!harness.check_parameter(plan.params[i].name)) {
+            ::printf("Unknown parameter: %s\n", plan.params[i].name);
+            exit(1);
+        }
+    }
+    for (uint8_t i=0; i<plan.num_sweeps; i++) {
+        if (!harness.check_parameter(plan.sweeps[i].name)) {
+            ::printf("Unknown parameter: %s\n", plan.sweeps[i].name);
+            exit(1);
+        }
+    }
+
+    const uint64_t total = (uint64_t)num_points() * plan.num_tests * plan.repeat;
+    if (total > UINT32_MAX / 2) {
+        ::printf("Too many runs: %llu\n", (unsigned long long)total);
+        exit(1);
+    }
+    const uint32_t num_jobs = total;
+
+    struct job_result *results = (struct job_result *)mmap(nullptr, num_jobs * sizeof(struct job_result),
+                                                           PROT_READ | PROT_WRITE,
+                                                           MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (!run_jobs(num_jobs, results)) {
+        exit(1);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    const double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1.0e-9;
+
+    print_results(num_jobs, results);
+
+    uint32_t failed = 0;
+    for (uint32_t i=0; i<num_jobs; i++) {
+        if (results[i].state != JOB_DONE) {
+            failed++;
+        }
+    }
+    ::fprintf(stderr, "%u runs (%u failed) in %.2fs with %u jobs, %.1f runs/s\n",
+              (unsigned)num_jobs, (unsigned)failed, elapsed, (unsigned)plan.jobs,
+              elapsed > 0 ? num_jobs / elapsed : 0);
+
+    munmap(results, num_jobs * sizeof(struct job_result));
+    return failed == 0 ? 0 : 1;
+}
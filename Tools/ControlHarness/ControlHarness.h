@@ -0,0 +1,180 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  headless closed-loop controller harness. The copter attitude and
+  position controllers fly the SITL multicopter physics in simulated
+  time, with no scheduler, no serial ports and no wall clock, so that
+  step responses can be measured for many sets of gains. The runs per
+  second of each sweep are measured and printed when it finishes
+ */
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Param/AP_Param.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_InertialSensor/AP_InertialSensor.h>
+#include <AP_Baro/AP_Baro.h>
+#include <AP_GPS/AP_GPS.h>
+#include <AP_Vehicle/AP_Vehicle.h>
+#include <AC_PID/AC_P.h>
+#include <AC_PID/AC_PID.h>
+#include <AC_PID/AC_PI_2D.h>
+#include <AC_AttitudeControl/AC_AttitudeControl_Multi.h>
+#include <AC_AttitudeControl/AC_PosControl.h>
+#include <SRV_Channel/SRV_Channel.h>
+#include <SITL/SITL.h>
+
+#include "HarnessAHRS.h"
+#include "HarnessModel.h"
+#include "StepResponse.h"
+
+// controller loop rate, as MAIN_LOOP_RATE in ArduCopter
+#define HARNESS_LOOP_RATE       400
+#define HARNESS_LOOP_SECONDS    (1.0f / HARNESS_LOOP_RATE)
+
+// altitude above home the vehicle starts each run hovering at
+#define HARNESS_START_ALT_M     10
+
+enum step_type {
+    STEP_ROLL = 0,      // roll angle, degrees
+    STEP_PITCH,         // pitch angle, degrees
+    STEP_YAW,           // yaw angle, degrees
+    STEP_ROLL_RATE,     // body roll rate, degrees/s
+    STEP_PITCH_RATE,    // body pitch rate, degrees/s
+    STEP_YAW_RATE,      // body yaw rate, degrees/s
+    STEP_ALT,           // altitude, metres
+    STEP_NORTH,         // position north, metres
+    STEP_NUM_TYPES
+};
+
+struct step_test {
+    enum step_type type;
+    float size;
+    // seconds recorded after the step
+    float duration;
+};
+
+// a parameter set by name for one run
+struct harness_param {
+    char name[AP_MAX_NAME_SIZE+1];
+    float value;
+};
+
+class ControlHarness {
+public:
+    ControlHarness();
+
+    // settings which are the same for every run
+    struct {
+        const char *frame;
+        float physics_rate_hz;
+        float settle_time;
+        float band;
+        bool noisy;
+    } options;
+
+    // check the parameter table and build the vehicle, once per process
+    void init();
+
+    // return false if a parameter can't be set on the run's vehicle
+    bool check_parameter(const char *name);
+
+    /*
+      fly one step test with params applied after the harness
+      defaults. The same seed gives the same run. This uses up the
+      vehicle, so call it once in each process forked after init()
+     */
+    bool run(const struct step_test &test, uint32_t seed,
+             const struct harness_param *params, uint16_t num_params,
+             StepResponse::metrics &m);
+
+    static const char *step_name(enum step_type type);
+    static bool step_from_name(const char *name, enum step_type &type);
+    static float default_duration(enum step_type type);
+
+    // return false if the harness can't fly this SITL frame
+    static bool frame_supported(const char *frame);
+
+private:
+    // keys for the parameter table
+    enum {
+        k_param_angle_max = 0,
+        k_param_sitl,
+        k_param_motors,
+        k_param_attitude_control,
+        k_param_pos_control,
+        k_param_p_pos_z,
+        k_param_p_vel_z,
+        k_param_pid_accel_z,
+        k_param_p_pos_xy,
+        k_param_pi_vel_xy,
+    };
+
+    // these live for the whole process, as some are singletons
+    AP_InertialSensor ins;
+    AP_Baro barometer;
+    AP_GPS gps;
+    SRV_Channels servo_channels;
+    SITL::SITL sitl;
+    AP_Vehicle::MultiCopter aparm;
+
+    // the vehicle, built once and copied into each run's process
+    HarnessAHRS *ahrs;
+    AP_AHRS_View *ahrs_view;
+    HarnessInertialNav *inertial_nav;
+    HarnessMotors *motors;
+    AC_AttitudeControl_Multi *attitude_control;
+    AC_PosControl *pos_control;
+    AC_P *p_pos_z;
+    AC_P *p_vel_z;
+    AC_PID *pid_accel_z;
+    AC_P *p_pos_xy;
+    AC_PI_2D *pi_vel_xy;
+    HarnessCopter *model;
+
+    // simulated time of the controllers, and how far it is ahead of
+    // the model's time, which stands still while the motors spool up
+    uint64_t time_us;
+    uint64_t physics_offset_us;
+
+    // controller targets, in the units the controllers take
+    struct {
+        Vector3f angle_cd;
+        Vector3f rate_cds;
+        Vector2f pos_cm;
+        float alt_cm;
+        bool rate_control;
+        bool pos_control_xy;
+    } target;
+
+    void setup_vehicle();
+    bool set_parameter(const char *name, float value);
+    bool start_vehicle();
+    bool fly(const struct step_test &test, StepResponse::metrics &m);
+
+    void update_sensors();
+    void update_targets();
+    void update_throttle_hover();
+    void control_loop();
+    void step_physics();
+    void set_step_target(const struct step_test &test, float initial, float target_value);
+    float measure(enum step_type type) const;
+
+    // setup the var_info table
+    AP_Param param_loader{var_info};
+
+    static const AP_Param::Info var_info[];
+};
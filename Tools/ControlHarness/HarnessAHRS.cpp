@@ -0,0 +1,130 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HarnessAHRS.h"
+
+void HarnessAHRS::set_state(const Matrix3f &dcm, const Vector3f &position, const Vector3f &velocity)
+{
+    _dcm_matrix = dcm;
+    _position = position;
+    _velocity = velocity;
+}
+
+void HarnessAHRS::update(bool skip_ins_update)
+{
+    _omega = _ins.get_gyro();
+
+    _dcm_matrix.to_euler(&roll, &pitch, &yaw);
+    update_cd_values();
+    update_trig();
+
+    const uint8_t accel = _ins.get_primary_accel();
+    _accel_ef[accel] = _dcm_matrix * _ins.get_accel();
+    _accel_ef_blended = _accel_ef[accel];
+}
+
+void HarnessAHRS::reset_attitude(const float &_roll, const float &_pitch, const float &_yaw)
+{
+    _dcm_matrix.from_euler(_roll, _pitch, _yaw);
+}
+
+bool HarnessAHRS::get_position(struct Location &loc) const
+{
+    loc = _home;
+    location_offset(loc, _position.x, _position.y);
+    loc.alt = _home.alt - _position.z * 100;
+    return true;
+}
+
+bool HarnessAHRS::get_velocity_NED(Vector3f &vec) const
+{
+    vec = _velocity;
+    return true;
+}
+
+// the origin and home are the same point in the harness
+bool HarnessAHRS::get_relative_position_NED_home(Vector3f &vec) const
+{
+    vec = _position;
+    return true;
+}
+
+bool HarnessAHRS::get_relative_position_NED_origin(Vector3f &vec) const
+{
+    vec = _position;
+    return true;
+}
+
+bool HarnessAHRS::get_relative_position_NE_home(Vector2f &posNE) const
+{
+    posNE = Vector2f(_position.x, _position.y);
+    return true;
+}
+
+bool HarnessAHRS::get_relative_position_NE_origin(Vector2f &posNE) const
+{
+    posNE = Vector2f(_position.x, _position.y);
+    return true;
+}
+
+void HarnessAHRS::get_relative_position_D_home(float &posD) const
+{
+    posD = _position.z;
+}
+
+bool HarnessAHRS::get_relative_position_D_origin(float &posD) const
+{
+    posD = _position.z;
+    return true;
+}
+
+void HarnessInertialNav::update(float dt)
+{
+    Vector3f position, velocity;
+    _ahrs.get_relative_position_NED_origin(position);
+    _ahrs.get_velocity_NED(velocity);
+
+    _relpos_cm = Vector3f(position.x, position.y, -position.z) * 100;
+    _velocity_cm = Vector3f(velocity.x, velocity.y, -velocity.z) * 100;
+}
+
+nav_filter_status HarnessInertialNav::get_filter_status() const
+{
+    nav_filter_status status {};
+    status.flags.attitude = true;
+    status.flags.horiz_vel = true;
+    status.flags.vert_vel = true;
+    status.flags.horiz_pos_rel = true;
+    status.flags.horiz_pos_abs = true;
+    status.flags.vert_pos = true;
+    status.flags.pred_horiz_pos_rel = true;
+    status.flags.pred_horiz_pos_abs = true;
+    status.flags.using_gps = true;
+    return status;
+}
+
+int32_t HarnessInertialNav::get_latitude() const
+{
+    struct Location loc;
+    _ahrs.get_position(loc);
+    return loc.lat;
+}
+
+int32_t HarnessInertialNav::get_longitude() const
+{
+    struct Location loc;
+    _ahrs.get_position(loc);
+    return loc.lng;
+}
@@ -0,0 +1,104 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  attitude and navigation estimates for the control harness, taken
+  from the state of the simulated vehicle rather than estimated from
+  sensors, so that a tuning run measures the controllers alone
+ */
+#pragma once
+
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_InertialNav/AP_InertialNav.h>
+
+class HarnessAHRS : public AP_AHRS
+{
+public:
+    HarnessAHRS(AP_InertialSensor &ins, AP_Baro &baro, AP_GPS &gps) :
+        AP_AHRS(ins, baro, gps)
+    {
+        _dcm_matrix.identity();
+    }
+
+    /*
+      set the attitude, and position and velocity NED from home in
+      metres, for the next update. Rates and accelerations are taken
+      from the INS, so any sensor noise reaches the controllers
+     */
+    void set_state(const Matrix3f &dcm, const Vector3f &position, const Vector3f &velocity);
+
+    void update(bool skip_ins_update=false) override;
+
+    const Vector3f &get_gyro() const override { return _omega; }
+    const Vector3f &get_gyro_drift() const override { return _gyro_drift; }
+    void reset_gyro_drift() override {}
+    void reset(bool recover_eulers=false) override {}
+    void reset_attitude(const float &roll, const float &pitch, const float &yaw) override;
+    float get_error_rp() const override { return 0; }
+    float get_error_yaw() const override { return 0; }
+    const Matrix3f &get_rotation_body_to_ned() const override { return _dcm_matrix; }
+
+    bool get_position(struct Location &loc) const override;
+    Vector3f wind_estimate() override { return Vector3f(); }
+    bool get_velocity_NED(Vector3f &vec) const override;
+    bool get_relative_position_NED_home(Vector3f &vec) const override;
+    bool get_relative_position_NED_origin(Vector3f &vec) const override;
+    bool get_relative_position_NE_home(Vector2f &posNE) const override;
+    bool get_relative_position_NE_origin(Vector2f &posNE) const override;
+    void get_relative_position_D_home(float &posD) const override;
+    bool get_relative_position_D_origin(float &posD) const override;
+
+    void set_home(const Location &loc) override { _home = loc; }
+    bool healthy() const override { return true; }
+    uint32_t uptime_ms() const override { return AP_HAL::millis(); }
+
+private:
+    Matrix3f _dcm_matrix;
+    Vector3f _omega;
+    Vector3f _gyro_drift;
+    Vector3f _position;
+    Vector3f _velocity;
+};
+
+/*
+  inertial navigation in cm NEU from the same state as HarnessAHRS
+ */
+class HarnessInertialNav : public AP_InertialNav
+{
+public:
+    HarnessInertialNav(const HarnessAHRS &ahrs) :
+        _ahrs(ahrs)
+    {}
+
+    void update(float dt) override;
+
+    nav_filter_status get_filter_status() const override;
+    struct Location get_origin() const override { return _ahrs.get_home(); }
+
+    const Vector3f &get_position() const override { return _relpos_cm; }
+    bool get_location(struct Location &loc) const override { return _ahrs.get_position(loc); }
+    int32_t get_latitude() const override;
+    int32_t get_longitude() const override;
+    const Vector3f &get_velocity() const override { return _velocity_cm; }
+    float get_velocity_xy() const override { return norm(_velocity_cm.x, _velocity_cm.y); }
+
+    float get_altitude() const override { return _relpos_cm.z; }
+    bool get_hgt_ctrl_limit(float &limit) const override { return false; }
+    float get_velocity_z() const override { return _velocity_cm.z; }
+
+private:
+    const HarnessAHRS &_ahrs;
+    Vector3f _relpos_cm;
+    Vector3f _velocity_cm;
+};
@@ -0,0 +1,49 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HarnessModel.h"
+
+HarnessCopter::HarnessCopter(const char *home_str, const char *frame_str, SITL::SITL *sitl_params, float rate_hz) :
+    MultiCopter(home_str, frame_str)
+{
+    sitl = sitl_params;
+
+    // time only moves when the harness steps the model
+    use_time_sync = false;
+    setup_frame_time(rate_hz, 1);
+}
+
+void HarnessCopter::set_hover(float alt_m, float yaw_rad)
+{
+    position = Vector3f(0, 0, -alt_m);
+    velocity_ef.zero();
+    gyro.zero();
+    gyro_prev.zero();
+    ang_accel.zero();
+    dcm.from_euler(0, 0, yaw_rad);
+    accel_body = Vector3f(0, 0, -GRAVITY_MSS);
+    update_position();
+}
+
+void HarnessMotors::rc_write(uint8_t chan, uint16_t pwm)
+{
+    if (_motor_map_mask & (1U<<chan)) {
+        // we have a mapped motor number for this channel
+        chan = _motor_map[chan];
+    }
+    if (chan < ARRAY_SIZE(_pwm)) {
+        _pwm[chan] = pwm;
+    }
+}
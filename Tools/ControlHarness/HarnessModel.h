@@ -0,0 +1,63 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  the vehicle side of the control harness: the SITL multicopter
+  physics, stepped directly by the harness, and motors whose outputs
+  go to the physics rather than to the HAL
+ */
+#pragma once
+
+#include <AP_Motors/AP_Motors.h>
+#include <SITL/SIM_Multicopter.h>
+
+/*
+  a SITL multicopter stepped in simulated time, with no wall clock
+  sync and no link to a HAL
+ */
+class HarnessCopter : public SITL::MultiCopter {
+public:
+    HarnessCopter(const char *home_str, const char *frame_str, SITL::SITL *sitl_params, float rate_hz);
+
+    // put the vehicle level and still at alt_m above home, facing yaw_rad
+    void set_hover(float alt_m, float yaw_rad);
+
+    uint64_t get_time_us() const { return time_now_us; }
+    const Location &get_home() const { return home; }
+
+    // truth state in the frames the simulator keeps it in
+    const Vector3f &get_position() const { return position; }
+    const Vector3f &get_accel_body() const { return accel_body; }
+};
+
+/*
+  multicopter motors which record the PWM they would write, for the
+  harness to feed to the physics
+ */
+class HarnessMotors : public AP_MotorsMatrix {
+public:
+    HarnessMotors(uint16_t loop_rate) :
+        AP_MotorsMatrix(loop_rate)
+    {}
+
+    uint16_t get_pwm(uint8_t chan) const { return chan < ARRAY_SIZE(_pwm) ? _pwm[chan] : 0; }
+
+protected:
+    void rc_write(uint8_t chan, uint16_t pwm) override;
+    void rc_set_freq(uint32_t mask, uint16_t freq_hz) override {}
+    void rc_enable_ch(uint8_t chan) override {}
+
+private:
+    uint16_t _pwm[SITL_NUM_CHANNELS] {};
+};
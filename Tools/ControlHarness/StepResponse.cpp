@@ -0,0 +1,93 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StepResponse.h"
+
+#include <stdlib.h>
+#include <AP_Math/AP_Math.h>
+
+StepResponse::~StepResponse()
+{
+    free(_samples);
+}
+
+bool StepResponse::init(uint32_t max_samples)
+{
+    _samples = (float *)calloc(max_samples, sizeof(float));
+    if (_samples == nullptr) {
+        return false;
+    }
+    _max_samples = max_samples;
+    _num_samples = 0;
+    return true;
+}
+
+void StepResponse::start(float initial, float target, float dt)
+{
+    _initial = initial;
+    _step = target - initial;
+    _dt = dt;
+    _num_samples = 0;
+}
+
+void StepResponse::sample(float value)
+{
+    if (_num_samples >= _max_samples || is_zero(_step)) {
+        return;
+    }
+    _samples[_num_samples++] = (value - _initial) / _step;
+}
+
+bool StepResponse::compute(float band, struct metrics &m) const
+{
+    if (_num_samples == 0) {
+        return false;
+    }
+
+    int32_t rise_start = -1;
+    int32_t rise_end = -1;
+    int32_t last_outside = -1;
+    float peak = 0;
+    float iae = 0;
+    for (uint32_t i = 0; i < _num_samples; i++) {
+        const float r = _samples[i];
+        if (rise_start < 0 && r >= 0.1f) {
+            rise_start = i;
+        }
+        if (rise_end < 0 && r >= 0.9f) {
+            rise_end = i;
+        }
+        if (fabsf(r - 1) > band) {
+            last_outside = i;
+        }
+        peak = MAX(peak, r);
+        iae += fabsf(1 - r) * _dt;
+    }
+
+    if (rise_end >= 0) {
+        m.rise_time = (rise_end - rise_start) * _dt;
+    } else {
+        m.rise_time = -1;
+    }
+    m.overshoot = MAX(peak - 1, 0) * 100;
+    if (last_outside == (int32_t)_num_samples - 1) {
+        m.settling_time = -1;
+    } else {
+        m.settling_time = (last_outside + 1) * _dt;
+    }
+    m.final_error = (1 - _samples[_num_samples-1]) * _step;
+    m.iae = iae;
+    return true;
+}
@@ -0,0 +1,78 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  record the response of one variable to a step in its target, at a
+  fixed sample rate, and work out how well it followed the step
+ */
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+
+class StepResponse {
+public:
+    struct metrics {
+        // seconds from 10% to 90% of the step, negative if it never
+        // got to 90%
+        float rise_time;
+
+        // percentage of the step beyond the target at the furthest
+        float overshoot;
+
+        // seconds after the step until the response stayed within the
+        // band around the target, negative if it hadn't by the end
+        float settling_time;
+
+        // distance from the target at the end, in the units of the step
+        float final_error;
+
+        // integral of the absolute error as a fraction of the step,
+        // in seconds
+        float iae;
+    };
+
+    StepResponse() :
+        _samples(nullptr),
+        _max_samples(0),
+        _num_samples(0),
+        _initial(0),
+        _step(0),
+        _dt(0)
+    {}
+    ~StepResponse();
+
+    // allocate room for max_samples
+    bool init(uint32_t max_samples);
+
+    // start recording a step from initial to target, sampled every dt
+    void start(float initial, float target, float dt);
+
+    // record the next sample
+    void sample(float value);
+
+    uint32_t num_samples() const { return _num_samples; }
+
+    // work out the metrics, with band as a fraction of the step
+    bool compute(float band, struct metrics &m) const;
+
+private:
+    // samples as a fraction of the step, 0 at the start and 1 on target
+    float *_samples;
+    uint32_t _max_samples;
+    uint32_t _num_samples;
+
+    float _initial;
+    float _step;
+    float _dt;
+};
@@ -0,0 +1,115 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+#include "StepResponse.h"
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#define DT 0.01f
+
+// feed a step from 10 to 20, with the response as a fraction of the step
+static void record(StepResponse &resp, const float *fractions, uint32_t n)
+{
+    ASSERT_TRUE(resp.init(n));
+    resp.start(10.0f, 20.0f, DT);
+    for (uint32_t i = 0; i < n; i++) {
+        resp.sample(10.0f + 10.0f * fractions[i]);
+    }
+    ASSERT_EQ(n, resp.num_samples());
+}
+
+TEST(StepResponse, no_samples)
+{
+    StepResponse resp;
+    StepResponse::metrics m;
+    ASSERT_TRUE(resp.init(10));
+    resp.start(0.0f, 1.0f, DT);
+    EXPECT_FALSE(resp.compute(0.05f, m));
+}
+
+TEST(StepResponse, rise_overshoot_settling)
+{
+    // 10% at sample 2, 90% at sample 5, peaks 20% over and stays within 5% from sample 9
+    const float r[] = { 0.0f, 0.05f, 0.1f, 0.4f, 0.8f, 0.95f, 1.2f, 1.1f, 0.9f, 0.97f, 1.02f, 1.0f, 1.0f };
+    StepResponse resp;
+    record(resp, r, ARRAY_SIZE(r));
+
+    StepResponse::metrics m;
+    ASSERT_TRUE(resp.compute(0.05f, m));
+    EXPECT_FLOAT_EQ(3 * DT, m.rise_time);
+    EXPECT_FLOAT_EQ(20.0f, m.overshoot);
+    EXPECT_FLOAT_EQ(9 * DT, m.settling_time);
+    EXPECT_FLOAT_EQ(0.0f, m.final_error);
+
+    float iae = 0;
+    for (uint8_t i = 0; i < ARRAY_SIZE(r); i++) {
+        iae += fabsf(1 - r[i]) * DT;
+    }
+    EXPECT_FLOAT_EQ(iae, m.iae);
+}
+
+TEST(StepResponse, never_rises)
+{
+    // gets to 10% but never to 90%, and never settles
+    const float r[] = { 0.0f, 0.2f, 0.5f, 0.7f, 0.8f, 0.8f };
+    StepResponse resp;
+    record(resp, r, ARRAY_SIZE(r));
+
+    StepResponse::metrics m;
+    ASSERT_TRUE(resp.compute(0.05f, m));
+    EXPECT_LT(m.rise_time, 0);
+    EXPECT_FLOAT_EQ(0.0f, m.overshoot);
+    EXPECT_LT(m.settling_time, 0);
+    // in the units of the step, 20% short of a step of 10
+    EXPECT_FLOAT_EQ(2.0f, m.final_error);
+}
+
+TEST(StepResponse, settled_from_start)
+{
+    // a response already within the band is settled at once
+    const float r[] = { 0.98f, 1.0f, 1.01f, 1.0f };
+    StepResponse resp;
+    record(resp, r, ARRAY_SIZE(r));
+
+    StepResponse::metrics m;
+    ASSERT_TRUE(resp.compute(0.05f, m));
+    EXPECT_FLOAT_EQ(0.0f, m.rise_time);
+    EXPECT_NEAR(1.0f, m.overshoot, 1.0e-3f);
+    EXPECT_FLOAT_EQ(0.0f, m.settling_time);
+}
+
+TEST(StepResponse, negative_step)
+{
+    // a step down is measured the same way as a step up
+    StepResponse resp;
+    ASSERT_TRUE(resp.init(4));
+    resp.start(5.0f, -5.0f, DT);
+    resp.sample(5.0f);
+    resp.sample(-6.0f);
+    resp.sample(-5.0f);
+    resp.sample(-5.0f);
+
+    StepResponse::metrics m;
+    ASSERT_TRUE(resp.compute(0.05f, m));
+    EXPECT_FLOAT_EQ(0.0f, m.rise_time);
+    EXPECT_FLOAT_EQ(10.0f, m.overshoot);
+    EXPECT_FLOAT_EQ(2 * DT, m.settling_time);
+}
+
+TEST(StepResponse, samples_beyond_capacity_dropped)
+{
+    StepResponse resp;
+    ASSERT_TRUE(resp.init(2));
+    resp.start(0.0f, 1.0f, DT);
+    resp.sample(0.5f);
+    resp.sample(1.0f);
+    resp.sample(2.0f);
+    EXPECT_EQ(2U, resp.num_samples());
+
+    StepResponse::metrics m;
+    ASSERT_TRUE(resp.compute(0.05f, m));
+    EXPECT_FLOAT_EQ(0.0f, m.overshoot);
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,83 @@
+#!/usr/bin/env python
+'''
+run two builds of Replay over a set of logs and check the EKF messages
+they write are identical. Use this for changes which should not alter
+the filter arithmetic, where CheckLogs.py would let small differences
+through its tolerances
+'''
+
+import glob, optparse, os, shutil, subprocess, sys, tempfile
+
+from pymavlink import mavutil
+
+parser = optparse.OptionParser("CheckEquivalence [options] LOG...")
+parser.add_option("--baseline", type='string', default=None, help="Replay.elf built without the change")
+parser.add_option("--candidate", type='string', default='./Replay.elf', help="Replay.elf built with the change")
+parser.add_option("--types", type='string',
+                  default='NKF1,NKF2,NKF3,NKF4,NKF5,XKF1,XKF2,XKF3,XKF4,XKF5',
+                  help="message types to compare, comma separated")
+
+opts, args = parser.parse_args()
+
+if opts.baseline is None or len(args) == 0:
+    parser.print_help()
+    sys.exit(1)
+
+def run_replay(replay, logfile):
+    '''run Replay on one logfile in a scratch directory, returning the directory and the log written'''
+    tmpdir = tempfile.mkdtemp(prefix='replay-')
+    with open(os.devnull, 'w') as devnull:
+        subprocess.call([os.path.abspath(replay), '--', os.path.abspath(logfile)],
+                        cwd=tmpdir, stdout=devnull, stderr=devnull)
+    logs = sorted(glob.glob(os.path.join(tmpdir, 'logs', '*.BIN')), key=os.path.getmtime)
+    if len(logs) == 0:
+        return tmpdir, None
+    return tmpdir, logs[-1]
+
+def read_messages(logfile, types):
+    '''return the given message types of a log as a list of dictionaries'''
+    mlog = mavutil.mavlink_connection(logfile)
+    ret = []
+    while True:
+        m = mlog.recv_match(type=types)
+        if m is None:
+            break
+        ret.append(m.to_dict())
+    return ret
+
+def check_log(logfile):
+    '''compare the output of both builds for one log, returning true if identical'''
+    types = opts.types.split(',')
+    dir1, out1 = run_replay(opts.baseline, logfile)
+    dir2, out2 = run_replay(opts.candidate, logfile)
+    try:
+        if out1 is None or out2 is None:
+            print("%s: Replay wrote no log" % logfile)
+            return False
+        msgs1 = read_messages(out1, types)
+        msgs2 = read_messages(out2, types)
+        if len(msgs1) == 0:
+            print("%s: no %s messages" % (logfile, opts.types))
+            return False
+        for i in range(min(len(msgs1), len(msgs2))):
+            if msgs1[i] != msgs2[i]:
+                print("%s: message %u differs" % (logfile, i))
+                print("  baseline:  %s" % msgs1[i])
+                print("  candidate: %s" % msgs2[i])
+                return False
+        if len(msgs1) != len(msgs2):
+            print("%s: %u messages from the baseline, %u from the candidate" % (logfile, len(msgs1), len(msgs2)))
+            return False
+        print("%s: %u messages identical" % (logfile, len(msgs1)))
+        return True
+    finally:
+        shutil.rmtree(dir1)
+        shutil.rmtree(dir2)
+
+failed = 0
+for logfile in args:
+    if not check_log(logfile):
+        failed += 1
+
+print("%u of %u logs differ" % (failed, len(args)))
+sys.exit(1 if failed else 0)
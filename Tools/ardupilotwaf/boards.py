@@ -163,6 +163,7 @@ class Board:
             ]
 
         if self.with_uavcan:
+            env.WITH_UAVCAN = True
             env.AP_LIBRARIES += [
                 'AP_UAVCAN',
                 'modules/uavcan/libuavcan/src/**/*.cpp'
@@ -246,6 +247,9 @@ class sitl(Board):
 
 class linux(Board):
     def configure_env(self, cfg, env):
+        if cfg.options.enable_uavcan:
+            self.with_uavcan = True
+
         super(linux, self).configure_env(cfg, env)
 
         cfg.find_toolchain_program('pkg-config', var='PKGCONFIG')
@@ -270,10 +274,18 @@ class linux(Board):
         cfg.check_libiio(env)
 
         env.LINKFLAGS += ['-pthread',]
-        env.AP_LIBRARIES = [
+        env.AP_LIBRARIES += [
             'AP_HAL_Linux',
         ]
 
+        if self.with_uavcan:
+            env.DEFINES.update(
+                HAL_WITH_UAVCAN = 1,
+            )
+            env.GIT_SUBMODULES += [
+                'uavcan',
+            ]
+
 
 class minlure(linux):
     def configure_env(self, cfg, env):
@@ -364,6 +376,11 @@ class bebop(linux):
             CONFIG_HAL_BOARD_SUBTYPE = 'HAL_BOARD_SUBTYPE_LINUX_BEBOP',
         )
 
+        # the P7 has NEON, used by the onboard optical flow kernels
+        env.CXXFLAGS += [
+            '-mfpu=neon',
+        ]
+
 class disco(linux):
     toolchain = 'arm-linux-gnueabihf'
 
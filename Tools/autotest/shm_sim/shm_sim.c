@@ -0,0 +1,229 @@
+/*
+  stand-in external simulator for the SITL "shm" model: a quad X
+  copter stepped in lockstep with ArduPilot over shared memory. Use it
+  to try the exchange, or as a starting point for connecting another
+  physics engine.
+
+  build with: gcc -O2 -I../../../libraries/SITL -o shm_sim shm_sim.c -lrt -lm
+
+  run ArduCopter with --model shm, then: ./shm_sim [NAME] [RATE_HZ]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include <SIM_SHM_Interface.h>
+
+#define GRAVITY_MSS 9.80665
+
+// roughly a 3DR Iris: hovers at half throttle
+#define MASS_KG 1.5
+#define ARM_M 0.2
+#define INERTIA_KGM2 0.02
+#define YAW_TORQUE_FACTOR 0.05
+#define LINEAR_DRAG 0.1
+#define ANGULAR_DRAG 0.05
+#define MAX_THRUST_N (MASS_KG * GRAVITY_MSS / (4 * 0.5))
+
+// ArduCopter quad X motors: angle from the nose and spin direction
+static const struct {
+    double angle_deg;
+    bool clockwise;
+} motors[4] = {
+    {   45, false },
+    { -135, false },
+    {  -45, true },
+    {  135, true },
+};
+
+struct state {
+    double time;
+    double q[4];        // body to earth, w x y z
+    double gyro[3];     // rad/s, body frame
+    double vel[3];      // m/s, NED
+    double pos[3];      // m, NED
+    double accel[3];    // m/s/s specific force, body frame
+};
+
+static void reset(struct state *s)
+{
+    memset(s, 0, sizeof(*s));
+    s->q[0] = 1;
+    s->accel[2] = -GRAVITY_MSS;
+}
+
+// v_earth = R v_body with R from the quaternion q
+static void body_to_earth(const double q[4], const double v[3], double r[3])
+{
+    const double w = q[0], x = q[1], y = q[2], z = q[3];
+    r[0] = (1 - 2*(y*y + z*z)) * v[0] + 2*(x*y - w*z) * v[1] + 2*(x*z + w*y) * v[2];
+    r[1] = 2*(x*y + w*z) * v[0] + (1 - 2*(x*x + z*z)) * v[1] + 2*(y*z - w*x) * v[2];
+    r[2] = 2*(x*z - w*y) * v[0] + 2*(y*z + w*x) * v[1] + (1 - 2*(x*x + y*y)) * v[2];
+}
+
+static void earth_to_body(const double q[4], const double v[3], double r[3])
+{
+    const double qc[4] = { q[0], -q[1], -q[2], -q[3] };
+    body_to_earth(qc, v, r);
+}
+
+static void step(struct state *s, const struct sim_shm_servos *servos, double dt)
+{
+    double thrust = 0;
+    double torque[3] = { 0, 0, 0 };
+    for (int i = 0; i < 4; i++) {
+        double throttle = (servos->pwm[i] - 1000) / 1000.0;
+        throttle = throttle < 0 ? 0 : (throttle > 1 ? 1 : throttle);
+        const double t = throttle * MAX_THRUST_N;
+        const double a = motors[i].angle_deg * M_PI / 180;
+        // thrust along -z at (cos(a), sin(a)) * ARM_M
+        torque[0] -= sin(a) * ARM_M * t;
+        torque[1] += cos(a) * ARM_M * t;
+        torque[2] += (motors[i].clockwise ? -1 : 1) * YAW_TORQUE_FACTOR * t;
+        thrust += t;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        s->gyro[i] += (torque[i] - ANGULAR_DRAG * s->gyro[i]) / INERTIA_KGM2 * dt;
+    }
+
+    // q += 0.5 q * (0, gyro) dt
+    const double *q = s->q, *g = s->gyro;
+    const double dq[4] = {
+        0.5 * (-q[1]*g[0] - q[2]*g[1] - q[3]*g[2]),
+        0.5 * ( q[0]*g[0] + q[2]*g[2] - q[3]*g[1]),
+        0.5 * ( q[0]*g[1] - q[1]*g[2] + q[3]*g[0]),
+        0.5 * ( q[0]*g[2] + q[1]*g[1] - q[2]*g[0]),
+    };
+    double norm = 0;
+    for (int i = 0; i < 4; i++) {
+        s->q[i] += dq[i] * dt;
+        norm += s->q[i] * s->q[i];
+    }
+    norm = sqrt(norm);
+    for (int i = 0; i < 4; i++) {
+        s->q[i] /= norm;
+    }
+
+    const double force_body[3] = { 0, 0, -thrust };
+    double accel_earth[3];
+    body_to_earth(s->q, force_body, accel_earth);
+    for (int i = 0; i < 3; i++) {
+        accel_earth[i] = (accel_earth[i] - LINEAR_DRAG * s->vel[i]) / MASS_KG;
+    }
+    accel_earth[2] += GRAVITY_MSS;
+
+    for (int i = 0; i < 3; i++) {
+        s->vel[i] += accel_earth[i] * dt;
+        s->pos[i] += s->vel[i] * dt;
+    }
+
+    // sitting on the ground at the home location
+    if (s->pos[2] >= 0 && accel_earth[2] >= 0) {
+        s->pos[2] = 0;
+        memset(s->vel, 0, sizeof(s->vel));
+        memset(s->gyro, 0, sizeof(s->gyro));
+        memset(accel_earth, 0, sizeof(accel_earth));
+    }
+
+    // an accelerometer measures the acceleration less gravity
+    accel_earth[2] -= GRAVITY_MSS;
+    earth_to_body(s->q, accel_earth, s->accel);
+
+    s->time += dt;
+}
+
+static struct sim_shm_header *open_shm(const char *name)
+{
+    int fd;
+    while ((fd = shm_open(name, O_RDWR, 0)) == -1) {
+        // SITL not started yet
+        usleep(100000);
+    }
+    struct sim_shm_header *hdr = mmap(NULL, sizeof(*hdr), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (hdr == MAP_FAILED) {
+        perror(name);
+        return NULL;
+    }
+    while (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != SIM_SHM_MAGIC) {
+        usleep(10000);
+    }
+    if (hdr->version != SIM_SHM_VERSION || hdr->total_size != sizeof(*hdr)) {
+        printf("%s: unsupported version\n", name);
+        return NULL;
+    }
+    return hdr;
+}
+
+static double wall_time(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+int main(int argc, const char *argv[])
+{
+    char default_name[32];
+    snprintf(default_name, sizeof(default_name), SIM_SHM_NAME_FORMAT, 0U);
+    const char *name = argc > 1 ? argv[1] : default_name;
+    const double rate_hz = argc > 2 ? atof(argv[2]) : 1000;
+    const double dt = 1.0 / rate_hz;
+
+    struct sim_shm_header *hdr = open_shm(name);
+    if (hdr == NULL) {
+        return 1;
+    }
+    printf("Simulating on %s at %.0fHz\n", name, rate_hz);
+
+    struct state s;
+    reset(&s);
+    uint32_t seq = 0;
+    uint32_t frames = 0;
+    double last_report = wall_time();
+
+    while (true) {
+        const uint32_t last_seq = seq;
+        seq = sim_shm_wait(&hdr->servo_seq, last_seq, 1000);
+        if (seq == last_seq) {
+            continue;
+        }
+        const struct sim_shm_servos servos = hdr->servos;
+        if (servos.frame == 1) {
+            // SITL (re)started
+            reset(&s);
+        }
+
+        step(&s, &servos, dt);
+
+        struct sim_shm_fdm *fdm = &hdr->fdm;
+        fdm->frame = servos.frame;
+        fdm->timestamp = s.time;
+        memcpy(fdm->gyro, s.gyro, sizeof(fdm->gyro));
+        memcpy(fdm->accel, s.accel, sizeof(fdm->accel));
+        memcpy(fdm->quaternion, s.q, sizeof(fdm->quaternion));
+        memcpy(fdm->velocity, s.vel, sizeof(fdm->velocity));
+        memcpy(fdm->position, s.pos, sizeof(fdm->position));
+        fdm->airspeed = -1;
+        sim_shm_post(&hdr->fdm_seq, seq);
+
+        frames++;
+        const double now = wall_time();
+        if (now - last_report >= 5) {
+            printf("%.0f frames/s, altitude %.1fm\n", frames / (now - last_report), -s.pos[2]);
+            frames = 0;
+            last_report = now;
+        }
+    }
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include "AC_AttitudeControl_Heli.h"
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Scheduler/LatencyTrace.h>
 
 // table of user settable parameters
 const AP_Param::GroupInfo AC_AttitudeControl_Heli::var_info[] = {
@@ -263,6 +264,11 @@ void AC_AttitudeControl_Heli::rate_controller_run()
     } else {
         _motors.set_yaw(rate_target_to_motor_yaw(gyro_latest.z, _rate_target_ang_vel.z));
     }
+
+    LatencyTrace *trace = LatencyTrace::get_instance();
+    if (trace != nullptr) {
+        trace->mark(LatencyTrace::STAGE_RATE);
+    }
 }
 
 // Update Alt_Hold angle maximum
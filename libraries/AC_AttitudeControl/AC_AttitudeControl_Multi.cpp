@@ -1,6 +1,7 @@
 #include "AC_AttitudeControl_Multi.h"
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
+#include <AP_Scheduler/LatencyTrace.h>
 
 // table of user settable parameters
 const AP_Param::GroupInfo AC_AttitudeControl_Multi::var_info[] = {
@@ -261,6 +262,11 @@ void AC_AttitudeControl_Multi::rate_controller_run()
     _motors.set_yaw(rate_target_to_motor_yaw(gyro_latest.z, _rate_target_ang_vel.z));
 
     control_monitor_update();
+
+    LatencyTrace *trace = LatencyTrace::get_instance();
+    if (trace != nullptr) {
+        trace->mark(LatencyTrace::STAGE_RATE);
+    }
 }
 
 // sanity check parameters.  should be called once before takeoff
@@ -427,7 +427,7 @@ bool AC_Fence::load_polygon_from_eeprom(bool force_reload)
     if (!_inav.get_location(temp_loc)) {
         return false;
     }
-    const struct Location &ekf_origin = _inav.get_origin();
+    const LocalFrame frame(_inav.get_origin());
 
     // sanity check total
     _total = constrain_int16(_total, 0, _poly_loader.max_points());
@@ -437,10 +437,8 @@ bool AC_Fence::load_polygon_from_eeprom(bool force_reload)
     for (uint16_t index=0; index<_total; index++) {
         // load boundary point as lat/lon point
         _poly_loader.load_point_from_eeprom(index, temp_latlon);
-        // move into location structure and convert to offset from ekf origin
-        temp_loc.lat = temp_latlon.x;
-        temp_loc.lng = temp_latlon.y;
-        _boundary[index] = location_diff(ekf_origin, temp_loc) * 100.0f;
+        // convert to offset from ekf origin
+        _boundary[index] = frame.to_ne(temp_latlon.x, temp_latlon.y) * 100.0f;
     }
     _boundary_num_points = _total;
     _boundary_loaded = true;
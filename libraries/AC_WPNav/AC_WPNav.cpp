@@ -128,7 +128,6 @@ AC_WPNav::AC_WPNav(const AP_InertialNav& inav, const AP_AHRS_View& ahrs, AC_PosC
     _track_leash_length(0.0f),
     _slow_down_dist(0.0f),
     _spline_time(0.0f),
-    _spline_time_scale(0.0f),
     _spline_vel_scaler(0.0f),
     _yaw(0.0f)
 {
@@ -998,6 +997,9 @@ bool AC_WPNav::set_spline_origin_and_destination(const Vector3f& origin, const V
         update_spline_solution(origin, destination, _spline_origin_vel, _spline_destination_vel);
     }
 
+    // build the arc length table once per segment so that advancing the target is a table lookup
+    update_spline_length(_hermite_spline_solution, _spline_length);
+
     // store origin and destination locations
     _origin = origin;
     _destination = destination;
@@ -1124,7 +1126,7 @@ bool AC_WPNav::advance_spline_target_along_track(float dt)
         }
 
         // update velocity
-        float spline_dist_to_wp = (_destination - target_pos).length();
+        float spline_dist_to_wp = MAX(_spline_length.length[WPNAV_SPLINE_LENGTH_STEPS] - spline_length_at_time(_spline_length, _spline_time), 0.0f);
         float vel_limit = _wp_speed_cms;
         if (!is_zero(dt)) {
             vel_limit = MIN(vel_limit, track_leash_slack/dt);
@@ -1141,12 +1143,6 @@ bool AC_WPNav::advance_spline_target_along_track(float dt)
         // constrain target velocity
         _spline_vel_scaler = constrain_float(_spline_vel_scaler, 0.0f, vel_limit);
 
-        // scale the spline_time by the velocity we've calculated vs the velocity that came out of the spline calculator
-        float target_vel_length = target_vel.length();
-        if (!is_zero(target_vel_length)) {
-            _spline_time_scale = _spline_vel_scaler/target_vel_length;
-        }
-
         // update target position
         target_pos.z += terr_offset;
         _pos_control.set_pos_target(target_pos);
@@ -1168,8 +1164,8 @@ bool AC_WPNav::advance_spline_target_along_track(float dt)
             }
         }
 
-        // advance spline time to next step
-        _spline_time += _spline_time_scale*dt;
+        // advance spline time to next step, moving the target the distance along the spline we've calculated
+        _spline_time = spline_time_at_length(_spline_length, spline_length_at_time(_spline_length, _spline_time) + _spline_vel_scaler*dt);
 
         // we will reach the next waypoint in the next step so set reached_destination flag
         // To-Do: is this one step too early?
@@ -1182,19 +1178,115 @@ bool AC_WPNav::advance_spline_target_along_track(float dt)
 
 // calc_spline_pos_vel_accel - calculates target position, velocity and acceleration for the given "spline_time"
 /// 	relies on update_spline_solution being called when the segment's origin and destination were set
-void AC_WPNav::calc_spline_pos_vel(float spline_time, Vector3f& position, Vector3f& velocity)
+void AC_WPNav::calc_spline_pos_vel(const Vector3f spline_solution[4], float spline_time, Vector3f& position, Vector3f& velocity)
 {
-    float spline_time_sqrd = spline_time * spline_time;
-    float spline_time_cubed = spline_time_sqrd * spline_time;
+    position = spline_solution[0] + \
+               (spline_solution[1] + \
+                (spline_solution[2] + \
+                 spline_solution[3] * spline_time) * spline_time) * spline_time;
+
+    velocity = spline_solution[1] + \
+               (spline_solution[2] * 2.0f + \
+                spline_solution[3] * (3.0f * spline_time)) * spline_time;
+}
 
-    position = _hermite_spline_solution[0] + \
-               _hermite_spline_solution[1] * spline_time + \
-               _hermite_spline_solution[2] * spline_time_sqrd + \
-               _hermite_spline_solution[3] * spline_time_cubed;
+/// update_spline_length - recalculates the arc length table of a spline segment from its hermite spline solution
+///     each step of the table sums the chords between WPNAV_SPLINE_LENGTH_SUBSTEPS points on the spline
+void AC_WPNav::update_spline_length(const Vector3f spline_solution[4], spline_length_table& table)
+{
+    const uint16_t num_points = WPNAV_SPLINE_LENGTH_STEPS * WPNAV_SPLINE_LENGTH_SUBSTEPS;
+    Vector3f prev_pos = spline_solution[0];
+    Vector3f pos, vel;
+    float length = 0.0f;
+
+    table.length[0] = 0.0f;
+    table.speed[0] = spline_solution[1].length();
+    for (uint16_t i = 1; i <= num_points; i++) {
+        calc_spline_pos_vel(spline_solution, (float)i / num_points, pos, vel);
+        length += (pos - prev_pos).length();
+        prev_pos = pos;
+        if (i % WPNAV_SPLINE_LENGTH_SUBSTEPS == 0) {
+            table.length[i / WPNAV_SPLINE_LENGTH_SUBSTEPS] = length;
+            table.speed[i / WPNAV_SPLINE_LENGTH_SUBSTEPS] = vel.length();
+        }
+    }
+}
+
+/// spline_step_length - distance in cm along the spline at fraction u of step i of the arc length table
+///     the distance is a cubic hermite curve through the lengths and speeds at either end of the step, which
+///     unlike a straight line follows the distance growing with the square of the time after a stop
+float AC_WPNav::spline_step_length(const spline_length_table& table, uint8_t i, float u, float& rate)
+{
+    const float h = 1.0f / WPNAV_SPLINE_LENGTH_STEPS;
+    const float l0 = table.length[i];
+    const float l1 = table.length[i+1];
+    const float m0 = table.speed[i] * h;
+    const float m1 = table.speed[i+1] * h;
+    const float u2 = u * u;
+    const float u3 = u2 * u;
+
+    rate = (6.0f*u2 - 6.0f*u) * (l0 - l1) + (3.0f*u2 - 4.0f*u + 1.0f) * m0 + (3.0f*u2 - 2.0f*u) * m1;
+    return (2.0f*u3 - 3.0f*u2 + 1.0f) * l0 + (u3 - 2.0f*u2 + u) * m0 + (3.0f*u2 - 2.0f*u3) * l1 + (u3 - u2) * m1;
+}
+
+/// spline_length_at_time - distance in cm along the spline from the origin at the given spline time
+///     interpolates the arc length table, extrapolating at the destination's speed past the destination
+float AC_WPNav::spline_length_at_time(const spline_length_table& table, float spline_time)
+{
+    const float step = MAX(spline_time, 0.0f) * WPNAV_SPLINE_LENGTH_STEPS;
+    if (step >= WPNAV_SPLINE_LENGTH_STEPS) {
+        return table.length[WPNAV_SPLINE_LENGTH_STEPS] + (spline_time - 1.0f) * table.speed[WPNAV_SPLINE_LENGTH_STEPS];
+    }
+    const uint8_t i = (uint8_t)step;
+    float rate;
+    return spline_step_length(table, i, step - i, rate);
+}
 
-    velocity = _hermite_spline_solution[1] + \
-               _hermite_spline_solution[2] * 2.0f * spline_time + \
-               _hermite_spline_solution[3] * 3.0f * spline_time_sqrd;
+/// spline_time_at_length - spline time at the given distance in cm along the spline from the origin
+///     inverts spline_length_at_time, extrapolating at the destination's speed past the destination
+float AC_WPNav::spline_time_at_length(const spline_length_table& table, float length_cm)
+{
+    if (length_cm <= 0.0f) {
+        return 0.0f;
+    }
+
+    if (length_cm >= table.length[WPNAV_SPLINE_LENGTH_STEPS]) {
+        const float speed = table.speed[WPNAV_SPLINE_LENGTH_STEPS];
+        if (!is_positive(speed)) {
+            return 1.0f;
+        }
+        return 1.0f + (length_cm - table.length[WPNAV_SPLINE_LENGTH_STEPS]) / speed;
+    }
+
+    // find the last step starting at or before length_cm
+    uint8_t low = 0;
+    uint8_t high = WPNAV_SPLINE_LENGTH_STEPS-1;
+    while (low < high) {
+        const uint8_t mid = (low + high + 1) / 2;
+        if (table.length[mid] <= length_cm) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    const float step_length = table.length[low+1] - table.length[low];
+    if (!is_positive(step_length)) {
+        // zero length step, only possible at the end of a degenerate spline
+        return (float)(low + 1) / WPNAV_SPLINE_LENGTH_STEPS;
+    }
+
+    // start from a straight line through the step and refine with a few newton iterations on the cubic
+    float u = (length_cm - table.length[low]) / step_length;
+    for (uint8_t n = 0; n < WPNAV_SPLINE_LENGTH_ITERATIONS; n++) {
+        float rate;
+        const float error = spline_step_length(table, low, u, rate) - length_cm;
+        if (!is_positive(rate)) {
+            break;
+        }
+        u = constrain_float(u - error / rate, 0.0f, 1.0f);
+    }
+    return (low + u) / WPNAV_SPLINE_LENGTH_STEPS;
 }
 
 // get terrain's altitude (in cm above the ekf origin) at the current position (+ve means terrain below vehicle is above ekf origin's altitude)
@@ -44,8 +44,14 @@
 
 #define WPNAV_RANGEFINDER_FILT_Z         0.25f      // range finder distance filtered at 0.25hz
 
+#define WPNAV_SPLINE_LENGTH_STEPS           16      // number of evenly spaced spline times in each spline segment's arc length table
+#define WPNAV_SPLINE_LENGTH_SUBSTEPS         4      // chords summed for each step of the arc length table
+#define WPNAV_SPLINE_LENGTH_ITERATIONS       4      // newton iterations used to find the spline time at a distance along the spline
+
 class AC_WPNav
 {
+    friend class AC_WPNav_Test;
+
 public:
 
     // spline segment end types enum
@@ -272,6 +278,12 @@ protected:
         SEGMENT_SPLINE = 1
     };
 
+    // arc length table of a spline segment
+    struct spline_length_table {
+        float length[WPNAV_SPLINE_LENGTH_STEPS+1];  // distance in cm along the spline from the origin at evenly spaced spline times
+        float speed[WPNAV_SPLINE_LENGTH_STEPS+1];   // speed of the spline at the same times in cm per unit of spline time
+    };
+
     // flags structure
     struct wpnav_flags {
         uint8_t reached_destination     : 1;    // true if we have reached the destination
@@ -304,7 +316,24 @@ protected:
 
     /// calc_spline_pos_vel - update position and velocity from given spline time
     /// 	relies on update_spline_solution being called since the previous
-    void calc_spline_pos_vel(float spline_time, Vector3f& position, Vector3f& velocity);
+    void calc_spline_pos_vel(float spline_time, Vector3f& position, Vector3f& velocity) {
+        calc_spline_pos_vel(_hermite_spline_solution, spline_time, position, velocity);
+    }
+    static void calc_spline_pos_vel(const Vector3f spline_solution[4], float spline_time, Vector3f& position, Vector3f& velocity);
+
+    /// update_spline_length - recalculates the arc length table of a spline segment from its hermite spline solution
+    static void update_spline_length(const Vector3f spline_solution[4], spline_length_table& table);
+
+    /// spline_step_length - distance in cm along the spline at fraction u of step i of the arc length table
+    ///     rate is set to the rate of change of the distance with u
+    static float spline_step_length(const spline_length_table& table, uint8_t i, float u, float& rate);
+
+    /// spline_length_at_time - distance in cm along the spline from the origin at the given spline time
+    static float spline_length_at_time(const spline_length_table& table, float spline_time);
+
+    /// spline_time_at_length - spline time at the given distance in cm along the spline from the origin
+    ///     distances past the destination give spline times above 1
+    static float spline_time_at_length(const spline_length_table& table, float length_cm);
 
     // get terrain's altitude (in cm above the ekf origin) at the current position (+ve means terrain below vehicle is above ekf origin's altitude)
     bool get_terrain_offset(float& offset_cm);
@@ -358,10 +387,10 @@ protected:
 
     // spline variables
     float       _spline_time;           // current spline time between origin and destination
-    float       _spline_time_scale;     // current spline time between origin and destination
     Vector3f    _spline_origin_vel;     // the target velocity vector at the origin of the spline segment
     Vector3f    _spline_destination_vel;// the target velocity vector at the destination point of the spline segment
     Vector3f    _hermite_spline_solution[4]; // array describing spline path between origin and destination
+    spline_length_table _spline_length; // arc length table of the spline segment
     float       _spline_vel_scaler;	    //
     float       _yaw;                   // heading according to yaw
 
@@ -0,0 +1,124 @@
+#include <AP_gtest.h>
+
+#include <AC_WPNav/AC_WPNav.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#define SPEED_CMS 500.0f
+#define DT 0.01f
+
+class AC_WPNav_Test
+{
+public:
+    // hermite spline from origin to dest, as update_spline_solution() builds it
+    AC_WPNav_Test(const Vector3f& origin, const Vector3f& dest, const Vector3f& origin_vel, const Vector3f& dest_vel)
+    {
+        solution[0] = origin;
+        solution[1] = origin_vel;
+        solution[2] = -origin*3.0f -origin_vel*2.0f + dest*3.0f - dest_vel;
+        solution[3] = origin*2.0f + origin_vel -dest*2.0f + dest_vel;
+        AC_WPNav::update_spline_length(solution, length);
+    }
+
+    Vector3f pos(float spline_time) const
+    {
+        Vector3f position, velocity;
+        AC_WPNav::calc_spline_pos_vel(solution, spline_time, position, velocity);
+        return position;
+    }
+
+    float total_length() const { return length.length[WPNAV_SPLINE_LENGTH_STEPS]; }
+    float length_at_time(float spline_time) const { return AC_WPNav::spline_length_at_time(length, spline_time); }
+    float time_at_length(float length_cm) const { return AC_WPNav::spline_time_at_length(length, length_cm); }
+
+    // the spline time after one step at SPEED_CMS, as advance_spline_target_along_track() moves it
+    float advance(float spline_time) const
+    {
+        return time_at_length(length_at_time(spline_time) + SPEED_CMS * DT);
+    }
+
+    // the spline time after one step at SPEED_CMS, as the target was moved
+    // before, scaling the step by the speed of the spline at spline_time
+    float advance_by_spline_speed(float spline_time) const
+    {
+        Vector3f position, velocity;
+        AC_WPNav::calc_spline_pos_vel(solution, spline_time, position, velocity);
+        return spline_time + SPEED_CMS / velocity.length() * DT;
+    }
+
+    Vector3f solution[4];
+    AC_WPNav::spline_length_table length;
+};
+
+// a segment starting from a stop and turning towards the next waypoint
+static const AC_WPNav_Test curve(Vector3f(0, 0, 0), Vector3f(2000, 1000, 0),
+                                 Vector3f(0, 0, 0), Vector3f(1500, 1500, 0));
+
+TEST(AC_WPNav, spline_length_straight)
+{
+    const AC_WPNav_Test line(Vector3f(0, 0, 0), Vector3f(1000, 0, 0),
+                             Vector3f(1000, 0, 0), Vector3f(1000, 0, 0));
+
+    EXPECT_NEAR(1000.0f, line.total_length(), 0.01f);
+    EXPECT_NEAR(500.0f, line.length_at_time(0.5f), 0.01f);
+    EXPECT_NEAR(0.25f, line.time_at_length(250.0f), 1.0e-5f);
+    EXPECT_EQ(0.0f, line.time_at_length(-10.0f));
+
+    // past the destination the last step of the table is extrapolated
+    EXPECT_NEAR(1.1f, line.time_at_length(1100.0f), 1.0e-5f);
+    EXPECT_NEAR(1100.0f, line.length_at_time(1.1f), 0.01f);
+}
+
+TEST(AC_WPNav, spline_length_inverse)
+{
+    // the chords are never longer than the spline
+    const float chord = (curve.pos(1.0f) - curve.pos(0.0f)).length();
+    EXPECT_GT(curve.total_length(), chord);
+
+    for (float t = 0.0f; t <= 1.0f; t += 0.05f) {
+        EXPECT_NEAR(t, curve.time_at_length(curve.length_at_time(t)), 1.0e-4f);
+    }
+}
+
+TEST(AC_WPNav, spline_target_progress)
+{
+    // the target moves SPEED_CMS*DT along the spline each step, from the stop at the origin to the destination
+    float t = 0.0f;
+    uint16_t steps = 0;
+    while (t < 1.0f && steps < 10000) {
+        const float next = curve.advance(t);
+        const float moved = (curve.pos(next) - curve.pos(t)).length();
+        if (next < 1.0f) {
+            EXPECT_NEAR(SPEED_CMS * DT, moved, 0.02f * SPEED_CMS * DT) << "at spline time " << t;
+        }
+        t = next;
+        steps++;
+    }
+    const float expected_steps = curve.total_length() / (SPEED_CMS * DT);
+    EXPECT_NEAR(expected_steps, steps, 1.0f);
+}
+
+TEST(AC_WPNav, spline_target_progress_matches_spline_speed)
+{
+    // away from the ends, scaling by the spline speed moved the target by
+    // the same distance, so cruising along a segment is unchanged
+    for (float t = 0.2f; t < 0.9f; t += 0.1f) {
+        const float moved = (curve.pos(curve.advance(t)) - curve.pos(t)).length();
+        const float moved_before = (curve.pos(curve.advance_by_spline_speed(t)) - curve.pos(t)).length();
+        EXPECT_NEAR(moved_before, moved, 0.02f * SPEED_CMS * DT) << "at spline time " << t;
+    }
+}
+
+TEST(AC_WPNav, spline_target_progress_from_stop)
+{
+    // just after a stop the spline is slow, scaling by its speed threw
+    // the target far along the segment while the arc length moves it the
+    // intended distance
+    const float t = 0.001f;
+    const float moved = (curve.pos(curve.advance(t)) - curve.pos(t)).length();
+    const float moved_before = (curve.pos(curve.advance_by_spline_speed(t)) - curve.pos(t)).length();
+    EXPECT_NEAR(SPEED_CMS * DT, moved, 0.02f * SPEED_CMS * DT);
+    EXPECT_GT(moved_before, 10.0f * SPEED_CMS * DT);
+}
+
+AP_GTEST_MAIN()
@@ -164,6 +164,7 @@ void AP_ADSB::update(void)
     if (!_ahrs.get_position(_my_loc)) {
         _my_loc.zero();
     }
+    _my_frame.set_origin(_my_loc);
 
     if (!_enabled) {
         if (in_state.vehicle_list != nullptr) {
@@ -258,7 +259,7 @@ void AP_ADSB::determine_furthest_aircraft(void)
     uint16_t max_distance_index = 0;
 
     for (uint16_t index = 0; index < in_state.vehicle_count; index++) {
-        float distance = _my_loc.get_distance(get_location(in_state.vehicle_list[index]));
+        float distance = _my_frame.get_distance(get_location(in_state.vehicle_list[index]));
         if (max_distance < distance || index == 0) {
             max_distance = distance;
             max_distance_index = index;
@@ -336,7 +337,7 @@ void AP_ADSB::handle_vehicle(const mavlink_message_t* packet)
     mavlink_msg_adsb_vehicle_decode(packet, &vehicle.info);
     Location_Class vehicle_loc = Location_Class(AP_ADSB::get_location(vehicle));
     bool my_loc_is_zero = _my_loc.is_zero();
-    float my_loc_distance_to_vehicle = _my_loc.get_distance(vehicle_loc);
+    float my_loc_distance_to_vehicle = _my_frame.get_distance(vehicle_loc);
     bool out_of_range = in_state.list_radius > 0 && !my_loc_is_zero && my_loc_distance_to_vehicle > in_state.list_radius;
     bool is_tracked_in_list = find_index(vehicle, &index);
     uint32_t now = AP_HAL::millis();
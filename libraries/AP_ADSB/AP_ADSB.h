@@ -116,6 +116,8 @@ private:
     AP_Int8     _enabled;
 
     Location_Class  _my_loc;
+    // frame at _my_loc for the distances to the vehicles
+    LocalFrame      _my_frame;
 
 
     // ADSB-IN state. Maintains list of external vehicles
@@ -128,6 +128,15 @@ const AP_Param::GroupInfo AP_AHRS::var_info[] = {
     AP_GROUPINFO("EKF_TYPE",  14, AP_AHRS, _ekf_type, 2),
 #endif
 
+#if AP_AHRS_NAVEKF_ASYNC_AVAILABLE
+    // @Param: EKF_ASYNC
+    // @DisplayName: Run the secondary EKF asynchronously
+    // @Description: When both EKF2 and EKF3 are enabled, run the one not selected by AHRS_EKF_TYPE on a lower priority thread instead of in the fast loop. It is fed the same IMU and other sensor data through a queue and may lag behind the primary. Not used with beacons enabled.
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("EKF_ASYNC",  15, AP_AHRS, _ekf_async, 0),
+#endif
+
     AP_GROUPEND
 };
 
@@ -592,6 +592,7 @@ protected:
     AP_Int8 _gps_minsats;
     AP_Int8 _gps_delay;
     AP_Int8 _ekf_type;
+    AP_Int8 _ekf_async;
 
     // flags structure
     struct ahrs_flags {
@@ -0,0 +1,332 @@
+#pragma once
+
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  run the updates of a filter on a thread of its own, from a queue of
+  the samples it would have been given in the fast loop.
+
+  The main thread never waits for an update, only for the short queue
+  operations, so a low priority thread can't hold up the fast loop.
+  Calls which change the filter are written into the Commands with
+  commands_take()/commands_give() instead of being made directly.
+  They go out with the next sample pushed, and the thread apply()s
+  them just before that sample's update, in the same order relative
+  to the samples as if the filter had been run in the fast loop.
+
+  Sample must have accumulate(const Sample &newer), and Commands
+  merge(const Commands &newer). A default constructed Commands does
+  nothing.
+ */
+
+#include <AP_HAL/AP_HAL_Boards.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include <AP_HAL/utility/RingBuffer.h>
+
+template <typename Sample, typename Commands, typename Output>
+class AP_AHRS_Async
+{
+public:
+    // priority is the SCHED_FIFO priority of the thread, 0 to leave it
+    // with the default scheduling
+    AP_AHRS_Async(uint16_t queue_size, int priority) :
+        _queue_size(queue_size),
+        _priority(priority),
+        _thread_started(false),
+        _exit(false),
+        _queue(nullptr),
+        _running(false),
+        _busy(false),
+        _have_pending(false),
+        _queued_us(0),
+        _processed_us(0),
+        _overflows(0)
+    {
+        // the main thread shares the queue lock with the thread, so
+        // don't let it be held up by something preempting the thread
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+        pthread_mutex_init(&_mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+        pthread_cond_init(&_cond, nullptr);
+    }
+
+    // stop() must have been called first, so update() isn't running
+    virtual ~AP_AHRS_Async(void)
+    {
+        if (_thread_started) {
+            pthread_mutex_lock(&_mutex);
+            _exit = true;
+            pthread_cond_broadcast(&_cond);
+            pthread_mutex_unlock(&_mutex);
+            pthread_join(_thread, nullptr);
+        }
+        delete _queue;
+        pthread_cond_destroy(&_cond);
+        pthread_mutex_destroy(&_mutex);
+    }
+
+    // begin taking samples, creating the thread on first use. output
+    // is returned by get_output() until the first update. False if the
+    // thread couldn't be created
+    bool start(const Output &output);
+
+    // wait up to timeout_ms for the queued samples to be used, then
+    // drop any left and wait for the update in progress. Commands not
+    // used by the thread are applied here. Returns false if samples
+    // were dropped
+    bool stop(uint32_t timeout_ms);
+
+    bool running(void) const { return _running; }
+
+    // queue the data for one update along with the commands given
+    // since the last push. If the thread has fallen behind so the queue
+    // is full, newer samples are folded into one waiting for space so
+    // none of their data is lost
+    void push(const Sample &sample, uint32_t time_us);
+
+    // lock and return the commands going with the next push()
+    Commands &commands_take(void)
+    {
+        pthread_mutex_lock(&_mutex);
+        return _commands;
+    }
+    void commands_give(void) { pthread_mutex_unlock(&_mutex); }
+
+    // the output published after the last update
+    void get_output(Output &output)
+    {
+        pthread_mutex_lock(&_mutex);
+        output = _output;
+        pthread_mutex_unlock(&_mutex);
+    }
+
+    // time between the last sample pushed and the last one used
+    uint32_t lag_us(void) const { return _queued_us - _processed_us; }
+
+    // number of times a sample had to wait for space in the queue
+    uint32_t overflows(void) const { return _overflows; }
+
+    // the sample of the update in progress. Only changed by the thread
+    // between updates, so a filter may read it through a pointer
+    const Sample &current(void) const { return _current.sample; }
+
+protected:
+    // both called on the thread, or by stop() while it is idle
+    virtual void apply(const Commands &commands) = 0;
+    virtual void update(const Sample &sample, Output &output) = 0;
+
+private:
+    struct entry {
+        Sample sample;
+        Commands commands;
+        uint32_t time_us;
+    };
+
+    static void *thread_main(void *arg);
+    void run(void);
+
+    const uint16_t _queue_size;
+    const int _priority;
+
+    pthread_t _thread;
+    bool _thread_started;
+    bool _exit;
+    // protects everything below, signals new samples and idling
+    pthread_mutex_t _mutex;
+    pthread_cond_t _cond;
+    ObjectBuffer<entry> *_queue;
+    bool _running;
+    bool _busy;
+    // sample which didn't fit in the queue, accumulating newer ones
+    entry _pending;
+    bool _have_pending;
+    Commands _commands;
+    Output _output;
+    volatile uint32_t _queued_us;
+    volatile uint32_t _processed_us;
+    uint32_t _overflows;
+
+    // only used by the thread
+    entry _current;
+};
+
+template <typename Sample, typename Commands, typename Output>
+bool AP_AHRS_Async<Sample, Commands, Output>::start(const Output &output)
+{
+    if (_queue == nullptr) {
+        _queue = new ObjectBuffer<entry>(_queue_size);
+        if (_queue == nullptr) {
+            return false;
+        }
+    }
+
+    if (!_thread_started) {
+        int ret = -1;
+        if (_priority > 0) {
+            pthread_attr_t attr;
+            pthread_attr_init(&attr);
+            struct sched_param param = { .sched_priority = _priority };
+            pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+            pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+            pthread_attr_setschedparam(&attr, &param);
+            ret = pthread_create(&_thread, &attr, &AP_AHRS_Async::thread_main, this);
+            pthread_attr_destroy(&attr);
+        }
+        if (ret != 0) {
+            // without permission to change the scheduling, run with
+            // the default priority
+            ret = pthread_create(&_thread, nullptr, &AP_AHRS_Async::thread_main, this);
+        }
+        if (ret != 0) {
+            return false;
+        }
+        _thread_started = true;
+    }
+
+    pthread_mutex_lock(&_mutex);
+    _output = output;
+    _queued_us = _processed_us = 0;
+    _commands = Commands();
+    _running = true;
+    pthread_mutex_unlock(&_mutex);
+    return true;
+}
+
+template <typename Sample, typename Commands, typename Output>
+bool AP_AHRS_Async<Sample, Commands, Output>::stop(uint32_t timeout_ms)
+{
+    if (!_running) {
+        return true;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += timeout_ms * 1000000UL;
+    while (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    bool drained = true;
+    pthread_mutex_lock(&_mutex);
+    while (_have_pending || _busy || !_queue->empty()) {
+        if (_have_pending && _queue->push(_pending)) {
+            _have_pending = false;
+            pthread_cond_broadcast(&_cond);
+        }
+        if (!drained) {
+            // only waiting for the update in progress
+            pthread_cond_wait(&_cond, &_mutex);
+        } else if (pthread_cond_timedwait(&_cond, &_mutex, &deadline) == ETIMEDOUT) {
+            // drop the samples, but keep their commands to apply below
+            Commands commands;
+            entry e;
+            while (_queue->pop(e)) {
+                commands.merge(e.commands);
+            }
+            if (_have_pending) {
+                commands.merge(_pending.commands);
+                _have_pending = false;
+            }
+            commands.merge(_commands);
+            _commands = commands;
+            drained = false;
+        }
+    }
+    _running = false;
+    const Commands commands = _commands;
+    _commands = Commands();
+    pthread_mutex_unlock(&_mutex);
+
+    // the thread is idle now it isn't running
+    apply(commands);
+    return drained;
+}
+
+template <typename Sample, typename Commands, typename Output>
+void AP_AHRS_Async<Sample, Commands, Output>::push(const Sample &sample, uint32_t time_us)
+{
+    if (!_running) {
+        return;
+    }
+
+    pthread_mutex_lock(&_mutex);
+    if (_have_pending) {
+        // the thread is behind: fold this update into the sample
+        // waiting for space
+        _pending.sample.accumulate(sample);
+        _pending.commands.merge(_commands);
+        _pending.time_us = time_us;
+        if (_queue->push(_pending)) {
+            _have_pending = false;
+        }
+    } else {
+        _pending.sample = sample;
+        _pending.commands = _commands;
+        _pending.time_us = time_us;
+        if (!_queue->push(_pending)) {
+            _have_pending = true;
+            _overflows++;
+        }
+    }
+    _commands = Commands();
+    _queued_us = time_us;
+    pthread_cond_broadcast(&_cond);
+    pthread_mutex_unlock(&_mutex);
+}
+
+template <typename Sample, typename Commands, typename Output>
+void *AP_AHRS_Async<Sample, Commands, Output>::thread_main(void *arg)
+{
+    static_cast<AP_AHRS_Async *>(arg)->run();
+    return nullptr;
+}
+
+template <typename Sample, typename Commands, typename Output>
+void AP_AHRS_Async<Sample, Commands, Output>::run(void)
+{
+    pthread_mutex_lock(&_mutex);
+    while (!_exit) {
+        if (!_running || !_queue->pop(_current)) {
+            // let stop() know the queue has been drained
+            _busy = false;
+            pthread_cond_broadcast(&_cond);
+            pthread_cond_wait(&_cond, &_mutex);
+            continue;
+        }
+        _busy = true;
+        pthread_mutex_unlock(&_mutex);
+
+        apply(_current.commands);
+        Output output;
+        update(_current.sample, output);
+
+        pthread_mutex_lock(&_mutex);
+        _output = output;
+        _processed_us = _current.time_us;
+    }
+    pthread_mutex_unlock(&_mutex);
+}
+
+#endif // CONFIG_HAL_BOARD
@@ -22,6 +22,7 @@
  */
 #include "AP_AHRS.h"
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Scheduler/LatencyTrace.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -92,6 +93,11 @@ AP_AHRS_DCM::update(bool skip_ins_update)
 
     // update AOA and SSA
     update_AOA_SSA();
+
+    LatencyTrace *trace = LatencyTrace::get_instance();
+    if (trace != nullptr) {
+        trace->mark(LatencyTrace::STAGE_AHRS);
+    }
 }
 
 // update the DCM matrix using only the gyros
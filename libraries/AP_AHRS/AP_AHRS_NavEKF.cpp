@@ -24,6 +24,8 @@
 #include <AP_Vehicle/AP_Vehicle.h>
 #include <GCS_MAVLink/GCS.h>
 #include <AP_Module/AP_Module.h>
+#include <AP_Scheduler/LatencyTrace.h>
+#include <DataFlash/DataFlash.h>
 
 #if AP_AHRS_NAVEKF_AVAILABLE
 
@@ -34,6 +36,7 @@ AP_AHRS_NavEKF::AP_AHRS_NavEKF(AP_InertialSensor &ins, AP_Baro &baro, AP_GPS &gp
     AP_AHRS_DCM(ins, baro, gps),
     EKF2(_EKF2),
     EKF3(_EKF3),
+    _rng(rng),
     _ekf2_started(false),
     _ekf3_started(false),
     _force_ekf(false),
@@ -75,8 +78,17 @@ void AP_AHRS_NavEKF::reset_gyro_drift(void)
     AP_AHRS_DCM::reset_gyro_drift();
 
     // reset the EKF gyro bias states
-    EKF2.resetGyroBias();
-    EKF3.resetGyroBias();
+    async_commands *commands = async_commands_take();
+    if (commands != nullptr) {
+        commands->reset_gyro_bias = true;
+        async_commands_give();
+    }
+    if (!async_owns(EKF_TYPE2)) {
+        EKF2.resetGyroBias();
+    }
+    if (!async_owns(EKF_TYPE3)) {
+        EKF3.resetGyroBias();
+    }
 }
 
 void AP_AHRS_NavEKF::update(bool skip_ins_update)
@@ -86,6 +98,7 @@ void AP_AHRS_NavEKF::update(bool skip_ins_update)
         _ekf_type.set(2);
     }
     update_DCM(skip_ins_update);
+    async_select();
     if (_ekf_type == 2) {
         // if EK2 is primary then run EKF2 first to give it CPU
         // priority
@@ -96,10 +109,16 @@ void AP_AHRS_NavEKF::update(bool skip_ins_update)
         update_EKF3();
         update_EKF2();
     }
+    async_push();
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
     update_SITL();
 #endif
 
+    LatencyTrace *trace = LatencyTrace::get_instance();
+    if (trace != nullptr) {
+        trace->mark(LatencyTrace::STAGE_AHRS);
+    }
+
     // call AHRS_update hook if any
     AP_Module::call_hook_AHRS_update(*this);
 
@@ -146,7 +165,9 @@ void AP_AHRS_NavEKF::update_EKF2(void)
         }
     }
     if (_ekf2_started) {
-        EKF2.UpdateFilter();
+        if (!async_owns(EKF_TYPE2)) {
+            EKF2.UpdateFilter();
+        }
         if (active_EKF_type() == EKF_TYPE2) {
             Vector3f eulers;
             EKF2.getRotationBodyToNED(_dcm_matrix);
@@ -216,7 +237,9 @@ void AP_AHRS_NavEKF::update_EKF3(void)
         }
     }
     if (_ekf3_started) {
-        EKF3.UpdateFilter();
+        if (!async_owns(EKF_TYPE3)) {
+            EKF3.UpdateFilter();
+        }
         if (active_EKF_type() == EKF_TYPE3) {
             Vector3f eulers;
             EKF3.getRotationBodyToNED(_dcm_matrix);
@@ -329,7 +352,7 @@ void AP_AHRS_NavEKF::update_SITL(void)
             Vector3f earth_vel = Vector3f(fdm.speedN,fdm.speedE,fdm.speedD);
             Vector3f delPos = Tbn.transposed() * (earth_vel * delTime);
             // write to EKF
-            EKF3.writeBodyFrameOdom(quality, delPos, delAng, delTime, timeStamp_ms, posOffset);
+            writeBodyFrameOdom(quality, delPos, delAng, delTime, timeStamp_ms, posOffset);
         }
     }
 }
@@ -357,6 +380,7 @@ void AP_AHRS_NavEKF::reset(bool recover_eulers)
 {
     AP_AHRS_DCM::reset(recover_eulers);
     _dcm_attitude(roll, pitch, yaw);
+    async_stop();
     if (_ekf2_started) {
         _ekf2_started = EKF2.InitialiseFilter();
     }
@@ -370,6 +394,7 @@ void AP_AHRS_NavEKF::reset_attitude(const float &_roll, const float &_pitch, con
 {
     AP_AHRS_DCM::reset_attitude(_roll, _pitch, _yaw);
     _dcm_attitude(roll, pitch, yaw);
+    async_stop();
     if (_ekf2_started) {
         _ekf2_started = EKF2.InitialiseFilter();
     }
@@ -492,7 +517,9 @@ bool AP_AHRS_NavEKF::get_secondary_attitude(Vector3f &eulers)
     switch (active_EKF_type()) {
     case EKF_TYPE_NONE:
         // EKF is secondary
-        EKF2.getEulerAngles(-1, eulers);
+        if (!async_get_output(EKF_TYPE2, &eulers, nullptr, nullptr)) {
+            EKF2.getEulerAngles(-1, eulers);
+        }
         return _ekf2_started;
 
     case EKF_TYPE2:
@@ -513,7 +540,9 @@ bool AP_AHRS_NavEKF::get_secondary_quaternion(Quaternion &quat)
     switch (active_EKF_type()) {
     case EKF_TYPE_NONE:
         // EKF is secondary
-        EKF2.getQuaternion(-1, quat);
+        if (!async_get_output(EKF_TYPE2, nullptr, &quat, nullptr)) {
+            EKF2.getQuaternion(-1, quat);
+        }
         return _ekf2_started;
 
     case EKF_TYPE2:
@@ -533,7 +562,9 @@ bool AP_AHRS_NavEKF::get_secondary_position(struct Location &loc)
     switch (active_EKF_type()) {
     case EKF_TYPE_NONE:
         // EKF is secondary
-        EKF2.getLLH(loc);
+        if (!async_get_output(EKF_TYPE2, nullptr, nullptr, &loc)) {
+            EKF2.getLLH(loc);
+        }
         return _ekf2_started;
 
     case EKF_TYPE2:
@@ -584,8 +615,16 @@ void AP_AHRS_NavEKF::set_home(const Location &loc)
 // from which to decide the origin on its own
 bool AP_AHRS_NavEKF::set_origin(const Location &loc)
 {
-    bool ret2 = EKF2.setOriginLLH(loc);
-    bool ret3 = EKF3.setOriginLLH(loc);
+    // the asynchronous EKF is never the active one, so its result
+    // isn't needed
+    async_commands *commands = async_commands_take();
+    if (commands != nullptr) {
+        commands->set_origin = true;
+        commands->origin = loc;
+        async_commands_give();
+    }
+    bool ret2 = !async_owns(EKF_TYPE2) && EKF2.setOriginLLH(loc);
+    bool ret3 = !async_owns(EKF_TYPE3) && EKF3.setOriginLLH(loc);
 
     // return success if active EKF's origin was set
     switch (active_EKF_type()) {
@@ -1142,34 +1181,69 @@ bool AP_AHRS_NavEKF::get_filter_status(nav_filter_status &status) const
 // write optical flow data to EKF
 void  AP_AHRS_NavEKF::writeOptFlowMeas(uint8_t &rawFlowQuality, Vector2f &rawFlowRates, Vector2f &rawGyroRates, uint32_t &msecFlowMeas, const Vector3f &posOffset)
 {
-    EKF2.writeOptFlowMeas(rawFlowQuality, rawFlowRates, rawGyroRates, msecFlowMeas, posOffset);
-    EKF3.writeOptFlowMeas(rawFlowQuality, rawFlowRates, rawGyroRates, msecFlowMeas, posOffset);
+    async_commands *commands = async_commands_take();
+    if (commands != nullptr) {
+        commands->opt_flow = true;
+        commands->flow_quality = rawFlowQuality;
+        commands->flow_rates = rawFlowRates;
+        commands->flow_gyro_rates = rawGyroRates;
+        commands->flow_ms = msecFlowMeas;
+        commands->flow_pos_offset = posOffset;
+        async_commands_give();
+    }
+    if (!async_owns(EKF_TYPE2)) {
+        EKF2.writeOptFlowMeas(rawFlowQuality, rawFlowRates, rawGyroRates, msecFlowMeas, posOffset);
+    }
+    if (!async_owns(EKF_TYPE3)) {
+        EKF3.writeOptFlowMeas(rawFlowQuality, rawFlowRates, rawGyroRates, msecFlowMeas, posOffset);
+    }
 }
 
 // write body frame odometry measurements to the EKF
 void  AP_AHRS_NavEKF::writeBodyFrameOdom(float quality, const Vector3f &delPos, const Vector3f &delAng, float delTime, uint32_t timeStamp_ms, const Vector3f &posOffset)
 {
-    EKF3.writeBodyFrameOdom(quality, delPos, delAng, delTime, timeStamp_ms, posOffset);
+    if (!async_owns(EKF_TYPE3)) {
+        EKF3.writeBodyFrameOdom(quality, delPos, delAng, delTime, timeStamp_ms, posOffset);
+        return;
+    }
+    async_commands *commands = async_commands_take();
+    if (commands != nullptr) {
+        commands->body_odom = true;
+        commands->odom_quality = quality;
+        commands->odom_del_pos = delPos;
+        commands->odom_del_ang = delAng;
+        commands->odom_del_time = delTime;
+        commands->odom_ms = timeStamp_ms;
+        commands->odom_pos_offset = posOffset;
+        async_commands_give();
+    }
 }
 
 // inhibit GPS usage
 uint8_t AP_AHRS_NavEKF::setInhibitGPS(void)
 {
+    uint8_t ret = false;
+    // the primary EKF is never the asynchronous one once that has
+    // caught up with a change of EKF_TYPE
+    async_select();
     switch (ekf_type()) {
     case 0:
 
     case 2:
     default:
-        return EKF2.setInhibitGPS();
+        ret = EKF2.setInhibitGPS();
+        break;
 
     case 3:
-        return EKF3.setInhibitGPS();
+        ret = EKF3.setInhibitGPS();
+        break;
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
     case EKF_TYPE_SITL:
-        return false;
+        break;
 #endif
     }
+    return ret;
 }
 
 // get speed limit
@@ -1357,16 +1431,28 @@ uint32_t AP_AHRS_NavEKF::getLastPosDownReset(float &posDelta) const
 // If using a range finder for height no reset is performed and it returns false
 bool AP_AHRS_NavEKF::resetHeightDatum(void)
 {
+    // the other EKF may be the asynchronous one
+    async_select();
+    async_commands *commands = async_commands_take();
+    if (commands != nullptr) {
+        commands->reset_height_datum = true;
+        async_commands_give();
+    }
+
     switch (ekf_type()) {
 
     case 2:
     default: {
-        EKF3.resetHeightDatum();
+        if (!async_owns(EKF_TYPE3)) {
+            EKF3.resetHeightDatum();
+        }
         return EKF2.resetHeightDatum();
     }
 
     case 3: {
-        EKF2.resetHeightDatum();
+        if (!async_owns(EKF_TYPE2)) {
+            EKF2.resetHeightDatum();
+        }
         return EKF3.resetHeightDatum();
     }
 
@@ -1518,6 +1604,7 @@ bool AP_AHRS_NavEKF::get_variances(float &velVar, float &posVar, float &hgtVar,
 
 void AP_AHRS_NavEKF::setTakeoffExpected(bool val)
 {
+    async_select();
     switch (ekf_type()) {
         case EKF_TYPE2:
         default:
@@ -1537,6 +1624,7 @@ void AP_AHRS_NavEKF::setTakeoffExpected(bool val)
 
 void AP_AHRS_NavEKF::setTouchdownExpected(bool val)
 {
+    async_select();
     switch (ekf_type()) {
         case EKF_TYPE2:
         default:
@@ -1688,5 +1776,302 @@ bool AP_AHRS_NavEKF::save_learnt_compass_offsets(float learn_proportion)
     return false;
 }
 
+// return true if the given EKF is being run by the asynchronous thread
+bool AP_AHRS_NavEKF::async_owns(EKF_TYPE type) const
+{
+#if AP_AHRS_NAVEKF_ASYNC_AVAILABLE
+    return _async_type == type;
+#else
+    return false;
+#endif
+}
+
+// copy the outputs the asynchronous thread published after its last
+// update of the given EKF, false if it isn't running it
+bool AP_AHRS_NavEKF::async_get_output(EKF_TYPE type, Vector3f *eulers, Quaternion *quat, Location *loc)
+{
+#if AP_AHRS_NAVEKF_ASYNC_AVAILABLE
+    if (!async_owns(type)) {
+        return false;
+    }
+    async_output output;
+    _async.get_output(output);
+    if (eulers != nullptr) {
+        *eulers = output.eulers;
+    }
+    if (quat != nullptr) {
+        *quat = output.quat;
+    }
+    if (loc != nullptr) {
+        *loc = output.loc;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+// stop the EKF running on the thread updating in the fast loop, if
+// AHRS_EKF_ASYNC or the primary EKF have changed, and hand the
+// non-primary one to the thread once it has started. Beacons are read
+// by the EKFs directly rather than from a snapshot, so with them
+// enabled both EKFs stay in the fast loop
+void AP_AHRS_NavEKF::async_select(void)
+{
+#if AP_AHRS_NAVEKF_ASYNC_AVAILABLE
+    EKF_TYPE type = EKF_TYPE_NONE;
+    if (_ekf_async != 0 && (_beacon == nullptr || !_beacon->enabled())) {
+        if (_ekf_type == 2 && _ekf3_started) {
+            type = EKF_TYPE3;
+        } else if (_ekf_type == 3 && _ekf2_started) {
+            type = EKF_TYPE2;
+        }
+    }
+    if (type == _async_type) {
+        return;
+    }
+    async_stop();
+    if (type != EKF_TYPE_NONE && !async_start(type)) {
+        // don't try again until the parameter is changed
+        _ekf_async.set(0);
+    }
+#endif
+}
+
+// queue the IMU data used by this update for the asynchronous EKF,
+// with the calls made on it since the last one
+void AP_AHRS_NavEKF::async_push(void)
+{
+#if AP_AHRS_NAVEKF_ASYNC_AVAILABLE
+    if (_async_type == EKF_TYPE_NONE) {
+        return;
+    }
+
+    async_sample sample;
+    sample.imu.capture(_ins, AP_HAL::micros64());
+    sample.sensors.capture(_gps, _compass, _baro, _rng, _airspeed);
+    _async.push(sample, (uint32_t)sample.imu.time_us);
+#endif
+}
+
+// wait for the thread to use up the queued data and go back to
+// updating its EKF in the fast loop. If it can't catch up within
+// AP_AHRS_NAVEKF_ASYNC_STOP_MS the rest of the queue is dropped and
+// its EKF initialised again, so the fast loop is never held up for
+// more than one update of it
+void AP_AHRS_NavEKF::async_stop(void)
+{
+#if AP_AHRS_NAVEKF_ASYNC_AVAILABLE
+    if (_async_type == EKF_TYPE_NONE) {
+        return;
+    }
+
+    const bool drained = _async.stop(AP_AHRS_NAVEKF_ASYNC_STOP_MS);
+
+    const EKF_TYPE type = _async_type;
+    _async_type = EKF_TYPE_NONE;
+    if (type == EKF_TYPE2) {
+        EKF2.setIMUSample(nullptr, nullptr);
+        if (!drained) {
+            // the EKF missed the samples dropped
+            _ekf2_started = EKF2.InitialiseFilter();
+        }
+    } else {
+        EKF3.setIMUSample(nullptr, nullptr);
+        if (!drained) {
+            _ekf3_started = EKF3.InitialiseFilter();
+        }
+    }
+#endif
+}
+
+// lock and return the calls to be made on the asynchronous EKF before
+// its next update, nullptr if no EKF is asynchronous
+AP_AHRS_NavEKF::async_commands *AP_AHRS_NavEKF::async_commands_take(void)
+{
+#if AP_AHRS_NAVEKF_ASYNC_AVAILABLE
+    if (_async_type != EKF_TYPE_NONE) {
+        return &_async.commands_take();
+    }
+#endif
+    return nullptr;
+}
+
+void AP_AHRS_NavEKF::async_commands_give(void)
+{
+#if AP_AHRS_NAVEKF_ASYNC_AVAILABLE
+    _async.commands_give();
+#endif
+}
+
+void AP_AHRS_NavEKF::async_commands::merge(const async_commands &newer)
+{
+    reset_gyro_bias |= newer.reset_gyro_bias;
+    reset_height_datum |= newer.reset_height_datum;
+    if (newer.set_origin) {
+        set_origin = true;
+        origin = newer.origin;
+    }
+    if (newer.opt_flow) {
+        opt_flow = true;
+        flow_quality = newer.flow_quality;
+        flow_rates = newer.flow_rates;
+        flow_gyro_rates = newer.flow_gyro_rates;
+        flow_ms = newer.flow_ms;
+        flow_pos_offset = newer.flow_pos_offset;
+    }
+    if (newer.body_odom) {
+        body_odom = true;
+        odom_quality = newer.odom_quality;
+        odom_del_pos = newer.odom_del_pos;
+        odom_del_ang = newer.odom_del_ang;
+        odom_del_time = newer.odom_del_time;
+        odom_ms = newer.odom_ms;
+        odom_pos_offset = newer.odom_pos_offset;
+    }
+    if (newer.log) {
+        log = true;
+        log_optflow = newer.log_optflow;
+    }
+}
+
+// make the calls common to both EKFs, in the order the main thread
+// would have
+template <typename EKF>
+void AP_AHRS_NavEKF::async_apply(EKF &ekf, const async_commands &commands)
+{
+    if (commands.reset_gyro_bias) {
+        ekf.resetGyroBias();
+    }
+    if (commands.set_origin) {
+        ekf.setOriginLLH(commands.origin);
+    }
+    if (commands.opt_flow) {
+        uint8_t quality = commands.flow_quality;
+        Vector2f rates = commands.flow_rates;
+        Vector2f gyro_rates = commands.flow_gyro_rates;
+        uint32_t ms = commands.flow_ms;
+        ekf.writeOptFlowMeas(quality, rates, gyro_rates, ms, commands.flow_pos_offset);
+    }
+    if (commands.reset_height_datum) {
+        ekf.resetHeightDatum();
+    }
+}
+
+// log EKF2 or EKF3 from the asynchronous thread, so it isn't read
+// while being updated
+bool AP_AHRS_NavEKF::async_log(uint8_t type, bool optFlowEnabled)
+{
+    if (!async_owns((EKF_TYPE)type)) {
+        return false;
+    }
+    async_commands *commands = async_commands_take();
+    if (commands != nullptr) {
+        commands->log = true;
+        commands->log_optflow = optFlowEnabled;
+        async_commands_give();
+    }
+    return true;
+}
+
+void AP_AHRS_NavEKF::get_NavEKF2_attitude_position(Vector3f &eulers, struct Location &loc)
+{
+    if (!async_get_output(EKF_TYPE2, &eulers, nullptr, &loc)) {
+        EKF2.getEulerAngles(-1, eulers);
+        EKF2.getLLH(loc);
+    }
+}
+
+uint32_t AP_AHRS_NavEKF::get_async_EKF_lag_us(void) const
+{
+#if AP_AHRS_NAVEKF_ASYNC_AVAILABLE
+    if (_async_type == EKF_TYPE_NONE) {
+        return 0;
+    }
+    return _async.lag_us();
+#else
+    return 0;
+#endif
+}
+
+#if AP_AHRS_NAVEKF_ASYNC_AVAILABLE
+// hand an EKF to the asynchronous thread, creating it on first use
+bool AP_AHRS_NavEKF::async_start(EKF_TYPE type)
+{
+    // the thread is idle, nothing reads the sample until the next push
+    async_output output;
+    if (type == EKF_TYPE2) {
+        EKF2.getEulerAngles(-1, output.eulers);
+        EKF2.getQuaternion(-1, output.quat);
+        EKF2.getLLH(output.loc);
+        EKF2.setIMUSample(&_async.current().imu, &_async.current().sensors);
+    } else {
+        EKF3.getEulerAngles(-1, output.eulers);
+        EKF3.getQuaternion(-1, output.quat);
+        EKF3.getLLH(output.loc);
+        EKF3.setIMUSample(&_async.current().imu, &_async.current().sensors);
+    }
+    if (!_async.start(output)) {
+        if (type == EKF_TYPE2) {
+            EKF2.setIMUSample(nullptr, nullptr);
+        } else {
+            EKF3.setIMUSample(nullptr, nullptr);
+        }
+        return false;
+    }
+    _async_type = type;
+    return true;
+}
+
+AP_AHRS_NavEKF::AsyncEKF::AsyncEKF(AP_AHRS_NavEKF &ahrs) :
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    // just below the main loop, above the IO threads
+    AP_AHRS_Async(AP_AHRS_NAVEKF_ASYNC_QUEUE_SIZE, 11),
+#else
+    AP_AHRS_Async(AP_AHRS_NAVEKF_ASYNC_QUEUE_SIZE, 0),
+#endif
+    _ahrs(ahrs)
+{
+}
+
+// make the calls posted from the main thread since the last update,
+// logging first as the main thread would have after that update
+void AP_AHRS_NavEKF::AsyncEKF::apply(const async_commands &commands)
+{
+    DataFlash_Class *dataflash = DataFlash_Class::instance();
+    if (_ahrs._async_type == EKF_TYPE2) {
+        if (commands.log && dataflash != nullptr) {
+            dataflash->Log_Write_EKF2(_ahrs, commands.log_optflow);
+        }
+        _ahrs.async_apply(_ahrs.EKF2, commands);
+    } else {
+        if (commands.log && dataflash != nullptr) {
+            dataflash->Log_Write_EKF3(_ahrs, commands.log_optflow);
+        }
+        _ahrs.async_apply(_ahrs.EKF3, commands);
+        if (commands.body_odom) {
+            _ahrs.EKF3.writeBodyFrameOdom(commands.odom_quality, commands.odom_del_pos, commands.odom_del_ang,
+                                          commands.odom_del_time, commands.odom_ms, commands.odom_pos_offset);
+        }
+    }
+}
+
+void AP_AHRS_NavEKF::AsyncEKF::update(const async_sample &sample, async_output &output)
+{
+    // the EKF reads the sample through the pointer set in async_start()
+    if (_ahrs._async_type == EKF_TYPE2) {
+        _ahrs.EKF2.UpdateFilter();
+        _ahrs.EKF2.getEulerAngles(-1, output.eulers);
+        _ahrs.EKF2.getQuaternion(-1, output.quat);
+        _ahrs.EKF2.getLLH(output.loc);
+    } else {
+        _ahrs.EKF3.UpdateFilter();
+        _ahrs.EKF3.getEulerAngles(-1, output.eulers);
+        _ahrs.EKF3.getQuaternion(-1, output.quat);
+        _ahrs.EKF3.getLLH(output.loc);
+    }
+}
+#endif // AP_AHRS_NAVEKF_ASYNC_AVAILABLE
+
 #endif // AP_AHRS_NAVEKF_AVAILABLE
 
@@ -36,6 +36,13 @@
 #define AP_AHRS_NAVEKF_AVAILABLE 1
 #define AP_AHRS_NAVEKF_SETTLE_TIME_MS 20000     // time in milliseconds the ekf needs to settle after being started
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#include "AP_AHRS_Async.h"
+#define AP_AHRS_NAVEKF_ASYNC_AVAILABLE 1
+#define AP_AHRS_NAVEKF_ASYNC_QUEUE_SIZE 100     // IMU samples queued for the asynchronous EKF
+#define AP_AHRS_NAVEKF_ASYNC_STOP_MS 5          // time allowed to drain the queue before the asynchronous EKF is reset
+#endif
+
 class AP_AHRS_NavEKF : public AP_AHRS_DCM
 {
 public:
@@ -251,7 +258,20 @@ public:
 
     // save proportion of learned compass offsets
     bool save_learnt_compass_offsets(float learn_proportion);
-    
+
+    // time in microseconds the asynchronous secondary EKF lags behind
+    // the IMU data, 0 if none is running
+    uint32_t get_async_EKF_lag_us(void) const;
+
+    // have the asynchronous thread log EKF2 or EKF3 (2 or 3) after its
+    // current update. Returns false if that EKF isn't run by the thread,
+    // in which case the caller should log it
+    bool async_log(uint8_t ekf_type, bool optFlowEnabled);
+
+    // EKF2 attitude and position, as published by the asynchronous
+    // thread if it is running EKF2
+    void get_NavEKF2_attitude_position(Vector3f &eulers, struct Location &loc);
+
 private:
     enum EKF_TYPE {EKF_TYPE_NONE=0,
                    EKF_TYPE3=3,
@@ -268,6 +288,7 @@ private:
 
     NavEKF2 &EKF2;
     NavEKF3 &EKF3;
+    const RangeFinder &_rng;
     bool _ekf2_started;
     bool _ekf3_started;
     bool _force_ekf;
@@ -294,5 +315,91 @@ private:
     uint32_t _last_body_odm_update_ms = 0;
     void update_SITL(void);
 #endif    
+
+    /*
+      With AHRS_EKF_ASYNC set, the EKF which isn't primary runs on a
+      lower priority thread, consuming snapshots of the IMU and other
+      sensor data from a queue instead of running in the fast loop.
+      Reports for it come from outputs the thread publishes after each
+      update, so may be a step out of date. Calls changing it go to the
+      thread with the next sample, so the main thread never waits for
+      an update to finish.
+     */
+    void async_select(void);
+    void async_push(void);
+    bool async_owns(EKF_TYPE type) const;
+    bool async_get_output(EKF_TYPE type, Vector3f *eulers, Quaternion *quat, Location *loc);
+    void async_stop(void);
+
+    // calls changing the asynchronous EKF, made on the thread before
+    // its next update
+    struct async_commands {
+        bool reset_gyro_bias = false;
+        bool reset_height_datum = false;
+        bool set_origin = false;
+        Location origin {};
+        bool opt_flow = false;
+        uint8_t flow_quality = 0;
+        Vector2f flow_rates;
+        Vector2f flow_gyro_rates;
+        uint32_t flow_ms = 0;
+        Vector3f flow_pos_offset;
+        // EKF3 only
+        bool body_odom = false;
+        float odom_quality = 0;
+        Vector3f odom_del_pos;
+        Vector3f odom_del_ang;
+        float odom_del_time = 0;
+        uint32_t odom_ms = 0;
+        Vector3f odom_pos_offset;
+        bool log = false;
+        bool log_optflow = false;
+
+        // fold in commands given after these
+        void merge(const async_commands &newer);
+    };
+
+    // lock and return the commands for the asynchronous EKF, nullptr
+    // if there isn't one
+    async_commands *async_commands_take(void);
+    void async_commands_give(void);
+    template <typename EKF>
+    void async_apply(EKF &ekf, const async_commands &commands);
+
+#if AP_AHRS_NAVEKF_ASYNC_AVAILABLE
+    // sensor data queued for one update of the asynchronous EKF
+    struct async_sample {
+        ekf_imu_sample imu;
+        ekf_sensor_sample sensors;
+
+        void accumulate(const async_sample &newer) {
+            imu.accumulate(newer.imu);
+            sensors = newer.sensors;
+        }
+    };
+
+    // outputs of the asynchronous EKF read by the main thread
+    struct async_output {
+        Vector3f eulers;
+        Quaternion quat;
+        Location loc;
+    };
+
+    class AsyncEKF : public AP_AHRS_Async<async_sample, async_commands, async_output> {
+    public:
+        AsyncEKF(AP_AHRS_NavEKF &ahrs);
+    protected:
+        void apply(const async_commands &commands) override;
+        void update(const async_sample &sample, async_output &output) override;
+    private:
+        AP_AHRS_NavEKF &_ahrs;
+    };
+
+    bool async_start(EKF_TYPE type);
+
+    // only changed by the main thread while the thread is idle
+    EKF_TYPE _async_type = EKF_TYPE_NONE;
+    AsyncEKF _async{*this};
+#endif
 };
 #endif
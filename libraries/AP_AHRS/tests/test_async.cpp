@@ -0,0 +1,228 @@
+#include <AP_gtest.h>
+
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_AHRS/AP_AHRS_Async.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+  the EKFs need real sensors to update, so the thread is tested with a
+  filter whose result depends on the order of every sample and command
+ */
+struct TestSample {
+    int32_t value;
+    uint32_t count;
+
+    void accumulate(const TestSample &newer) {
+        value += newer.value;
+        count += newer.count;
+    }
+};
+
+struct TestCommands {
+    TestCommands(bool _reset = false, int32_t _add = 0) :
+        reset(_reset),
+        add(_add)
+    {
+    }
+
+    bool reset;
+    int32_t add;
+
+    void merge(const TestCommands &newer) {
+        if (newer.reset) {
+            reset = true;
+            add = newer.add;
+        } else {
+            add += newer.add;
+        }
+    }
+};
+
+struct TestOutput {
+    int64_t state;
+    uint32_t count;
+};
+
+class TestFilter : public AP_AHRS_Async<TestSample, TestCommands, TestOutput>
+{
+public:
+    TestFilter(uint16_t queue_size) :
+        AP_AHRS_Async(queue_size, 0)
+    {
+    }
+
+    ~TestFilter()
+    {
+        blocked = false;
+        stop(1000);
+    }
+
+    // what the main thread would do with the filter in the fast loop
+    void apply_sync(const TestCommands &commands) { apply(commands); }
+    void update_sync(const TestSample &sample)
+    {
+        TestOutput output;
+        update(sample, output);
+    }
+
+    int64_t state = 0;
+    uint32_t count = 0;
+    std::vector<int64_t> history;
+    uint32_t delay_us = 0;
+    std::atomic<bool> blocked{false};
+    std::atomic<bool> in_update{false};
+
+protected:
+    void apply(const TestCommands &commands) override
+    {
+        if (commands.reset) {
+            state = 0;
+        }
+        state += commands.add;
+    }
+
+    void update(const TestSample &sample, TestOutput &output) override
+    {
+        in_update = true;
+        while (blocked) {
+            usleep(100);
+        }
+        if (delay_us != 0) {
+            usleep(delay_us);
+        }
+        state = state / 2 + sample.value;
+        count += sample.count;
+        history.push_back(state);
+        output.state = state;
+        output.count = count;
+        in_update = false;
+    }
+};
+
+static void post(TestFilter &filter, bool reset, int32_t add)
+{
+    TestCommands &commands = filter.commands_take();
+    commands.merge(TestCommands(reset, add));
+    filter.commands_give();
+}
+
+static void wait_for_update(TestFilter &filter)
+{
+    while (!filter.in_update) {
+        usleep(100);
+    }
+}
+
+TEST(AP_AHRS_Async, matches_synchronous)
+{
+    TestFilter async(200);
+    TestFilter sync(1);
+    async.delay_us = 200;
+    ASSERT_TRUE(async.start(TestOutput{}));
+
+    for (int32_t i = 0; i < 150; i++) {
+        const TestSample sample { i * 7 - 300, 1 };
+        // calls between updates, some pushed with the same sample
+        if (i % 10 == 3) {
+            post(async, true, i);
+            sync.apply_sync(TestCommands(true, i));
+        }
+        if (i % 4 == 1) {
+            post(async, false, -i);
+            post(async, false, 5);
+            sync.apply_sync(TestCommands(false, 5 - i));
+        }
+        async.push(sample, i * 2500);
+        sync.update_sync(sample);
+    }
+
+    // the updates are slower than the pushes, so it falls behind
+    EXPECT_GT(async.lag_us(), 0U);
+    EXPECT_TRUE(async.stop(1000));
+    EXPECT_EQ(0U, async.overflows());
+    EXPECT_EQ(0U, async.lag_us());
+
+    EXPECT_EQ(sync.history, async.history);
+    TestOutput output;
+    async.get_output(output);
+    EXPECT_EQ(sync.state, output.state);
+    EXPECT_EQ(150U, output.count);
+}
+
+TEST(AP_AHRS_Async, push_never_waits_for_update)
+{
+    TestFilter filter(4);
+    ASSERT_TRUE(filter.start(TestOutput{7, 0}));
+
+    filter.blocked = true;
+    filter.push(TestSample{1, 1}, 1000);
+    wait_for_update(filter);
+
+    // the update never finishes while these are pushed, the queue
+    // fills and the rest are folded into one sample
+    for (uint32_t i = 2; i <= 20; i++) {
+        filter.push(TestSample{1, 1}, i * 1000);
+        post(filter, false, 1);
+    }
+    TestOutput output;
+    filter.get_output(output);
+    EXPECT_EQ(7, output.state);
+    EXPECT_EQ(20000U, filter.lag_us());
+    EXPECT_EQ(1U, filter.overflows());
+
+    filter.blocked = false;
+    EXPECT_TRUE(filter.stop(1000));
+
+    // no sample was lost
+    filter.get_output(output);
+    EXPECT_EQ(20U, output.count);
+    EXPECT_EQ(20U, filter.count);
+    EXPECT_LE(filter.history.size(), 6U);
+}
+
+TEST(AP_AHRS_Async, stop_applies_commands)
+{
+    TestFilter filter(4);
+    ASSERT_TRUE(filter.start(TestOutput{}));
+
+    filter.push(TestSample{10, 1}, 1000);
+    post(filter, true, 100);
+    EXPECT_TRUE(filter.stop(1000));
+    EXPECT_EQ(100, filter.state);
+
+    // samples still queued at the timeout are dropped, and their
+    // commands applied
+    ASSERT_TRUE(filter.start(TestOutput{}));
+    filter.blocked = true;
+    filter.push(TestSample{10, 1}, 2000);
+    wait_for_update(filter);
+    filter.push(TestSample{10, 1}, 3000);
+    post(filter, false, 3);
+    filter.push(TestSample{10, 1}, 4000);
+    post(filter, false, 4);
+
+    std::thread release([&filter]() {
+        usleep(50000);
+        filter.blocked = false;
+    });
+    EXPECT_FALSE(filter.stop(10));
+    release.join();
+
+    // only the update in progress ran, then the commands on the caller
+    EXPECT_EQ(2U, filter.count);
+    EXPECT_EQ(100 / 2 + 10 + 3 + 4, filter.state);
+    EXPECT_FALSE(filter.running());
+
+    // pushes are ignored until started again
+    filter.push(TestSample{10, 1}, 5000);
+    EXPECT_TRUE(filter.stop(1000));
+    EXPECT_EQ(2U, filter.count);
+}
+
+AP_GTEST_MAIN()
@@ -187,13 +187,25 @@ uint16_t AP_Baro_MS56XX::_read_prom_word(uint8_t word)
     return (val[0] << 8) | val[1];
 }
 
-uint32_t AP_Baro_MS56XX::_read_adc()
+/*
+ * Read the last conversion into adc_val and start the next one with next_cmd
+ * in a single batch. Returns false if the batch failed, in which case the
+ * next conversion may not have been started. adc_val is 0 if the sensor
+ * had no conversion to give, even when the batch succeeded.
+ */
+bool AP_Baro_MS56XX::_read_adc(uint8_t next_cmd, uint32_t &adc_val)
 {
     uint8_t val[3];
-    if (!_dev->transfer(&CMD_MS56XX_READ_ADC, 1, val, sizeof(val))) {
-        return 0;
+    const AP_HAL::Device::Transfer transfers[] = {
+        { &CMD_MS56XX_READ_ADC, 1, val, sizeof(val) },
+        { &next_cmd, 1, nullptr, 0 },
+    };
+    adc_val = 0;
+    if (!_dev->transfer_batch(transfers, ARRAY_SIZE(transfers))) {
+        return false;
     }
-    return (val[0] << 16) | (val[1] << 8) | val[2];
+    adc_val = (val[0] << 16) | (val[1] << 8) | val[2];
+    return true;
 }
 
 bool AP_Baro_MS56XX::_read_prom_5611(uint16_t prom[8])
@@ -269,23 +281,25 @@ bool AP_Baro_MS56XX::_read_prom_5637(uint16_t prom[8])
 */
 void AP_Baro_MS56XX::_timer(void)
 {
-    uint8_t next_cmd;
-    uint8_t next_state;
-    uint32_t adc_val = _read_adc();
+    const uint8_t next_state = (_state + 1) % 5;
+    const uint8_t next_cmd = next_state == 0 ? ADDR_CMD_CONVERT_TEMPERATURE
+                                             : ADDR_CMD_CONVERT_PRESSURE;
 
     /*
-     * If read fails, re-initiate a read command for current state or we are
-     * stuck
+     * The conversion for the next state is started together with the read
+     * of the current one. The conversion that follows a failed read is
+     * always discarded, so it doesn't matter that it's for the next state
+     * rather than for a retry of the current one.
      */
-    if (adc_val == 0) {
-        next_state = _state;
-    } else {
-        next_state = (_state + 1) % 5;
-    }
+    uint32_t adc_val;
+    const bool started = _read_adc(next_cmd, adc_val);
 
-    next_cmd = next_state == 0 ? ADDR_CMD_CONVERT_TEMPERATURE
-                               : ADDR_CMD_CONVERT_PRESSURE;
-    if (!_dev->transfer(&next_cmd, 1, nullptr, 0)) {
+    /*
+     * If the batch failed, make sure a conversion is running or we are
+     * stuck. After a successful batch one already is, and starting
+     * another would interrupt it
+     */
+    if (!started && !_dev->transfer(&next_cmd, 1, nullptr, 0)) {
         return;
     }
 
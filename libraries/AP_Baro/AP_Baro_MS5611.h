@@ -50,7 +50,7 @@ private:
     bool _read_prom_5637(uint16_t prom[8]);
 
     uint16_t _read_prom_word(uint8_t word);
-    uint32_t _read_adc();
+    bool _read_adc(uint8_t next_cmd, uint32_t &adc_val);
 
     void _timer();
 
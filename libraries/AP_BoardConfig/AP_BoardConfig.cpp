@@ -205,6 +205,10 @@ void AP_BoardConfig::init()
     _st_can_debug = (int8_t) _var_info_can._can_debug;
 #endif
 
+#if HAL_WITH_UAVCAN && CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    setup_canbus();
+#endif
+
 #if HAL_HAVE_IMU_HEATER
     // let the HAL know the target temperature. We pass a pointer as
     // we want the user to be able to change the parameter without
@@ -110,6 +110,11 @@ private:
 
 #if HAL_WITH_UAVCAN
     CAN_var_info _var_info_can;
+
+    static int8_t _st_can_enable;
+    static int8_t _st_can_debug;
+
+    void setup_canbus(void);
 #endif
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_PX4 || CONFIG_HAL_BOARD == HAL_BOARD_VRBRAIN
@@ -128,11 +133,6 @@ private:
 
     static enum px4_board_type px4_configured_board;
 
-#if HAL_WITH_UAVCAN
-    static int8_t _st_can_enable;
-    static int8_t _st_can_debug;
-#endif
-
     void px4_drivers_start(void);
     void px4_setup(void);
     void px4_setup_pwm(void);
@@ -140,7 +140,6 @@ private:
     void px4_setup_safety_mask(void);
     void px4_setup_uart(void);
     void px4_setup_sbus(void);
-    void px4_setup_canbus(void);
     void px4_setup_drivers(void);
     void px4_setup_peripherals(void);
     void px4_setup_px4io(void);
@@ -20,6 +20,14 @@
 #if HAL_WITH_UAVCAN
 #include <AP_UAVCAN/AP_UAVCAN.h>
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_PX4 || CONFIG_HAL_BOARD == HAL_BOARD_VRBRAIN
+#include <AP_HAL_PX4/CAN.h>
+#elif CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#include <AP_HAL_Linux/CAN.h>
+#endif
+
+extern const AP_HAL::HAL& hal;
+
 // table of user settable CAN bus parameters
 const AP_Param::GroupInfo AP_BoardConfig::CAN_var_info::var_info[] = {
     // @Param: ENABLE
@@ -56,4 +64,49 @@ const AP_Param::GroupInfo AP_BoardConfig::CAN_var_info::var_info[] = {
 
     AP_GROUPEND
 };
+
+/*
+  setup CANBUS drivers
+ */
+void AP_BoardConfig::setup_canbus(void)
+{
+    if (_var_info_can._can_enable >= 1) {
+        if(hal.can_mgr == nullptr)
+        {
+#if CONFIG_HAL_BOARD == HAL_BOARD_PX4 || CONFIG_HAL_BOARD == HAL_BOARD_VRBRAIN
+            const_cast <AP_HAL::HAL&> (hal).can_mgr = new PX4::PX4CANManager;
+#elif CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+            const_cast <AP_HAL::HAL&> (hal).can_mgr = new Linux::CANManager;
+#endif
+        }
+
+        if(hal.can_mgr != nullptr)
+        {
+            if(_var_info_can._uavcan_enable > 0)
+            {
+                _var_info_can._uavcan = new AP_UAVCAN;
+                if(_var_info_can._uavcan != nullptr)
+                {
+                    AP_Param::load_object_from_eeprom(_var_info_can._uavcan, AP_UAVCAN::var_info);
+
+                    hal.can_mgr->set_UAVCAN(_var_info_can._uavcan);
+
+                    bool initret = hal.can_mgr->begin(_var_info_can._can_bitrate, _var_info_can._can_enable);
+                    if (!initret) {
+                        hal.console->printf("Failed to initialize can_mgr\n\r");
+                    } else {
+                        hal.console->printf("can_mgr initialized well\n\r");
+
+                        // start UAVCAN working thread
+                        hal.scheduler->create_uavcan_thread();
+                    }
+                } else
+                {
+                    _var_info_can._uavcan_enable.set(0);
+                    hal.console->printf("AP_UAVCAN failed to allocate\n\r");
+                }
+            }
+        }
+    }
+}
 #endif
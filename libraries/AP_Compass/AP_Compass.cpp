@@ -423,7 +423,16 @@ const AP_Param::GroupInfo Compass::var_info[] = {
     // @Group: PMOT
     // @Path: Compass_PerMotor.cpp
     AP_SUBGROUPINFO(_per_motor, "PMOT", 32, Compass, Compass_PerMotor),
-    
+
+#if COMPASS_CAL_FIT_THREAD_AVAILABLE
+    // @Param: CAL_THREAD
+    // @DisplayName: Compass calibration fitting thread
+    // @Description: This controls where compass calibration fits are run. With MainLoop one fit step is run per update. With Thread each compass is fitted on its own thread and the result is used once the thread is done. ThreadDeterministic waits for the thread at the update after each fit is started, so that results don't depend on thread timing.
+    // @Values: 0:MainLoop,1:Thread,2:ThreadDeterministic
+    // @User: Advanced
+    AP_GROUPINFO("CAL_THREAD", 33, Compass, _cal_thread, COMPASS_CAL_FIT_THREAD),
+#endif
+
     AP_GROUPEND
 };
 
@@ -451,6 +460,10 @@ Compass::Compass(void) :
     // default device ids to zero.  init() method will overwrite with the actual device ids
     for (uint8_t i=0; i<COMPASS_MAX_INSTANCES; i++) {
         _state[i].dev_id = 0;
+        // no valid source, so the first _update_transforms() builds them
+        _state[i].last_source.rotation = ROTATION_MAX;
+        _state[i].sem = nullptr;
+        _state[i].transforms_changed = false;
     }
 }
 
@@ -463,6 +476,7 @@ Compass::init()
         // detect available backends. Only called once
         _detect_backends();
     }
+    _update_transforms();
     if (_compass_count != 0) {
         // get initial health status
         hal.scheduler->delay(100);
@@ -749,9 +763,72 @@ Compass::accumulate(void)
     }
 }
 
+/*
+  rebuild the transforms of a compass if its orientation or
+  calibration has changed. Parameters can be changed from anywhere, so
+  this compares against what the transforms were built from rather
+  than relying on being told
+ */
+void Compass::_update_transforms(uint8_t i)
+{
+    mag_state &state = _state[i];
+
+    if (state.diagonals.get().is_zero()) {
+        state.diagonals.set(Vector3f(1.0f,1.0f,1.0f));
+    }
+
+    const mag_state::transform_source source {
+        state.rotation, _board_orientation,
+        state.external.get(), state.orientation.get(),
+        state.offset.get(), state.diagonals.get(), state.offdiagonals.get()
+    };
+    if (source == state.last_source) {
+        return;
+    }
+
+    // the board orientation applies to internal compasses, the
+    // user selectable orientation to external ones
+    const enum Rotation last = source.external ? (enum Rotation)source.orientation : _board_orientation;
+    const Affine3f rotate_transform = Affine3f::rotation(last) *
+        Affine3f::rotation(source.rotation) *
+        Affine3f::rotation(MAG_BOARD_ORIENTATION);
+
+    // offsets are added before the elliptical correction
+    const Matrix3f mat(
+        source.diagonals.x, source.offdiagonals.x, source.offdiagonals.y,
+        source.offdiagonals.x, source.diagonals.y, source.offdiagonals.z,
+        source.offdiagonals.y, source.offdiagonals.z, source.diagonals.z
+    );
+    const Affine3f correct_transform(mat, mat * source.offset);
+
+    // the backend copies them from its own thread when told they
+    // have changed
+    if (state.sem != nullptr && !state.sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        return;
+    }
+    state.rotate_transform = rotate_transform;
+    state.correct_transform = correct_transform;
+    state.transforms_changed = true;
+    if (state.sem != nullptr) {
+        state.sem->give();
+    }
+
+    state.last_source = source;
+}
+
+void Compass::_update_transforms(void)
+{
+    for (uint8_t i=0; i<COMPASS_MAX_INSTANCES; i++) {
+        _update_transforms(i);
+    }
+}
+
 bool
 Compass::read(void)
 {
+    // pick up calibration changes before reading the backends
+    _update_transforms();
+
     for (uint8_t i=0; i< _backend_count; i++) {
         // call read on each of the backend. This call updates field[i]
         _backends[i]->read();
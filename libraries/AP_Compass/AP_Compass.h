@@ -10,7 +10,6 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 
 #include "CompassCalibrator.h"
-#include "AP_Compass_Backend.h"
 #include "Compass_PerMotor.h"
 
 // motor compensation types (for use with motor_comp_enabled)
@@ -44,6 +43,9 @@
 #define COMPASS_MAX_INSTANCES 3
 #define COMPASS_MAX_BACKEND   3
 
+// after the sizes, which backends keep per instance state with
+#include "AP_Compass_Backend.h"
+
 // fwd declaration of AP_AHRS
 class AP_AHRS;
 
@@ -431,8 +433,44 @@ private:
 
         // board specific orientation
         enum Rotation rotation;
+
+        // the rotations and the offset and elliptical calibration
+        // composed into the transforms backends apply to each sample
+        Affine3f rotate_transform;
+        Affine3f correct_transform;
+
+        // semaphore of the backend which registered this compass,
+        // held while the transforms are replaced
+        AP_HAL::Semaphore *sem;
+
+        // set when the transforms are replaced, until the backend
+        // has copied them
+        volatile bool transforms_changed;
+
+        // what the transforms were last built from
+        struct transform_source {
+            enum Rotation rotation;
+            enum Rotation board_orientation;
+            int8_t external;
+            int8_t orientation;
+            Vector3f offset;
+            Vector3f diagonals;
+            Vector3f offdiagonals;
+
+            bool operator ==(const transform_source &s) const {
+                return rotation == s.rotation &&
+                    board_orientation == s.board_orientation &&
+                    external == s.external && orientation == s.orientation &&
+                    offset == s.offset && diagonals == s.diagonals &&
+                    offdiagonals == s.offdiagonals;
+            }
+        } last_source;
     } _state[COMPASS_MAX_INSTANCES];
 
+    // rebuild the transforms whose source has changed
+    void _update_transforms(uint8_t i);
+    void _update_transforms(void);
+
     AP_Int16 _offset_max;
     
     CompassCalibrator _calibrator[COMPASS_MAX_INSTANCES];
@@ -444,4 +482,9 @@ private:
     bool _hil_mode:1;
 
     AP_Float _calibration_threshold;
+
+#if COMPASS_CAL_FIT_THREAD_AVAILABLE
+    // where calibration fits are run, see compass_cal_fit_mode_t
+    AP_Int8 _cal_thread;
+#endif
 };
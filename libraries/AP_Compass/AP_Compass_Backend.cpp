@@ -11,21 +11,33 @@ AP_Compass_Backend::AP_Compass_Backend(Compass &compass) :
     _sem = hal.util->new_semaphore();    
 }
 
-void AP_Compass_Backend::rotate_field(Vector3f &mag, uint8_t instance)
+/*
+  the transforms are applied from our copies, which only the thread
+  reading the sensor touches. The frontend replaces its transforms
+  under our semaphore, so that is only taken to copy them when they
+  have changed
+ */
+void AP_Compass_Backend::update_transforms(uint8_t instance)
 {
     Compass::mag_state &state = _compass._state[instance];
-    mag.rotate(MAG_BOARD_ORIENTATION);
-    mag.rotate(state.rotation);
-
-    if (!state.external) {
-        // and add in AHRS_ORIENTATION setting if not an external compass
-        mag.rotate(_compass._board_orientation);
-    } else {
-        // add user selectable orientation
-        mag.rotate((enum Rotation)state.orientation.get());
+
+    if (state.transforms_changed && _sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        _rotate_transform[instance] = state.rotate_transform;
+        _correct_transform[instance] = state.correct_transform;
+        state.transforms_changed = false;
+        _sem->give();
     }
 }
 
+void AP_Compass_Backend::rotate_field(Vector3f &mag, uint8_t instance)
+{
+    update_transforms(instance);
+
+    // MAG_BOARD_ORIENTATION, the backend's rotation, then the board
+    // orientation or the user's orientation for an external compass
+    mag = _rotate_transform[instance] * mag;
+}
+
 void AP_Compass_Backend::publish_raw_field(const Vector3f &mag, uint32_t time_us, uint8_t instance)
 {
     Compass::mag_state &state = _compass._state[instance];
@@ -42,26 +54,10 @@ void AP_Compass_Backend::correct_field(Vector3f &mag, uint8_t i)
 {
     Compass::mag_state &state = _compass._state[i];
 
-    if (state.diagonals.get().is_zero()) {
-        state.diagonals.set(Vector3f(1.0f,1.0f,1.0f));
-    }
-
-    const Vector3f &offsets = state.offset.get();
-    const Vector3f &diagonals = state.diagonals.get();
-    const Vector3f &offdiagonals = state.offdiagonals.get();
-    const Vector3f &mot = state.motor_compensation.get();
-
-    // add in the basic offsets
-    mag += offsets;
-
-    // apply eliptical correction
-    Matrix3f mat(
-        diagonals.x, offdiagonals.x, offdiagonals.y,
-        offdiagonals.x,    diagonals.y, offdiagonals.z,
-        offdiagonals.y, offdiagonals.z,    diagonals.z
-    );
+    update_transforms(i);
 
-    mag = mat * mag;
+    // add in the basic offsets and apply eliptical correction
+    mag = _correct_transform[i] * mag;
 
     /*
       calculate motor-power based compensation
@@ -74,7 +70,7 @@ void AP_Compass_Backend::correct_field(Vector3f &mag, uint8_t i)
         _compass._per_motor.compensate(state.motor_offset);
     } else if (_compass._motor_comp_type == AP_COMPASS_MOT_COMP_THROTTLE ||
                _compass._motor_comp_type == AP_COMPASS_MOT_COMP_CURRENT) {
-        state.motor_offset = mot * _compass._thr_or_curr;
+        state.motor_offset = state.motor_compensation.get() * _compass._thr_or_curr;
     }
 
     /*
@@ -111,7 +107,11 @@ void AP_Compass_Backend::set_last_update_usec(uint32_t last_update, uint8_t inst
  */
 uint8_t AP_Compass_Backend::register_compass(void) const
 { 
-    return _compass.register_compass(); 
+    const uint8_t instance = _compass.register_compass();
+    _compass._state[instance].sem = _sem;
+    // so the first samples are rotated and corrected
+    _compass._update_transforms(instance);
+    return instance;
 }
 
 
@@ -131,6 +131,7 @@ void AP_Compass_Backend::set_external(uint8_t instance, bool external)
     if (_compass._state[instance].external != 2) {
         _compass._state[instance].external.set_and_notify(external);
     }
+    _compass._update_transforms(instance);
 }
 
 bool AP_Compass_Backend::is_external(uint8_t instance)
@@ -142,4 +143,5 @@ bool AP_Compass_Backend::is_external(uint8_t instance)
 void AP_Compass_Backend::set_rotation(uint8_t instance, enum Rotation rotation)
 {
     _compass._state[instance].rotation = rotation;
+    _compass._update_transforms(instance);
 }
@@ -109,4 +109,11 @@ protected:
 
 private:
     void apply_corrections(Vector3f &mag, uint8_t i);
+
+    // copy the frontend's transforms if they have changed
+    void update_transforms(uint8_t instance);
+
+    // our copies of the frontend's transforms of each instance
+    Affine3f _rotate_transform[COMPASS_MAX_INSTANCES];
+    Affine3f _correct_transform[COMPASS_MAX_INSTANCES];
 };
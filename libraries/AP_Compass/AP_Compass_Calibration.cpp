@@ -62,6 +62,9 @@ Compass::_start_calibration(uint8_t i, bool retry, float delay)
         // lot noisier
         _calibrator[i].set_tolerance(_calibration_threshold*2);
     }
+#if COMPASS_CAL_FIT_THREAD_AVAILABLE
+    _calibrator[i].set_fit_mode(_cal_thread);
+#endif
     _cal_saved[i] = false;
     _calibrator[i].start(retry, delay, get_offsets_max());
 
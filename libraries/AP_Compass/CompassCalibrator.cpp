@@ -69,8 +69,19 @@ extern const AP_HAL::HAL& hal;
 
 CompassCalibrator::CompassCalibrator():
 _tolerance(COMPASS_CAL_DEFAULT_TOLERANCE),
-_sample_buffer(nullptr)
+_sample_buffer(nullptr),
+_fit_mode(COMPASS_CAL_FIT_MAIN_LOOP)
+#if COMPASS_CAL_FIT_THREAD_AVAILABLE
+,_fit_thread_started(false)
+,_fit_samples(nullptr)
+#endif
 {
+#if COMPASS_CAL_FIT_THREAD_AVAILABLE
+    _fit_job.queued = false;
+    _fit_job.running = false;
+    _fit_job.done = false;
+    _fit_job.discard = false;
+#endif
     clear();
 }
 
@@ -178,34 +189,35 @@ void CompassCalibrator::update(bool &failure) {
         return;
     }
 
+    if (_fit_step < num_fit_steps(_status)) {
+#if COMPASS_CAL_FIT_THREAD_AVAILABLE
+        if (_fit_mode != COMPASS_CAL_FIT_MAIN_LOOP && fit_thread_update()) {
+            return;
+        }
+#endif
+        // one step per update to limit the time taken in the main loop
+        fit_state fit = get_fit_state();
+        const bool improved = run_fit_step(_status, _fit_step, fit);
+        set_fit_state(fit);
+        if (improved) {
+            update_completion_mask();
+        }
+        _fit_step++;
+        return;
+    }
+
     if(_status == COMPASS_CAL_RUNNING_STEP_ONE) {
-        if (_fit_step >= 10) {
-            if(is_equal(_fitness,_initial_fitness) || isnan(_fitness)) {           //if true, means that fitness is diverging instead of converging
-                set_status(COMPASS_CAL_FAILED);
-                failure = true;
-            }
-            set_status(COMPASS_CAL_RUNNING_STEP_TWO);
-        } else {
-            if (_fit_step == 0) {
-                calc_initial_offset();
-            }
-            run_sphere_fit();
-            _fit_step++;
+        if(is_equal(_fitness,_initial_fitness) || isnan(_fitness)) {           //if true, means that fitness is diverging instead of converging
+            set_status(COMPASS_CAL_FAILED);
+            failure = true;
         }
+        set_status(COMPASS_CAL_RUNNING_STEP_TWO);
     } else if(_status == COMPASS_CAL_RUNNING_STEP_TWO) {
-        if (_fit_step >= 35) {
-            if(fit_acceptable()) {
-                set_status(COMPASS_CAL_SUCCESS);
-            } else {
-                set_status(COMPASS_CAL_FAILED);
-                failure = true;
-            }
-        } else if (_fit_step < 15) {
-            run_sphere_fit();
-            _fit_step++;
+        if(fit_acceptable()) {
+            set_status(COMPASS_CAL_SUCCESS);
         } else {
-            run_ellipsoid_fit();
-            _fit_step++;
+            set_status(COMPASS_CAL_FAILED);
+            failure = true;
         }
     }
 }
@@ -251,6 +263,10 @@ bool CompassCalibrator::set_status(compass_cal_status_t status) {
         return true;
     }
 
+#if COMPASS_CAL_FIT_THREAD_AVAILABLE
+    fit_thread_discard();
+#endif
+
     switch(status) {
         case COMPASS_CAL_NOT_STARTED:
             reset_state();
@@ -422,7 +438,7 @@ bool CompassCalibrator::accept_sample(const CompassSample& sample) {
     return accept_sample(sample.get());
 }
 
-float CompassCalibrator::calc_residual(const Vector3f& sample, const param_t& params) const {
+float CompassCalibrator::calc_residual(const Vector3f& sample, const param_t& params) {
     Matrix3f softiron(
         params.diag.x    , params.offdiag.x , params.offdiag.y,
         params.offdiag.x , params.diag.y    , params.offdiag.z,
@@ -438,20 +454,25 @@ float CompassCalibrator::calc_mean_squared_residuals() const
 
 float CompassCalibrator::calc_mean_squared_residuals(const param_t& params) const
 {
-    if(_sample_buffer == nullptr || _samples_collected == 0) {
+    return calc_mean_squared_residuals(_sample_buffer, _samples_collected, params);
+}
+
+float CompassCalibrator::calc_mean_squared_residuals(const CompassSample *samples, uint16_t num_samples, const param_t& params)
+{
+    if(samples == nullptr || num_samples == 0) {
         return 1.0e30f;
     }
     float sum = 0.0f;
-    for(uint16_t i=0; i < _samples_collected; i++){
-        Vector3f sample = _sample_buffer[i].get();
+    for(uint16_t i=0; i < num_samples; i++){
+        Vector3f sample = samples[i].get();
         float resid = calc_residual(sample, params);
         sum += sq(resid);
     }
-    sum /= _samples_collected;
+    sum /= num_samples;
     return sum;
 }
 
-void CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const{
+void CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) {
     const Vector3f &offset = params.offset;
     const Vector3f &diag = params.diag;
     const Vector3f &offdiag = params.offdiag;
@@ -474,36 +495,36 @@ void CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t&
     ret[3] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
 }
 
-void CompassCalibrator::calc_initial_offset()
+void CompassCalibrator::calc_initial_offset(fit_state &fit)
 {
     // Set initial offset to the average value of the samples
-    _params.offset.zero();
-    for(uint16_t k = 0; k<_samples_collected; k++) {
-        _params.offset -= _sample_buffer[k].get();
+    fit.params.offset.zero();
+    for(uint16_t k = 0; k<fit.num_samples; k++) {
+        fit.params.offset -= fit.samples[k].get();
     }
-    _params.offset /= _samples_collected;
+    fit.params.offset /= fit.num_samples;
 }
 
-void CompassCalibrator::run_sphere_fit()
+bool CompassCalibrator::run_sphere_fit(fit_state &fit)
 {
-    if(_sample_buffer == nullptr) {
-        return;
+    if(fit.samples == nullptr) {
+        return false;
     }
 
     const float lma_damping = 10.0f;
 
-    float fitness = _fitness;
+    float fitness = fit.fitness;
     float fit1, fit2;
     param_t fit1_params, fit2_params;
-    fit1_params = fit2_params = _params;
+    fit1_params = fit2_params = fit.params;
 
     float JTJ[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
     float JTJ2[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
     float JTFI[COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
 
     // Gauss Newton Part common for all kind of extensions including LM
-    for(uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
+    for(uint16_t k = 0; k<fit.num_samples; k++) {
+        Vector3f sample = fit.samples[k].get();
 
         float sphere_jacob[COMPASS_CAL_NUM_SPHERE_PARAMS];
 
@@ -524,16 +545,16 @@ void CompassCalibrator::run_sphere_fit()
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     //refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
     for(uint8_t i = 0; i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-        JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+i] += _sphere_lambda;
-        JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+i] += _sphere_lambda/lma_damping;
+        JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+i] += fit.sphere_lambda;
+        JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+i] += fit.sphere_lambda/lma_damping;
     }
 
     if(!inverse(JTJ, JTJ, 4)) {
-        return;
+        return false;
     }
 
     if(!inverse(JTJ2, JTJ2, 4)) {
-        return;
+        return false;
     }
 
     for(uint8_t row=0; row < COMPASS_CAL_NUM_SPHERE_PARAMS; row++) {
@@ -543,30 +564,31 @@ void CompassCalibrator::run_sphere_fit()
         }
     }
 
-    fit1 = calc_mean_squared_residuals(fit1_params);
-    fit2 = calc_mean_squared_residuals(fit2_params);
+    fit1 = calc_mean_squared_residuals(fit.samples, fit.num_samples, fit1_params);
+    fit2 = calc_mean_squared_residuals(fit.samples, fit.num_samples, fit2_params);
 
-    if(fit1 > _fitness && fit2 > _fitness){
-        _sphere_lambda *= lma_damping;
-    } else if(fit2 < _fitness && fit2 < fit1) {
-        _sphere_lambda /= lma_damping;
+    if(fit1 > fit.fitness && fit2 > fit.fitness){
+        fit.sphere_lambda *= lma_damping;
+    } else if(fit2 < fit.fitness && fit2 < fit1) {
+        fit.sphere_lambda /= lma_damping;
         fit1_params = fit2_params;
         fitness = fit2;
-    } else if(fit1 < _fitness){
+    } else if(fit1 < fit.fitness){
         fitness = fit1;
     }
     //--------------------Levenberg-Marquardt-part-ends-here--------------------------------//
 
-    if(!isnan(fitness) && fitness < _fitness) {
-        _fitness = fitness;
-        _params = fit1_params;
-        update_completion_mask();
+    if(!isnan(fitness) && fitness < fit.fitness) {
+        fit.fitness = fitness;
+        fit.params = fit1_params;
+        return true;
     }
+    return false;
 }
 
 
 
-void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const{
+void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) {
     const Vector3f &offset = params.offset;
     const Vector3f &diag = params.diag;
     const Vector3f &offdiag = params.offdiag;
@@ -595,19 +617,19 @@ void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param
     ret[8] = -1.0f * (((sample.z + offset.z) * B) + ((sample.y + offset.y) * C))/length;
 }
 
-void CompassCalibrator::run_ellipsoid_fit()
+bool CompassCalibrator::run_ellipsoid_fit(fit_state &fit)
 {
-    if(_sample_buffer == nullptr) {
-        return;
+    if(fit.samples == nullptr) {
+        return false;
     }
 
     const float lma_damping = 10.0f;
 
 
-    float fitness = _fitness;
+    float fitness = fit.fitness;
     float fit1, fit2;
     param_t fit1_params, fit2_params;
-    fit1_params = fit2_params = _params;
+    fit1_params = fit2_params = fit.params;
 
 
     float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
@@ -615,8 +637,8 @@ void CompassCalibrator::run_ellipsoid_fit()
     float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
 
     // Gauss Newton Part common for all kind of extensions including LM
-    for(uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
+    for(uint16_t k = 0; k<fit.num_samples; k++) {
+        Vector3f sample = fit.samples[k].get();
 
         float ellipsoid_jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
 
@@ -638,16 +660,16 @@ void CompassCalibrator::run_ellipsoid_fit()
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     //refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
     for(uint8_t i = 0; i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-        JTJ[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += _ellipsoid_lambda;
-        JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += _ellipsoid_lambda/lma_damping;
+        JTJ[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += fit.ellipsoid_lambda;
+        JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += fit.ellipsoid_lambda/lma_damping;
     }
 
     if(!inverse(JTJ, JTJ, 9)) {
-        return;
+        return false;
     }
 
     if(!inverse(JTJ2, JTJ2, 9)) {
-        return;
+        return false;
     }
 
     for(uint8_t row=0; row < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; row++) {
@@ -657,26 +679,194 @@ void CompassCalibrator::run_ellipsoid_fit()
         }
     }
 
-    fit1 = calc_mean_squared_residuals(fit1_params);
-    fit2 = calc_mean_squared_residuals(fit2_params);
+    fit1 = calc_mean_squared_residuals(fit.samples, fit.num_samples, fit1_params);
+    fit2 = calc_mean_squared_residuals(fit.samples, fit.num_samples, fit2_params);
 
-    if(fit1 > _fitness && fit2 > _fitness){
-        _ellipsoid_lambda *= lma_damping;
-    } else if(fit2 < _fitness && fit2 < fit1) {
-        _ellipsoid_lambda /= lma_damping;
+    if(fit1 > fit.fitness && fit2 > fit.fitness){
+        fit.ellipsoid_lambda *= lma_damping;
+    } else if(fit2 < fit.fitness && fit2 < fit1) {
+        fit.ellipsoid_lambda /= lma_damping;
         fit1_params = fit2_params;
         fitness = fit2;
-    } else if(fit1 < _fitness){
+    } else if(fit1 < fit.fitness){
         fitness = fit1;
     }
     //--------------------Levenberg-part-ends-here--------------------------------//
 
-    if(fitness < _fitness) {
-        _fitness = fitness;
-        _params = fit1_params;
-        update_completion_mask();
+    if(fitness < fit.fitness) {
+        fit.fitness = fitness;
+        fit.params = fit1_params;
+        return true;
+    }
+    return false;
+}
+
+uint16_t CompassCalibrator::num_fit_steps(compass_cal_status_t status)
+{
+    switch (status) {
+    case COMPASS_CAL_RUNNING_STEP_ONE:
+        return 10;
+    case COMPASS_CAL_RUNNING_STEP_TWO:
+        return 35;
+    default:
+        return 0;
+    }
+}
+
+bool CompassCalibrator::run_fit_step(compass_cal_status_t status, uint16_t step, fit_state &fit)
+{
+    if (status == COMPASS_CAL_RUNNING_STEP_ONE) {
+        if (step == 0) {
+            calc_initial_offset(fit);
+        }
+        return run_sphere_fit(fit);
+    }
+    if (step < 15) {
+        return run_sphere_fit(fit);
+    }
+    return run_ellipsoid_fit(fit);
+}
+
+CompassCalibrator::fit_state CompassCalibrator::get_fit_state() const
+{
+    fit_state fit;
+    fit.params = _params;
+    fit.fitness = _fitness;
+    fit.sphere_lambda = _sphere_lambda;
+    fit.ellipsoid_lambda = _ellipsoid_lambda;
+    fit.samples = _sample_buffer;
+    fit.num_samples = _samples_collected;
+    return fit;
+}
+
+void CompassCalibrator::set_fit_state(const fit_state &fit)
+{
+    _params = fit.params;
+    _fitness = fit.fitness;
+    _sphere_lambda = fit.sphere_lambda;
+    _ellipsoid_lambda = fit.ellipsoid_lambda;
+}
+
+#if COMPASS_CAL_FIT_THREAD_AVAILABLE
+bool CompassCalibrator::fit_thread_update()
+{
+    if (!_fit_thread_started && !fit_thread_start()) {
+        return false;
+    }
+
+    pthread_mutex_lock(&_fit_mutex);
+
+    if (_fit_mode == COMPASS_CAL_FIT_THREAD_DETERMINISTIC) {
+        // take the result at the update after the job was queued, however
+        // long the thread takes, so that runs can be repeated
+        while (_fit_job.queued || _fit_job.running) {
+            pthread_cond_wait(&_fit_cond, &_fit_mutex);
+        }
+    }
+
+    if (_fit_job.done) {
+        _fit_job.done = false;
+        if (!_fit_job.discard) {
+            set_fit_state(_fit_job.fit);
+            _fit_step = num_fit_steps(_status);
+            pthread_mutex_unlock(&_fit_mutex);
+            update_completion_mask();
+            return true;
+        }
+    }
+
+    if (!_fit_job.queued && !_fit_job.running) {
+        // the thread is idle, hand it the rest of the steps for this status
+        memcpy(_fit_samples, _sample_buffer, sizeof(CompassSample) * _samples_collected);
+        _fit_job.fit = get_fit_state();
+        _fit_job.fit.samples = _fit_samples;
+        _fit_job.status = _status;
+        _fit_job.first_step = _fit_step;
+        _fit_job.discard = false;
+        _fit_job.queued = true;
+        pthread_cond_broadcast(&_fit_cond);
+    }
+
+    pthread_mutex_unlock(&_fit_mutex);
+    return true;
+}
+
+bool CompassCalibrator::fit_thread_start()
+{
+    if (_fit_samples == nullptr) {
+        _fit_samples = (CompassSample*) malloc(sizeof(CompassSample) * COMPASS_CAL_NUM_SAMPLES);
+        if (_fit_samples == nullptr) {
+            return false;
+        }
+    }
+
+    /*
+      run the thread as a normal task, below the realtime threads. The
+      scheduling is set explicitly as otherwise it is inherited from the
+      thread calling update(), which is the realtime main loop
+     */
+    struct sched_param param = { .sched_priority = 0 };
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED) != 0 ||
+        pthread_attr_setschedpolicy(&attr, SCHED_OTHER) != 0 ||
+        pthread_attr_setschedparam(&attr, &param) != 0) {
+        pthread_attr_destroy(&attr);
+        return false;
+    }
+    const int ret = pthread_create(&_fit_thread, &attr, &CompassCalibrator::fit_thread_main, this);
+    pthread_attr_destroy(&attr);
+    if (ret != 0) {
+        return false;
+    }
+    _fit_thread_started = true;
+    return true;
+}
+
+void CompassCalibrator::fit_thread_discard()
+{
+    pthread_mutex_lock(&_fit_mutex);
+    if (_fit_job.queued || _fit_job.running || _fit_job.done) {
+        _fit_job.discard = true;
+    }
+    pthread_mutex_unlock(&_fit_mutex);
+}
+
+void *CompassCalibrator::fit_thread_main(void *arg)
+{
+    ((CompassCalibrator *)arg)->fit_thread_run();
+    return nullptr;
+}
+
+void CompassCalibrator::fit_thread_run()
+{
+    pthread_mutex_lock(&_fit_mutex);
+    while (true) {
+        while (!_fit_job.queued) {
+            pthread_cond_wait(&_fit_cond, &_fit_mutex);
+        }
+        _fit_job.queued = false;
+        _fit_job.running = true;
+        fit_state fit = _fit_job.fit;
+        const compass_cal_status_t status = _fit_job.status;
+        const uint16_t first_step = _fit_job.first_step;
+        pthread_mutex_unlock(&_fit_mutex);
+
+        // the same steps as update() would run inline, so the result
+        // doesn't depend on where the fit runs
+        for (uint16_t step = first_step; step < num_fit_steps(status); step++) {
+            run_fit_step(status, step, fit);
+        }
+
+        pthread_mutex_lock(&_fit_mutex);
+        _fit_job.fit = fit;
+        _fit_job.running = false;
+        _fit_job.done = true;
+        pthread_cond_broadcast(&_fit_cond);
     }
+    return;
 }
+#endif // COMPASS_CAL_FIT_THREAD_AVAILABLE
 
 
 //////////////////////////////////////////////////////////
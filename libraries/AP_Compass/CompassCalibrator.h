@@ -1,5 +1,11 @@
+#include <AP_HAL/AP_HAL_Boards.h>
 #include <AP_Math/AP_Math.h>
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#include <pthread.h>
+#define COMPASS_CAL_FIT_THREAD_AVAILABLE 1
+#endif
+
 #define COMPASS_CAL_NUM_SPHERE_PARAMS 4
 #define COMPASS_CAL_NUM_ELLIPSOID_PARAMS 9
 #define COMPASS_CAL_NUM_SAMPLES 300
@@ -16,7 +22,16 @@ enum compass_cal_status_t {
     COMPASS_CAL_FAILED=5
 };
 
+// where the fitting runs, see COMPASS_CAL_THREAD
+enum compass_cal_fit_mode_t {
+    COMPASS_CAL_FIT_MAIN_LOOP=0,
+    COMPASS_CAL_FIT_THREAD=1,
+    COMPASS_CAL_FIT_THREAD_DETERMINISTIC=2
+};
+
 class CompassCalibrator {
+    friend class CompassCalibrator_Test;
+
 public:
     typedef uint8_t completion_mask_t[10];
 
@@ -34,6 +49,9 @@ public:
 
     void set_tolerance(float tolerance) { _tolerance = tolerance; }
 
+    // falls back to the main loop where threads aren't available
+    void set_fit_mode(uint8_t mode) { _fit_mode = mode; }
+
     void get_calibration(Vector3f &offsets, Vector3f &diagonals, Vector3f &offdiagonals);
 
     float get_completion_percent() const;
@@ -69,6 +87,16 @@ private:
         int16_t z;
     };
 
+    // a fit and the samples it runs on, kept apart from the rest of the
+    // calibrator so that it can be run on another thread
+    struct fit_state {
+        param_t params;
+        float fitness; // mean squared residuals
+        float sphere_lambda;
+        float ellipsoid_lambda;
+        const CompassSample *samples;
+        uint16_t num_samples;
+    };
 
 
     enum compass_cal_status_t _status;
@@ -114,16 +142,27 @@ private:
     // thins out samples between step one and step two
     void thin_samples();
 
-    float calc_residual(const Vector3f& sample, const param_t& params) const;
+    static float calc_residual(const Vector3f& sample, const param_t& params);
+    static float calc_mean_squared_residuals(const CompassSample *samples, uint16_t num_samples, const param_t& params);
     float calc_mean_squared_residuals(const param_t& params) const;
     float calc_mean_squared_residuals() const;
 
-    void calc_initial_offset();
-    void calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
-    void run_sphere_fit();
+    // the fit methods return true if they improved the fit
+    static void calc_initial_offset(fit_state &fit);
+    static void calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret);
+    static bool run_sphere_fit(fit_state &fit);
 
-    void calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
-    void run_ellipsoid_fit();
+    static void calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret);
+    static bool run_ellipsoid_fit(fit_state &fit);
+
+    // number of fit steps run while in status
+    static uint16_t num_fit_steps(compass_cal_status_t status);
+    // run fit step number step of status
+    static bool run_fit_step(compass_cal_status_t status, uint16_t step, fit_state &fit);
+
+    // copy the fit to and from the calibrator's state
+    fit_state get_fit_state() const;
+    void set_fit_state(const fit_state &fit);
 
     /**
      * Update #_completion_mask for the geodesic section of \p v. Corrections
@@ -136,4 +175,39 @@ private:
      * Reset and update #_completion_mask with the current samples.
      */
     void update_completion_mask();
+
+    uint8_t _fit_mode;
+
+#if COMPASS_CAL_FIT_THREAD_AVAILABLE
+    /*
+      Fitting on a thread: the remaining fit steps of the current status
+      run on a snapshot of the samples and the result replaces the
+      calibrator's fit at a later update(). Each calibrator has its own
+      thread so that several compasses are fitted in parallel.
+     */
+    // returns false if the thread can't be used and the fit must run inline
+    bool fit_thread_update();
+    bool fit_thread_start();
+    // drop the result of the fit in progress, called on status changes
+    void fit_thread_discard();
+    static void *fit_thread_main(void *arg);
+    void fit_thread_run();
+
+    bool _fit_thread_started;
+    pthread_t _fit_thread;
+    // protects _fit_job and _fit_samples, signals new and finished jobs
+    pthread_mutex_t _fit_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t _fit_cond = PTHREAD_COND_INITIALIZER;
+    // snapshot of _sample_buffer the thread fits to
+    CompassSample *_fit_samples;
+    struct {
+        fit_state fit;
+        compass_cal_status_t status;
+        uint16_t first_step;
+        bool queued;    // waiting for the thread
+        bool running;   // being run by the thread
+        bool done;      // fit holds the result
+        bool discard;   // the calibration has moved on since it was queued
+    } _fit_job;
+#endif
 };
@@ -0,0 +1,118 @@
+#include <AP_gtest.h>
+
+#include <AP_Compass/CompassCalibrator.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if COMPASS_CAL_FIT_THREAD_AVAILABLE
+
+class CompassCalibrator_Test
+{
+public:
+    // start a calibration and feed it samples until it has enough to fit
+    static void start(CompassCalibrator &cal, uint8_t fit_mode)
+    {
+        cal.set_fit_mode(fit_mode);
+        cal.start(false, 0.0f, 1000);
+        ASSERT_EQ(COMPASS_CAL_RUNNING_STEP_ONE, cal.get_status());
+        collect(cal);
+    }
+
+    // feed samples from an offset sphere until the calibrator has enough to fit
+    static void collect(CompassCalibrator &cal)
+    {
+        const Vector3f offset(50.0f, -30.0f, 20.0f);
+        const uint16_t points = 2000;
+
+        // evenly spread points on a sphere of radius 400
+        for (uint16_t i = 0; i < points && !cal.fitting(); i++) {
+            const float z = 1.0f - (2.0f * i + 1.0f) / points;
+            const float r = safe_sqrt(1.0f - z * z);
+            const float phi = i * M_PI * (3.0f - safe_sqrt(5.0f));
+            cal.new_sample(Vector3f(r * cosf(phi), r * sinf(phi), z) * 400.0f - offset);
+        }
+        ASSERT_TRUE(cal.fitting());
+    }
+
+    // run updates until the fit steps of the current status are done
+    static void fit(CompassCalibrator &cal)
+    {
+        const compass_cal_status_t status = cal.get_status();
+        bool failure;
+        for (uint16_t i = 0; i < 1000 && cal._fit_step < cal.num_fit_steps(status); i++) {
+            cal.update(failure);
+        }
+        ASSERT_EQ(cal.num_fit_steps(status), cal._fit_step);
+        ASSERT_EQ(status, cal.get_status());
+    }
+
+    // the samples are shuffled at random between the two steps, give
+    // the second calibrator the same samples as the first and start
+    // both fits from them
+    static void copy_samples(CompassCalibrator &from, CompassCalibrator &to)
+    {
+        memcpy(to._sample_buffer, from._sample_buffer, sizeof(CompassCalibrator::CompassSample) * from._samples_collected);
+        to._samples_collected = from._samples_collected;
+        to._samples_thinned = from._samples_thinned;
+        from.initialize_fit();
+        to.initialize_fit();
+    }
+
+    static bool thread_started(const CompassCalibrator &cal)
+    {
+        return cal._fit_thread_started;
+    }
+
+    static void expect_same_fit(const CompassCalibrator &a, const CompassCalibrator &b)
+    {
+        EXPECT_EQ(a._fitness, b._fitness);
+        EXPECT_EQ(a._params.radius, b._params.radius);
+        EXPECT_EQ(a._params.offset, b._params.offset);
+        EXPECT_EQ(a._params.diag, b._params.diag);
+        EXPECT_EQ(a._params.offdiag, b._params.offdiag);
+    }
+};
+
+static CompassCalibrator inline_cal;
+static CompassCalibrator thread_cal;
+
+TEST(CompassCalibrator, thread_fit_matches_inline)
+{
+    CompassCalibrator_Test::start(inline_cal, COMPASS_CAL_FIT_MAIN_LOOP);
+    CompassCalibrator_Test::start(thread_cal, COMPASS_CAL_FIT_THREAD_DETERMINISTIC);
+
+    // sphere fit
+    CompassCalibrator_Test::fit(inline_cal);
+    CompassCalibrator_Test::fit(thread_cal);
+    ASSERT_TRUE(CompassCalibrator_Test::thread_started(thread_cal));
+    CompassCalibrator_Test::expect_same_fit(inline_cal, thread_cal);
+
+    // thin the samples, top them up and move on to the ellipsoid fit
+    bool failure;
+    inline_cal.update(failure);
+    thread_cal.update(failure);
+    ASSERT_EQ(COMPASS_CAL_RUNNING_STEP_TWO, inline_cal.get_status());
+    ASSERT_EQ(COMPASS_CAL_RUNNING_STEP_TWO, thread_cal.get_status());
+    CompassCalibrator_Test::collect(inline_cal);
+    CompassCalibrator_Test::collect(thread_cal);
+    CompassCalibrator_Test::copy_samples(inline_cal, thread_cal);
+
+    CompassCalibrator_Test::fit(inline_cal);
+    CompassCalibrator_Test::fit(thread_cal);
+    CompassCalibrator_Test::expect_same_fit(inline_cal, thread_cal);
+
+    inline_cal.update(failure);
+    thread_cal.update(failure);
+    EXPECT_EQ(COMPASS_CAL_SUCCESS, inline_cal.get_status());
+    EXPECT_EQ(COMPASS_CAL_SUCCESS, thread_cal.get_status());
+
+    Vector3f offsets, diagonals, offdiagonals;
+    inline_cal.get_calibration(offsets, diagonals, offdiagonals);
+    EXPECT_NEAR(50.0f, offsets.x, 1.0f);
+    EXPECT_NEAR(-30.0f, offsets.y, 1.0f);
+    EXPECT_NEAR(20.0f, offsets.z, 1.0f);
+}
+
+#endif // COMPASS_CAL_FIT_THREAD_AVAILABLE
+
+AP_GTEST_MAIN()
@@ -26,11 +26,39 @@ extern const AP_HAL::HAL& hal;
 
 ObjectArray<mavlink_statustext_t> AP_Frsky_Telem::_statustext_queue(FRSKY_TELEM_PAYLOAD_STATUS_CAPACITY);
 
+// indexed by PassthroughItem
+const AP_Frsky_Telem::passthrough_schedule AP_Frsky_Telem::_passthrough_schedule[] = {
+    // period_ms, priority
+    {    0, 4 },    // PASSTHROUGH_TEXT, as fast as it can while text is queued
+    {  500, 3 },    // PASSTHROUGH_AP_STATUS
+    {  500, 2 },    // PASSTHROUGH_HOME
+    {  500, 2 },    // PASSTHROUGH_VELANDYAW
+    { 1000, 2 },    // PASSTHROUGH_BATT
+    { 1000, 2 },    // PASSTHROUGH_GPS_STATUS
+    { 1000, 1 },    // PASSTHROUGH_GPS_LATLNG, longitude then latitude
+    { 1000, 1 },    // PASSTHROUGH_PARAM
+};
+
 //constructor
 AP_Frsky_Telem::AP_Frsky_Telem(AP_AHRS &ahrs, const AP_BattMonitor &battery, const RangeFinder &rng) :
     _ahrs(ahrs),
     _battery(battery),
-    _rng(rng)
+    _rng(rng),
+    _port(nullptr),
+    _protocol(AP_SerialManager::SerialProtocol_None),
+    _initialised_uart(false),
+    _crc(0),
+    _frame(),
+    _params(),
+    _ap(),
+    check_sensor_status_timer(0),
+    check_ekf_status_timer(0),
+    _paramID(0),
+    _gps(),
+    _passthrough(),
+    _SPort(),
+    _D(),
+    _msg_chunk()
     {}
 
 /*
@@ -96,63 +124,109 @@ void AP_Frsky_Telem::send_SPort_Passthrough(void)
     }
 
     if ((prev_byte == START_STOP_SPORT) && (_passthrough.new_byte == SENSOR_ID_28)) { // byte 0x7E is the header of each poll request
-        if (_passthrough.send_attiandrng) { // skip other data, send attitude (roll, pitch) and range only this iteration
-            _passthrough.send_attiandrng = false; // next iteration, check if we should send something other
-        } else { // send other sensor data if it's time for them, and reset the corresponding timer if sent
-            _passthrough.send_attiandrng = true; // next iteration, send attitude b/c it needs frequent updates to remain smooth
-            uint32_t now = AP_HAL::millis();
-            if ((now - _passthrough.params_timer) >= 1000) {
-                send_uint32(DIY_FIRST_ID+7, calc_param());
-                _passthrough.params_timer = AP_HAL::millis();
-                return;
-            }
-            // build message queue for sensor_status_flags
-            check_sensor_status_flags();
-            // build message queue for ekf_status
-            check_ekf_status();
-            // if there's any message in the queue, start sending them chunk by chunk; three times each chunk
-            if (get_next_msg_chunk()) {
-                send_uint32(DIY_FIRST_ID, _msg_chunk.chunk);
-                return;
-            }
-            if ((now - _passthrough.ap_status_timer) >= 500) {
-                if (((*_ap.valuep) & AP_INITIALIZED_FLAG) > 0) {  // send ap status only once vehicle has been initialised
-                    send_uint32(DIY_FIRST_ID+1, calc_ap_status());
-                    _passthrough.ap_status_timer = AP_HAL::millis();
-                }
-                return;
-            }
-            if ((now - _passthrough.batt_timer) >= 1000) {
-                send_uint32(DIY_FIRST_ID+3, calc_batt());
-                _passthrough.batt_timer = AP_HAL::millis();
-                return;
-            }
-            if ((now - _passthrough.gps_status_timer) >= 1000) {
-                send_uint32(DIY_FIRST_ID+2, calc_gps_status());
-                _passthrough.gps_status_timer = AP_HAL::millis();
-                return;
-            }
-            if ((now - _passthrough.home_timer) >= 500) {
-                send_uint32(DIY_FIRST_ID+4, calc_home());
-                _passthrough.home_timer = AP_HAL::millis();
-                return;
-            }
-            if ((now - _passthrough.velandyaw_timer) >= 500) {
-                send_uint32(DIY_FIRST_ID+5, calc_velandyaw());
-                _passthrough.velandyaw_timer = AP_HAL::millis();
-                return;
+        frame_passthrough_item(AP_HAL::millis());
+    }
+}
+
+/*
+ * answer one poll: frame attitude and range or the next item due
+ * for FrSky SPort Passthrough (OpenTX) protocol (X-receivers)
+ */
+void AP_Frsky_Telem::frame_passthrough_item(uint32_t now)
+{
+    if (_passthrough.send_attiandrng) { // skip other data, send attitude (roll, pitch) and range only this iteration
+        _passthrough.send_attiandrng = false; // next iteration, check if we should send something other
+    } else { // send whichever other item is most overdue, and note when it was sent
+        _passthrough.send_attiandrng = true; // next iteration, send attitude b/c it needs frequent updates to remain smooth
+        // build message queue for sensor_status_flags
+        check_sensor_status_flags();
+        // build message queue for ekf_status
+        check_ekf_status();
+        const int8_t item = next_passthrough_item(now);
+        if (item >= 0) {
+            switch (item) {
+            case PASSTHROUGH_TEXT:
+                // send queued messages chunk by chunk; three times each chunk
+                get_next_msg_chunk();
+                frame_uint32(DIY_FIRST_ID, _msg_chunk.chunk);
+                break;
+            case PASSTHROUGH_AP_STATUS:
+                frame_uint32(DIY_FIRST_ID+1, calc_ap_status());
+                break;
+            case PASSTHROUGH_HOME:
+                frame_uint32(DIY_FIRST_ID+4, calc_home());
+                break;
+            case PASSTHROUGH_VELANDYAW:
+                frame_uint32(DIY_FIRST_ID+5, calc_velandyaw());
+                break;
+            case PASSTHROUGH_BATT:
+                frame_uint32(DIY_FIRST_ID+3, calc_batt());
+                break;
+            case PASSTHROUGH_GPS_STATUS:
+                frame_uint32(DIY_FIRST_ID+2, calc_gps_status());
+                break;
+            case PASSTHROUGH_GPS_LATLNG:
+                frame_uint32(GPS_LONG_LATI_FIRST_ID, calc_gps_latlng(&_passthrough.send_latitude)); // gps latitude or longitude
+                break;
+            case PASSTHROUGH_PARAM:
+                frame_uint32(DIY_FIRST_ID+7, calc_param());
+                break;
             }
-            if ((now - _passthrough.gps_latlng_timer) >= 1000) {
-                send_uint32(GPS_LONG_LATI_FIRST_ID, calc_gps_latlng(&_passthrough.send_latitude)); // gps latitude or longitude
-                if (!_passthrough.send_latitude) { // we've cycled and sent one each of longitude then latitude, so reset the timer
-                    _passthrough.gps_latlng_timer = AP_HAL::millis();
-                }
-                return;
+            // the gps item is only done once we've cycled and sent one each of longitude then latitude
+            if (item != PASSTHROUGH_GPS_LATLNG || !_passthrough.send_latitude) {
+                _passthrough.last_sent_ms[item] = now;
             }
+            return;
         }
-        // if nothing else needed to be sent, send attitude (roll, pitch) and range data
-        send_uint32(DIY_FIRST_ID+6, calc_attiandrng());
     }
+    // if nothing else needed to be sent, send attitude (roll, pitch) and range data
+    frame_uint32(DIY_FIRST_ID+6, calc_attiandrng());
+}
+
+/*
+ * true if an SPort Passthrough item has something to send
+ * for FrSky SPort Passthrough (OpenTX) protocol (X-receivers)
+ */
+bool AP_Frsky_Telem::passthrough_item_ready(uint8_t item) const
+{
+    switch (item) {
+    case PASSTHROUGH_TEXT:
+        return !_statustext_queue.empty();
+    case PASSTHROUGH_AP_STATUS:
+        // send ap status only once vehicle has been initialised
+        return ((*_ap.valuep) & AP_INITIALIZED_FLAG) > 0;
+    default:
+        return true;
+    }
+}
+
+/*
+ * pick the SPort Passthrough item to send next: the one which is most
+ * overdue, weighted by its priority, or -1 if none is due. Weighting
+ * by lateness keeps a long run of text messages or a high priority
+ * item from starving the others
+ * for FrSky SPort Passthrough (OpenTX) protocol (X-receivers)
+ */
+int8_t AP_Frsky_Telem::next_passthrough_item(uint32_t now) const
+{
+    int8_t best = -1;
+    uint32_t best_score = 0;
+
+    for (uint8_t i = 0; i < PASSTHROUGH_NUM_ITEMS; i++) {
+        const uint32_t age = now - _passthrough.last_sent_ms[i];
+        if (age < _passthrough_schedule[i].period_ms || !passthrough_item_ready(i)) {
+            continue;
+        }
+        // clamp so that items never sent can't overflow the score
+        const uint32_t late = MIN(age - _passthrough_schedule[i].period_ms, 0xFFFFU) + 1;
+        const uint32_t score = late * _passthrough_schedule[i].priority;
+        // on a tie the item listed first wins
+        if (score > best_score) {
+            best = i;
+            best_score = score;
+        }
+    }
+    return best;
 }
 
 /*
@@ -185,13 +259,13 @@ void AP_Frsky_Telem::send_SPort(void)
                 case SENSOR_ID_FAS:
                     switch (_SPort.fas_call) {
                         case 0:
-                            send_uint32(DATA_ID_FUEL, (uint16_t)roundf(_battery.capacity_remaining_pct())); // send battery remaining
+                            frame_uint32(DATA_ID_FUEL, (uint16_t)roundf(_battery.capacity_remaining_pct())); // send battery remaining
                             break;
                         case 1:
-                            send_uint32(DATA_ID_VFAS, (uint16_t)roundf(_battery.voltage() * 10.0f)); // send battery voltage
+                            frame_uint32(DATA_ID_VFAS, (uint16_t)roundf(_battery.voltage() * 10.0f)); // send battery voltage
                             break;
                         case 2:
-                            send_uint32(DATA_ID_CURRENT, (uint16_t)roundf(_battery.current_amps() * 10.0f)); // send current consumption
+                            frame_uint32(DATA_ID_CURRENT, (uint16_t)roundf(_battery.current_amps() * 10.0f)); // send current consumption
                             break;
                     }
                     if (_SPort.fas_call++ > 2) _SPort.fas_call = 0;
@@ -200,37 +274,37 @@ void AP_Frsky_Telem::send_SPort(void)
                     switch (_SPort.gps_call) {
                         case 0:
                             calc_gps_position(); // gps data is not recalculated until all of it has been sent
-                            send_uint32(DATA_ID_GPS_LAT_BP, _gps.latdddmm); // send gps lattitude degree and minute integer part
+                            frame_uint32(DATA_ID_GPS_LAT_BP, _gps.latdddmm); // send gps lattitude degree and minute integer part
                             break;
                         case 1:
-                            send_uint32(DATA_ID_GPS_LAT_AP, _gps.latmmmm); // send gps lattitude minutes decimal part
+                            frame_uint32(DATA_ID_GPS_LAT_AP, _gps.latmmmm); // send gps lattitude minutes decimal part
                             break;
                         case 2:
-                            send_uint32(DATA_ID_GPS_LAT_NS, _gps.lat_ns); // send gps North / South information
+                            frame_uint32(DATA_ID_GPS_LAT_NS, _gps.lat_ns); // send gps North / South information
                             break;
                         case 3:
-                            send_uint32(DATA_ID_GPS_LONG_BP, _gps.londddmm); // send gps longitude degree and minute integer part
+                            frame_uint32(DATA_ID_GPS_LONG_BP, _gps.londddmm); // send gps longitude degree and minute integer part
                             break;
                         case 4:
-                            send_uint32(DATA_ID_GPS_LONG_AP, _gps.lonmmmm); // send gps longitude minutes decimal part
+                            frame_uint32(DATA_ID_GPS_LONG_AP, _gps.lonmmmm); // send gps longitude minutes decimal part
                             break;
                         case 5:
-                            send_uint32(DATA_ID_GPS_LONG_EW, _gps.lon_ew); // send gps East / West information
+                            frame_uint32(DATA_ID_GPS_LONG_EW, _gps.lon_ew); // send gps East / West information
                             break;
                         case 6:
-                            send_uint32(DATA_ID_GPS_SPEED_BP, _gps.speed_in_meter); // send gps speed integer part
+                            frame_uint32(DATA_ID_GPS_SPEED_BP, _gps.speed_in_meter); // send gps speed integer part
                             break;
                         case 7:
-                            send_uint32(DATA_ID_GPS_SPEED_AP, _gps.speed_in_centimeter); // send gps speed decimal part
+                            frame_uint32(DATA_ID_GPS_SPEED_AP, _gps.speed_in_centimeter); // send gps speed decimal part
                             break;
                         case 8:
-                            send_uint32(DATA_ID_GPS_ALT_BP, _gps.alt_gps_meters); // send gps altitude integer part
+                            frame_uint32(DATA_ID_GPS_ALT_BP, _gps.alt_gps_meters); // send gps altitude integer part
                             break;
                         case 9:
-                            send_uint32(DATA_ID_GPS_ALT_AP, _gps.alt_gps_cm); // send gps altitude decimals
+                            frame_uint32(DATA_ID_GPS_ALT_AP, _gps.alt_gps_cm); // send gps altitude decimals
                             break;
                         case 10:
-                            send_uint32(DATA_ID_GPS_COURS_BP, (uint16_t)((_ahrs.yaw_sensor / 100) % 360)); // send heading in degree based on AHRS and not GPS
+                            frame_uint32(DATA_ID_GPS_COURS_BP, (uint16_t)((_ahrs.yaw_sensor / 100) % 360)); // send heading in degree based on AHRS and not GPS
                             break;
                     }
                     if (_SPort.gps_call++ > 10) _SPort.gps_call = 0;
@@ -239,10 +313,10 @@ void AP_Frsky_Telem::send_SPort(void)
                     switch (_SPort.vario_call) {
                         case 0 :
                             calc_nav_alt(); // nav altitude is not recalculated until all of it has been sent
-                            send_uint32(DATA_ID_BARO_ALT_BP, _gps.alt_nav_meters); // send altitude integer part
+                            frame_uint32(DATA_ID_BARO_ALT_BP, _gps.alt_nav_meters); // send altitude integer part
                             break;
                         case 1:
-                            send_uint32(DATA_ID_BARO_ALT_AP, _gps.alt_nav_cm); // send altitude decimal part
+                            frame_uint32(DATA_ID_BARO_ALT_AP, _gps.alt_nav_cm); // send altitude decimal part
                             break;
                         }
                     if (_SPort.vario_call++ > 1) _SPort.vario_call = 0;
@@ -250,10 +324,10 @@ void AP_Frsky_Telem::send_SPort(void)
                 case SENSOR_ID_SP2UR:
                     switch (_SPort.various_call) {
                         case 0 :
-                            send_uint32(DATA_ID_TEMP2, (uint16_t)(_ahrs.get_gps().num_sats() * 10 + _ahrs.get_gps().status())); // send GPS status and number of satellites as num_sats*10 + status (to fit into a uint8_t)
+                            frame_uint32(DATA_ID_TEMP2, (uint16_t)(_ahrs.get_gps().num_sats() * 10 + _ahrs.get_gps().status())); // send GPS status and number of satellites as num_sats*10 + status (to fit into a uint8_t)
                             break;
                         case 1:
-                            send_uint32(DATA_ID_TEMP1, _ap.control_mode); // send flight mode
+                            frame_uint32(DATA_ID_TEMP1, _ap.control_mode); // send flight mode
                             break;
                     }
                     if (_SPort.various_call++ > 1) _SPort.various_call = 0;
@@ -276,31 +350,31 @@ void AP_Frsky_Telem::send_D(void)
     // send frame1 every 200ms
     if (now - _D.last_200ms_frame >= 200) {
         _D.last_200ms_frame = now;
-        send_uint16(DATA_ID_TEMP2, (uint16_t)(_ahrs.get_gps().num_sats() * 10 + _ahrs.get_gps().status())); // send GPS status and number of satellites as num_sats*10 + status (to fit into a uint8_t)
-        send_uint16(DATA_ID_TEMP1, _ap.control_mode); // send flight mode
-        send_uint16(DATA_ID_FUEL, (uint16_t)roundf(_battery.capacity_remaining_pct())); // send battery remaining
-        send_uint16(DATA_ID_VFAS, (uint16_t)roundf(_battery.voltage() * 10.0f)); // send battery voltage
-        send_uint16(DATA_ID_CURRENT, (uint16_t)roundf(_battery.current_amps() * 10.0f)); // send current consumption
+        frame_uint16(DATA_ID_TEMP2, (uint16_t)(_ahrs.get_gps().num_sats() * 10 + _ahrs.get_gps().status())); // send GPS status and number of satellites as num_sats*10 + status (to fit into a uint8_t)
+        frame_uint16(DATA_ID_TEMP1, _ap.control_mode); // send flight mode
+        frame_uint16(DATA_ID_FUEL, (uint16_t)roundf(_battery.capacity_remaining_pct())); // send battery remaining
+        frame_uint16(DATA_ID_VFAS, (uint16_t)roundf(_battery.voltage() * 10.0f)); // send battery voltage
+        frame_uint16(DATA_ID_CURRENT, (uint16_t)roundf(_battery.current_amps() * 10.0f)); // send current consumption
         calc_nav_alt();
-        send_uint16(DATA_ID_BARO_ALT_BP, _gps.alt_nav_meters); // send nav altitude integer part
-        send_uint16(DATA_ID_BARO_ALT_AP, _gps.alt_nav_cm); // send nav altitude decimal part
+        frame_uint16(DATA_ID_BARO_ALT_BP, _gps.alt_nav_meters); // send nav altitude integer part
+        frame_uint16(DATA_ID_BARO_ALT_AP, _gps.alt_nav_cm); // send nav altitude decimal part
     }
     // send frame2 every second
     if (now - _D.last_1000ms_frame >= 1000) {
         _D.last_1000ms_frame = now;
-        send_uint16(DATA_ID_GPS_COURS_BP, (uint16_t)((_ahrs.yaw_sensor / 100) % 360)); // send heading in degree based on AHRS and not GPS
+        frame_uint16(DATA_ID_GPS_COURS_BP, (uint16_t)((_ahrs.yaw_sensor / 100) % 360)); // send heading in degree based on AHRS and not GPS
         calc_gps_position();
         if (_ahrs.get_gps().status() >= 3) {
-            send_uint16(DATA_ID_GPS_LAT_BP, _gps.latdddmm); // send gps lattitude degree and minute integer part
-            send_uint16(DATA_ID_GPS_LAT_AP, _gps.latmmmm); // send gps lattitude minutes decimal part
-            send_uint16(DATA_ID_GPS_LAT_NS, _gps.lat_ns); // send gps North / South information
-            send_uint16(DATA_ID_GPS_LONG_BP, _gps.londddmm); // send gps longitude degree and minute integer part
-            send_uint16(DATA_ID_GPS_LONG_AP, _gps.lonmmmm); // send gps longitude minutes decimal part
-            send_uint16(DATA_ID_GPS_LONG_EW, _gps.lon_ew); // send gps East / West information
-            send_uint16(DATA_ID_GPS_SPEED_BP, _gps.speed_in_meter); // send gps speed integer part
-            send_uint16(DATA_ID_GPS_SPEED_AP, _gps.speed_in_centimeter); // send gps speed decimal part
-            send_uint16(DATA_ID_GPS_ALT_BP, _gps.alt_gps_meters); // send gps altitude integer part
-            send_uint16(DATA_ID_GPS_ALT_AP, _gps.alt_gps_cm); // send gps altitude decimal part
+            frame_uint16(DATA_ID_GPS_LAT_BP, _gps.latdddmm); // send gps lattitude degree and minute integer part
+            frame_uint16(DATA_ID_GPS_LAT_AP, _gps.latmmmm); // send gps lattitude minutes decimal part
+            frame_uint16(DATA_ID_GPS_LAT_NS, _gps.lat_ns); // send gps North / South information
+            frame_uint16(DATA_ID_GPS_LONG_BP, _gps.londddmm); // send gps longitude degree and minute integer part
+            frame_uint16(DATA_ID_GPS_LONG_AP, _gps.lonmmmm); // send gps longitude minutes decimal part
+            frame_uint16(DATA_ID_GPS_LONG_EW, _gps.lon_ew); // send gps East / West information
+            frame_uint16(DATA_ID_GPS_SPEED_BP, _gps.speed_in_meter); // send gps speed integer part
+            frame_uint16(DATA_ID_GPS_SPEED_AP, _gps.speed_in_centimeter); // send gps speed decimal part
+            frame_uint16(DATA_ID_GPS_ALT_BP, _gps.alt_gps_meters); // send gps altitude integer part
+            frame_uint16(DATA_ID_GPS_ALT_AP, _gps.alt_gps_cm); // send gps altitude decimal part
         }
     }
 }
@@ -328,6 +402,9 @@ void AP_Frsky_Telem::tick(void)
     } else if (_protocol == AP_SerialManager::SerialProtocol_FrSky_SPort_Passthrough) { // FrSky SPort Passthrough (OpenTX) protocol (X-receivers)
         send_SPort_Passthrough();
     }
+
+    // write whatever was framed this tick in one go
+    send_frame();
 }
 
 /* 
@@ -342,73 +419,103 @@ void AP_Frsky_Telem::calc_crc(uint8_t byte)
 }
 
 /*
- * send the frame's crc at the end of the frame
+ * add the frame's crc at the end of the frame
  * for FrSky SPort protocol (X-receivers)
  */
-void AP_Frsky_Telem::send_crc(void) 
+void AP_Frsky_Telem::frame_crc(void) 
 {
-    send_byte(0xFF - _crc);
+    frame_byte(0xFF - _crc);
     _crc = 0;
 }
 
 
 /*
-  send 1 byte and do byte stuffing
+  add 1 byte to the frame buffer and do byte stuffing
 */
-void AP_Frsky_Telem::send_byte(uint8_t byte)
+void AP_Frsky_Telem::frame_byte(uint8_t byte)
 {
+    // room for a stuffed byte. The frame_*() functions send the
+    // buffer before it gets this full, so this shouldn't happen
+    if (_frame.len > FRSKY_FRAME_BUFSIZE - 2) {
+        return;
+    }
+    uint8_t *p = &_frame.buf[_frame.len];
     if (_protocol == AP_SerialManager::SerialProtocol_FrSky_D) { // FrSky D protocol (D-receivers)
         if (byte == START_STOP_D) {
-            _port->write(0x5D);
-            _port->write(0x3E);
+            *p++ = 0x5D;
+            *p++ = 0x3E;
         } else if (byte == BYTESTUFF_D) {
-            _port->write(0x5D);
-            _port->write(0x3D);
+            *p++ = 0x5D;
+            *p++ = 0x3D;
         } else {
-            _port->write(byte);
+            *p++ = byte;
         }
     } else { // FrSky SPort protocol (X-receivers)
         if (byte == START_STOP_SPORT) {
-            _port->write(0x7D);
-            _port->write(0x5E);
+            *p++ = 0x7D;
+            *p++ = 0x5E;
         } else if (byte == BYTESTUFF_SPORT) {
-            _port->write(0x7D);
-            _port->write(0x5D);
+            *p++ = 0x7D;
+            *p++ = 0x5D;
         } else {
-            _port->write(byte);
+            *p++ = byte;
         }
         calc_crc(byte);
     }
+    _frame.len = p - _frame.buf;
 }
 
 /*
- * send one uint32 frame of FrSky data - for FrSky SPort protocol (X-receivers)
+ * add one uint32 frame of FrSky data to the frame buffer - for FrSky SPort protocol (X-receivers)
  */
-void  AP_Frsky_Telem::send_uint32(uint16_t id, uint32_t data)
+void  AP_Frsky_Telem::frame_uint32(uint16_t id, uint32_t data)
 {
-    send_byte(0x10); // DATA_FRAME
+    if (_frame.len + FRSKY_SPORT_FRAME_MAX > FRSKY_FRAME_BUFSIZE) {
+        send_frame();
+    }
+    frame_byte(0x10); // DATA_FRAME
     uint8_t *bytes = (uint8_t*)&id;
-    send_byte(bytes[0]); // LSB
-    send_byte(bytes[1]); // MSB
+    frame_byte(bytes[0]); // LSB
+    frame_byte(bytes[1]); // MSB
     bytes = (uint8_t*)&data;
-    send_byte(bytes[0]); // LSB
-    send_byte(bytes[1]);
-    send_byte(bytes[2]);
-    send_byte(bytes[3]); // MSB
-    send_crc();
+    frame_byte(bytes[0]); // LSB
+    frame_byte(bytes[1]);
+    frame_byte(bytes[2]);
+    frame_byte(bytes[3]); // MSB
+    frame_crc();
 }
 
 /*
- * send one uint16 frame of FrSky data - for FrSky D protocol (D-receivers)
+ * add one uint16 frame of FrSky data to the frame buffer - for FrSky D protocol (D-receivers)
  */
-void  AP_Frsky_Telem::send_uint16(uint16_t id, uint16_t data)
+void  AP_Frsky_Telem::frame_uint16(uint16_t id, uint16_t data)
 {
-    _port->write(START_STOP_D);    // send a 0x5E start byte
+    if (_frame.len + FRSKY_D_FRAME_MAX > FRSKY_FRAME_BUFSIZE) {
+        send_frame();
+    }
+    _frame.buf[_frame.len++] = START_STOP_D;    // a 0x5E start byte
     uint8_t *bytes = (uint8_t*)&id;
-    send_byte(bytes[0]);
+    frame_byte(bytes[0]);
     bytes = (uint8_t*)&data;
-    send_byte(bytes[0]); // LSB
-    send_byte(bytes[1]); // MSB
+    frame_byte(bytes[0]); // LSB
+    frame_byte(bytes[1]); // MSB
+}
+
+/*
+ * write the frame buffer to the UART with a single write
+ */
+void AP_Frsky_Telem::send_frame(void)
+{
+    if (_frame.len == 0) {
+        return;
+    }
+    // drop the frames rather than leave part of one in the stream
+    if (_port->txspace() >= _frame.len) {
+        _port->write(_frame.buf, _frame.len);
+    } else {
+        _frame.dropped++;
+    }
+    _frame.len = 0;
 }
 
 /*
@@ -67,6 +67,13 @@ for FrSky SPort and SPort Passthrough (OpenTX) protocols (X-receivers)
 #define START_STOP_SPORT            0x7E
 #define BYTESTUFF_SPORT             0x7D
 
+// longest frames once byte stuffed: a D frame is a start byte and 3
+// data bytes, an SPort frame is 0x10, 6 data bytes and the crc
+#define FRSKY_D_FRAME_MAX           7
+#define FRSKY_SPORT_FRAME_MAX       15
+// holds all of a D frame2 so it goes out in one write
+#define FRSKY_FRAME_BUFSIZE         80
+
 /* 
 for FrSky SPort Passthrough
 */
@@ -110,6 +117,8 @@ for FrSky SPort Passthrough
 
 class AP_Frsky_Telem
 {
+    friend class AP_Frsky_Telem_Test;
+
 public:
     //constructor
     AP_Frsky_Telem(AP_AHRS &ahrs, const AP_BattMonitor &battery, const RangeFinder &rng);
@@ -134,6 +143,9 @@ public:
     // functioning correctly
     void update_sensor_status_flags(uint32_t error_mask) { _ap.sensor_status_flags = error_mask; }
 
+    // number of buffered writes dropped because the UART was full
+    uint32_t frames_dropped(void) const { return _frame.dropped; }
+
     static ObjectArray<mavlink_statustext_t> _statustext_queue;
     
 private:
@@ -145,6 +157,14 @@ private:
     bool _initialised_uart;
     uint16_t _crc;
 
+    // frames waiting for send_frame(), already byte stuffed
+    struct
+    {
+        uint8_t buf[FRSKY_FRAME_BUFSIZE];
+        uint8_t len;
+        uint32_t dropped; // writes dropped for lack of UART space
+    } _frame;
+
     struct
     {
         uint8_t mav_type; // frame type (see MAV_TYPE in Mavlink definition file common.h)
@@ -179,18 +199,34 @@ private:
         uint16_t speed_in_centimeter;
     } _gps;
 
+    // SPort Passthrough items sent in turn with attitude and range,
+    // see send_SPort_Passthrough()
+    enum PassthroughItem {
+        PASSTHROUGH_TEXT = 0,
+        PASSTHROUGH_AP_STATUS,
+        PASSTHROUGH_HOME,
+        PASSTHROUGH_VELANDYAW,
+        PASSTHROUGH_BATT,
+        PASSTHROUGH_GPS_STATUS,
+        PASSTHROUGH_GPS_LATLNG,
+        PASSTHROUGH_PARAM,
+        PASSTHROUGH_NUM_ITEMS
+    };
+
+    // how often each item should be sent and how much to favour it
+    // over other items which are as late, see next_passthrough_item()
+    struct passthrough_schedule {
+        uint16_t period_ms;
+        uint8_t priority;
+    };
+    static const passthrough_schedule _passthrough_schedule[PASSTHROUGH_NUM_ITEMS];
+
     struct
     {
         uint8_t new_byte;
         bool send_attiandrng;
         bool send_latitude;
-        uint32_t params_timer;
-        uint32_t ap_status_timer;
-        uint32_t batt_timer;
-        uint32_t gps_status_timer;
-        uint32_t home_timer;
-        uint32_t velandyaw_timer;
-        uint32_t gps_latlng_timer;
+        uint32_t last_sent_ms[PASSTHROUGH_NUM_ITEMS];
     } _passthrough;
     
     struct
@@ -226,12 +262,16 @@ private:
 
     // methods related to the nuts-and-bolts of sending data
     void calc_crc(uint8_t byte);
-    void send_crc(void);
-    void send_byte(uint8_t value);
-    void send_uint32(uint16_t id, uint32_t data);
-    void send_uint16(uint16_t id, uint16_t data);
+    void frame_crc(void);
+    void frame_byte(uint8_t value);
+    void frame_uint32(uint16_t id, uint32_t data);
+    void frame_uint16(uint16_t id, uint16_t data);
+    void send_frame(void);
 
     // methods to convert flight controller data to FrSky SPort Passthrough (OpenTX) format
+    void frame_passthrough_item(uint32_t now);
+    bool passthrough_item_ready(uint8_t item) const;
+    int8_t next_passthrough_item(uint32_t now) const;
     bool get_next_msg_chunk(void);
     void check_sensor_status_flags(void);
     void check_ekf_status(void);
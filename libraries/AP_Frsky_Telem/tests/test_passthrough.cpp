@@ -0,0 +1,165 @@
+#include <AP_gtest.h>
+
+#include <AP_Frsky_Telem/AP_Frsky_Telem.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static AP_InertialSensor ins;
+static AP_Baro baro;
+static AP_GPS gps;
+static AP_AHRS_DCM ahrs{ins, baro, gps};
+static AP_BattMonitor battery;
+static AP_SerialManager serial_manager;
+static RangeFinder rng{serial_manager, ROTATION_PITCH_270};
+
+// the receiver polls each sensor id in turn, so ours comes round
+// about this often
+#define POLL_MS 12
+
+// UART which takes writes while it has txspace()
+class FakeUART : public AP_HAL::UARTDriver
+{
+public:
+    void begin(uint32_t baud) override {}
+    void begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    void end() override {}
+    void flush() override {}
+    bool is_initialized() override { return true; }
+    void set_blocking_writes(bool blocking) override {}
+    bool tx_pending() override { return false; }
+    uint32_t available() override { return 0; }
+    uint32_t txspace() override { return space; }
+    int16_t read() override { return -1; }
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override
+    {
+        written += size;
+        return size;
+    }
+
+    uint32_t space = 0;
+    uint32_t written = 0;
+};
+
+class AP_Frsky_Telem_Test
+{
+public:
+    AP_Frsky_Telem_Test() :
+        telem{ahrs, battery, rng}
+    {
+        // set up as init() does for rover and plane, without a UART
+        telem._protocol = AP_SerialManager::SerialProtocol_FrSky_SPort_Passthrough;
+        telem._ap.value = AP_INITIALIZED_FLAG;
+        telem._ap.valuep = &telem._ap.value;
+        AP_Frsky_Telem::_statustext_queue.clear();
+    }
+
+    // answer one poll, returning the data id of the frame sent
+    uint16_t poll(uint32_t now)
+    {
+        telem._frame.len = 0;
+        telem.frame_passthrough_item(now);
+        // a 0x10 then the id, LSB first. No id needs byte stuffing
+        return telem._frame.buf[1] | (telem._frame.buf[2] << 8);
+    }
+
+    // frame one value and write it to the UART
+    void send(AP_HAL::UARTDriver *port, uint16_t id, uint32_t data)
+    {
+        telem._port = port;
+        telem.frame_uint32(id, data);
+        telem.send_frame();
+    }
+
+    bool text_queued() const { return !AP_Frsky_Telem::_statustext_queue.empty(); }
+
+    AP_Frsky_Telem telem;
+};
+
+// index of an item in sent[], by the id it is sent with
+static uint8_t item_index(uint16_t id)
+{
+    if (id == GPS_LONG_LATI_FIRST_ID) {
+        return 8;
+    }
+    return id - DIY_FIRST_ID;
+}
+
+TEST(AP_Frsky_Telem, passthrough_text_no_starvation)
+{
+    AP_Frsky_Telem_Test test;
+    uint32_t sent[9] {};
+    uint32_t polls = 0;
+    const uint32_t run_ms = 20000;
+
+    for (uint32_t now = POLL_MS; now < run_ms; now += POLL_MS, polls++) {
+        // keep the text queue full for the whole run
+        while (AP_Frsky_Telem::_statustext_queue.space() > 0) {
+            test.telem.queue_message(MAV_SEVERITY_INFO, "a long status text message for the queue");
+        }
+        sent[item_index(test.poll(now))]++;
+    }
+
+    // text gets the most slots, but every other item still goes out
+    // at no less than half its rate
+    EXPECT_GT(sent[0], polls / 4);
+    EXPECT_GE(sent[item_index(DIY_FIRST_ID+1)], run_ms / 500 / 2);   // ap status
+    EXPECT_GE(sent[item_index(DIY_FIRST_ID+4)], run_ms / 500 / 2);   // home
+    EXPECT_GE(sent[item_index(DIY_FIRST_ID+5)], run_ms / 500 / 2);   // velandyaw
+    EXPECT_GE(sent[item_index(DIY_FIRST_ID+3)], run_ms / 1000 / 2);  // battery
+    EXPECT_GE(sent[item_index(DIY_FIRST_ID+2)], run_ms / 1000 / 2);  // gps status
+    EXPECT_GE(sent[item_index(GPS_LONG_LATI_FIRST_ID)], run_ms / 1000); // longitude and latitude
+    EXPECT_GE(sent[item_index(DIY_FIRST_ID+7)], run_ms / 1000 / 2);  // param
+
+    // attitude and range have every other poll
+    EXPECT_GE(sent[item_index(DIY_FIRST_ID+6)], polls / 2);
+}
+
+TEST(AP_Frsky_Telem, passthrough_text_drains)
+{
+    AP_Frsky_Telem_Test test;
+
+    for (uint8_t i = 0; i < FRSKY_TELEM_PAYLOAD_STATUS_CAPACITY; i++) {
+        test.telem.queue_message(MAV_SEVERITY_INFO, "a long status text message for the queue");
+    }
+
+    uint32_t now = POLL_MS;
+    uint16_t chunks = 0;
+    for (; now < 60000 && test.text_queued(); now += POLL_MS) {
+        if (test.poll(now) == DIY_FIRST_ID) {
+            chunks++;
+        }
+    }
+    EXPECT_FALSE(test.text_queued());
+
+    // each message goes out four characters at a time, each chunk
+    // repeated; the other items only delay it by a few seconds
+    const uint16_t chunks_per_message = (strlen("a long status text message for the queue") + 4) / 4;
+    EXPECT_GE(chunks, chunks_per_message * FRSKY_TELEM_PAYLOAD_STATUS_CAPACITY * 3);
+    EXPECT_LT(now, 10000U);
+
+    // with nothing queued text isn't sent again
+    for (uint32_t end = now + 5000; now < end; now += POLL_MS) {
+        EXPECT_NE(DIY_FIRST_ID, test.poll(now));
+    }
+}
+
+TEST(AP_Frsky_Telem, send_frame_drops_counted)
+{
+    AP_Frsky_Telem_Test test;
+    FakeUART uart;
+
+    // a frame which doesn't fit is dropped whole and counted
+    uart.space = 4;
+    test.send(&uart, DIY_FIRST_ID, 0);
+    EXPECT_EQ(0U, uart.written);
+    EXPECT_EQ(1U, test.telem.frames_dropped());
+
+    // 0x10, the id, the data and the crc
+    uart.space = FRSKY_FRAME_BUFSIZE;
+    test.send(&uart, DIY_FIRST_ID, 0);
+    EXPECT_EQ(8U, uart.written);
+    EXPECT_EQ(1U, test.telem.frames_dropped());
+}
+
+AP_GTEST_MAIN()
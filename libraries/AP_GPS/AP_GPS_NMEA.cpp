@@ -111,23 +111,30 @@ AP_GPS_NMEA::AP_GPS_NMEA(AP_GPS &_gps, AP_GPS::GPS_State &_state, AP_HAL::UARTDr
 
 bool AP_GPS_NMEA::read(void)
 {
-    int16_t numc;
+    uint8_t buf[GPS_READ_CHUNK_SIZE];
+    uint32_t numc;
     bool parsed = false;
 
     numc = port->available();
-    while (numc--) {
-        char c = port->read();
+    while (numc > 0) {
+        uint32_t n = port->read(buf, MIN(numc, sizeof(buf)));
+        if (n == 0) {
+            break;
+        }
+        numc -= n;
 #ifdef NMEA_LOG_PATH
         static FILE *logf = nullptr;
         if (logf == nullptr) {
             logf = fopen(NMEA_LOG_PATH, "wb");
         }
         if (logf != nullptr) {
-            ::fwrite(&c, 1, 1, logf);
+            ::fwrite(buf, 1, n, logf);
         }
 #endif
-        if (_decode(c)) {
-            parsed = true;
+        for (uint32_t i = 0; i < n; i++) {
+            if (_decode(buf[i])) {
+                parsed = true;
+            }
         }
     }
     return parsed;
@@ -70,9 +70,12 @@ AP_GPS_SBF::read(void)
     }
 
     bool ret = false;
-    while (port->available() > 0) {
-        uint8_t temp = port->read();
-        ret |= parse(temp);
+    uint8_t buf[GPS_READ_CHUNK_SIZE];
+    uint32_t n;
+    while ((n = port->read(buf, sizeof(buf))) > 0) {
+        for (uint32_t i = 0; i < n; i++) {
+            ret |= parse(buf[i]);
+        }
     }
 
     return ret;
@@ -343,8 +343,6 @@ AP_GPS_UBLOX::_request_port(void)
 bool
 AP_GPS_UBLOX::read(void)
 {
-    uint8_t data;
-    int16_t numc;
     bool parsed = false;
     uint32_t millis_now = AP_HAL::millis();
 
@@ -373,11 +371,35 @@ AP_GPS_UBLOX::read(void)
         }
     }
 
-    numc = port->available();
-    for (int16_t i = 0; i < numc; i++) {        // Process bytes received
+    // Process bytes received, in chunks
+    uint8_t buf[GPS_READ_CHUNK_SIZE];
+    uint32_t numc = port->available();
+    while (numc > 0) {
+        uint32_t n = port->read(buf, MIN(numc, sizeof(buf)));
+        if (n == 0) {
+            break;
+        }
+        numc -= n;
+        if (_parse_bytes(buf, n)) {
+            parsed = true;
+        }
+    }
+    return parsed;
+}
+
+/*
+  run the message state machine over a span of received bytes, returning
+  true if a message was parsed
+ */
+bool
+AP_GPS_UBLOX::_parse_bytes(const uint8_t *buf, uint32_t len)
+{
+    uint8_t data;
+    bool parsed = false;
+
+    for (uint32_t i = 0; i < len; i++) {
 
-        // read the next byte
-        data = port->read();
+        data = buf[i];
 
 	reset:
         switch(_step) {
@@ -400,8 +422,15 @@ AP_GPS_UBLOX::read(void)
             Debug("reset %u", __LINE__);
             /* no break */
         case 0:
-            if(PREAMBLE1 == data)
+            if(PREAMBLE1 == data) {
                 _step++;
+                break;
+            }
+            // skip straight to the next possible preamble in the span
+            {
+                const uint8_t *next = (const uint8_t *)memchr(&buf[i+1], PREAMBLE1, len - i - 1);
+                i = next ? (next - buf) - 1 : len - 1;
+            }
             break;
 
         // Message header processing
@@ -441,18 +470,29 @@ AP_GPS_UBLOX::read(void)
 				goto reset;
             }
             _payload_counter = 0;                               // prepare to receive payload
+            if (_payload_length == 0) {
+                // no payload, next byte is the checksum
+                _step++;
+            }
             break;
 
         // Receive message data
         //
-        case 6:
-            _ck_b += (_ck_a += data);                   // checksum byte
-            if (_payload_counter < sizeof(_buffer)) {
-                _buffer[_payload_counter] = data;
+        // The payload is copied straight from the span, as much of it
+        // as has been received
+        //
+        case 6: {
+            uint32_t count = MIN(len - i, (uint32_t)(_payload_length - _payload_counter));
+            for (uint32_t k = 0; k < count; k++) {
+                _ck_b += (_ck_a += buf[i+k]);           // checksum byte
             }
-            if (++_payload_counter == _payload_length)
+            memcpy(&_buffer[_payload_counter], &buf[i], count);
+            _payload_counter += count;
+            i += count - 1;
+            if (_payload_counter == _payload_length)
                 _step++;
             break;
+        }
 
         // Checksum and message processing
         //
@@ -547,6 +547,7 @@ private:
 
     // Buffer parse & GPS state update
     bool        _parse_gps();
+    bool        _parse_bytes(const uint8_t *buf, uint32_t len);
 
     // used to update fix between status and position packets
     AP_GPS::GPS_Status next_fix;
@@ -21,6 +21,11 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include "AP_GPS.h"
 
+// number of bytes drivers take from the UART at once in read()
+#ifndef GPS_READ_CHUNK_SIZE
+#define GPS_READ_CHUNK_SIZE 64
+#endif
+
 class AP_GPS_Backend
 {
 public:
@@ -0,0 +1,175 @@
+#include <AP_gbenchmark.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <AP_GPS/AP_GPS.h>
+#include <AP_GPS/AP_GPS_NMEA.h>
+#include <AP_GPS/AP_GPS_UBLOX.h>
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+ * UART replaying a byte stream as if received from a GPS, one second of
+ * output per KeepRunning() iteration. Writes are discarded. With bulk set
+ * to false, the span read falls back to the per-byte read() to compare
+ * both paths.
+ */
+class ReplayUARTDriver : public AP_HAL::UARTDriver {
+public:
+    ReplayUARTDriver(const std::vector<uint8_t> &stream, bool bulk)
+        : _stream(stream)
+        , _bulk(bulk)
+    {
+    }
+
+    void rewind() { _pos = 0; }
+
+    void begin(uint32_t baud) override { }
+    void begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override { }
+    void end() override { }
+    void flush() override { }
+    bool is_initialized() override { return true; }
+    void set_blocking_writes(bool blocking) override { }
+    bool tx_pending() override { return false; }
+
+    uint32_t available() override { return _stream.size() - _pos; }
+    uint32_t txspace() override { return 1024; }
+
+    int16_t read() override
+    {
+        if (_pos >= _stream.size()) {
+            return -1;
+        }
+        return _stream[_pos++];
+    }
+
+    uint32_t read(uint8_t *buffer, uint32_t count) override
+    {
+        if (!_bulk) {
+            return AP_HAL::UARTDriver::read(buffer, count);
+        }
+        if (count > available()) {
+            count = available();
+        }
+        memcpy(buffer, &_stream[_pos], count);
+        _pos += count;
+        return count;
+    }
+
+    size_t write(uint8_t c) override { return 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { return size; }
+
+private:
+    const std::vector<uint8_t> &_stream;
+    size_t _pos = 0;
+    bool _bulk;
+};
+
+static void ubx_append(std::vector<uint8_t> &stream, uint8_t msg_class,
+                       uint8_t msg_id, uint16_t length)
+{
+    uint8_t ck_a = 0, ck_b = 0;
+    uint8_t header[] = { msg_class, msg_id, (uint8_t)(length & 0xFF),
+                         (uint8_t)(length >> 8) };
+
+    stream.push_back(0xb5);
+    stream.push_back(0x62);
+    for (uint8_t b : header) {
+        stream.push_back(b);
+        ck_b += (ck_a += b);
+    }
+    for (uint16_t i = 0; i < length; i++) {
+        uint8_t b = i * 7;
+        stream.push_back(b);
+        ck_b += (ck_a += b);
+    }
+    stream.push_back(ck_a);
+    stream.push_back(ck_b);
+}
+
+/* 10Hz NAV-PVT and NAV-DOP plus RXM-RAWX with 32 measurements */
+static const std::vector<uint8_t> &ubx_stream()
+{
+    static std::vector<uint8_t> stream;
+
+    if (stream.empty()) {
+        for (uint8_t i = 0; i < 10; i++) {
+            ubx_append(stream, 0x01, 0x07, 92);
+            ubx_append(stream, 0x01, 0x04, 18);
+            ubx_append(stream, 0x02, 0x15, 16 + 32 * 32);
+        }
+    }
+
+    return stream;
+}
+
+static void nmea_append(std::vector<uint8_t> &stream, const char *sentence)
+{
+    uint8_t parity = 0;
+    char checksum[6];
+
+    stream.push_back('$');
+    for (const char *c = sentence; *c; c++) {
+        stream.push_back(*c);
+        parity ^= *c;
+    }
+    snprintf(checksum, sizeof(checksum), "*%02X\r\n", parity);
+    stream.insert(stream.end(), checksum, checksum + strlen(checksum));
+}
+
+/* 10Hz GGA, RMC and VTG */
+static const std::vector<uint8_t> &nmea_stream()
+{
+    static std::vector<uint8_t> stream;
+
+    if (stream.empty()) {
+        for (uint8_t i = 0; i < 10; i++) {
+            nmea_append(stream, "GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,");
+            nmea_append(stream, "GPRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W");
+            nmea_append(stream, "GPVTG,054.7,T,034.4,M,005.5,N,010.2,K");
+        }
+    }
+
+    return stream;
+}
+
+static void BM_GPS_UBLOX_Read(benchmark::State& state)
+{
+    AP_GPS gps;
+    AP_GPS::GPS_State gps_state {};
+    ReplayUARTDriver port(ubx_stream(), state.range_x());
+    AP_GPS_UBLOX ublox(gps, gps_state, &port);
+
+    while (state.KeepRunning()) {
+        port.rewind();
+        bool parsed = ublox.read();
+        gbenchmark_escape(&parsed);
+    }
+
+    state.SetBytesProcessed(state.iterations() * ubx_stream().size());
+}
+
+BENCHMARK(BM_GPS_UBLOX_Read)->Arg(0)->Arg(1);
+
+static void BM_GPS_NMEA_Read(benchmark::State& state)
+{
+    AP_GPS gps;
+    AP_GPS::GPS_State gps_state {};
+    ReplayUARTDriver port(nmea_stream(), state.range_x());
+    AP_GPS_NMEA nmea(gps, gps_state, &port);
+
+    while (state.KeepRunning()) {
+        port.rewind();
+        bool parsed = nmea.read();
+        gbenchmark_escape(&parsed);
+    }
+
+    state.SetBytesProcessed(state.iterations() * nmea_stream().size());
+}
+
+BENCHMARK(BM_GPS_NMEA_Read)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN()
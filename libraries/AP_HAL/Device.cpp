@@ -108,3 +108,18 @@ bool AP_HAL::Device::check_next_register(void)
     _checked.next = (_checked.next+1) % _checked.n_set;
     return true;
 }
+
+/*
+  default batch implementation for buses that can't queue transfers:
+  one bus transaction per transfer
+ */
+bool AP_HAL::Device::transfer_batch(const Transfer *transfers, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        const Transfer &t = transfers[i];
+        if (!transfer(t.send, t.send_len, t.recv, t.recv_len)) {
+            return false;
+        }
+    }
+    return true;
+}
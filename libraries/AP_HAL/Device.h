@@ -96,6 +96,26 @@ public:
     virtual bool transfer(const uint8_t *send, uint32_t send_len,
                           uint8_t *recv, uint32_t recv_len) = 0;
 
+    /*
+     * One segment of a batch: send_len bytes are sent and recv_len bytes
+     * received back, as in a call to #transfer()
+     */
+    struct Transfer {
+        const uint8_t *send;
+        uint32_t send_len;
+        uint8_t *recv;
+        uint32_t recv_len;
+    };
+
+    /*
+     * Do count transfers in order, each one as its own bus transaction.
+     * Buses that support it submit them all at once instead of doing a
+     * round trip per transfer. Stops at the first transfer that fails.
+     *
+     * Return: true if all transfers were successful, false on failure.
+     */
+    virtual bool transfer_batch(const Transfer *transfers, uint8_t count);
+
     /**
      * Wrapper function over #transfer() to read recv_len registers, starting
      * by first_reg, into the array pointed by recv. The read flag passed to
@@ -32,6 +32,12 @@ public:
     /* Read an array of channels, return the valid count */
     virtual uint8_t read(uint16_t* periods, uint8_t len) = 0;
 
+    /**
+     * Return the time from AP_HAL::micros() the last frame was decoded,
+     * or 0 if the driver doesn't record it
+     */
+    virtual uint32_t last_frame_us() { return 0; }
+
     /**
      * Overrides: these are really grody and don't belong here but we need
      * them at the moment to make the port work.
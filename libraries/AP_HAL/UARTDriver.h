@@ -45,6 +45,28 @@ public:
     virtual void set_flow_control(enum flow_control flow_control_setting) {};
     virtual enum flow_control get_flow_control(void) { return FLOW_CONTROL_DISABLE; }
 
+    /*
+      read up to count bytes into buffer, returning the number of bytes
+      read. The default implementation calls read() for each byte, ports
+      with their own receive buffer should copy the bytes in one go.
+     */
+    using AP_HAL::Stream::read;
+    virtual uint32_t read(uint8_t *buffer, uint32_t count);
+
+    /*
+      zero-copy access to received data: return a pointer to the
+      contiguous bytes at the front of the receive buffer and set len to
+      their number, or nullptr if there are none or the port doesn't
+      support it. The bytes stay in the buffer until consume() is
+      called, which must be done before any other read.
+     */
+    virtual const uint8_t *peek_span(uint32_t &len) { len = 0; return nullptr; }
+
+    /*
+      discard len bytes previously returned by peek_span()
+     */
+    virtual bool consume(uint32_t len) { return false; }
+
     /* Implementations of BetterStream virtual methods. These are
      * provided by AP_HAL to ensure consistency between ports to
      * different boards
@@ -2,6 +2,7 @@
 
 #include <stdarg.h>
 #include "AP_HAL_Namespace.h"
+#include "utility/PerfHistogram.h"
 
 class AP_HAL::Util {
 public:
@@ -108,6 +109,27 @@ public:
     virtual void perf_end(perf_counter_t h) {}
     virtual void perf_count(perf_counter_t h) {}
 
+    /*
+      snapshot of a counter for reporting, summed over the threads
+      which used it. count is the number of events, and for timed
+      counters hist has the time each took
+     */
+    struct perf_info {
+        const char *name;
+        perf_counter_type type;
+        uint32_t count;
+        uint64_t total_ns;
+        PerfHistogram hist;
+    };
+    virtual uint16_t perf_num_counters(void) { return 0; }
+    virtual bool perf_get_info(uint16_t index, perf_info &info) { return false; }
+
+    // events which weren't counted because the HAL had no room for them
+    virtual uint32_t perf_dropped(void) { return 0; }
+
+    // pass one latency from the control loop's trace to the platform's tracer
+    virtual void trace_latency(const char *name, uint32_t latency_us) {}
+
     // create a new semaphore
     virtual Semaphore *new_semaphore(void) { return nullptr; }
 
@@ -0,0 +1,73 @@
+#include <string.h>
+
+#include "PerfHistogram.h"
+
+void PerfHistogram::reset(void)
+{
+    _count = 0;
+    _min_us = UINT32_MAX;
+    _max_us = 0;
+    memset(_buckets, 0, sizeof(_buckets));
+}
+
+uint8_t PerfHistogram::bucket(uint32_t us)
+{
+    if (us < (1U << HAL_PERF_FIRST_SHIFT)) {
+        return 0;
+    }
+    const uint8_t b = 31 - __builtin_clz(us) - HAL_PERF_FIRST_SHIFT + 1;
+    return b < HAL_PERF_BUCKETS ? b : HAL_PERF_BUCKETS - 1;
+}
+
+void PerfHistogram::add(uint32_t us)
+{
+    // a long run saturates rather than wrapping the counts
+    if (_count == UINT32_MAX) {
+        return;
+    }
+    _count++;
+    _buckets[bucket(us)]++;
+    if (us < _min_us) {
+        _min_us = us;
+    }
+    if (us > _max_us) {
+        _max_us = us;
+    }
+}
+
+void PerfHistogram::merge(const PerfHistogram &other)
+{
+    if (other._count == 0) {
+        return;
+    }
+    _count += other._count;
+    for (uint8_t i = 0; i < HAL_PERF_BUCKETS; i++) {
+        _buckets[i] += other._buckets[i];
+    }
+    if (other._min_us < _min_us) {
+        _min_us = other._min_us;
+    }
+    if (other._max_us > _max_us) {
+        _max_us = other._max_us;
+    }
+}
+
+uint32_t PerfHistogram::percentile(uint8_t pct) const
+{
+    if (_count == 0) {
+        return 0;
+    }
+    uint64_t target = ((uint64_t)_count * pct + 99) / 100;
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t sum = 0;
+    for (uint8_t i = 0; i < HAL_PERF_BUCKETS - 1; i++) {
+        sum += _buckets[i];
+        if (sum >= target) {
+            const uint32_t top = 1U << (i + HAL_PERF_FIRST_SHIFT);
+            return top < _max_us ? top : _max_us;
+        }
+    }
+    return _max_us;
+}
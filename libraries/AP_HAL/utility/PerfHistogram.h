@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+
+// number of buckets in a perf histogram
+#define HAL_PERF_BUCKETS        8
+
+// the first bucket ends at 64us, each bucket after covers twice the
+// range of the one before and the last has everything from 4.096ms
+#define HAL_PERF_FIRST_SHIFT    6
+
+/*
+ * Histogram of times in microseconds, shared by the HAL's perf
+ * counters and the control loop's latency trace so that both are read
+ * the same way.
+ */
+class PerfHistogram {
+public:
+    PerfHistogram() { reset(); }
+
+    void reset(void);
+    void add(uint32_t us);
+
+    // add the samples of another histogram to this one
+    void merge(const PerfHistogram &other);
+
+    // time in microseconds that pct percent of the samples were
+    // within. This is the top of the bucket the percentile falls into,
+    // so it is an upper bound
+    uint32_t percentile(uint8_t pct) const;
+
+    // index of the bucket a time falls into
+    static uint8_t bucket(uint32_t us);
+
+    uint32_t count(void) const { return _count; }
+    uint32_t min_us(void) const { return _count ? _min_us : 0; }
+    uint32_t max_us(void) const { return _max_us; }
+    uint32_t bucket_count(uint8_t i) const { return _buckets[i]; }
+
+private:
+    uint32_t _count;
+    uint32_t _min_us;
+    uint32_t _max_us;
+    uint32_t _buckets[HAL_PERF_BUCKETS];
+};
@@ -0,0 +1,249 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PerfRegistry.h"
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
+
+#include <string.h>
+#include <time.h>
+
+using perf_counter_t = AP_HAL::Util::perf_counter_t;
+
+// times to try for a consistent copy of a shard before skipping it,
+// as its thread may have been preempted in the middle of an update
+#define PERF_REGISTRY_READ_RETRIES 16
+
+// the calling thread's shard, or nullptr before it is allocated
+static thread_local void *tls_shard;
+static thread_local bool tls_no_shard;
+
+static inline uint64_t now_nsec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_nsec + (ts.tv_sec * 1000000000ULL);
+}
+
+PerfRegistry *PerfRegistry::get_instance()
+{
+    static PerfRegistry registry;
+    return &registry;
+}
+
+PerfRegistry::PerfRegistry()
+    : _num_counters{0}
+    , _num_shards{0}
+    , _dropped{0}
+{
+    for (uint16_t i = 0; i < PERF_REGISTRY_MAX_COUNTERS; i++) {
+        _counters[i].name = nullptr;
+    }
+    for (uint8_t i = 0; i < PERF_REGISTRY_MAX_THREADS; i++) {
+        _shards[i] = nullptr;
+    }
+}
+
+/*
+  take the next free index of a table holding max entries, leaving the
+  count at max once the table is full
+ */
+bool PerfRegistry::_claim(std::atomic<uint16_t> &next, uint16_t max, uint16_t &index)
+{
+    uint16_t n = next.load();
+    do {
+        if (n >= max) {
+            return false;
+        }
+    } while (!next.compare_exchange_weak(n, n + 1));
+    index = n;
+    return true;
+}
+
+perf_counter_t PerfRegistry::add(perf_counter_type type, const char *name)
+{
+    uint16_t idx;
+    if (!_claim(_num_counters, PERF_REGISTRY_MAX_COUNTERS, idx)) {
+        return nullptr;
+    }
+    _counters[idx].type = type;
+    _counters[idx].name.store(name, std::memory_order_release);
+
+    // handles start from 1 so that nullptr is never a counter
+    return (perf_counter_t)(uintptr_t)(idx + 1);
+}
+
+const char *PerfRegistry::name(perf_counter_t pc) const
+{
+    const uintptr_t idx = (uintptr_t)pc - 1;
+    if (idx >= PERF_REGISTRY_MAX_COUNTERS) {
+        return "";
+    }
+    const char *name = _counters[idx].name.load(std::memory_order_acquire);
+    return name != nullptr ? name : "";
+}
+
+PerfRegistry::Shard *PerfRegistry::_get_shard()
+{
+    if (tls_shard != nullptr) {
+        return (Shard *)tls_shard;
+    }
+    if (tls_no_shard) {
+        return nullptr;
+    }
+
+    uint16_t n;
+    if (!_claim(_num_shards, PERF_REGISTRY_MAX_THREADS, n)) {
+        tls_no_shard = true;
+        return nullptr;
+    }
+    Shard *shard = new Shard();
+    if (shard == nullptr) {
+        tls_no_shard = true;
+        return nullptr;
+    }
+    _shards[n].store(shard, std::memory_order_release);
+    tls_shard = shard;
+    return shard;
+}
+
+void PerfRegistry::_record(Shard *shard, Stats &stats, uint64_t elapsed_ns)
+{
+    const uint32_t seq = shard->seq.load(std::memory_order_relaxed);
+    shard->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const uint64_t us = elapsed_ns / 1000;
+    stats.count++;
+    stats.total_ns += elapsed_ns;
+    stats.hist.add(us > UINT32_MAX ? UINT32_MAX : us);
+
+    shard->seq.store(seq + 2, std::memory_order_release);
+}
+
+void PerfRegistry::begin(perf_counter_t pc)
+{
+    const uintptr_t idx = (uintptr_t)pc - 1;
+    if (idx >= PERF_REGISTRY_MAX_COUNTERS || _counters[idx].type != AP_HAL::Util::PC_ELAPSED) {
+        return;
+    }
+    Shard *shard = _get_shard();
+    if (shard == nullptr) {
+        return;
+    }
+    shard->stats[idx].start_ns = now_nsec();
+}
+
+void PerfRegistry::end(perf_counter_t pc)
+{
+    const uintptr_t idx = (uintptr_t)pc - 1;
+    if (idx >= PERF_REGISTRY_MAX_COUNTERS || _counters[idx].type != AP_HAL::Util::PC_ELAPSED) {
+        return;
+    }
+    Shard *shard = _get_shard();
+    if (shard == nullptr) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Stats &stats = shard->stats[idx];
+    if (stats.start_ns == 0) {
+        // end() without begin() on this thread
+        return;
+    }
+    _record(shard, stats, now_nsec() - stats.start_ns);
+    stats.start_ns = 0;
+}
+
+void PerfRegistry::count(perf_counter_t pc)
+{
+    const uintptr_t idx = (uintptr_t)pc - 1;
+    if (idx >= PERF_REGISTRY_MAX_COUNTERS || _counters[idx].type == AP_HAL::Util::PC_ELAPSED) {
+        return;
+    }
+    Shard *shard = _get_shard();
+    if (shard == nullptr) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Stats &stats = shard->stats[idx];
+
+    if (_counters[idx].type == AP_HAL::Util::PC_COUNT) {
+        const uint32_t seq = shard->seq.load(std::memory_order_relaxed);
+        shard->seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        stats.count++;
+        shard->seq.store(seq + 2, std::memory_order_release);
+        return;
+    }
+
+    // PC_INTERVAL: the first call on each thread only starts timing
+    const uint64_t now = now_nsec();
+    if (stats.start_ns != 0) {
+        _record(shard, stats, now - stats.start_ns);
+    }
+    stats.start_ns = now;
+}
+
+uint16_t PerfRegistry::num_counters() const
+{
+    return _num_counters.load();
+}
+
+bool PerfRegistry::_read_stats(const Shard *shard, uint16_t index, Stats &stats) const
+{
+    for (uint8_t i = 0; i < PERF_REGISTRY_READ_RETRIES; i++) {
+        const uint32_t seq = shard->seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            continue;
+        }
+        memcpy(&stats, &shard->stats[index], sizeof(stats));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (shard->seq.load(std::memory_order_relaxed) == seq) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PerfRegistry::get_info(uint16_t index, perf_info &info) const
+{
+    if (index >= num_counters()) {
+        return false;
+    }
+    const char *name = _counters[index].name.load(std::memory_order_acquire);
+    if (name == nullptr) {
+        // still being added
+        return false;
+    }
+
+    info = perf_info();
+    info.name = name;
+    info.type = _counters[index].type;
+
+    const uint16_t num_shards = _num_shards.load();
+    for (uint16_t i = 0; i < num_shards; i++) {
+        const Shard *shard = _shards[i].load(std::memory_order_acquire);
+        Stats stats;
+        if (shard == nullptr || !_read_stats(shard, index, stats) || stats.count == 0) {
+            continue;
+        }
+        info.count += stats.count;
+        info.total_ns += stats.total_ns;
+        info.hist.merge(stats.hist);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,100 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  perf counters for HALs with POSIX threads, cheap enough to leave on
+
+  Counters live in a fixed table, so a handle is an index which never
+  moves. Each thread keeps its own statistics for every counter in a
+  shard allocated the first time it uses one, so begin(), end() and
+  count() take no locks and share no cache lines with other
+  threads. The owning thread brackets each update with a sequence
+  number, which lets get_info() take a consistent copy of each shard
+  and sum them without stopping the writers.
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
+
+#include <atomic>
+
+#define PERF_REGISTRY_MAX_COUNTERS  128
+
+// threads beyond this many don't record anything, their events are
+// counted by dropped()
+#define PERF_REGISTRY_MAX_THREADS   16
+
+class PerfRegistry {
+    using perf_counter_type = AP_HAL::Util::perf_counter_type;
+    using perf_counter_t = AP_HAL::Util::perf_counter_t;
+    using perf_info = AP_HAL::Util::perf_info;
+
+public:
+    static PerfRegistry *get_instance();
+
+    // returns nullptr if the table is full
+    perf_counter_t add(perf_counter_type type, const char *name);
+
+    void begin(perf_counter_t pc);
+    void end(perf_counter_t pc);
+    void count(perf_counter_t pc);
+
+    // empty for a handle add() didn't return
+    const char *name(perf_counter_t pc) const;
+
+    uint16_t num_counters() const;
+    bool get_info(uint16_t index, perf_info &info) const;
+
+    // events from threads which had no shard
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    PerfRegistry();
+
+    struct Counter {
+        std::atomic<const char *> name;
+        perf_counter_type type;
+    };
+
+    struct Stats {
+        // begin() of PC_ELAPSED or the last count() of PC_INTERVAL
+        uint64_t start_ns;
+        uint32_t count;
+        uint64_t total_ns;
+        PerfHistogram hist;
+    };
+
+    struct Shard {
+        // odd while the owning thread is updating stats
+        std::atomic<uint32_t> seq;
+        Stats stats[PERF_REGISTRY_MAX_COUNTERS];
+    };
+
+    Shard *_get_shard();
+    static bool _claim(std::atomic<uint16_t> &next, uint16_t max, uint16_t &index);
+    void _record(Shard *shard, Stats &stats, uint64_t elapsed_ns);
+    bool _read_stats(const Shard *shard, uint16_t index, Stats &stats) const;
+
+    Counter _counters[PERF_REGISTRY_MAX_COUNTERS];
+    std::atomic<uint16_t> _num_counters;
+
+    std::atomic<Shard *> _shards[PERF_REGISTRY_MAX_THREADS];
+    std::atomic<uint16_t> _num_shards;
+
+    std::atomic<uint32_t> _dropped;
+};
+
+#endif
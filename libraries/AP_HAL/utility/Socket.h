@@ -54,6 +54,9 @@ public:
     // return true if there is room for output data
     bool pollout(uint32_t timeout_ms);
 
+    // return the underlying file descriptor
+    int get_fd() const { return fd; }
+
     // start listening for new tcp connections
     bool listen(uint16_t backlog);
 
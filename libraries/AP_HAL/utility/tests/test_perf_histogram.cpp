@@ -0,0 +1,74 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/PerfHistogram.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+TEST(PerfHistogramTest, Buckets)
+{
+    EXPECT_EQ(0, PerfHistogram::bucket(0));
+    EXPECT_EQ(0, PerfHistogram::bucket(63));
+    EXPECT_EQ(1, PerfHistogram::bucket(64));
+    EXPECT_EQ(1, PerfHistogram::bucket(127));
+    EXPECT_EQ(2, PerfHistogram::bucket(128));
+    EXPECT_EQ(6, PerfHistogram::bucket(4095));
+    EXPECT_EQ(7, PerfHistogram::bucket(4096));
+    EXPECT_EQ(7, PerfHistogram::bucket(UINT32_MAX));
+}
+
+TEST(PerfHistogramTest, Percentiles)
+{
+    PerfHistogram hist;
+    EXPECT_EQ(0U, hist.percentile(50));
+    EXPECT_EQ(0U, hist.min_us());
+
+    for (uint8_t i = 0; i < 99; i++) {
+        hist.add(200);
+    }
+    hist.add(3000);
+
+    EXPECT_EQ(100U, hist.count());
+    EXPECT_EQ(200U, hist.min_us());
+    EXPECT_EQ(3000U, hist.max_us());
+    EXPECT_EQ(99U, hist.bucket_count(2));
+    EXPECT_EQ(1U, hist.bucket_count(6));
+
+    // the top of the bucket, limited to the largest sample
+    EXPECT_EQ(256U, hist.percentile(50));
+    EXPECT_EQ(256U, hist.percentile(99));
+    EXPECT_EQ(3000U, hist.percentile(100));
+}
+
+TEST(PerfHistogramTest, Merge)
+{
+    PerfHistogram a, b;
+    a.add(100);
+    b.add(10);
+    b.add(5000);
+    a.merge(b);
+    a.merge(PerfHistogram());
+
+    EXPECT_EQ(3U, a.count());
+    EXPECT_EQ(10U, a.min_us());
+    EXPECT_EQ(5000U, a.max_us());
+    EXPECT_EQ(1U, a.bucket_count(0));
+    EXPECT_EQ(1U, a.bucket_count(1));
+    EXPECT_EQ(1U, a.bucket_count(7));
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,135 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <thread>
+#include <vector>
+#include <AP_HAL/utility/PerfRegistry.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+using perf_counter_t = AP_HAL::Util::perf_counter_t;
+using perf_info = AP_HAL::Util::perf_info;
+
+// index of a counter in the registry from its handle
+static uint16_t index_of(perf_counter_t pc)
+{
+    return (uint16_t)((uintptr_t)pc - 1);
+}
+
+TEST(PerfRegistryTest, Handles)
+{
+    PerfRegistry *registry = PerfRegistry::get_instance();
+    perf_counter_t pc = registry->add(AP_HAL::Util::PC_COUNT, "handle");
+
+    EXPECT_NE(nullptr, pc);
+    EXPECT_STREQ("handle", registry->name(pc));
+    EXPECT_STREQ("", registry->name(nullptr));
+
+    // calls on an invalid handle are ignored
+    registry->count(nullptr);
+    registry->begin(nullptr);
+    registry->end(nullptr);
+}
+
+TEST(PerfRegistryTest, Elapsed)
+{
+    PerfRegistry *registry = PerfRegistry::get_instance();
+    perf_counter_t pc = registry->add(AP_HAL::Util::PC_ELAPSED, "elapsed");
+
+    // end() without begin() isn't counted
+    registry->end(pc);
+    for (uint8_t i = 0; i < 3; i++) {
+        registry->begin(pc);
+        registry->end(pc);
+    }
+
+    perf_info info;
+    ASSERT_TRUE(registry->get_info(index_of(pc), info));
+    EXPECT_STREQ("elapsed", info.name);
+    EXPECT_EQ(AP_HAL::Util::PC_ELAPSED, info.type);
+    EXPECT_EQ(3U, info.count);
+    EXPECT_EQ(3U, info.hist.count());
+    EXPECT_LE(info.hist.min_us(), info.hist.max_us());
+    uint32_t total = 0;
+    for (uint8_t b = 0; b < HAL_PERF_BUCKETS; b++) {
+        total += info.hist.bucket_count(b);
+    }
+    EXPECT_EQ(3U, total);
+}
+
+TEST(PerfRegistryTest, Threads)
+{
+    PerfRegistry *registry = PerfRegistry::get_instance();
+    perf_counter_t pc = registry->add(AP_HAL::Util::PC_COUNT, "threads");
+
+    std::vector<std::thread> threads;
+    for (uint8_t t = 0; t < 4; t++) {
+        threads.emplace_back([registry, pc] {
+            for (uint16_t i = 0; i < 1000; i++) {
+                registry->count(pc);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    perf_info info;
+    ASSERT_TRUE(registry->get_info(index_of(pc), info));
+    EXPECT_EQ(4000U, info.count);
+}
+
+TEST(PerfRegistryTest, ThreadsPastTheLimitDropped)
+{
+    PerfRegistry *registry = PerfRegistry::get_instance();
+    perf_counter_t pc = registry->add(AP_HAL::Util::PC_COUNT, "dropped");
+    const uint32_t dropped = registry->dropped();
+
+    // more threads than there are shards left
+    for (uint8_t t = 0; t < PERF_REGISTRY_MAX_THREADS; t++) {
+        std::thread([registry, pc] {
+            for (uint16_t i = 0; i < 10; i++) {
+                registry->count(pc);
+            }
+        }).join();
+    }
+
+    perf_info info;
+    ASSERT_TRUE(registry->get_info(index_of(pc), info));
+    EXPECT_GT(registry->dropped(), dropped);
+    EXPECT_EQ(10U * PERF_REGISTRY_MAX_THREADS, info.count + registry->dropped() - dropped);
+}
+
+// fills the table, so runs last
+TEST(PerfRegistryTest, TableFull)
+{
+    PerfRegistry *registry = PerfRegistry::get_instance();
+    while (registry->num_counters() < PERF_REGISTRY_MAX_COUNTERS) {
+        EXPECT_NE(nullptr, registry->add(AP_HAL::Util::PC_COUNT, "fill"));
+    }
+
+    for (uint16_t i = 0; i < 1000; i++) {
+        EXPECT_EQ(nullptr, registry->add(AP_HAL::Util::PC_COUNT, "full"));
+    }
+    EXPECT_EQ(PERF_REGISTRY_MAX_COUNTERS, registry->num_counters());
+
+    perf_info info;
+    EXPECT_TRUE(registry->get_info(PERF_REGISTRY_MAX_COUNTERS - 1, info));
+    EXPECT_STREQ("fill", info.name);
+    EXPECT_FALSE(registry->get_info(PERF_REGISTRY_MAX_COUNTERS, info));
+}
+
+AP_GTEST_MAIN()
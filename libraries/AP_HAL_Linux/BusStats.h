@@ -0,0 +1,36 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <inttypes.h>
+
+namespace Linux {
+
+/*
+ * Counters kept for each SPI and I2C bus. They are updated with the bus
+ * semaphore held, so a reader on another thread may see them mid update.
+ */
+struct BusStats {
+    /* ioctl() calls made on the bus, including retries and mode changes */
+    uint32_t syscalls;
+    /* messages handed to the kernel, one per send or receive segment */
+    uint32_t messages;
+    /* bytes sent plus bytes received */
+    uint64_t bytes;
+    /* ioctl() calls that failed */
+    uint32_t errors;
+};
+
+}
@@ -0,0 +1,633 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AP_HAL/AP_HAL.h>
+
+#include <AP_BoardConfig/AP_BoardConfig.h>
+
+#if HAL_WITH_UAVCAN
+
+#include <errno.h>
+#include <net/if.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/can/error.h>
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_UAVCAN/AP_UAVCAN.h>
+
+#include "CAN.h"
+
+extern const AP_HAL::HAL& hal;
+
+using namespace Linux;
+
+// control message room for SCM_TIMESTAMPING and SO_RXQ_OVFL
+#define RX_CONTROL_SIZE (CMSG_SPACE(sizeof(struct timespec) * 3) + CMSG_SPACE(sizeof(uint32_t)))
+
+static uint64_t timespec_to_usec(const struct timespec &ts)
+{
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static uavcan::CanFrame frame_from_socketcan(const struct can_frame &cf)
+{
+    uint32_t id;
+    if (cf.can_id & CAN_EFF_FLAG) {
+        id = (cf.can_id & CAN_EFF_MASK) | uavcan::CanFrame::FlagEFF;
+    } else {
+        id = cf.can_id & CAN_SFF_MASK;
+    }
+    if (cf.can_id & CAN_RTR_FLAG) {
+        id |= uavcan::CanFrame::FlagRTR;
+    }
+    return uavcan::CanFrame(id, cf.data, MIN(cf.can_dlc, (uint8_t)CAN_MAX_DLEN));
+}
+
+static void frame_to_socketcan(const uavcan::CanFrame &frame, struct can_frame &cf)
+{
+    memset(&cf, 0, sizeof(cf));
+    if (frame.isExtended()) {
+        cf.can_id = (frame.id & uavcan::CanFrame::MaskExtID) | CAN_EFF_FLAG;
+    } else {
+        cf.can_id = frame.id & uavcan::CanFrame::MaskStdID;
+    }
+    if (frame.isRemoteTransmissionRequest()) {
+        cf.can_id |= CAN_RTR_FLAG;
+    }
+    cf.can_dlc = frame.dlc;
+    memcpy(cf.data, frame.data, frame.dlc);
+}
+
+CAN::CAN(CANManager &manager, uint8_t self_index)
+    : _manager(manager)
+    , _self_index(self_index)
+    , _rx_pending(false)
+    , _tx_count(0)
+    , _tx_blocked(false)
+    , _rx_overflows(0)
+    , _error_count(0)
+{
+}
+
+CAN::~CAN()
+{
+    end();
+}
+
+bool CAN::begin(uint32_t bitrate)
+{
+    if (_fd >= 0) {
+        return true;
+    }
+
+    char name[IFNAMSIZ];
+    snprintf(name, sizeof(name), HAL_LINUX_CAN_IFACE_PREFIX "%u", (unsigned)_self_index);
+
+    int fd = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+    if (fd < 0) {
+        if (AP_BoardConfig::get_can_debug() >= 1) {
+            printf("CAN: failed to open socket for %s: %m\n", name);
+        }
+        return false;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+    if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+        if (AP_BoardConfig::get_can_debug() >= 1) {
+            printf("CAN: no interface %s: %m\n", name);
+        }
+        close(fd);
+        return false;
+    }
+    const int ifindex = ifr.ifr_ifindex;
+
+    // report bus errors as error frames, so aborts can be handled
+    const can_err_mask_t err_mask = CAN_ERR_TX_TIMEOUT | CAN_ERR_CRTL | CAN_ERR_BUSOFF | CAN_ERR_BUSERROR;
+    setsockopt(fd, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &err_mask, sizeof(err_mask));
+
+    // count the frames the kernel drops when we don't keep up
+    const int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on));
+
+    /*
+      date received frames with the kernel's software timestamps, which
+      are on CLOCK_REALTIME and so are UTC. A controller's own
+      timestamps are on its free running clock, which can't be related
+      to UTC without the controller exposing it, so they aren't used
+     */
+    const int ts_flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &ts_flags, sizeof(ts_flags));
+
+    struct sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifindex;
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        if (AP_BoardConfig::get_can_debug() >= 1) {
+            printf("CAN: failed to bind %s: %m\n", name);
+        }
+        close(fd);
+        return false;
+    }
+
+    return begin_with_socket(fd);
+}
+
+bool CAN::begin_with_socket(int fd)
+{
+    if (_fd >= 0) {
+        close(fd);
+        return false;
+    }
+
+    _fd = fd;
+    reset();
+
+    _pollable.set_fd(fd);
+    if (!_manager._poller.register_pollable(&_pollable, EPOLLIN | EPOLLOUT | EPOLLET)) {
+        end();
+        return false;
+    }
+
+    // pick up anything received before registering
+    _rx_pending = true;
+
+    return true;
+}
+
+void CAN::end()
+{
+    if (_fd < 0) {
+        return;
+    }
+    _manager._poller.unregister_pollable(&_pollable);
+    _pollable.set_fd(-1);
+    close(_fd);
+    _fd = -1;
+}
+
+void CAN::reset()
+{
+    _rx_queue.clear();
+    _rx_pending = false;
+    _tx_count = 0;
+    _tx_blocked = false;
+    _error_count = 0;
+}
+
+bool CAN::is_initialized()
+{
+    return _fd >= 0;
+}
+
+int32_t CAN::tx_pending()
+{
+    if (_fd < 0) {
+        return -1;
+    }
+    return _tx_count;
+}
+
+int32_t CAN::available()
+{
+    if (_fd < 0) {
+        return -1;
+    }
+    return _rx_queue.available();
+}
+
+/*
+  queue a frame in priority order behind any of equal priority. It
+  goes to the kernel on the next flush_tx(), so the frames uavcan
+  sends in one spin are written with one sendmmsg()
+ */
+int16_t CAN::send(const uavcan::CanFrame &frame, uavcan::MonotonicTime tx_deadline,
+                  uavcan::CanIOFlags flags)
+{
+    if (_fd < 0 || frame.isErrorFrame() || frame.dlc > CAN_MAX_DLEN) {
+        return -1;
+    }
+    if (_tx_count >= LINUX_CAN_TX_QUEUE_SIZE) {
+        return 0;
+    }
+
+    uint16_t pos = _tx_count;
+    while (pos > 0 && frame.priorityHigherThan(_tx_queue[pos-1].frame)) {
+        _tx_queue[pos] = _tx_queue[pos-1];
+        pos--;
+    }
+    _tx_queue[pos].frame = frame;
+    _tx_queue[pos].deadline_us = tx_deadline.toUSec();
+    _tx_queue[pos].flags = flags;
+    _tx_count++;
+
+    return 1;
+}
+
+int16_t CAN::receive(uavcan::CanFrame &out_frame, uavcan::MonotonicTime &out_ts_monotonic,
+                     uavcan::UtcTime &out_ts_utc, uavcan::CanIOFlags &out_flags)
+{
+    RxItem item;
+    if (_fd < 0 || !_rx_queue.pop(item)) {
+        return 0;
+    }
+    out_frame = item.frame;
+    out_ts_monotonic = uavcan::MonotonicTime::fromUSec(item.monotonic_us);
+    out_ts_utc = uavcan::UtcTime::fromUSec(item.utc_us);
+    out_flags = item.flags;
+    return 1;
+}
+
+int16_t CAN::configureFilters(const uavcan::CanFilterConfig *filter_configs,
+                              uint16_t num_configs)
+{
+    if (_fd < 0 || num_configs > CAN_MAX_FILTERS) {
+        return -1;
+    }
+
+    struct can_filter filters[CAN_MAX_FILTERS];
+    for (uint16_t i = 0; i < num_configs; i++) {
+        const uavcan::CanFilterConfig &fc = filter_configs[i];
+        filters[i].can_id = fc.id & uavcan::CanFrame::MaskExtID;
+        filters[i].can_mask = fc.mask & uavcan::CanFrame::MaskExtID;
+        if (fc.id & uavcan::CanFrame::FlagEFF) {
+            filters[i].can_id |= CAN_EFF_FLAG;
+        }
+        if (fc.id & uavcan::CanFrame::FlagRTR) {
+            filters[i].can_id |= CAN_RTR_FLAG;
+        }
+        if (fc.mask & uavcan::CanFrame::FlagEFF) {
+            filters[i].can_mask |= CAN_EFF_FLAG;
+        }
+        if (fc.mask & uavcan::CanFrame::FlagRTR) {
+            filters[i].can_mask |= CAN_RTR_FLAG;
+        }
+    }
+
+    // no filters means accept everything
+    if (num_configs == 0) {
+        filters[0].can_id = 0;
+        filters[0].can_mask = 0;
+        num_configs = 1;
+    }
+
+    if (setsockopt(_fd, SOL_CAN_RAW, CAN_RAW_FILTER, filters,
+                   num_configs * sizeof(filters[0])) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+void CAN::_push_rx(const uavcan::CanFrame &frame, uint64_t monotonic_us,
+                   uint64_t utc_us, uavcan::CanIOFlags flags)
+{
+    RxItem item;
+    item.frame = frame;
+    item.monotonic_us = monotonic_us;
+    item.utc_us = utc_us;
+    item.flags = flags;
+    if (!_rx_queue.push(item)) {
+        _error_count++;
+    }
+}
+
+void CAN::drain_rx()
+{
+    _rx_pending = false;
+    if (_fd < 0) {
+        return;
+    }
+
+    struct can_frame frames[LINUX_CAN_BATCH_SIZE];
+    struct iovec iov[LINUX_CAN_BATCH_SIZE];
+    struct mmsghdr msgs[LINUX_CAN_BATCH_SIZE];
+    union {
+        struct cmsghdr align;
+        uint8_t buf[RX_CONTROL_SIZE];
+    } control[LINUX_CAN_BATCH_SIZE];
+
+    for (;;) {
+        const uint32_t space = _rx_queue.space();
+        if (space == 0) {
+            // leave the rest in the socket until receive() makes room
+            _rx_pending = true;
+            return;
+        }
+        const unsigned batch = MIN(space, (uint32_t)LINUX_CAN_BATCH_SIZE);
+
+        memset(msgs, 0, sizeof(msgs[0]) * batch);
+        for (unsigned i = 0; i < batch; i++) {
+            iov[i].iov_base = &frames[i];
+            iov[i].iov_len = sizeof(frames[i]);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_control = control[i].buf;
+            msgs[i].msg_hdr.msg_controllen = sizeof(control[i].buf);
+        }
+
+        const int n = recvmmsg(_fd, msgs, batch, MSG_DONTWAIT, nullptr);
+        if (n <= 0) {
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                _error_count++;
+            }
+            return;
+        }
+
+        /*
+          the kernel's software timestamps are on the realtime clock, so
+          read both clocks once for the batch and date each frame by how
+          long ago it arrived
+         */
+        const uint64_t now_monotonic = AP_HAL::micros64();
+        struct timespec ts_now;
+        clock_gettime(CLOCK_REALTIME, &ts_now);
+        const uint64_t now_realtime = timespec_to_usec(ts_now);
+
+        for (int i = 0; i < n; i++) {
+            if (msgs[i].msg_len < sizeof(struct can_frame)) {
+                continue;
+            }
+            uint64_t sw_us = 0;
+            for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr);
+                 cmsg != nullptr;
+                 cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+                if (cmsg->cmsg_level != SOL_SOCKET) {
+                    continue;
+                }
+                if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+                    // the software stamp is first, followed by two unused ones
+                    struct timespec stamp;
+                    memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+                    sw_us = timespec_to_usec(stamp);
+                } else if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+                    uint32_t overflows;
+                    memcpy(&overflows, CMSG_DATA(cmsg), sizeof(overflows));
+                    _error_count += overflows - _rx_overflows;
+                    _rx_overflows = overflows;
+                }
+            }
+
+            const struct can_frame &cf = frames[i];
+            if (cf.can_id & CAN_ERR_FLAG) {
+                _error_count++;
+                _abort_on_error();
+                continue;
+            }
+
+            if (sw_us == 0 || sw_us > now_realtime) {
+                sw_us = now_realtime;
+            }
+            const uint64_t age_us = MIN(now_realtime - sw_us, now_monotonic);
+
+            _push_rx(frame_from_socketcan(cf), now_monotonic - age_us, sw_us, 0);
+        }
+
+        if (n < (int)batch) {
+            return;
+        }
+    }
+}
+
+void CAN::_remove_tx(uint16_t start, uint16_t count)
+{
+    memmove(&_tx_queue[start], &_tx_queue[start + count],
+            (_tx_count - start - count) * sizeof(_tx_queue[0]));
+    _tx_count -= count;
+}
+
+// drop queued frames which asked not to be retried after a bus error
+void CAN::_abort_on_error()
+{
+    uint16_t kept = 0;
+    for (uint16_t i = 0; i < _tx_count; i++) {
+        if (!(_tx_queue[i].flags & uavcan::CanIOFlagAbortOnError)) {
+            _tx_queue[kept++] = _tx_queue[i];
+        }
+    }
+    _tx_count = kept;
+}
+
+void CAN::flush_tx(uint64_t now_us)
+{
+    if (_fd < 0 || _tx_count == 0) {
+        return;
+    }
+
+    uint16_t kept = 0;
+    for (uint16_t i = 0; i < _tx_count; i++) {
+        if (_tx_queue[i].deadline_us >= now_us) {
+            _tx_queue[kept++] = _tx_queue[i];
+        } else {
+            _error_count++;
+        }
+    }
+    _tx_count = kept;
+
+    if (_tx_blocked) {
+        return;
+    }
+
+    struct can_frame frames[LINUX_CAN_BATCH_SIZE];
+    struct iovec iov[LINUX_CAN_BATCH_SIZE];
+    struct mmsghdr msgs[LINUX_CAN_BATCH_SIZE];
+
+    while (_tx_count > 0) {
+        const unsigned batch = MIN(_tx_count, (uint16_t)LINUX_CAN_BATCH_SIZE);
+
+        memset(msgs, 0, sizeof(msgs[0]) * batch);
+        for (unsigned i = 0; i < batch; i++) {
+            frame_to_socketcan(_tx_queue[i].frame, frames[i]);
+            iov[i].iov_base = &frames[i];
+            iov[i].iov_len = sizeof(frames[i]);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        const int n = sendmmsg(_fd, msgs, batch, MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // EPOLLOUT says when there is room again
+                _tx_blocked = true;
+            } else if (errno != ENOBUFS) {
+                // the device queue being full (ENOBUFS) is retried on
+                // the next select(), anything else loses the frame
+                _error_count++;
+                _remove_tx(0, 1);
+                continue;
+            }
+            return;
+        }
+
+        /*
+          SocketCAN only echoes frames back to other sockets, so answer
+          loopback requests here with the time they went to the kernel
+         */
+        const uint64_t sent_us = AP_HAL::micros64();
+        for (int i = 0; i < n; i++) {
+            if (_tx_queue[i].flags & uavcan::CanIOFlagLoopback) {
+                _push_rx(_tx_queue[i].frame, sent_us, sent_us, uavcan::CanIOFlagLoopback);
+            }
+        }
+        _remove_tx(0, n);
+
+        if (n < (int)batch) {
+            return;
+        }
+    }
+}
+
+CANManager::CANManager()
+    : _num_ifaces(0)
+    , _initialized(false)
+    , _uavcan(nullptr)
+{
+}
+
+bool CANManager::begin(uint32_t bitrate, uint8_t can_number)
+{
+    if (!_poller) {
+        return false;
+    }
+
+    _num_ifaces = MIN(can_number, (uint8_t)LINUX_CAN_MAX_IFACES);
+    for (uint8_t i = 0; i < _num_ifaces; i++) {
+        if (!_ifaces[i]->begin(bitrate)) {
+            return false;
+        }
+    }
+    _initialized = true;
+
+    if (_uavcan == nullptr) {
+        return true;
+    }
+    for (uint16_t tries = 0; tries < 100; tries++) {
+        if (_uavcan->try_init()) {
+            return true;
+        }
+        hal.scheduler->delay(1);
+    }
+    return false;
+}
+
+bool CANManager::begin_with_sockets(const int *fds, uint8_t num_fds)
+{
+    if (!_poller) {
+        return false;
+    }
+
+    _num_ifaces = MIN(num_fds, (uint8_t)LINUX_CAN_MAX_IFACES);
+    for (uint8_t i = 0; i < _num_ifaces; i++) {
+        if (!_ifaces[i]->begin_with_socket(fds[i])) {
+            return false;
+        }
+    }
+    _initialized = true;
+    return true;
+}
+
+bool CANManager::is_initialized()
+{
+    return _initialized;
+}
+
+CAN *CANManager::getIface(uint8_t iface_index)
+{
+    if (iface_index >= _num_ifaces) {
+        return nullptr;
+    }
+    return _ifaces[iface_index];
+}
+
+uavcan::CanSelectMasks CANManager::_make_select_masks(const uavcan::CanFrame* (&pending_tx)[uavcan::MaxCanIfaces]) const
+{
+    uavcan::CanSelectMasks msk;
+
+    for (uint8_t i = 0; i < _num_ifaces; i++) {
+        if (_ifaces[i]->has_rx()) {
+            msk.read |= 1U << i;
+        }
+        if (pending_tx[i] != nullptr && _ifaces[i]->can_accept_tx()) {
+            msk.write |= 1U << i;
+        }
+    }
+
+    return msk;
+}
+
+/*
+  flush what uavcan queued since the last call, then sleep on the
+  sockets until one of the requested events or the deadline. Receiving
+  happens in the Poller's callbacks, a batch at a time
+ */
+int16_t CANManager::select(uavcan::CanSelectMasks &inout_masks,
+                           const uavcan::CanFrame* (&pending_tx)[uavcan::MaxCanIfaces],
+                           uavcan::MonotonicTime blocking_deadline)
+{
+    const uavcan::CanSelectMasks in_masks = inout_masks;
+    uint64_t now = AP_HAL::micros64();
+
+    bool retry_tx = false;
+    for (uint8_t i = 0; i < _num_ifaces; i++) {
+        _ifaces[i]->flush_tx(now);
+        if (_ifaces[i]->rx_pending()) {
+            _ifaces[i]->drain_rx();
+        }
+        retry_tx |= _ifaces[i]->needs_tx_retry();
+    }
+
+    inout_masks = _make_select_masks(pending_tx);
+    if ((inout_masks.read & in_masks.read) != 0 || (inout_masks.write & in_masks.write) != 0) {
+        return 1;
+    }
+
+    const uint64_t deadline = blocking_deadline.toUSec();
+    int timeout_ms = deadline > now ? (deadline - now + 999) / 1000 : 0;
+    if (retry_tx) {
+        timeout_ms = MIN(timeout_ms, 1);
+    }
+    _poller.poll(timeout_ms);
+
+    // the sockets may have room again
+    now = AP_HAL::micros64();
+    for (uint8_t i = 0; i < _num_ifaces; i++) {
+        _ifaces[i]->flush_tx(now);
+    }
+
+    // return what we got even if none of the requested events are set
+    inout_masks = _make_select_masks(pending_tx);
+    return 1;
+}
+
+AP_UAVCAN *CANManager::get_UAVCAN(void)
+{
+    return _uavcan;
+}
+
+void CANManager::set_UAVCAN(AP_UAVCAN *uavcan)
+{
+    _uavcan = uavcan;
+}
+
+#endif
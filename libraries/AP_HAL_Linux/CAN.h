@@ -0,0 +1,211 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ * SocketCAN driver for UAVCAN. Each interface is a raw CAN socket,
+ * frames are moved to and from the kernel in batches with recvmmsg()
+ * and sendmmsg(), and the manager's select() sleeps on a Poller
+ * watching all of the sockets.
+ *
+ * Received frames are dated on the monotonic clock uavcan uses and
+ * given the kernel's receive time on CLOCK_REALTIME as their UTC time.
+ */
+#pragma once
+
+#include <AP_HAL/CAN.h>
+
+#if HAL_WITH_UAVCAN
+
+#include <linux/can.h>
+
+#include <AP_HAL/utility/RingBuffer.h>
+
+#include "Poller.h"
+
+/*
+ * interfaces are named with this prefix followed by their index, so
+ * "can0" and "can1". A vcan interface named can0 can stand in for a
+ * real bus
+ */
+#ifndef HAL_LINUX_CAN_IFACE_PREFIX
+#define HAL_LINUX_CAN_IFACE_PREFIX "can"
+#endif
+
+#define LINUX_CAN_MAX_IFACES        2
+#define LINUX_CAN_RX_QUEUE_SIZE     128
+#define LINUX_CAN_TX_QUEUE_SIZE     64
+
+// frames moved in one recvmmsg() or sendmmsg() call
+#define LINUX_CAN_BATCH_SIZE        32
+
+namespace Linux {
+
+class CANManager;
+
+class CAN: public AP_HAL::CAN {
+public:
+    CAN(CANManager &manager, uint8_t self_index);
+    ~CAN();
+
+    /*
+     * The bitrate is left to the kernel, as set with "ip link set canX
+     * type can bitrate N", so begin() only opens the socket
+     */
+    bool begin(uint32_t bitrate) override;
+
+    /*
+     * use a socket which is already open instead of the interface, as
+     * tests do with one end of a socketpair. The socket is closed by
+     * end(), or at once if it can't be used
+     */
+    bool begin_with_socket(int fd);
+
+    void end() override;
+    void reset() override;
+    bool is_initialized() override;
+    int32_t tx_pending() override;
+    int32_t available() override;
+
+    int16_t send(const uavcan::CanFrame &frame, uavcan::MonotonicTime tx_deadline,
+                 uavcan::CanIOFlags flags) override;
+
+    int16_t receive(uavcan::CanFrame &out_frame, uavcan::MonotonicTime &out_ts_monotonic,
+                    uavcan::UtcTime &out_ts_utc, uavcan::CanIOFlags &out_flags) override;
+
+    int16_t configureFilters(const uavcan::CanFilterConfig *filter_configs,
+                             uint16_t num_configs) override;
+
+    uint16_t getNumFilters() const override { return CAN_MAX_FILTERS; }
+
+    uint64_t getErrorCount() const override { return _error_count; }
+
+    bool has_rx() const { return !_rx_queue.empty(); }
+    bool can_accept_tx() const { return _tx_count < LINUX_CAN_TX_QUEUE_SIZE; }
+
+    /*
+     * true if frames are queued but the kernel refused them without
+     * the socket becoming unwritable, so no event will say when to
+     * try again
+     */
+    bool needs_tx_retry() const { return _tx_count > 0 && !_tx_blocked; }
+
+    // drop frames past their deadline and hand the rest to the kernel
+    void flush_tx(uint64_t now_us);
+
+    // move what the kernel has received into the rx queue, as far as
+    // there is room
+    void drain_rx();
+
+    // true if the rx queue filled up before the socket was empty
+    bool rx_pending() const { return _rx_pending; }
+
+private:
+    enum {
+        CAN_MAX_FILTERS = 32
+    };
+
+    struct RxItem {
+        uavcan::CanFrame frame;
+        uint64_t monotonic_us;
+        uint64_t utc_us;
+        uavcan::CanIOFlags flags;
+    };
+
+    struct TxItem {
+        uavcan::CanFrame frame;
+        uint64_t deadline_us;
+        uavcan::CanIOFlags flags;
+    };
+
+    class SocketPollable : public Pollable {
+    public:
+        SocketPollable(CAN &can) : _can(can) { }
+        ~SocketPollable() { _fd = -1; }
+
+        void set_fd(int fd) { _fd = fd; }
+
+        void on_can_read() override { _can.drain_rx(); }
+        void on_can_write() override { _can._tx_blocked = false; }
+        void on_error() override { _can._error_count++; }
+
+    private:
+        CAN &_can;
+    };
+
+    void _push_rx(const uavcan::CanFrame &frame, uint64_t monotonic_us,
+                  uint64_t utc_us, uavcan::CanIOFlags flags);
+    void _remove_tx(uint16_t start, uint16_t count);
+    void _abort_on_error();
+
+    CANManager &_manager;
+    const uint8_t _self_index;
+
+    int _fd = -1;
+    SocketPollable _pollable{*this};
+
+    ObjectBuffer<RxItem> _rx_queue{LINUX_CAN_RX_QUEUE_SIZE};
+
+    bool _rx_pending;
+
+    // waiting for the socket, highest priority frame first
+    TxItem _tx_queue[LINUX_CAN_TX_QUEUE_SIZE];
+    uint16_t _tx_count;
+
+    // set when the socket buffer is full until it can be written again
+    bool _tx_blocked;
+
+    // cumulative count of frames the kernel dropped as the socket
+    // buffer was full, from SO_RXQ_OVFL
+    uint32_t _rx_overflows;
+
+    uint64_t _error_count;
+};
+
+class CANManager: public AP_HAL::CANManager {
+    friend class CAN;
+public:
+    CANManager();
+
+    bool begin(uint32_t bitrate, uint8_t can_number) override;
+
+    // begin with already open sockets, see CAN::begin_with_socket()
+    bool begin_with_sockets(const int *fds, uint8_t num_fds);
+
+    bool is_initialized() override;
+
+    CAN *getIface(uint8_t iface_index) override;
+    uint8_t getNumIfaces() const override { return _num_ifaces; }
+
+    int16_t select(uavcan::CanSelectMasks &inout_masks,
+                   const uavcan::CanFrame* (&pending_tx)[uavcan::MaxCanIfaces],
+                   uavcan::MonotonicTime blocking_deadline) override;
+
+    AP_UAVCAN *get_UAVCAN(void) override;
+    void set_UAVCAN(AP_UAVCAN *uavcan) override;
+
+private:
+    uavcan::CanSelectMasks _make_select_masks(const uavcan::CanFrame* (&pending_tx)[uavcan::MaxCanIfaces]) const;
+
+    Poller _poller{};
+    CAN _if0{*this, 0};
+    CAN _if1{*this, 1};
+    CAN *_ifaces[LINUX_CAN_MAX_IFACES] = { &_if0, &_if1 };
+    uint8_t _num_ifaces;
+    bool _initialized;
+    AP_UAVCAN *_uavcan;
+};
+
+}
+
+#endif
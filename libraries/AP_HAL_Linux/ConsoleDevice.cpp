@@ -97,3 +97,12 @@ void ConsoleDevice::set_blocking(bool blocking)
 void ConsoleDevice::set_speed(uint32_t baudrate)
 {
 }
+
+int ConsoleDevice::get_fd() const
+{
+    if (_closed) {
+        return -1;
+    }
+
+    return _rd_fd;
+}
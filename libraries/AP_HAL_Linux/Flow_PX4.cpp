@@ -44,6 +44,15 @@
 #include <cmath>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define FLOW_PX4_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FLOW_PX4_NEON
+#endif
 
 extern const AP_HAL::HAL& hal;
 
@@ -84,8 +93,9 @@ Flow_PX4::Flow_PX4(uint32_t width, uint32_t bytesperline,
  * @param offX x coordinate of upper left corner of 8x8 pattern in image
  * @param offY y coordinate of upper left corner of 8x8 pattern in image
  */
-static inline uint32_t compute_diff(uint8_t *image, uint16_t offx, uint16_t offy,
-                                    uint16_t row_size, uint8_t window_size)
+uint32_t Flow_PX4::compute_diff_scalar(const uint8_t *image, uint16_t offx,
+                                       uint16_t offy, uint16_t row_size,
+                                       uint8_t window_size)
 {
     /* calculate position in image buffer */
     /* we calc only the 4x4 pattern */
@@ -125,10 +135,11 @@ static inline uint32_t compute_diff(uint8_t *image, uint16_t offx, uint16_t offy
  * @param off2X x coordinate of upper left corner of pattern in image2
  * @param off2Y y coordinate of upper left corner of pattern in image2
  */
-static inline uint32_t compute_sad(uint8_t *image1, uint8_t *image2,
-                                   uint16_t off1x, uint16_t off1y,
-                                   uint16_t off2x, uint16_t off2y,
-                                   uint16_t row_size, uint16_t window_size)
+uint32_t Flow_PX4::compute_sad_scalar(const uint8_t *image1,
+                                      const uint8_t *image2,
+                                      uint16_t off1x, uint16_t off1y,
+                                      uint16_t off2x, uint16_t off2y,
+                                      uint16_t row_size, uint16_t window_size)
 {
     /* calculate position in image buffer
      * off1 for image1 and off2 for image2
@@ -158,11 +169,12 @@ static inline uint32_t compute_sad(uint8_t *image1, uint8_t *image2,
  * @param off2Y y coordinate of upper left corner of pattern in image2
  * @param acc array to store SAD distances for shift in every direction
  */
-static inline uint32_t compute_subpixel(uint8_t *image1, uint8_t *image2,
-                                        uint16_t off1x, uint16_t off1y,
-                                        uint16_t off2x, uint16_t off2y,
-                                        uint32_t *acc, uint16_t row_size,
-                                        uint16_t window_size)
+void Flow_PX4::compute_subpixel_scalar(const uint8_t *image1,
+                                       const uint8_t *image2,
+                                       uint16_t off1x, uint16_t off1y,
+                                       uint16_t off2x, uint16_t off2y,
+                                       uint32_t *acc, uint16_t row_size,
+                                       uint16_t window_size)
 {
     /* calculate position in image buffer */
     uint16_t off1 = off1y * row_size + off1x; // image1
@@ -227,8 +239,230 @@ static inline uint32_t compute_subpixel(uint8_t *image1, uint8_t *image2,
             }
         }
     }
+}
+
+#if defined(FLOW_PX4_SSE2)
+/* load 8 pixels and widen them to 16 bits */
+static inline __m128i load_widen_8px(const uint8_t *p)
+{
+    return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)p),
+                             _mm_setzero_si128());
+}
+
+/* sum of the two 64 bits halves produced by _mm_sad_epu8() */
+static inline uint32_t sad_total(__m128i v)
+{
+    return _mm_cvtsi128_si32(_mm_add_epi32(v, _mm_srli_si128(v, 8)));
+}
+#elif defined(FLOW_PX4_NEON)
+static inline uint32_t sum_u16x8(uint16x8_t v)
+{
+    uint64x2_t s = vpaddlq_u32(vpaddlq_u16(v));
+    return vgetq_lane_u64(s, 0) + vgetq_lane_u64(s, 1);
+}
+#endif
+
+#if defined(FLOW_PX4_SSE2) || defined(FLOW_PX4_NEON)
+static inline uint32_t load_4px(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+#endif
+
+uint32_t Flow_PX4::compute_diff(const uint8_t *image, uint16_t offx,
+                                uint16_t offy, uint16_t row_size,
+                                uint8_t window_size)
+{
+#if defined(FLOW_PX4_SSE2) || defined(FLOW_PX4_NEON)
+    if (window_size == 4) {
+        uint16_t off = (offy + 2) * row_size + (offx + 2);
+        /* the 4x4 pattern, one row per 32 bits lane. Vertical steps compare
+         * rows 0-2 against rows 1-3, horizontal steps compare pixels 0-2 of
+         * each row against pixels 1-3 (the pixel shifted out is zero on
+         * both sides so it doesn't count) */
+#if defined(FLOW_PX4_SSE2)
+        __m128i rows = _mm_setr_epi32(load_4px(&image[off]),
+                                      load_4px(&image[off + row_size]),
+                                      load_4px(&image[off + 2 * row_size]),
+                                      load_4px(&image[off + 3 * row_size]));
+        __m128i v1 = _mm_and_si128(rows, _mm_setr_epi32(-1, -1, -1, 0));
+        __m128i v2 = _mm_srli_si128(rows, 4);
+        __m128i h1 = _mm_and_si128(rows, _mm_set1_epi32(0x00FFFFFF));
+        __m128i h2 = _mm_srli_epi32(rows, 8);
+
+        return sad_total(_mm_add_epi64(_mm_sad_epu8(v1, v2),
+                                       _mm_sad_epu8(h1, h2)));
+#else
+        const uint32_t r[4] = { load_4px(&image[off]),
+                                load_4px(&image[off + row_size]),
+                                load_4px(&image[off + 2 * row_size]),
+                                load_4px(&image[off + 3 * row_size]) };
+        uint32x4_t rows = vld1q_u32(r);
+        uint32x4_t v1 = vsetq_lane_u32(0, rows, 3);
+        uint32x4_t v2 = vextq_u32(rows, vdupq_n_u32(0), 1);
+        uint32x4_t h1 = vandq_u32(rows, vdupq_n_u32(0x00FFFFFF));
+        uint32x4_t h2 = vshrq_n_u32(rows, 8);
+        uint16x8_t acc = vpaddlq_u8(vabdq_u8(vreinterpretq_u8_u32(v1),
+                                             vreinterpretq_u8_u32(v2)));
+        acc = vpadalq_u8(acc, vabdq_u8(vreinterpretq_u8_u32(h1),
+                                       vreinterpretq_u8_u32(h2)));
+
+        return sum_u16x8(acc);
+#endif
+    }
+#endif
+    return compute_diff_scalar(image, offx, offy, row_size, window_size);
+}
 
-    return 0;
+uint32_t Flow_PX4::compute_sad(const uint8_t *image1, const uint8_t *image2,
+                               uint16_t off1x, uint16_t off1y,
+                               uint16_t off2x, uint16_t off2y,
+                               uint16_t row_size, uint16_t window_size)
+{
+#if defined(FLOW_PX4_SSE2) || defined(FLOW_PX4_NEON)
+    if (window_size == 8) {
+        uint16_t off1 = off1y * row_size + off1x;
+        uint16_t off2 = off2y * row_size + off2x;
+        const uint8_t *p1 = &image1[off1];
+        const uint8_t *p2 = &image2[off2];
+#if defined(FLOW_PX4_SSE2)
+        __m128i acc = _mm_setzero_si128();
+
+        /* two rows of 8 pixels per register */
+        for (unsigned int j = 0; j < 8; j += 2) {
+            __m128i a = _mm_unpacklo_epi64(
+                _mm_loadl_epi64((const __m128i *)&p1[j * row_size]),
+                _mm_loadl_epi64((const __m128i *)&p1[(j + 1) * row_size]));
+            __m128i b = _mm_unpacklo_epi64(
+                _mm_loadl_epi64((const __m128i *)&p2[j * row_size]),
+                _mm_loadl_epi64((const __m128i *)&p2[(j + 1) * row_size]));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(a, b));
+        }
+
+        return sad_total(acc);
+#else
+        uint16x8_t acc = vdupq_n_u16(0);
+
+        for (unsigned int j = 0; j < 8; j++) {
+            acc = vabal_u8(acc, vld1_u8(&p1[j * row_size]),
+                           vld1_u8(&p2[j * row_size]));
+        }
+
+        return sum_u16x8(acc);
+#endif
+    }
+#endif
+    return compute_sad_scalar(image1, image2, off1x, off1y, off2x, off2y,
+                              row_size, window_size);
+}
+
+void Flow_PX4::compute_subpixel(const uint8_t *image1, const uint8_t *image2,
+                                uint16_t off1x, uint16_t off1y,
+                                uint16_t off2x, uint16_t off2y,
+                                uint32_t *acc, uint16_t row_size,
+                                uint16_t window_size)
+{
+#if defined(FLOW_PX4_SSE2) || defined(FLOW_PX4_NEON)
+    if (window_size == 8) {
+        uint16_t off1 = off1y * row_size + off1x;
+        uint16_t off2 = off2y * row_size + off2x;
+
+        /* same subpixel positions as compute_subpixel_scalar(), computed for
+         * a whole row of 8 pixels at once. Means are truncated like the
+         * integer divisions of the scalar version. */
+#if defined(FLOW_PX4_SSE2)
+        __m128i acc01 = _mm_setzero_si128();
+        __m128i acc23 = _mm_setzero_si128();
+        __m128i acc45 = _mm_setzero_si128();
+        __m128i acc67 = _mm_setzero_si128();
+
+        for (unsigned int j = 0; j < 8; j++) {
+            const uint8_t *p = &image2[off2 + j * row_size];
+            __m128i c = load_widen_8px(p);
+            __m128i l = load_widen_8px(p - 1);
+            __m128i r = load_widen_8px(p + 1);
+            __m128i u = load_widen_8px(p - row_size);
+            __m128i ul = load_widen_8px(p - row_size - 1);
+            __m128i ur = load_widen_8px(p - row_size + 1);
+            __m128i d = load_widen_8px(p + row_size);
+            __m128i dl = load_widen_8px(p + row_size - 1);
+            __m128i dr = load_widen_8px(p + row_size + 1);
+
+            __m128i cr = _mm_add_epi16(c, r);
+            __m128i cl = _mm_add_epi16(c, l);
+
+            __m128i s0 = _mm_srli_epi16(cr, 1);
+            __m128i s1 = _mm_srli_epi16(_mm_add_epi16(cr, _mm_add_epi16(d, dr)), 2);
+            __m128i s2 = _mm_srli_epi16(_mm_add_epi16(c, dr), 1);
+            __m128i s3 = _mm_srli_epi16(_mm_add_epi16(cl, _mm_add_epi16(dl, d)), 2);
+            __m128i s4 = _mm_srli_epi16(_mm_add_epi16(c, dl), 1);
+            __m128i s5 = _mm_srli_epi16(_mm_add_epi16(cl, _mm_add_epi16(ul, u)), 2);
+            __m128i s6 = _mm_srli_epi16(_mm_add_epi16(c, u), 1);
+            __m128i s7 = _mm_srli_epi16(_mm_add_epi16(cr, _mm_add_epi16(u, ur)), 2);
+
+            __m128i a = _mm_loadl_epi64((const __m128i *)&image1[off1 + j * row_size]);
+            a = _mm_unpacklo_epi64(a, a);
+
+            /* each SAD gives the sum for two directions, one per half */
+            acc01 = _mm_add_epi64(acc01, _mm_sad_epu8(a, _mm_packus_epi16(s0, s1)));
+            acc23 = _mm_add_epi64(acc23, _mm_sad_epu8(a, _mm_packus_epi16(s2, s3)));
+            acc45 = _mm_add_epi64(acc45, _mm_sad_epu8(a, _mm_packus_epi16(s4, s5)));
+            acc67 = _mm_add_epi64(acc67, _mm_sad_epu8(a, _mm_packus_epi16(s6, s7)));
+        }
+
+        acc[0] = _mm_cvtsi128_si32(acc01);
+        acc[1] = _mm_cvtsi128_si32(_mm_srli_si128(acc01, 8));
+        acc[2] = _mm_cvtsi128_si32(acc23);
+        acc[3] = _mm_cvtsi128_si32(_mm_srli_si128(acc23, 8));
+        acc[4] = _mm_cvtsi128_si32(acc45);
+        acc[5] = _mm_cvtsi128_si32(_mm_srli_si128(acc45, 8));
+        acc[6] = _mm_cvtsi128_si32(acc67);
+        acc[7] = _mm_cvtsi128_si32(_mm_srli_si128(acc67, 8));
+#else
+        uint16x8_t sad[8];
+
+        for (unsigned int k = 0; k < 8; k++) {
+            sad[k] = vdupq_n_u16(0);
+        }
+
+        for (unsigned int j = 0; j < 8; j++) {
+            const uint8_t *p = &image2[off2 + j * row_size];
+            uint8x8_t c = vld1_u8(p);
+            uint8x8_t l = vld1_u8(p - 1);
+            uint8x8_t r = vld1_u8(p + 1);
+            uint8x8_t u = vld1_u8(p - row_size);
+            uint8x8_t ul = vld1_u8(p - row_size - 1);
+            uint8x8_t ur = vld1_u8(p - row_size + 1);
+            uint8x8_t d = vld1_u8(p + row_size);
+            uint8x8_t dl = vld1_u8(p + row_size - 1);
+            uint8x8_t dr = vld1_u8(p + row_size + 1);
+
+            uint16x8_t cr = vaddl_u8(c, r);
+            uint16x8_t cl = vaddl_u8(c, l);
+
+            uint8x8_t a = vld1_u8(&image1[off1 + j * row_size]);
+
+            sad[0] = vabal_u8(sad[0], a, vshrn_n_u16(cr, 1));
+            sad[1] = vabal_u8(sad[1], a, vshrn_n_u16(vaddq_u16(cr, vaddl_u8(d, dr)), 2));
+            sad[2] = vabal_u8(sad[2], a, vshrn_n_u16(vaddl_u8(c, dr), 1));
+            sad[3] = vabal_u8(sad[3], a, vshrn_n_u16(vaddq_u16(cl, vaddl_u8(dl, d)), 2));
+            sad[4] = vabal_u8(sad[4], a, vshrn_n_u16(vaddl_u8(c, dl), 1));
+            sad[5] = vabal_u8(sad[5], a, vshrn_n_u16(vaddq_u16(cl, vaddl_u8(ul, u)), 2));
+            sad[6] = vabal_u8(sad[6], a, vshrn_n_u16(vaddl_u8(c, u), 1));
+            sad[7] = vabal_u8(sad[7], a, vshrn_n_u16(vaddq_u16(cr, vaddl_u8(u, ur)), 2));
+        }
+
+        for (unsigned int k = 0; k < 8; k++) {
+            acc[k] = sum_u16x8(sad[k]);
+        }
+#endif
+        return;
+    }
+#endif
+    compute_subpixel_scalar(image1, image2, off1x, off1y, off2x, off2y,
+                            acc, row_size, window_size);
 }
 
 uint8_t Flow_PX4::compute_flow(uint8_t *image1, uint8_t *image2,
@@ -26,6 +26,38 @@ public:
              float bottom_flow_value_threshold);
     uint8_t compute_flow(uint8_t *image1, uint8_t *image2, uint32_t delta_time,
                          float *pixel_flow_x, float *pixel_flow_y);
+
+    /* Block matching kernels used by compute_flow(). They use SSE2 or NEON
+     * when available at build time and fall back to the scalar versions
+     * otherwise; both must give exactly the same results. */
+    static uint32_t compute_diff(const uint8_t *image, uint16_t offx,
+                                 uint16_t offy, uint16_t row_size,
+                                 uint8_t window_size);
+    static uint32_t compute_sad(const uint8_t *image1, const uint8_t *image2,
+                                uint16_t off1x, uint16_t off1y,
+                                uint16_t off2x, uint16_t off2y,
+                                uint16_t row_size, uint16_t window_size);
+    static void compute_subpixel(const uint8_t *image1, const uint8_t *image2,
+                                 uint16_t off1x, uint16_t off1y,
+                                 uint16_t off2x, uint16_t off2y,
+                                 uint32_t *acc, uint16_t row_size,
+                                 uint16_t window_size);
+
+    static uint32_t compute_diff_scalar(const uint8_t *image, uint16_t offx,
+                                        uint16_t offy, uint16_t row_size,
+                                        uint8_t window_size);
+    static uint32_t compute_sad_scalar(const uint8_t *image1,
+                                       const uint8_t *image2,
+                                       uint16_t off1x, uint16_t off1y,
+                                       uint16_t off2x, uint16_t off2y,
+                                       uint16_t row_size,
+                                       uint16_t window_size);
+    static void compute_subpixel_scalar(const uint8_t *image1,
+                                        const uint8_t *image2,
+                                        uint16_t off1x, uint16_t off1y,
+                                        uint16_t off2x, uint16_t off2y,
+                                        uint32_t *acc, uint16_t row_size,
+                                        uint16_t window_size);
 private:
     uint32_t _width;
     uint32_t _search_size;
@@ -11,6 +11,7 @@
 #include <AP_HAL_Empty/AP_HAL_Empty.h>
 #include <AP_HAL_Empty/AP_HAL_Empty_Private.h>
 #include <AP_Module/AP_Module.h>
+#include <AP_Module/AP_Module_Export.h>
 
 #include "AnalogIn_ADS1115.h"
 #include "AnalogIn_IIO.h"
@@ -276,11 +277,18 @@ void _usage(void)
     printf("\tmodule support:\n");
     printf("\t                   --module-directory %s\n", AP_MODULE_DEFAULT_DIRECTORY);
     printf("\t                   -M %s\n", AP_MODULE_DEFAULT_DIRECTORY);
+    printf("\tshared memory export of module data:\n");
+    printf("\t                   --module-export %s\n", AP_EXPORT_DEFAULT_NAME);
+    printf("\t                   -x %s\n", AP_EXPORT_DEFAULT_NAME);
+    printf("\tcheck for other processes changing the SPI mode:\n");
+    printf("\t                   --spi-mode-check\n");
+    printf("\t                   -c\n");
 }
 
 void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
 {
     const char *module_path = AP_MODULE_DEFAULT_DIRECTORY;
+    const char *module_export = nullptr;
     
     assert(callbacks);
 
@@ -299,11 +307,13 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         {"log-directory",       true,  0, 'l'},
         {"terrain-directory",   true,  0, 't'},
         {"module-directory",    true,  0, 'M'},
+        {"module-export",       true,  0, 'x'},
+        {"spi-mode-check",      false, 0, 'c'},
         {"help",                false,  0, 'h'},
         {0, false, 0, 0}
     };
 
-    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:l:t:he:SM:",
+    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:l:t:he:SM:cx:",
                     options);
 
     /*
@@ -346,6 +356,12 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         case 'M':
             module_path = gopt.optarg;
             break;
+        case 'x':
+            module_export = gopt.optarg;
+            break;
+        case 'c':
+            spi_mgr_instance.set_mode_check(true);
+            break;
         case 'h':
             _usage();
             exit(0);
@@ -377,6 +393,11 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         AP_Module::init(module_path);
     }
 
+    // possibly publish module data to other processes
+    if (module_export != nullptr) {
+        AP_Module::export_init(module_export);
+    }
+
     AP_Module::call_hook_setup_start();
     callbacks->setup();
     AP_Module::call_hook_setup_complete();
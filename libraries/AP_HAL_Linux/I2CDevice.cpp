@@ -94,6 +94,7 @@ public:
     int fd = -1;
     uint8_t bus;
     uint8_t ref;
+    BusStats stats { };
 };
 
 I2CBus::~I2CBus()
@@ -185,18 +186,64 @@ bool I2CDevice::transfer(const uint8_t *send, uint32_t send_len,
         return false;
     }
 
-    struct i2c_rdwr_ioctl_data i2c_data = { };
+    return _submit(msgs, nmsgs);
+}
 
-    i2c_data.msgs = msgs;
-    i2c_data.nmsgs = nmsgs;
+bool I2CDevice::transfer_batch(const AP_HAL::Device::Transfer *transfers,
+                               uint8_t count)
+{
+    if (_split_transfers) {
+        /* the device can't take a repeated start between send and receive */
+        return AP_HAL::I2CDevice::transfer_batch(transfers, count);
+    }
 
-    int r;
-    unsigned retries = _retries;
-    do {
-        r = ::ioctl(_bus.fd, I2C_RDWR, &i2c_data);
-    } while (r == -1 && retries-- > 0);
+    struct i2c_msg msgs[I2C_RDRW_IOCTL_MAX_MSGS];
+    unsigned nmsgs = 0;
+
+    assert(_bus.fd >= 0);
+
+    if (count == 0) {
+        return false;
+    }
+
+    memset(msgs, 0, sizeof(msgs));
+
+    for (uint8_t i = 0; i < count; i++) {
+        const AP_HAL::Device::Transfer &t = transfers[i];
+        const bool do_send = t.send && t.send_len != 0;
+        const bool do_recv = t.recv && t.recv_len != 0;
+
+        /* same as transfer(): nothing to do is an input error */
+        if (!do_send && !do_recv) {
+            return false;
+        }
+
+        /* don't split a transfer over two calls */
+        if (nmsgs + do_send + do_recv > I2C_RDRW_IOCTL_MAX_MSGS) {
+            if (!_submit(msgs, nmsgs)) {
+                return false;
+            }
+            nmsgs = 0;
+        }
+
+        if (do_send) {
+            msgs[nmsgs].addr = _address;
+            msgs[nmsgs].flags = 0;
+            msgs[nmsgs].buf = const_cast<uint8_t*>(t.send);
+            msgs[nmsgs].len = t.send_len;
+            nmsgs++;
+        }
+
+        if (do_recv) {
+            msgs[nmsgs].addr = _address;
+            msgs[nmsgs].flags = I2C_M_RD;
+            msgs[nmsgs].buf = t.recv;
+            msgs[nmsgs].len = t.recv_len;
+            nmsgs++;
+        }
+    }
 
-    return r != -1;
+    return _submit(msgs, nmsgs);
 }
 
 bool I2CDevice::read_registers_multiple(uint8_t first_reg, uint8_t *recv,
@@ -209,14 +256,10 @@ bool I2CDevice::read_registers_multiple(uint8_t first_reg, uint8_t *recv,
     while (times > 0) {
         uint8_t n = MIN(times, max_times);
         struct i2c_msg msgs[2 * n];
-        struct i2c_rdwr_ioctl_data i2c_data = { };
 
         memset(msgs, 0, 2 * n * sizeof(*msgs));
 
-        i2c_data.msgs = msgs;
-        i2c_data.nmsgs = 2 * n;
-
-        for (uint8_t i = 0; i < i2c_data.nmsgs; i += 2) {
+        for (uint8_t i = 0; i < 2 * n; i += 2) {
             msgs[i].addr = _address;
             msgs[i].flags = 0;
             msgs[i].buf = &first_reg;
@@ -229,13 +272,7 @@ bool I2CDevice::read_registers_multiple(uint8_t first_reg, uint8_t *recv,
             recv += recv_len;
         };
 
-        int r;
-        unsigned retries = _retries;
-        do {
-            r = ::ioctl(_bus.fd, I2C_RDWR, &i2c_data);
-        } while (r == -1 && retries-- > 0);
-
-        if (r == -1) {
+        if (!_submit(msgs, 2 * n)) {
             return false;
         }
 
@@ -245,6 +282,40 @@ bool I2CDevice::read_registers_multiple(uint8_t first_reg, uint8_t *recv,
     return true;
 }
 
+bool I2CDevice::_submit(struct i2c_msg *msgs, unsigned nmsgs)
+{
+    struct i2c_rdwr_ioctl_data i2c_data = { };
+
+    i2c_data.msgs = msgs;
+    i2c_data.nmsgs = nmsgs;
+
+    int r;
+    unsigned retries = _retries;
+    do {
+        r = ::ioctl(_bus.fd, I2C_RDWR, &i2c_data);
+        _bus.stats.syscalls++;
+        if (r == -1) {
+            _bus.stats.errors++;
+        }
+    } while (r == -1 && retries-- > 0);
+
+    if (r == -1) {
+        return false;
+    }
+
+    _bus.stats.messages += nmsgs;
+    for (unsigned i = 0; i < nmsgs; i++) {
+        _bus.stats.bytes += msgs[i].len;
+    }
+
+    return true;
+}
+
+BusStats I2CDevice::get_bus_stats() const
+{
+    return _bus.stats;
+}
+
 AP_HAL::Semaphore *I2CDevice::get_semaphore()
 {
     return &_bus.sem;
@@ -23,8 +23,11 @@
 #include <AP_HAL/I2CDevice.h>
 #include <AP_HAL/utility/OwnPtr.h>
 
+#include "BusStats.h"
 #include "Semaphores.h"
 
+struct i2c_msg;
+
 namespace Linux {
 
 class I2CBus;
@@ -57,6 +60,13 @@ public:
     bool transfer(const uint8_t *send, uint32_t send_len,
                   uint8_t *recv, uint32_t recv_len) override;
 
+    /*
+     * See AP_HAL::Device::transfer_batch(): the transfers go in as few
+     * I2C_RDWR calls as the kernel allows, with a repeated start in between
+     */
+    bool transfer_batch(const AP_HAL::Device::Transfer *transfers,
+                        uint8_t count) override;
+
     bool read_registers_multiple(uint8_t first_reg, uint8_t *recv,
                                  uint32_t recv_len, uint8_t times) override;
 
@@ -75,8 +85,16 @@ public:
     void set_split_transfers(bool set) override {
         _split_transfers = set;
     }
-    
+
+    /* Counters of the bus this device is on */
+    BusStats get_bus_stats() const;
+
 protected:
+    /*
+     * Submit nmsgs messages in a single I2C_RDWR, retrying on failure
+     */
+    bool _submit(struct i2c_msg *msgs, unsigned nmsgs);
+
     I2CBus &_bus;
     uint8_t _address;
     uint8_t _retries = 0;
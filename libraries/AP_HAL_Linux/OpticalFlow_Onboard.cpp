@@ -34,6 +34,7 @@
 #include "AP_HAL/utility/RingBuffer.h"
 
 #define OPTICAL_FLOW_ONBOARD_RTPRIO 11
+#define OPTICAL_FLOW_ONBOARD_CAPTURE_RTPRIO 12
 static const unsigned int OPTICAL_FLOW_GYRO_BUFFER_LEN = 400;
 
 extern const AP_HAL::HAL& hal;
@@ -47,10 +48,6 @@ void OpticalFlow_Onboard::init()
     uint32_t memtype = V4L2_MEMORY_MMAP;
     unsigned int nbufs = 0;
     int ret;
-    pthread_attr_t attr;
-    struct sched_param param = {
-        .sched_priority = OPTICAL_FLOW_ONBOARD_RTPRIO
-    };
 
     if (_initialized) {
         return;
@@ -169,25 +166,47 @@ void OpticalFlow_Onboard::init()
                          HAL_FLOW_PX4_BOTTOM_FLOW_FEATURE_THRESHOLD,
                          HAL_FLOW_PX4_BOTTOM_FLOW_VALUE_THRESHOLD);
 
-    /* Create the thread that will be waiting for frames
-     * Initialize thread and mutex */
+    /* Buffers for the frames converted by software, shared between the
+     * capture and the flow threads */
+    if (_format == V4L2_PIX_FMT_YUYV || _shrink_by_software ||
+        _crop_by_software) {
+        for (uint8_t i = 0; i < HAL_OPTFLOW_ONBOARD_POOL_SIZE; i++) {
+            _frame_pool[i] = (uint8_t *)malloc(_width * _height);
+            if (!_frame_pool[i]) {
+                AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate frame pool\n");
+            }
+        }
+    }
+
+    _free_buffers = new ObjectBuffer<int8_t>(HAL_OPTFLOW_ONBOARD_POOL_SIZE);
+    for (int8_t i = 0; i < HAL_OPTFLOW_ONBOARD_POOL_SIZE; i++) {
+        _free_buffers->push(i);
+    }
+    /* large enough to hold all the frames that can be in flight */
+    _ready_frames = new ObjectBuffer<FlowFrame>(nbufs +
+                                                HAL_OPTFLOW_ONBOARD_POOL_SIZE);
+
+    /* Create the threads that will be waiting for frames and computing the
+     * flow. Initialize threads and mutexes */
     ret = pthread_mutex_init(&_mutex, nullptr);
     if (ret != 0) {
         AP_HAL::panic("OpticalFlow_Onboard: failed to init mutex");
     }
 
-    ret = pthread_attr_init(&attr);
+    ret = pthread_mutex_init(&_frame_mutex, nullptr);
     if (ret != 0) {
-        AP_HAL::panic("OpticalFlow_Onboard: failed to init attr");
+        AP_HAL::panic("OpticalFlow_Onboard: failed to init frame mutex");
     }
-    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
-    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
-    pthread_attr_setschedparam(&attr, &param);
-    ret = pthread_create(&_thread, &attr, _read_thread, this);
+
+    ret = pthread_cond_init(&_frame_cond, nullptr);
     if (ret != 0) {
-        AP_HAL::panic("OpticalFlow_Onboard: failed to create thread");
+        AP_HAL::panic("OpticalFlow_Onboard: failed to init frame cond");
     }
 
+    _start_thread(&_capture_thread_id, _capture_thread,
+                  OPTICAL_FLOW_ONBOARD_CAPTURE_RTPRIO);
+    _start_thread(&_thread, _read_thread, OPTICAL_FLOW_ONBOARD_RTPRIO);
+
     _gyro_ring_buffer = new ObjectBuffer<GyroSample>(OPTICAL_FLOW_GYRO_BUFFER_LEN);
 
     _initialized = true;
@@ -256,6 +275,37 @@ void OpticalFlow_Onboard::push_gyro_bias(float gyro_bias_x, float gyro_bias_y)
     _gyro_bias.y = gyro_bias_y;
 }
 
+void OpticalFlow_Onboard::_start_thread(pthread_t *thread,
+                                        void *(*start_routine)(void *),
+                                        int priority)
+{
+    pthread_attr_t attr;
+    struct sched_param param = {
+        .sched_priority = priority
+    };
+    int ret;
+
+    ret = pthread_attr_init(&attr);
+    if (ret != 0) {
+        AP_HAL::panic("OpticalFlow_Onboard: failed to init attr");
+    }
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &param);
+    ret = pthread_create(thread, &attr, start_routine, this);
+    if (ret != 0) {
+        AP_HAL::panic("OpticalFlow_Onboard: failed to create thread");
+    }
+}
+
+void *OpticalFlow_Onboard::_capture_thread(void *arg)
+{
+    OpticalFlow_Onboard *optflow_onboard = (OpticalFlow_Onboard *) arg;
+
+    optflow_onboard->_run_capture();
+    return nullptr;
+}
+
 void *OpticalFlow_Onboard::_read_thread(void *arg)
 {
     OpticalFlow_Onboard *optflow_onboard = (OpticalFlow_Onboard *) arg;
@@ -264,131 +314,157 @@ void *OpticalFlow_Onboard::_read_thread(void *arg)
     return nullptr;
 }
 
-void OpticalFlow_Onboard::_run_optflow()
+/*
+ * First stage of the pipeline: dequeue frames from the camera and convert,
+ * crop or shrink them in a single pass into one of the pool buffers, giving
+ * the camera buffer back right away.
+ */
+void OpticalFlow_Onboard::_run_capture()
 {
-    GyroSample gyro_sample;
-    Vector2f flow_rate;
     VideoIn::Frame video_frame;
-    uint32_t convert_buffer_size = 0, output_buffer_size = 0;
-    uint32_t crop_left = 0, crop_top = 0;
-    uint32_t shrink_scale = 0, shrink_width = 0, shrink_height = 0;
-    uint32_t shrink_width_offset = 0, shrink_height_offset = 0;
-    uint8_t *convert_buffer = nullptr, *output_buffer = nullptr;
-    uint8_t qual;
-
-    if (_format == V4L2_PIX_FMT_YUYV) {
-        if (_shrink_by_software || _crop_by_software) {
-            convert_buffer_size = _camera_output_width * _camera_output_height;
-        } else {
-            convert_buffer_size = _width * _height;
-        }
-
-        convert_buffer = (uint8_t *)malloc(convert_buffer_size);
-        if (!convert_buffer) {
-            AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate conversion buffer\n");
-        }
-    }
+    uint32_t input_width = _width, input_height = _height;
+    uint32_t left = 0, top = 0;
+    uint32_t selection_width = _width, selection_height = _height;
+    uint32_t scale = 1;
+    bool convert = _format == V4L2_PIX_FMT_YUYV;
 
     if (_shrink_by_software || _crop_by_software) {
-        output_buffer_size = HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH *
-            HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT;
-
-        output_buffer = (uint8_t *)malloc(output_buffer_size);
-        if (!output_buffer) {
-            if (convert_buffer) {
-                free(convert_buffer);
-            }
-
-            AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate crop buffer\n");
-        }
+        input_width = _camera_output_width;
+        input_height = _camera_output_height;
     }
 
     if (_shrink_by_software) {
-        if (_camera_output_width > _camera_output_height) {
-            shrink_scale = (uint32_t) _camera_output_height /
-                HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT;
+        if (input_width > input_height) {
+            scale = input_height / HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT;
         } else {
-            shrink_scale = (uint32_t) _camera_output_width /
-                HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH;
+            scale = input_width / HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH;
         }
 
-        shrink_width = HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH * shrink_scale;
-        shrink_height = HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT * shrink_scale;
+        selection_width = HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH * scale;
+        selection_height = HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT * scale;
 
-        shrink_width_offset = (_camera_output_width - shrink_width) / 2;
-        shrink_height_offset = (_camera_output_height - shrink_height) / 2;
+        left = (input_width - selection_width) / 2;
+        top = (input_height - selection_height) / 2;
     } else if (_crop_by_software) {
-        crop_left = _camera_output_width / 2 -
-           HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH / 2;
-        crop_top = _camera_output_height / 2 -
-           HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT / 2;
+        left = input_width / 2 - HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH / 2;
+        top = input_height / 2 - HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT / 2;
+        selection_width = HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH;
+        selection_height = HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT;
     }
 
-    while(true) {
+    while (true) {
+        FlowFrame frame;
+
         /* wait for next frame to come */
         if (!_videoin->get_frame(video_frame)) {
-            if (convert_buffer) {
-               free(convert_buffer);
-            }
+            AP_HAL::panic("OpticalFlow_Onboard: couldn't get frame\n");
+        }
 
-            if (output_buffer) {
-               free(output_buffer);
+        frame.timestamp = video_frame.timestamp;
+        frame.video_frame = video_frame;
+
+        if (!convert && !_shrink_by_software && !_crop_by_software) {
+            /* nothing to do, the flow thread gives the frame back */
+            frame.data = (uint8_t *)video_frame.data;
+            frame.pool_index = -1;
+        } else {
+            if (!_free_buffers->pop(frame.pool_index)) {
+                /* the flow thread is late, drop this frame */
+                _videoin->put_frame(video_frame);
+                continue;
+            }
+            frame.data = _frame_pool[frame.pool_index];
+
+            if (convert) {
+                VideoIn::yuyv_to_grey_shrink((uint8_t *)video_frame.data,
+                                             frame.data, input_width,
+                                             left, selection_width,
+                                             top, selection_height,
+                                             scale, scale);
+            } else if (_shrink_by_software) {
+                VideoIn::shrink_8bpp((uint8_t *)video_frame.data, frame.data,
+                                     input_width, input_height,
+                                     left, selection_width,
+                                     top, selection_height,
+                                     scale, scale);
+            } else {
+                VideoIn::crop_8bpp((uint8_t *)video_frame.data, frame.data,
+                                   input_width,
+                                   left, selection_width,
+                                   top, selection_height);
             }
 
-            AP_HAL::panic("OpticalFlow_Onboard: couldn't get frame\n");
+            _videoin->put_frame(video_frame);
         }
 
-        if (_format == V4L2_PIX_FMT_YUYV) {
-            VideoIn::yuyv_to_grey((uint8_t *)video_frame.data,
-                convert_buffer_size * 2, convert_buffer);
+        _ready_frames->push(frame);
 
-            memset(video_frame.data, 0, convert_buffer_size * 2);
-            memcpy(video_frame.data, convert_buffer, convert_buffer_size);
-        }
+        pthread_mutex_lock(&_frame_mutex);
+        pthread_cond_signal(&_frame_cond);
+        pthread_mutex_unlock(&_frame_mutex);
+    }
+}
+
+bool OpticalFlow_Onboard::_wait_frame(FlowFrame &frame)
+{
+    pthread_mutex_lock(&_frame_mutex);
+    while (_ready_frames->empty()) {
+        pthread_cond_wait(&_frame_cond, &_frame_mutex);
+    }
+    pthread_mutex_unlock(&_frame_mutex);
+
+    return _ready_frames->pop(frame);
+}
+
+void OpticalFlow_Onboard::_release_frame(FlowFrame &frame)
+{
+    if (frame.pool_index < 0) {
+        _videoin->put_frame(frame.video_frame);
+    } else {
+        _free_buffers->push(frame.pool_index);
+    }
+}
 
-        if (_shrink_by_software) {
-            /* shrink_8bpp() will shrink a selected area using the offsets,
-             * therefore, we don't need the crop. */
-            VideoIn::shrink_8bpp((uint8_t *)video_frame.data, output_buffer,
-                                 _camera_output_width, _camera_output_height,
-                                 shrink_width_offset, shrink_width,
-                                 shrink_height_offset, shrink_height,
-                                 shrink_scale, shrink_scale);
-            memset(video_frame.data, 0, _camera_output_width * _camera_output_height);
-            memcpy(video_frame.data, output_buffer, output_buffer_size);
-        } else if (_crop_by_software) {
-            VideoIn::crop_8bpp((uint8_t *)video_frame.data, output_buffer,
-                               _camera_output_width,
-                               crop_left, HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH,
-                               crop_top, HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT);
-
-            memset(video_frame.data, 0, _camera_output_width * _camera_output_height);
-            memcpy(video_frame.data, output_buffer, output_buffer_size);
+/*
+ * Second stage of the pipeline: compute the flow between the last two
+ * frames and integrate it along with the gyro data.
+ */
+void OpticalFlow_Onboard::_run_optflow()
+{
+    GyroSample gyro_sample;
+    Vector2f flow_rate;
+    FlowFrame frame;
+    uint8_t qual;
+
+    while(true) {
+        if (!_wait_frame(frame)) {
+            continue;
         }
 
         /* if it is at least the second frame we receive
          * since we have to compare 2 frames */
-        if (_last_video_frame.data == nullptr) {
-            _last_video_frame = video_frame;
+        if (!_has_last_frame) {
+            _last_frame = frame;
+            _has_last_frame = true;
             continue;
         }
 
         /* read the integrated gyro data */
-        _get_integrated_gyros(video_frame.timestamp, gyro_sample);
+        _get_integrated_gyros(frame.timestamp, gyro_sample);
 
 #ifdef OPTICALFLOW_ONBOARD_RECORD_VIDEO
         int fd = open(OPTICALFLOW_ONBOARD_VIDEO_FILE, O_CLOEXEC | O_CREAT | O_WRONLY
                 | O_APPEND, S_IRUSR | S_IWUSR | S_IRGRP |
                 S_IWGRP | S_IROTH | S_IWOTH);
 	    if (fd != -1) {
-	        write(fd, video_frame.data, _sizeimage);
+	        write(fd, frame.data, _width * _height);
 #ifdef OPTICALFLOW_ONBOARD_RECORD_METADATAS
             struct PACKED {
                 uint32_t timestamp;
                 float x;
                 float y;
                 float z;
-            } metas = { video_frame.timestamp, rate_x, rate_y, rate_z};
+            } metas = { frame.timestamp, rate_x, rate_y, rate_z};
             write(fd, &metas, sizeof(metas));
 #endif
 	        close(fd);
@@ -398,10 +474,8 @@ void OpticalFlow_Onboard::_run_optflow()
         /* compute gyro data and video frames
          * get flow rate to send it to the opticalflow driver
          */
-        qual = _flow->compute_flow((uint8_t*)_last_video_frame.data,
-                                   (uint8_t *)video_frame.data,
-                                   video_frame.timestamp -
-                                   _last_video_frame.timestamp,
+        qual = _flow->compute_flow(_last_frame.data, frame.data,
+                                   frame.timestamp - _last_frame.timestamp,
                                    &flow_rate.x, &flow_rate.y);
 
         /* fill data frame for upper layers */
@@ -410,31 +484,23 @@ void OpticalFlow_Onboard::_run_optflow()
                                   HAL_FLOW_PX4_FOCAL_LENGTH_MILLIPX;
         _pixel_flow_y_integral += flow_rate.y /
                                   HAL_FLOW_PX4_FOCAL_LENGTH_MILLIPX;
-        _integration_timespan += video_frame.timestamp -
-                                 _last_video_frame.timestamp;
+        _integration_timespan += frame.timestamp -
+                                 _last_frame.timestamp;
         _gyro_x_integral       += (gyro_sample.gyro.x - _last_gyro_rate.x) *
-                                  (video_frame.timestamp - _last_video_frame.timestamp) /
+                                  (frame.timestamp - _last_frame.timestamp) /
                                   (gyro_sample.time_us - _last_integration_time);
         _gyro_y_integral       += (gyro_sample.gyro.y - _last_gyro_rate.y) /
                                   (gyro_sample.time_us - _last_integration_time) *
-                                  (video_frame.timestamp - _last_video_frame.timestamp);
+                                  (frame.timestamp - _last_frame.timestamp);
         _surface_quality = qual;
         _data_available = true;
         pthread_mutex_unlock(&_mutex);
 
-        /* give the last frame back to the video input driver */
-        _videoin->put_frame(_last_video_frame);
+        /* give the last frame back to the capture stage */
+        _release_frame(_last_frame);
         _last_integration_time = gyro_sample.time_us;
-        _last_video_frame = video_frame;
+        _last_frame = frame;
         _last_gyro_rate = gyro_sample.gyro;
     }
-
-    if (convert_buffer) {
-        free(convert_buffer);
-    }
-
-    if (output_buffer) {
-        free(output_buffer);
-    }
 }
 #endif
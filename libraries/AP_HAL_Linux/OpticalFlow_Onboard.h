@@ -26,6 +26,12 @@
 #include "VideoIn.h"
 #include "AP_HAL/utility/RingBuffer.h"
 
+/* the flow thread holds the previous and the current frame while the
+ * capture thread converts the next one */
+#ifndef HAL_OPTFLOW_ONBOARD_POOL_SIZE
+#define HAL_OPTFLOW_ONBOARD_POOL_SIZE 3
+#endif
+
 namespace Linux {
 
 class GyroSample {
@@ -42,16 +48,41 @@ public:
     void push_gyro_bias(float gyro_bias_x, float gyro_bias_y);
 
 private:
+    /* Frame handed from the capture thread to the flow thread. Converted
+     * frames live in one of the pool buffers, otherwise the frame is the
+     * one from VideoIn and must be given back to it once processed. */
+    struct FlowFrame {
+        uint8_t *data;
+        uint32_t timestamp;
+        int8_t pool_index;
+        VideoIn::Frame video_frame;
+    };
+
+    void _run_capture();
     void _run_optflow();
+    static void *_capture_thread(void *arg);
     static void *_read_thread(void *arg);
+    void _start_thread(pthread_t *thread, void *(*start_routine)(void *),
+                       int priority);
+    bool _wait_frame(FlowFrame &frame);
+    void _release_frame(FlowFrame &frame);
     void _get_integrated_gyros(uint64_t timestamp, GyroSample &gyro);
     VideoIn* _videoin;
-    VideoIn::Frame _last_video_frame;
+    FlowFrame _last_frame;
+    bool _has_last_frame;
     PWM_Sysfs_Base* _pwm;
     CameraSensor* _camerasensor;
     Flow_PX4* _flow;
     pthread_t _thread;
+    pthread_t _capture_thread_id;
     pthread_mutex_t _mutex;
+    pthread_mutex_t _frame_mutex;
+    pthread_cond_t _frame_cond;
+    /* output buffers of the capture thread, indexes of the free ones are
+     * given back by the flow thread through _free_buffers */
+    uint8_t *_frame_pool[HAL_OPTFLOW_ONBOARD_POOL_SIZE];
+    ObjectBuffer<int8_t> *_free_buffers;
+    ObjectBuffer<FlowFrame> *_ready_frames;
     bool _initialized;
     bool _data_available;
     bool _crop_by_software;
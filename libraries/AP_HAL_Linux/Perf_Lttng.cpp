@@ -40,6 +40,11 @@ void Perf_Lttng::count(const char *name, uint64_t val)
     tracepoint(ardupilot, count, name, val);
 }
 
+void Perf_Lttng::latency(const char *name, uint32_t latency_us)
+{
+    tracepoint(ardupilot, latency, name, latency_us);
+}
+
 #else
 
 #include "Perf_Lttng.h"
@@ -49,5 +54,6 @@ using namespace Linux;
 void Perf_Lttng::begin(const char *name) { }
 void Perf_Lttng::end(const char *name) { }
 void Perf_Lttng::count(const char *name, uint64_t val) { }
+void Perf_Lttng::latency(const char *name, uint32_t latency_us) { }
 
 #endif
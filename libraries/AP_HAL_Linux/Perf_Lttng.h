@@ -22,9 +22,12 @@ namespace Linux {
 
 class Perf_Lttng {
 public:
-    void begin(const char *name);
-    void end(const char *name);
-    void count(const char *name, uint64_t val);
+    static void begin(const char *name);
+    static void end(const char *name);
+    static void count(const char *name, uint64_t val);
+
+    // one stage of the control loop's latency trace, in microseconds
+    static void latency(const char *name, uint32_t latency_us);
 };
 
 }
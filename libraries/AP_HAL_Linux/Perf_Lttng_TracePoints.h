@@ -59,6 +59,19 @@ TRACEPOINT_EVENT(
     )
 )
 
+TRACEPOINT_EVENT(
+    ardupilot,
+    latency,
+    TP_ARGS(
+        const char*, name_arg,
+        unsigned int, latency_arg
+    ),
+    TP_FIELDS(
+        ctf_string(name_field, name_arg)
+        ctf_integer(unsigned int, latency_field, latency_arg)
+    )
+)
+
 #endif
 
 #include <lttng/tracepoint-event.h>
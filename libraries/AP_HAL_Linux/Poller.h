@@ -106,10 +106,12 @@ public:
 
     /*
      * Wait for events on all Pollable objects registered with
-     * register_pollable(). New Pollable objects can be registered at any
-     * time, including when a thread is sleeping on a poll() call.
+     * register_pollable(), for at most @timeout_ms milliseconds or forever
+     * if negative. New Pollable objects can be registered at any time,
+     * including when a thread is sleeping on a poll() call. Returns the
+     * number of events handled, 0 on timeout.
      */
-    int poll() const;
+    int poll(int timeout_ms = -1) const;
 
     /*
      * Wake up the thread sleeping on a poll() call if it is in fact
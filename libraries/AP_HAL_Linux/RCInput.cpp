@@ -86,7 +86,7 @@ bool RCInput::set_override(uint8_t channel, int16_t override)
     if (channel < LINUX_RC_INPUT_NUM_CHANNELS) {
         _override[channel] = override;
         if (override != 0) {
-            rc_input_count++;
+            _new_frame();
             return true;
         }
     }
@@ -114,7 +114,7 @@ void RCInput::_process_ppmsum_pulse(uint16_t width_usec)
                 _pwm_values[i] = ppm_state._pulse_capt[i];
             }
             _num_channels = ppm_state._channel_counter;
-            rc_input_count++;
+            _new_frame();
         }
         ppm_state._channel_counter = 0;
         return;
@@ -145,7 +145,7 @@ void RCInput::_process_ppmsum_pulse(uint16_t width_usec)
             _pwm_values[i] = ppm_state._pulse_capt[i];
         }
         _num_channels = ppm_state._channel_counter;
-        rc_input_count++;
+        _new_frame();
         ppm_state._channel_counter = -1;
     }
 }
@@ -223,7 +223,7 @@ void RCInput::_process_sbus_pulse(uint16_t width_s0, uint16_t width_s1)
             }
             _num_channels = num_values;
             if (!sbus_failsafe) {
-                rc_input_count++;
+                _new_frame();
             }
         }
         goto reset;
@@ -293,7 +293,7 @@ void RCInput::_process_dsm_pulse(uint16_t width_s0, uint16_t width_s1)
                     _pwm_values[i] = values[i];
                 }
                 _num_channels = num_values;
-                rc_input_count++;
+                _new_frame();
             }
         }
         memset(&dsm_state, 0, sizeof(dsm_state));
@@ -351,7 +351,7 @@ void RCInput::_update_periods(uint16_t *periods, uint8_t len)
         _pwm_values[i] = periods[i];
     }
     _num_channels = len;
-    rc_input_count++;
+    _new_frame();
 }
 
 
@@ -410,7 +410,7 @@ bool RCInput::add_dsm_input(const uint8_t *bytes, size_t nbytes)
                 if (num_values > _num_channels) {
                     _num_channels = num_values;
                 }
-                rc_input_count++;
+                _new_frame();
 #if 0
                 printf("Decoded DSM %u channels %u %u %u %u %u %u %u %u\n",
                        (unsigned)num_values,
@@ -446,7 +446,7 @@ bool RCInput::add_sumd_input(const uint8_t *bytes, size_t nbytes)
                 }
             }
             _num_channels = channel_count;
-            rc_input_count++;
+            _new_frame();
             ret = true;
         }
         nbytes--;
@@ -476,7 +476,7 @@ bool RCInput::add_st24_input(const uint8_t *bytes, size_t nbytes)
                 }
             }
             _num_channels = channel_count;
-            rc_input_count++;
+            _new_frame();
             ret = true;
         }
         nbytes--;
@@ -505,7 +505,7 @@ bool RCInput::add_srxl_input(const uint8_t *bytes, size_t nbytes)
             }
             _num_channels = channel_count;
             if (failsafe_state == false) {
-                rc_input_count++;
+                _new_frame();
             }
             ret = true;
         }
@@ -566,7 +566,7 @@ void RCInput::add_sbus_input(const uint8_t *bytes, size_t nbytes)
                     _num_channels = num_values;
                 }
                 if (!sbus_failsafe) {
-                    rc_input_count++;
+                    _new_frame();
                 }
 #if 0
                 printf("Decoded SBUS %u channels %u %u %u %u %u %u %u %u %s\n",
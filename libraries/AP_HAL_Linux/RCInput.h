@@ -21,6 +21,7 @@ public:
     uint8_t num_channels();
     uint16_t read(uint8_t ch);
     uint8_t read(uint16_t* periods, uint8_t len);
+    uint32_t last_frame_us() override { return _last_frame_us; }
 
     bool set_overrides(int16_t *overrides, uint8_t len);
     bool set_override(uint8_t channel, int16_t override);
@@ -49,8 +50,16 @@ protected:
     void _process_rc_pulse(uint16_t width_s0, uint16_t width_s1);
     void _update_periods(uint16_t *periods, uint8_t len);
 
+    // a frame has been decoded into _pwm_values
+    void _new_frame()
+    {
+        _last_frame_us = AP_HAL::micros();
+        rc_input_count++;
+    }
+
     std::atomic<unsigned int> rc_input_count;
     std::atomic<unsigned int> last_rc_input_count;
+    std::atomic<uint32_t> _last_frame_us{0};
 
     uint16_t _pwm_values[LINUX_RC_INPUT_NUM_CHANNELS];
     uint8_t  _num_channels;
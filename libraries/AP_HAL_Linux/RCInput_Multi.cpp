@@ -58,6 +58,7 @@ void RCInput_Multi::_timer_tick(void)
         if (inputs[i]->new_input()) {
             inputs[i]->read(_pwm_values, inputs[i]->num_channels());
             _num_channels = inputs[i]->num_channels();
+            _last_frame_us = inputs[i]->last_frame_us();
             rc_input_count++;
         }        
     }
@@ -97,6 +97,16 @@ int RPIOUARTDriver::_read_fd(uint8_t *buf, uint16_t n)
     return -1;
 }
 
+int RPIOUARTDriver::_poll_fd()
+{
+    /* the SPI bus is serviced from its own timer */
+    if (!_external) {
+        return -1;
+    }
+
+    return UARTDriver::_poll_fd();
+}
+
 void RPIOUARTDriver::_timer_tick(void)
 {
     if (_external) {
@@ -22,6 +22,7 @@ public:
 protected:
     int _write_fd(const uint8_t *buf, uint16_t n);
     int _read_fd(uint8_t *buf, uint16_t n);
+    int _poll_fd() override;
 
 private:
     bool _in_timer;
@@ -43,27 +43,6 @@ static const AP_HAL::HAL &hal = AP_HAL::get_HAL();
 
 #define MHZ (1000U*1000U)
 #define KHZ (1000U)
-#define SPI_CS_KERNEL -1
-
-struct SPIDesc {
-    SPIDesc(const char *name_, uint16_t bus_, uint16_t subdev_, uint8_t mode_,
-            uint8_t bits_per_word_, int16_t cs_pin_, uint32_t lowspeed_,
-            uint32_t highspeed_)
-        : name(name_), bus(bus_), subdev(subdev_), mode(mode_)
-        , bits_per_word(bits_per_word_), cs_pin(cs_pin_), lowspeed(lowspeed_)
-        , highspeed(highspeed_)
-    {
-    }
-
-    const char *name;
-    uint16_t bus;
-    uint16_t subdev;
-    uint8_t mode;
-    uint8_t bits_per_word;
-    int16_t cs_pin;
-    uint32_t lowspeed;
-    uint32_t highspeed;
-};
 
 
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_PXF || CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_ERLEBOARD
@@ -161,6 +140,7 @@ public:
     uint16_t kernel_cs;
     uint8_t ref;
     int16_t last_mode = -1;
+    BusStats stats { };
 };
 
 SPIBus::~SPIBus()
@@ -278,20 +258,108 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
         return false;
     }
 
-    int r;
-    if (_bus.last_mode == _desc.mode) {
+    return _submit(msgs, nmsgs);
+}
+
+bool SPIDevice::transfer_batch(const AP_HAL::Device::Transfer *transfers,
+                               uint8_t count)
+{
+    if (_desc.cs_pin != SPI_CS_KERNEL) {
+        /* userspace CS has to be toggled between transfers */
+        return AP_HAL::SPIDevice::transfer_batch(transfers, count);
+    }
+
+    if (count == 0) {
+        return false;
+    }
+
+    /* at most 2 * 255 messages, still within SPI_IOC_MESSAGE() size limit */
+    struct spi_ioc_transfer msgs[2 * count];
+    unsigned nmsgs = 0;
+
+    assert(_bus.fd >= 0);
+
+    memset(msgs, 0, sizeof(msgs));
+
+    for (uint8_t i = 0; i < count; i++) {
+        const AP_HAL::Device::Transfer &t = transfers[i];
+        unsigned first = nmsgs;
+
+        if (t.send && t.send_len != 0) {
+            msgs[nmsgs].tx_buf = (uint64_t) t.send;
+            msgs[nmsgs].len = t.send_len;
+            msgs[nmsgs].speed_hz = _speed;
+            msgs[nmsgs].bits_per_word = _desc.bits_per_word;
+            nmsgs++;
+        }
+
+        if (t.recv && t.recv_len != 0) {
+            msgs[nmsgs].rx_buf = (uint64_t) t.recv;
+            msgs[nmsgs].len = t.recv_len;
+            msgs[nmsgs].speed_hz = _speed;
+            msgs[nmsgs].bits_per_word = _desc.bits_per_word;
+            nmsgs++;
+        }
+
+        /* same as transfer(): nothing to do is an input error */
+        if (nmsgs == first) {
+            return false;
+        }
+
+        /*
+         * Deselect the device at the end of each transfer but the last:
+         * cs_change on the last message would keep it selected instead
+         */
+        if (i + 1 < count) {
+            msgs[nmsgs - 1].cs_change = 1;
+        }
+    }
+
+    return _submit(msgs, nmsgs);
+}
+
+bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
+                                    uint32_t len)
+{
+    struct spi_ioc_transfer msgs[1] = { };
+
+    assert(_bus.fd >= 0);
+
+    if (!send || !recv || len == 0) {
+        return false;
+    }
+
+    msgs[0].tx_buf = (uint64_t) send;
+    msgs[0].rx_buf = (uint64_t) recv;
+    msgs[0].len = len;
+    msgs[0].speed_hz = _speed;
+    msgs[0].delay_usecs = 0;
+    msgs[0].bits_per_word = _desc.bits_per_word;
+    msgs[0].cs_change = 0;
+
+    /* both directions are counted once in the stats */
+    return _submit(msgs, 1);
+}
+
+bool SPIDevice::_set_mode()
+{
+    if (_bus.last_mode == _desc.mode &&
+        SPIDeviceManager::from(hal.spi)->_mode_check) {
         /*
           the mode in the kernel is not tied to the file descriptor,
           so there is a chance some other process has changed it since
           we last used the bus. We want to report when this happens so
           the user has a chance of figuring out when there is
           conflicted use of the SPI bus. Unfortunately this costs us
-          an extra syscall per transfer.
+          an extra syscall per transfer, so it's only done when the
+          check is enabled.
          */
         uint8_t current_mode;
+        _bus.stats.syscalls++;
         if (ioctl(_bus.fd, SPI_IOC_RD_MODE, &current_mode) < 0) {
             hal.console->printf("SPIDevice: error on getting mode fd=%d (%s)\n",
                                 _bus.fd, strerror(errno));
+            _bus.stats.errors++;
             _bus.last_mode = -1;
         } else if (current_mode != _bus.last_mode) {
             hal.console->printf("SPIDevice: bus mode conflict fd=%d mode=%u/%u\n",
@@ -299,68 +367,52 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
             _bus.last_mode = -1;
         }
     }
+
     if (_desc.mode != _bus.last_mode) {
-        r = ioctl(_bus.fd, SPI_IOC_WR_MODE, &_desc.mode);
-        if (r < 0) {
+        _bus.stats.syscalls++;
+        if (ioctl(_bus.fd, SPI_IOC_WR_MODE, &_desc.mode) < 0) {
             hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
                                 _bus.fd, strerror(errno));
+            _bus.stats.errors++;
+            _bus.last_mode = -1;
             return false;
         }
         _bus.last_mode = _desc.mode;
     }
 
-    _cs_assert();
-    r = ioctl(_bus.fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
-    _cs_release();
-
-    if (r == -1) {
-        hal.console->printf("SPIDevice: error transferring data fd=%d (%s)\n",
-                            _bus.fd, strerror(errno));
-        return false;
-    }
-
     return true;
 }
 
-bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
-                                    uint32_t len)
+bool SPIDevice::_submit(struct spi_ioc_transfer *msgs, unsigned nmsgs)
 {
-    struct spi_ioc_transfer msgs[1] = { };
-
-    assert(_bus.fd >= 0);
-
-    if (!send || !recv || len == 0) {
-        return false;
-    }
-
-    msgs[0].tx_buf = (uint64_t) send;
-    msgs[0].rx_buf = (uint64_t) recv;
-    msgs[0].len = len;
-    msgs[0].speed_hz = _speed;
-    msgs[0].delay_usecs = 0;
-    msgs[0].bits_per_word = _desc.bits_per_word;
-    msgs[0].cs_change = 0;
-
-    int r = ioctl(_bus.fd, SPI_IOC_WR_MODE, &_desc.mode);
-    if (r < 0) {
-        hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
-                            _bus.fd, strerror(errno));
+    if (!_set_mode()) {
         return false;
     }
 
     _cs_assert();
-    r = ioctl(_bus.fd, SPI_IOC_MESSAGE(1), &msgs);
+    int r = ioctl(_bus.fd, SPI_IOC_MESSAGE(nmsgs), msgs);
     _cs_release();
 
+    _bus.stats.syscalls++;
     if (r == -1) {
         hal.console->printf("SPIDevice: error transferring data fd=%d (%s)\n",
                             _bus.fd, strerror(errno));
+        _bus.stats.errors++;
         return false;
     }
 
+    _bus.stats.messages += nmsgs;
+    for (unsigned i = 0; i < nmsgs; i++) {
+        _bus.stats.bytes += msgs[i].len;
+    }
+
     return true;
 }
 
+BusStats SPIDevice::get_bus_stats() const
+{
+    return _bus.stats;
+}
 
 void SPIDevice::_cs_assert()
 {
@@ -430,6 +482,14 @@ SPIDeviceManager::get_device(const char *name)
         return AP_HAL::OwnPtr<AP_HAL::SPIDevice>(nullptr);
     }
 
+    return get_device(*desc);
+}
+
+AP_HAL::OwnPtr<AP_HAL::SPIDevice>
+SPIDeviceManager::get_device(SPIDesc &desc_)
+{
+    SPIDesc *desc = &desc_;
+
     /* Find if bus is already open */
     for (uint8_t i = 0, n = _buses.size(); i < n; i++) {
         if (_buses[i]->bus == desc->bus &&
@@ -22,13 +22,44 @@
 #include <AP_HAL/HAL.h>
 #include <AP_HAL/SPIDevice.h>
 
+#include "BusStats.h"
+
+struct spi_ioc_transfer;
+
 namespace Linux {
 
+#define SPI_CS_KERNEL -1
+
 class SPIBus;
-class SPIDesc;
+
+/* Description of a device, its bus and how to talk to it */
+struct SPIDesc {
+    SPIDesc(const char *name_, uint16_t bus_, uint16_t subdev_, uint8_t mode_,
+            uint8_t bits_per_word_, int16_t cs_pin_, uint32_t lowspeed_,
+            uint32_t highspeed_)
+        : name(name_), bus(bus_), subdev(subdev_), mode(mode_)
+        , bits_per_word(bits_per_word_), cs_pin(cs_pin_), lowspeed(lowspeed_)
+        , highspeed(highspeed_)
+    {
+    }
+
+    const char *name;
+    uint16_t bus;
+    uint16_t subdev;
+    uint8_t mode;
+    uint8_t bits_per_word;
+    int16_t cs_pin;
+    uint32_t lowspeed;
+    uint32_t highspeed;
+};
 
 class SPIDevice : public AP_HAL::SPIDevice {
 public:
+    static SPIDevice *from(AP_HAL::SPIDevice *dev)
+    {
+        return static_cast<SPIDevice*>(dev);
+    }
+
     SPIDevice(SPIBus &bus, SPIDesc &device_desc);
 
     virtual ~SPIDevice();
@@ -42,6 +73,14 @@ public:
     bool transfer(const uint8_t *send, uint32_t send_len,
                   uint8_t *recv, uint32_t recv_len) override;
 
+    /*
+     * See AP_HAL::Device::transfer_batch(): with a kernel chip select all
+     * the transfers go in a single SPI_IOC_MESSAGE, with the chip select
+     * toggled in between
+     */
+    bool transfer_batch(const AP_HAL::Device::Transfer *transfers,
+                        uint8_t count) override;
+
     /* See AP_HAL::SPIDevice::transfer_fullduplex() */
     bool transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                              uint32_t len) override;
@@ -57,6 +96,9 @@ public:
     bool adjust_periodic_callback(
         AP_HAL::Device::PeriodicHandle h, uint32_t period_usec) override;
 
+    /* Counters of the bus this device is on */
+    BusStats get_bus_stats() const;
+
 protected:
     SPIBus &_bus;
     SPIDesc &_desc;
@@ -72,6 +114,17 @@ protected:
      * Deselect device if using userspace CS
      */
     void _cs_release();
+
+    /*
+     * Set the SPI mode of this device on the bus if it's not the last one
+     * set, optionally checking it hasn't been changed by someone else
+     */
+    bool _set_mode();
+
+    /*
+     * Submit nmsgs messages in a single ioctl
+     */
+    bool _submit(struct spi_ioc_transfer *msgs, unsigned nmsgs);
 };
 
 class SPIDeviceManager : public AP_HAL::SPIDeviceManager {
@@ -92,6 +145,12 @@ public:
     /* AP_HAL::SPIDeviceManager implementation */
     AP_HAL::OwnPtr<AP_HAL::SPIDevice> get_device(const char *name);
 
+    /*
+     * Get a device from a description which isn't in the board's table,
+     * as tests do. The description must outlive the device
+     */
+    AP_HAL::OwnPtr<AP_HAL::SPIDevice> get_device(SPIDesc &desc);
+
     /*
      * Stop all SPI threads and block until they are finalized. This doesn't
      * free memory because they can still be used by devices, however device
@@ -105,11 +164,21 @@ public:
     /* See AP_HAL::SPIDeviceManager::get_device_name() */
     const char *get_device_name(uint8_t idx);
 
+    /*
+     * The SPI mode is kept in the kernel per bus rather than per file
+     * descriptor, and is only set again when a device with a different
+     * mode uses the bus. Enabling the mode check reads it back before
+     * every transfer to report other processes changing it, at the cost
+     * of an extra syscall per transfer.
+     */
+    void set_mode_check(bool enable) { _mode_check = enable; }
+
 protected:
     void _unregister(SPIBus &b);
     AP_HAL::OwnPtr<AP_HAL::SPIDevice> _create_device(SPIBus &b, SPIDesc &device_desc) const;
 
     std::vector<SPIBus*> _buses;
+    bool _mode_check = false;
 
     static const uint8_t _n_device_desc;
     static SPIDesc _device[];
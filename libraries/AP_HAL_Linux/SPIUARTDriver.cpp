@@ -136,6 +136,16 @@ int SPIUARTDriver::_read_fd(uint8_t *buf, uint16_t n)
     return n;
 }
 
+int SPIUARTDriver::_poll_fd()
+{
+    /* SPI transfers can only be done periodically */
+    if (!_external) {
+        return -1;
+    }
+
+    return UARTDriver::_poll_fd();
+}
+
 void SPIUARTDriver::_timer_tick(void)
 {
     if (_external) {
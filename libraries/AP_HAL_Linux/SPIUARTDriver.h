@@ -15,6 +15,7 @@ public:
 protected:
     int _write_fd(const uint8_t *buf, uint16_t n);
     int _read_fd(uint8_t *buf, uint16_t n);
+    int _poll_fd() override;
 
     AP_HAL::OwnPtr<AP_HAL::SPIDevice> _dev;
 
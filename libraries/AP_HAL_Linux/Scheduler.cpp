@@ -19,6 +19,10 @@
 #include "UARTDriver.h"
 #include "Util.h"
 
+#if HAL_WITH_UAVCAN
+#include <AP_UAVCAN/AP_UAVCAN.h>
+#endif
+
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_QFLIGHT
 #include <rpcmem.h>
 #include <AP_HAL_Linux/qflight/qflight_util.h>
@@ -36,6 +40,7 @@ extern const AP_HAL::HAL& hal;
 #define APM_LINUX_MAIN_PRIORITY         12
 #define APM_LINUX_TONEALARM_PRIORITY    11
 #define APM_LINUX_IO_PRIORITY           10
+#define APM_LINUX_UAVCAN_PRIORITY       11
 
 #define APM_LINUX_TIMER_RATE            1000
 #define APM_LINUX_UART_RATE             100
@@ -385,6 +390,33 @@ void Scheduler::_run_uarts()
     UARTDriver::from(hal.uartF)->_timer_tick();
 }
 
+/*
+  service all UARTs from the UART thread, returning true if any of them
+  needs to be serviced again after the periodic timeout
+ */
+bool Scheduler::_poll_uarts(Poller &poller)
+{
+    bool periodic = false;
+
+#if !HAL_LINUX_UARTS_ON_TIMER_THREAD
+    periodic |= UARTDriver::from(hal.uartA)->_poll_tick(poller);
+    periodic |= UARTDriver::from(hal.uartB)->_poll_tick(poller);
+#if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_RASPILOT
+    //SPI UART not use SPI
+    if (RPIOUARTDriver::from(hal.uartC)->isExternal()) {
+        periodic |= RPIOUARTDriver::from(hal.uartC)->_poll_tick(poller);
+    }
+#else
+    periodic |= UARTDriver::from(hal.uartC)->_poll_tick(poller);
+#endif
+    periodic |= UARTDriver::from(hal.uartD)->_poll_tick(poller);
+    periodic |= UARTDriver::from(hal.uartE)->_poll_tick(poller);
+    periodic |= UARTDriver::from(hal.uartF)->_poll_tick(poller);
+#endif
+
+    return periodic;
+}
+
 void Scheduler::_rcin_task()
 {
 #if !HAL_LINUX_UARTS_ON_TIMER_THREAD
@@ -466,6 +498,100 @@ bool Scheduler::SchedulerThread::_run()
     return PeriodicThread::_run();
 }
 
+bool Scheduler::UARTThread::_run()
+{
+    _sched._wait_all_threads();
+
+    if (!_poller) {
+        // no epoll: fall back to servicing all UARTs at a fixed rate
+        return PeriodicThread::_run();
+    }
+
+    _perf_wakeups = hal.util->perf_alloc(AP_HAL::Util::PC_COUNT, "UART_wakeups");
+
+    /*
+      sleep until a device has data, a UART wakes us up to write, or
+      the periodic timeout expires if any UART still needs it
+     */
+    int timeout_ms = 0;
+    while (!_should_exit) {
+        _poller.poll(timeout_ms);
+        hal.util->perf_count(_perf_wakeups);
+
+        if (_sched._poll_uarts(_poller)) {
+            timeout_ms = _period_usec / 1000;
+        } else {
+            timeout_ms = -1;
+        }
+    }
+
+    _started = false;
+    _should_exit = false;
+
+    return true;
+}
+
+bool Scheduler::UARTThread::stop()
+{
+    if (!is_started()) {
+        return false;
+    }
+
+    _should_exit = true;
+    _poller.wakeup();
+
+    return true;
+}
+
+void Scheduler::_uavcan_task()
+{
+#if HAL_WITH_UAVCAN
+    AP_UAVCAN *uavcan = hal.can_mgr->get_UAVCAN();
+    if (!_initialized || !hal.can_mgr->is_initialized() || uavcan == nullptr) {
+        microsleep(10000);
+        return;
+    }
+    uavcan->do_cyclic();
+#endif
+}
+
+#if HAL_WITH_UAVCAN
+bool Scheduler::UAVCANThread::_run()
+{
+    while (!_should_exit) {
+        _task();
+    }
+
+    _started = false;
+    _should_exit = false;
+
+    return true;
+}
+
+bool Scheduler::UAVCANThread::stop()
+{
+    if (!is_started()) {
+        return false;
+    }
+
+    // do_cyclic() wakes up at least every millisecond to see this
+    _should_exit = true;
+
+    return true;
+}
+#endif
+
+void Scheduler::create_uavcan_thread()
+{
+#if HAL_WITH_UAVCAN
+    if (_uavcan_thread.is_started()) {
+        return;
+    }
+    _uavcan_thread.set_stack_size(1024 * 1024);
+    _uavcan_thread.start("ap-uavcan", SCHED_FIFO, APM_LINUX_UAVCAN_PRIORITY);
+#endif
+}
+
 void Scheduler::teardown()
 {
     _timer_thread.stop();
@@ -473,10 +599,16 @@ void Scheduler::teardown()
     _rcin_thread.stop();
     _uart_thread.stop();
     _tonealarm_thread.stop();
+#if HAL_WITH_UAVCAN
+    _uavcan_thread.stop();
+#endif
 
     _timer_thread.join();
     _io_thread.join();
     _rcin_thread.join();
     _uart_thread.join();
     _tonealarm_thread.join();
+#if HAL_WITH_UAVCAN
+    _uavcan_thread.join();
+#endif
 }
@@ -3,6 +3,7 @@
 #include <pthread.h>
 
 #include "AP_HAL_Linux.h"
+#include "Poller.h"
 #include "Semaphores.h"
 #include "Thread.h"
 
@@ -52,6 +53,8 @@ public:
 
     void teardown();
 
+    void create_uavcan_thread() override;
+
 private:
     class SchedulerThread : public PeriodicThread {
     public:
@@ -66,6 +69,44 @@ private:
         Scheduler &_sched;
     };
 
+    /*
+     * Services the UARTs as their devices become ready and as data is
+     * queued for them, falling back to the thread's rate for the ones
+     * that can't be polled
+     */
+    class UARTThread : public SchedulerThread {
+    public:
+        UARTThread(Scheduler &sched)
+            : SchedulerThread(FUNCTOR_BIND(&sched, &Scheduler::_uart_task, void), sched)
+        { }
+
+        bool stop() override;
+
+    protected:
+        bool _run() override;
+
+        Poller _poller{};
+        AP_HAL::Util::perf_counter_t _perf_wakeups;
+    };
+
+#if HAL_WITH_UAVCAN
+    /*
+     * Runs UAVCAN, which sleeps on the CAN sockets between spins. It
+     * starts once CAN is set up, after the other threads
+     */
+    class UAVCANThread : public Thread {
+    public:
+        UAVCANThread(Scheduler &sched)
+            : Thread(FUNCTOR_BIND(&sched, &Scheduler::_uavcan_task, void))
+        { }
+
+        bool stop() override;
+
+    protected:
+        bool _run() override;
+    };
+#endif
+
     void _wait_all_threads();
 
     void     _debug_stack();
@@ -98,17 +139,22 @@ private:
     SchedulerThread _timer_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_timer_task, void), *this};
     SchedulerThread _io_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_io_task, void), *this};
     SchedulerThread _rcin_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_rcin_task, void), *this};
-    SchedulerThread _uart_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_uart_task, void), *this};
+    UARTThread _uart_thread{*this};
     SchedulerThread _tonealarm_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_tonealarm_task, void), *this};
+#if HAL_WITH_UAVCAN
+    UAVCANThread _uavcan_thread{*this};
+#endif
 
     void _timer_task();
     void _io_task();
     void _rcin_task();
     void _uart_task();
     void _tonealarm_task();
+    void _uavcan_task();
 
     void _run_io();
     void _run_uarts();
+    bool _poll_uarts(Poller &poller);
     bool _register_timesliced_proc(AP_HAL::MemberProc, uint8_t);
 
     uint64_t _stopped_clock_usec;
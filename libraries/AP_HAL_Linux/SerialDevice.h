@@ -15,6 +15,12 @@ public:
     virtual ssize_t read(uint8_t *buf, uint16_t n) = 0;
     virtual void set_blocking(bool blocking) = 0;
     virtual void set_speed(uint32_t speed) = 0;
+
+    /*
+     * File descriptor signalling incoming data, to be waited on with a
+     * Poller. Devices returning -1 are serviced periodically instead.
+     */
+    virtual int get_fd() const { return -1; }
     virtual AP_HAL::UARTDriver::flow_control get_flow_control(void) { return AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE; }
     virtual void set_flow_control(AP_HAL::UARTDriver::flow_control flow_control_setting)
     {
@@ -47,7 +47,7 @@ ssize_t TCPServerDevice::read(uint8_t *buf, uint16_t n)
     if (sock == nullptr) {
         return -1;
     }
-    ssize_t ret = sock->recv(buf, n, 1);
+    ssize_t ret = sock->recv(buf, n, 0);
     if (ret == 0) {
         // EOF, go back to waiting for a new connection
         delete sock;
@@ -118,3 +118,15 @@ void TCPServerDevice::set_blocking(bool blocking)
 void TCPServerDevice::set_speed(uint32_t speed)
 {
 }
+
+/*
+  wait on the listening socket for a new connection until a client is
+  connected
+ */
+int TCPServerDevice::get_fd() const
+{
+    if (sock != nullptr) {
+        return sock->get_fd();
+    }
+    return listener.get_fd();
+}
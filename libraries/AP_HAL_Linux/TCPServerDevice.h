@@ -12,6 +12,7 @@ public:
     virtual bool close() override;
     virtual void set_blocking(bool blocking) override;
     virtual void set_speed(uint32_t speed) override;
+    virtual int get_fd() const override;
     virtual ssize_t write(const uint8_t *buf, uint16_t n) override;
     virtual ssize_t read(uint8_t *buf, uint16_t n) override;
 
@@ -100,6 +100,11 @@ void UARTDevice::_disable_crlf()
     tcsetattr(_fd, TCSANOW, &t);
 }
 
+int UARTDevice::get_fd() const
+{
+    return _fd;
+}
+
 void UARTDevice::set_speed(uint32_t baudrate)
 {
     struct termios t;
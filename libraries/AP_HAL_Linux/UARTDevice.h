@@ -14,6 +14,7 @@ public:
     virtual ssize_t read(uint8_t *buf, uint16_t n) override;
     virtual void set_blocking(bool blocking) override;
     virtual void set_speed(uint32_t speed) override;
+    virtual int get_fd() const override;
     virtual void set_flow_control(enum AP_HAL::UARTDriver::flow_control flow_control_setting) override;
     virtual AP_HAL::UARTDriver::flow_control get_flow_control(void) override
     {
@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
@@ -88,6 +89,10 @@ void UARTDriver::begin(uint32_t b, uint16_t rxS, uint16_t txS)
     _device->set_speed(b);
 
     _allocate_buffers(rxS, txS);
+
+    // the device may have been reopened: have the UART thread pick it up
+    _reregister = true;
+    _wakeup_poller();
 }
 
 void UARTDriver::_allocate_buffers(uint16_t rxS, uint16_t txS)
@@ -282,6 +287,34 @@ int16_t UARTDriver::read()
     return byte;
 }
 
+uint32_t UARTDriver::read(uint8_t *buffer, uint32_t count)
+{
+    if (!_initialised) {
+        return 0;
+    }
+
+    return _readbuf.read(buffer, count);
+}
+
+const uint8_t *UARTDriver::peek_span(uint32_t &len)
+{
+    if (!_initialised) {
+        len = 0;
+        return nullptr;
+    }
+
+    return _readbuf.readptr(len);
+}
+
+bool UARTDriver::consume(uint32_t len)
+{
+    if (!_initialised) {
+        return false;
+    }
+
+    return _readbuf.advance(len);
+}
+
 /* Linux implementations of Print virtual methods */
 size_t UARTDriver::write(uint8_t c)
 {
@@ -295,7 +328,9 @@ size_t UARTDriver::write(uint8_t c)
         }
         hal.scheduler->delay(1);
     }
-    return _writebuf.write(&c, 1);
+    size_t ret = _writebuf.write(&c, 1);
+    _wakeup_poller();
+    return ret;
 }
 
 /*
@@ -308,17 +343,33 @@ size_t UARTDriver::write(const uint8_t *buffer, size_t size)
     }
     if (!_nonblocking_writes) {
         /*
-          use the per-byte delay loop in write() above for blocking writes
+          copy as much as fits in the write buffer at a time, waiting
+          for the timer to drain it in between
          */
-        size_t ret = 0;
-        while (size--) {
-            if (write(*buffer++) != 1) break;
-            ret++;
+        size_t ret = _writebuf.write(buffer, size);
+        _wakeup_poller();
+        while (ret < size) {
+            hal.scheduler->delay(1);
+            ret += _writebuf.write(buffer + ret, size - ret);
+            _wakeup_poller();
         }
         return ret;
     }
 
-    return _writebuf.write(buffer, size);
+    size_t ret = _writebuf.write(buffer, size);
+    _wakeup_poller();
+    return ret;
+}
+
+/*
+  wake up the UART thread to push out newly queued data. This is done
+  once until the thread runs, so a burst of writes costs a single wakeup
+ */
+void UARTDriver::_wakeup_poller()
+{
+    if (_poller != nullptr && !_write_pending.exchange(true)) {
+        _poller->wakeup();
+    }
 }
 
 /*
@@ -479,3 +530,93 @@ void UARTDriver::_timer_tick(void)
 
     _in_timer = false;
 }
+
+/*
+  read from the device until it has no more data or the read buffer is
+  full, as needed for edge triggered polling. Returns false in the latter
+  case, the rest being read once the buffer is drained
+ */
+bool UARTDriver::_fill_read_buffer()
+{
+    for (;;) {
+        ByteBuffer::IoVec vec[2];
+
+        /* read into the first iovec only, as datagrams may come short */
+        if (_readbuf.reserve(vec, _readbuf.space()) == 0) {
+            return false;
+        }
+
+        int ret = _read_fd(vec[0].data, vec[0].len);
+        if (ret <= 0) {
+            return true;
+        }
+        _readbuf.commit((unsigned)ret);
+    }
+}
+
+/*
+  follow the device's file descriptor, which changes as TCP clients
+  come and go, and register it again after begin() as the device may
+  have been closed and reopened with the same descriptor. Returns true
+  if the descriptor was registered anew
+ */
+bool UARTDriver::_update_pollable(Poller &poller)
+{
+    int fd = _poll_fd();
+    if (fd == _pollable.get_fd() && !_reregister) {
+        return false;
+    }
+    _reregister = false;
+    if (_pollable_registered) {
+        poller.unregister_pollable(&_pollable);
+    }
+    _pollable.set_fd(fd);
+    _pollable_registered = fd >= 0 &&
+        poller.register_pollable(&_pollable, EPOLLIN | EPOLLET);
+
+    // pick up anything received before registering
+    _read_pending = true;
+    return _pollable_registered;
+}
+
+bool UARTDriver::_poll_tick(Poller &poller)
+{
+    _poller = &poller;
+
+    if (!_initialised) {
+        return false;
+    }
+
+    _in_timer = true;
+
+    _update_pollable(poller);
+
+    if (!_pollable_registered) {
+        _in_timer = false;
+        _timer_tick();
+        return true;
+    }
+
+    // clear first so data queued while writing wakes us up again. The
+    // number of writes is bounded so a fast peer can't keep us here,
+    // anything left is sent after the periodic timeout
+    _write_pending = false;
+    uint8_t num_send = 10;
+    while (num_send != 0 && _write_pending_bytes()) {
+        num_send--;
+    }
+
+    if (_read_pending) {
+        _read_pending = !_fill_read_buffer();
+
+        // reading may have accepted a TCP client: register it now, as
+        // nothing would wake us up for data it sent before that
+        if (_update_pollable(poller)) {
+            _read_pending = !_fill_read_buffer();
+        }
+    }
+
+    _in_timer = false;
+
+    return _read_pending || _writebuf.available() > 0;
+}
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <atomic>
+
 #include <AP_HAL/utility/OwnPtr.h>
 #include <AP_HAL/utility/RingBuffer.h>
 
 #include "AP_HAL_Linux.h"
+#include "Poller.h"
 #include "SerialDevice.h"
 
 namespace Linux {
@@ -29,6 +32,9 @@ public:
     uint32_t available() override;
     uint32_t txspace() override;
     int16_t read() override;
+    uint32_t read(uint8_t *buffer, uint32_t count) override;
+    const uint8_t *peek_span(uint32_t &len) override;
+    bool consume(uint32_t len) override;
 
     /* Linux implementations of Print virtual methods */
     size_t write(uint8_t c);
@@ -39,6 +45,15 @@ public:
     bool _write_pending_bytes(void);
     virtual void _timer_tick(void);
 
+    /*
+     * Service the port from the UART thread: the device is registered
+     * with @poller so it's read as soon as data arrives, and data queued
+     * with write() is pushed out when the thread is woken up. Returns
+     * true if the port can't be polled or has pending work, and needs to
+     * be called again after the periodic timeout.
+     */
+    bool _poll_tick(Poller &poller);
+
     virtual enum flow_control get_flow_control(void) override
     {
         return _device->get_flow_control();
@@ -50,6 +65,23 @@ public:
    }
 
 private:
+    /*
+     * Pollable watching the device's file descriptor. The descriptor is
+     * owned by the device, so it must not be closed here.
+     */
+    class DevicePollable : public Pollable {
+    public:
+        DevicePollable(UARTDriver &uart) : _uart(uart) { }
+        ~DevicePollable() { _fd = -1; }
+
+        void set_fd(int fd) { _fd = fd; }
+
+        void on_can_read() override { _uart._read_pending = true; }
+
+    private:
+        UARTDriver &_uart;
+    };
+
     AP_HAL::OwnPtr<SerialDevice> _device;
     bool _nonblocking_writes;
     bool _console;
@@ -66,6 +98,17 @@ private:
     AP_HAL::OwnPtr<SerialDevice> _parseDevicePath(const char *arg);
     uint64_t _last_write_time;
 
+    bool _fill_read_buffer();
+    bool _update_pollable(Poller &poller);
+    void _wakeup_poller();
+
+    DevicePollable _pollable{*this};
+    Poller *_poller = nullptr;
+    bool _pollable_registered = false;
+    volatile bool _reregister = false;
+    bool _read_pending = false;
+    std::atomic<bool> _write_pending{false};
+
 protected:
     const char *device_path;
     volatile bool _initialised;
@@ -77,6 +120,9 @@ protected:
 
     virtual int _write_fd(const uint8_t *buf, uint16_t n);
     virtual int _read_fd(uint8_t *buf, uint16_t n);
+
+    /* file descriptor to poll for incoming data, -1 to be serviced periodically */
+    virtual int _poll_fd() { return _device->get_fd(); }
 };
 
 }
@@ -74,3 +74,8 @@ void UDPDevice::set_speed(uint32_t speed)
 {
 
 }
+
+int UDPDevice::get_fd() const
+{
+    return socket.get_fd();
+}
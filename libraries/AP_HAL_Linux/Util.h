@@ -3,8 +3,10 @@
 #include <AP_Common/AP_Common.h>
 #include <AP_HAL/AP_HAL.h>
 
+#include <AP_HAL/utility/PerfRegistry.h>
+
 #include "Heat.h"
-#include "Perf.h"
+#include "Perf_Lttng.h"
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_RASPILOT
 #include "ToneAlarm_Raspilot.h"
 #elif CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_DISCO
@@ -75,22 +77,49 @@ public:
 
     perf_counter_t perf_alloc(enum perf_counter_type t, const char *name) override
     {
-        return Perf::get_instance()->add(t, name);
+        return PerfRegistry::get_instance()->add(t, name);
     }
 
     void perf_begin(perf_counter_t perf) override
     {
-        return Perf::get_instance()->begin(perf);
+        PerfRegistry *registry = PerfRegistry::get_instance();
+        registry->begin(perf);
+        Perf_Lttng::begin(registry->name(perf));
     }
 
     void perf_end(perf_counter_t perf) override
     {
-        return Perf::get_instance()->end(perf);
+        PerfRegistry *registry = PerfRegistry::get_instance();
+        registry->end(perf);
+        Perf_Lttng::end(registry->name(perf));
     }
 
+    // each event is traced as a count of one, the totals are in the registry
     void perf_count(perf_counter_t perf) override
     {
-        return Perf::get_instance()->count(perf);
+        PerfRegistry *registry = PerfRegistry::get_instance();
+        registry->count(perf);
+        Perf_Lttng::count(registry->name(perf), 1);
+    }
+
+    uint16_t perf_num_counters(void) override
+    {
+        return PerfRegistry::get_instance()->num_counters();
+    }
+
+    bool perf_get_info(uint16_t index, perf_info &info) override
+    {
+        return PerfRegistry::get_instance()->get_info(index, info);
+    }
+
+    uint32_t perf_dropped(void) override
+    {
+        return PerfRegistry::get_instance()->dropped();
+    }
+
+    void trace_latency(const char *name, uint32_t latency_us) override
+    {
+        Perf_Lttng::latency(name, latency_us);
     }
 
     // create a new semaphore
@@ -264,10 +264,10 @@ void VideoIn::shrink_8bpp(uint8_t *buffer, uint8_t *new_buffer,
 
     /* selection offset */
     block_y = top * width;
-    block_position = left + block_y;
 
     for (i = 0; i < out_height; i++) {
         block_x = left;
+        block_position = block_x + block_y;
         for (j = 0; j < out_width; j++) {
             px = 0;
 
@@ -318,6 +318,49 @@ void VideoIn::yuyv_to_grey(uint8_t *buffer, uint32_t buffer_size,
     }
 }
 
+void VideoIn::yuyv_to_grey_shrink(const uint8_t *buffer, uint8_t *new_buffer,
+                                  uint32_t width, uint32_t left,
+                                  uint32_t selection_width, uint32_t top,
+                                  uint32_t selection_height,
+                                  uint32_t fx, uint32_t fy)
+{
+    uint32_t out_width = selection_width / fx;
+    uint32_t out_height = selection_height / fy;
+    uint32_t fx_fy = fx * fy;
+    /* 2 bytes per pixel, the luma being the first one */
+    uint32_t stride = width * 2;
+    const uint8_t *row = buffer + top * stride + left * 2;
+
+    if (fx_fy == 1) {
+        for (uint32_t i = 0; i < out_height; i++) {
+            for (uint32_t j = 0; j < out_width; j++) {
+                new_buffer[j] = row[j * 2];
+            }
+            row += stride;
+            new_buffer += out_width;
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < out_height; i++) {
+        for (uint32_t j = 0; j < out_width; j++) {
+            const uint8_t *block = row + j * fx * 2;
+            uint32_t px = 0;
+
+            for (uint32_t k = 0; k < fy; k++) {
+                for (uint32_t kk = 0; kk < fx; kk++) {
+                    px += block[kk * 2];
+                }
+                block += stride;
+            }
+
+            new_buffer[j] = px / fx_fy;
+        }
+        row += stride * fy;
+        new_buffer += out_width;
+    }
+}
+
 uint32_t VideoIn::_timeval_to_us(struct timeval& tv)
 {
     return (1.0e6 * tv.tv_sec + tv.tv_usec);
@@ -66,6 +66,15 @@ public:
     static void yuyv_to_grey(uint8_t *buffer, uint32_t buffer_size,
                              uint8_t *new_buffer);
 
+    /* Equivalent to yuyv_to_grey() followed by shrink_8bpp(), in a single
+     * pass and without an intermediate buffer. With fx and fy equal to 1
+     * this is a crop. */
+    static void yuyv_to_grey_shrink(const uint8_t *buffer, uint8_t *new_buffer,
+                                    uint32_t width, uint32_t left,
+                                    uint32_t selection_width, uint32_t top,
+                                    uint32_t selection_height,
+                                    uint32_t fx, uint32_t fy);
+
 private:
     void _queue_buffer(int index);
     bool _set_streaming(bool enable);
@@ -4,6 +4,7 @@
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BEBOP ||\
     CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_MINLURE
 
+#include <AP_HAL_Linux/Flow_PX4.h>
 #include <AP_HAL_Linux/VideoIn.h>
 
 static void BM_Crop8bpp(benchmark::State& state)
@@ -62,6 +63,197 @@ static void BM_YuyvToGrey(benchmark::State& state)
 }
 
 BENCHMARK(BM_YuyvToGrey)->Arg(64 * 64)->Arg(320 * 240)->Arg(640 * 480);
+
+/* 640x480 YUYV frame to a 64x64 grey image, either cropped (scale 1) or
+ * shrunk (scale 7) as done by OpticalFlow_Onboard */
+#define YUYV_WIDTH 640
+#define YUYV_HEIGHT 480
+#define GREY_OUTPUT_SIZE 64
+
+static void BM_YuyvToGreyShrink(benchmark::State& state)
+{
+    uint8_t *buffer, *new_buffer;
+    uint32_t scale = state.range_x();
+    uint32_t selection = GREY_OUTPUT_SIZE * scale;
+
+    buffer = (uint8_t *)malloc(YUYV_WIDTH * YUYV_HEIGHT * 2);
+    if (!buffer) {
+        fprintf(stderr, "error: couldn't malloc buffer\n");
+        return;
+    }
+
+    new_buffer = (uint8_t *)malloc(GREY_OUTPUT_SIZE * GREY_OUTPUT_SIZE);
+    if (!new_buffer) {
+        fprintf(stderr, "error: couldn't malloc new_buffer\n");
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        Linux::VideoIn::yuyv_to_grey_shrink(buffer, new_buffer, YUYV_WIDTH,
+            (YUYV_WIDTH - selection) / 2, selection,
+            (YUYV_HEIGHT - selection) / 2, selection, scale, scale);
+    }
+
+    free(buffer);
+    free(new_buffer);
+}
+
+BENCHMARK(BM_YuyvToGreyShrink)->Arg(1)->Arg(7);
+
+/* same as BM_YuyvToGreyShrink in two passes, for comparison */
+static void BM_YuyvToGreyThenShrink(benchmark::State& state)
+{
+    uint8_t *buffer, *grey_buffer, *new_buffer;
+    uint32_t scale = state.range_x();
+    uint32_t selection = GREY_OUTPUT_SIZE * scale;
+
+    buffer = (uint8_t *)malloc(YUYV_WIDTH * YUYV_HEIGHT * 2);
+    if (!buffer) {
+        fprintf(stderr, "error: couldn't malloc buffer\n");
+        return;
+    }
+
+    grey_buffer = (uint8_t *)malloc(YUYV_WIDTH * YUYV_HEIGHT);
+    if (!grey_buffer) {
+        fprintf(stderr, "error: couldn't malloc grey_buffer\n");
+        return;
+    }
+
+    new_buffer = (uint8_t *)malloc(GREY_OUTPUT_SIZE * GREY_OUTPUT_SIZE);
+    if (!new_buffer) {
+        fprintf(stderr, "error: couldn't malloc new_buffer\n");
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        Linux::VideoIn::yuyv_to_grey(buffer, YUYV_WIDTH * YUYV_HEIGHT * 2,
+                                     grey_buffer);
+        Linux::VideoIn::shrink_8bpp(grey_buffer, new_buffer, YUYV_WIDTH,
+            YUYV_HEIGHT, (YUYV_WIDTH - selection) / 2, selection,
+            (YUYV_HEIGHT - selection) / 2, selection, scale, scale);
+    }
+
+    free(buffer);
+    free(grey_buffer);
+    free(new_buffer);
+}
+
+BENCHMARK(BM_YuyvToGreyThenShrink)->Arg(1)->Arg(7);
+
+/* 64x64 images and a search size of 4 pixels, as used by OpticalFlow_Onboard */
+#define FLOW_IMAGE_SIZE 64
+#define FLOW_SEARCH_SIZE 4
+#define FLOW_FEATURE_THRESHOLD 30
+#define FLOW_VALUE_THRESHOLD 5000
+
+static void fill_random(uint8_t *buffer, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; i++) {
+        buffer[i] = rand();
+    }
+}
+
+static void BM_FlowComputeDiff(benchmark::State& state)
+{
+    uint8_t image[FLOW_IMAGE_SIZE * FLOW_IMAGE_SIZE];
+    uint32_t acc;
+
+    fill_random(image, sizeof(image));
+
+    while (state.KeepRunning()) {
+        if (state.range_x()) {
+            acc = Linux::Flow_PX4::compute_diff(image, 20, 20, FLOW_IMAGE_SIZE,
+                                                FLOW_SEARCH_SIZE);
+        } else {
+            acc = Linux::Flow_PX4::compute_diff_scalar(image, 20, 20,
+                                                       FLOW_IMAGE_SIZE,
+                                                       FLOW_SEARCH_SIZE);
+        }
+        gbenchmark_escape(&acc);
+    }
+}
+
+BENCHMARK(BM_FlowComputeDiff)->Arg(0)->Arg(1);
+
+static void BM_FlowComputeSad(benchmark::State& state)
+{
+    uint8_t image1[FLOW_IMAGE_SIZE * FLOW_IMAGE_SIZE];
+    uint8_t image2[FLOW_IMAGE_SIZE * FLOW_IMAGE_SIZE];
+    uint32_t acc;
+
+    fill_random(image1, sizeof(image1));
+    fill_random(image2, sizeof(image2));
+
+    while (state.KeepRunning()) {
+        if (state.range_x()) {
+            acc = Linux::Flow_PX4::compute_sad(image1, image2, 20, 20, 21, 19,
+                                               FLOW_IMAGE_SIZE,
+                                               2 * FLOW_SEARCH_SIZE);
+        } else {
+            acc = Linux::Flow_PX4::compute_sad_scalar(image1, image2,
+                                                      20, 20, 21, 19,
+                                                      FLOW_IMAGE_SIZE,
+                                                      2 * FLOW_SEARCH_SIZE);
+        }
+        gbenchmark_escape(&acc);
+    }
+}
+
+BENCHMARK(BM_FlowComputeSad)->Arg(0)->Arg(1);
+
+static void BM_FlowComputeSubpixel(benchmark::State& state)
+{
+    uint8_t image1[FLOW_IMAGE_SIZE * FLOW_IMAGE_SIZE];
+    uint8_t image2[FLOW_IMAGE_SIZE * FLOW_IMAGE_SIZE];
+    uint32_t acc[2 * FLOW_SEARCH_SIZE];
+
+    fill_random(image1, sizeof(image1));
+    fill_random(image2, sizeof(image2));
+
+    while (state.KeepRunning()) {
+        if (state.range_x()) {
+            Linux::Flow_PX4::compute_subpixel(image1, image2, 20, 20, 21, 19,
+                                              acc, FLOW_IMAGE_SIZE,
+                                              2 * FLOW_SEARCH_SIZE);
+        } else {
+            Linux::Flow_PX4::compute_subpixel_scalar(image1, image2,
+                                                     20, 20, 21, 19,
+                                                     acc, FLOW_IMAGE_SIZE,
+                                                     2 * FLOW_SEARCH_SIZE);
+        }
+        gbenchmark_escape(acc);
+    }
+}
+
+BENCHMARK(BM_FlowComputeSubpixel)->Arg(0)->Arg(1);
+
+static void BM_FlowComputeFlow(benchmark::State& state)
+{
+    uint8_t image1[FLOW_IMAGE_SIZE * FLOW_IMAGE_SIZE];
+    uint8_t image2[FLOW_IMAGE_SIZE * FLOW_IMAGE_SIZE];
+    float flow_x, flow_y;
+    uint8_t qual;
+
+    fill_random(image1, sizeof(image1));
+    /* image2 is image1 moved by (1, 2) pixels */
+    for (uint32_t y = 0; y < FLOW_IMAGE_SIZE; y++) {
+        for (uint32_t x = 0; x < FLOW_IMAGE_SIZE; x++) {
+            image2[y * FLOW_IMAGE_SIZE + x] =
+                image1[((y + 2) % FLOW_IMAGE_SIZE) * FLOW_IMAGE_SIZE +
+                       (x + 1) % FLOW_IMAGE_SIZE];
+        }
+    }
+
+    Linux::Flow_PX4 flow(FLOW_IMAGE_SIZE, FLOW_IMAGE_SIZE, FLOW_SEARCH_SIZE,
+                         FLOW_FEATURE_THRESHOLD, FLOW_VALUE_THRESHOLD);
+
+    while (state.KeepRunning()) {
+        qual = flow.compute_flow(image1, image2, 0, &flow_x, &flow_y);
+        gbenchmark_escape(&qual);
+    }
+}
+
+BENCHMARK(BM_FlowComputeFlow);
 #endif
 
 BENCHMARK_MAIN()
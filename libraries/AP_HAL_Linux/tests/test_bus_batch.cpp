@@ -0,0 +1,351 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#ifndef I2C_SMBUS_BLOCK_MAX
+#include <linux/i2c.h>
+#endif
+#include <linux/spi/spidev.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/I2CDevice.h>
+#include <AP_HAL_Linux/SPIDevice.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+ * Userspace stand-in for spidev and i2c-dev: open() and ioctl() are
+ * replaced so the devices of the test bus are backed by a register file.
+ * Writes set the register pointer to their first byte and store the rest,
+ * reads return the registers from the pointer on.
+ */
+static struct {
+    int spi_fd = -1;
+    int i2c_fd = -1;
+    uint8_t regs[256];
+    uint8_t ptr;
+    uint8_t spi_mode;
+    unsigned spi_messages;
+    unsigned spi_mode_reads;
+    unsigned spi_cs_changes;
+    unsigned i2c_rdwr;
+    unsigned i2c_messages;
+    unsigned fail;
+} fake;
+
+static void fake_write(const uint8_t *buf, uint32_t len)
+{
+    if (len == 0) {
+        return;
+    }
+    fake.ptr = buf[0];
+    for (uint32_t i = 1; i < len; i++) {
+        fake.regs[fake.ptr++] = buf[i];
+    }
+}
+
+static void fake_read(uint8_t *buf, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        buf[i] = fake.regs[fake.ptr++];
+    }
+}
+
+static int fake_spi_ioctl(unsigned long request, void *arg)
+{
+    if (request == SPI_IOC_RD_MODE) {
+        fake.spi_mode_reads++;
+        *(uint8_t *)arg = fake.spi_mode;
+        return 0;
+    }
+    if (request == SPI_IOC_WR_MODE) {
+        fake.spi_mode = *(uint8_t *)arg;
+        return 0;
+    }
+    if (_IOC_TYPE(request) != SPI_IOC_MAGIC || _IOC_NR(request) != 0) {
+        errno = ENOTTY;
+        return -1;
+    }
+
+    struct spi_ioc_transfer *msgs = (struct spi_ioc_transfer *)arg;
+    unsigned n = _IOC_SIZE(request) / sizeof(*msgs);
+    fake.spi_messages++;
+    for (unsigned i = 0; i < n; i++) {
+        if (msgs[i].tx_buf) {
+            fake_write((const uint8_t *)(uintptr_t)msgs[i].tx_buf, msgs[i].len);
+        }
+        if (msgs[i].rx_buf) {
+            fake_read((uint8_t *)(uintptr_t)msgs[i].rx_buf, msgs[i].len);
+        }
+        if (msgs[i].cs_change) {
+            fake.spi_cs_changes++;
+        }
+    }
+    return 0;
+}
+
+static int fake_i2c_ioctl(unsigned long request, void *arg)
+{
+    if (request != I2C_RDWR) {
+        errno = ENOTTY;
+        return -1;
+    }
+
+    fake.i2c_rdwr++;
+    if (fake.fail > 0) {
+        fake.fail--;
+        errno = EIO;
+        return -1;
+    }
+
+    struct i2c_rdwr_ioctl_data *data = (struct i2c_rdwr_ioctl_data *)arg;
+    if (data->nmsgs > I2C_RDRW_IOCTL_MAX_MSGS) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (unsigned i = 0; i < data->nmsgs; i++) {
+        if (data->msgs[i].flags & I2C_M_RD) {
+            fake_read(data->msgs[i].buf, data->msgs[i].len);
+        } else {
+            fake_write(data->msgs[i].buf, data->msgs[i].len);
+        }
+    }
+    fake.i2c_messages += data->nmsgs;
+    return data->nmsgs;
+}
+
+extern "C" int open(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+    if (flags & O_CREAT) {
+        va_list ap;
+        va_start(ap, flags);
+        mode = va_arg(ap, int);
+        va_end(ap);
+    }
+
+    if (strcmp(path, "/dev/spidev9.0") == 0) {
+        fake.spi_fd = syscall(SYS_openat, AT_FDCWD, "/dev/null", flags);
+        return fake.spi_fd;
+    }
+    if (strcmp(path, "/dev/i2c-7") == 0) {
+        fake.i2c_fd = syscall(SYS_openat, AT_FDCWD, "/dev/null", flags);
+        return fake.i2c_fd;
+    }
+    return syscall(SYS_openat, AT_FDCWD, path, flags, mode);
+}
+
+extern "C" int ioctl(int fd, unsigned long request, ...) __THROW
+{
+    va_list ap;
+    va_start(ap, request);
+    void *arg = va_arg(ap, void *);
+    va_end(ap);
+
+    if (fd >= 0 && fd == fake.spi_fd) {
+        return fake_spi_ioctl(request, arg);
+    }
+    if (fd >= 0 && fd == fake.i2c_fd) {
+        return fake_i2c_ioctl(request, arg);
+    }
+    return syscall(SYS_ioctl, fd, request, arg);
+}
+
+class LinuxBusBatch : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        for (unsigned i = 0; i < sizeof(fake.regs); i++) {
+            fake.regs[i] = i ^ 0xa5;
+        }
+        fake.ptr = 0;
+        fake.spi_messages = 0;
+        fake.spi_mode_reads = 0;
+        fake.spi_cs_changes = 0;
+        fake.i2c_rdwr = 0;
+        fake.i2c_messages = 0;
+        fake.fail = 0;
+    }
+};
+
+TEST_F(LinuxBusBatch, i2c_single_ioctl)
+{
+    auto dev = hal.i2c_mgr->get_device(7, 0x42);
+    ASSERT_TRUE(dev);
+
+    uint8_t regs[3] = { 0x10, 0x20, 0x30 };
+    uint8_t val[3][2];
+    const uint8_t write[2] = { 0x40, 0x99 };
+    const AP_HAL::Device::Transfer transfers[] = {
+        { &regs[0], 1, val[0], 2 },
+        { write, sizeof(write), nullptr, 0 },
+        { &regs[1], 1, val[1], 2 },
+        { &regs[2], 1, val[2], 2 },
+    };
+
+    ASSERT_TRUE(dev->transfer_batch(transfers, ARRAY_SIZE(transfers)));
+    EXPECT_EQ(1U, fake.i2c_rdwr);
+    EXPECT_EQ(7U, fake.i2c_messages);
+    EXPECT_EQ(0x99, fake.regs[0x40]);
+    for (uint8_t i = 0; i < 3; i++) {
+        EXPECT_EQ(regs[i] ^ 0xa5, val[i][0]);
+        EXPECT_EQ((regs[i] + 1) ^ 0xa5, val[i][1]);
+    }
+
+    BusStats stats = I2CDevice::from(dev.get())->get_bus_stats();
+    EXPECT_EQ(1U, stats.syscalls);
+    EXPECT_EQ(7U, stats.messages);
+    EXPECT_EQ(11U, stats.bytes);
+    EXPECT_EQ(0U, stats.errors);
+}
+
+TEST_F(LinuxBusBatch, i2c_chunks)
+{
+    auto dev = hal.i2c_mgr->get_device(7, 0x42);
+    ASSERT_TRUE(dev);
+
+    // 30 register reads take 60 messages: one transfer can't be split
+    // between calls, so they go in 21 + 9
+    uint8_t regs[30];
+    uint8_t val[30];
+    AP_HAL::Device::Transfer transfers[30];
+    for (uint8_t i = 0; i < 30; i++) {
+        regs[i] = i * 3;
+        transfers[i] = { &regs[i], 1, &val[i], 1 };
+    }
+
+    ASSERT_TRUE(dev->transfer_batch(transfers, ARRAY_SIZE(transfers)));
+    EXPECT_EQ(2U, fake.i2c_rdwr);
+    EXPECT_EQ(60U, fake.i2c_messages);
+    for (uint8_t i = 0; i < 30; i++) {
+        EXPECT_EQ(regs[i] ^ 0xa5, val[i]);
+    }
+}
+
+TEST_F(LinuxBusBatch, i2c_split_transfers)
+{
+    auto dev = hal.i2c_mgr->get_device(7, 0x42);
+    ASSERT_TRUE(dev);
+    dev->set_split_transfers(true);
+
+    uint8_t reg = 0x10;
+    uint8_t val[2];
+    const AP_HAL::Device::Transfer transfers[] = {
+        { &reg, 1, &val[0], 1 },
+        { &reg, 1, &val[1], 1 },
+    };
+
+    ASSERT_TRUE(dev->transfer_batch(transfers, ARRAY_SIZE(transfers)));
+    EXPECT_EQ(4U, fake.i2c_rdwr);
+    EXPECT_EQ(0x10 ^ 0xa5, val[0]);
+    EXPECT_EQ(0x10 ^ 0xa5, val[1]);
+}
+
+TEST_F(LinuxBusBatch, i2c_retries)
+{
+    auto dev = hal.i2c_mgr->get_device(7, 0x42);
+    ASSERT_TRUE(dev);
+
+    uint8_t reg = 0x10;
+    uint8_t val;
+    const AP_HAL::Device::Transfer transfers[] = {
+        { &reg, 1, &val, 1 },
+        { nullptr, 0, nullptr, 0 },
+    };
+
+    // nothing to do in a transfer is an error, as in transfer()
+    EXPECT_FALSE(dev->transfer_batch(transfers, ARRAY_SIZE(transfers)));
+    EXPECT_EQ(0U, fake.i2c_rdwr);
+
+    fake.fail = 2;
+    EXPECT_FALSE(dev->transfer_batch(transfers, 1));
+    dev->set_retries(1);
+    fake.fail = 1;
+    EXPECT_TRUE(dev->transfer_batch(transfers, 1));
+    EXPECT_EQ(3U, fake.i2c_rdwr);
+
+    BusStats stats = I2CDevice::from(dev.get())->get_bus_stats();
+    EXPECT_EQ(3U, stats.syscalls);
+    EXPECT_EQ(2U, stats.errors);
+}
+
+// test device on spidev9.0, out of the way of the board's own devices
+static SPIDesc spi_test_desc("test", 9, 0, SPI_MODE_3, 8, SPI_CS_KERNEL, 1000000, 1000000);
+
+TEST_F(LinuxBusBatch, spi_single_ioctl)
+{
+    auto dev = SPIDeviceManager::from(hal.spi)->get_device(spi_test_desc);
+    ASSERT_TRUE(dev);
+
+    uint8_t regs[3] = { 0x10, 0x20, 0x30 };
+    uint8_t val[3];
+    const AP_HAL::Device::Transfer transfers[] = {
+        { &regs[0], 1, &val[0], 1 },
+        { &regs[1], 1, &val[1], 1 },
+        { &regs[2], 1, &val[2], 1 },
+    };
+
+    ASSERT_TRUE(dev->transfer_batch(transfers, ARRAY_SIZE(transfers)));
+    EXPECT_EQ(1U, fake.spi_messages);
+    // chip select released between transfers, not after the last one
+    EXPECT_EQ(2U, fake.spi_cs_changes);
+    for (uint8_t i = 0; i < 3; i++) {
+        EXPECT_EQ(regs[i] ^ 0xa5, val[i]);
+    }
+}
+
+TEST_F(LinuxBusBatch, spi_mode_cache)
+{
+    auto dev = SPIDeviceManager::from(hal.spi)->get_device(spi_test_desc);
+    ASSERT_TRUE(dev);
+
+    uint8_t reg = 0x10;
+    uint8_t val;
+
+    // the mode is only set once and not read back
+    fake.spi_mode = SPI_MODE_0;
+    ASSERT_TRUE(dev->read_registers(reg, &val, 1));
+    EXPECT_EQ(SPI_MODE_3, fake.spi_mode);
+    ASSERT_TRUE(dev->read_registers(reg, &val, 1));
+    EXPECT_EQ(0U, fake.spi_mode_reads);
+
+    BusStats before = SPIDevice::from(dev.get())->get_bus_stats();
+    ASSERT_TRUE(dev->read_registers(reg, &val, 1));
+    BusStats after = SPIDevice::from(dev.get())->get_bus_stats();
+    EXPECT_EQ(1U, after.syscalls - before.syscalls);
+    EXPECT_EQ(2U, after.messages - before.messages);
+    EXPECT_EQ(2U, after.bytes - before.bytes);
+
+    // with the check enabled a mode changed by someone else is noticed
+    // and set again
+    SPIDeviceManager::from(hal.spi)->set_mode_check(true);
+    fake.spi_mode = SPI_MODE_0;
+    ASSERT_TRUE(dev->read_registers(reg, &val, 1));
+    EXPECT_EQ(1U, fake.spi_mode_reads);
+    EXPECT_EQ(SPI_MODE_3, fake.spi_mode);
+    SPIDeviceManager::from(hal.spi)->set_mode_check(false);
+}
+
+AP_GTEST_MAIN()
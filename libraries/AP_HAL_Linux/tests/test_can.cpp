@@ -0,0 +1,316 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ * The driver is given one end of a socketpair, with the test standing
+ * in for the other nodes on the bus at the other end. Filters are
+ * applied by the kernel's CAN layer, so they are tested on a virtual
+ * CAN interface when there is one:
+ *
+ *   ip link add dev can0 type vcan && ip link set up can0
+ *
+ * The tests are only built when configured with --enable-uavcan.
+ */
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if HAL_WITH_UAVCAN
+
+#include <net/if.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/can.h>
+#include <linux/can/error.h>
+#include <linux/can/raw.h>
+
+#include <AP_HAL_Linux/CAN.h>
+
+using namespace Linux;
+
+class LinuxCAN : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        int sv[2];
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sv));
+        peer_fd = sv[1];
+        ASSERT_TRUE(mgr.begin_with_sockets(&sv[0], 1));
+        iface = mgr.getIface(0);
+        ASSERT_NE(nullptr, iface);
+    }
+
+    void TearDown() override
+    {
+        if (peer_fd >= 0) {
+            close(peer_fd);
+        }
+    }
+
+    void peer_write(const struct can_frame &cf)
+    {
+        ASSERT_EQ((ssize_t)sizeof(cf), write(peer_fd, &cf, sizeof(cf)));
+    }
+
+    void peer_send(uint32_t id, uint8_t byte)
+    {
+        struct can_frame cf;
+        memset(&cf, 0, sizeof(cf));
+        cf.can_id = id | CAN_EFF_FLAG;
+        cf.can_dlc = 1;
+        cf.data[0] = byte;
+        peer_write(cf);
+    }
+
+    bool peer_receive(struct can_frame &cf, int timeout_ms = 100)
+    {
+        struct pollfd pfd = { peer_fd, POLLIN, 0 };
+        if (poll(&pfd, 1, timeout_ms) != 1) {
+            return false;
+        }
+        return read(peer_fd, &cf, sizeof(cf)) == sizeof(cf);
+    }
+
+    // one spin of the select() loop libuavcan runs, waiting to read
+    uavcan::CanSelectMasks select(uint32_t timeout_ms)
+    {
+        uavcan::CanSelectMasks masks;
+        masks.read = 1;
+        const uavcan::CanFrame *pending_tx[uavcan::MaxCanIfaces] = { };
+        EXPECT_GE(mgr.select(masks, pending_tx, deadline_in(timeout_ms)), 0);
+        return masks;
+    }
+
+    static uavcan::CanFrame make_frame(uint32_t id, uint8_t byte)
+    {
+        return uavcan::CanFrame(id | uavcan::CanFrame::FlagEFF, &byte, 1);
+    }
+
+    static uavcan::MonotonicTime deadline_in(uint32_t ms)
+    {
+        return uavcan::MonotonicTime::fromUSec(AP_HAL::micros64() + ms * 1000);
+    }
+
+    static uint64_t utc_usec()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+    }
+
+    CANManager mgr;
+    CAN *iface;
+    int peer_fd = -1;
+};
+
+TEST_F(LinuxCAN, receive_more_than_a_batch)
+{
+    const unsigned count = LINUX_CAN_BATCH_SIZE + 8;
+    for (unsigned i = 0; i < count; i++) {
+        peer_send(0x1000 + i, i);
+    }
+
+    const uint64_t before_utc_us = utc_usec();
+    uint64_t last_us = 0;
+    for (unsigned i = 0; i < count; i++) {
+        if (iface->available() == 0) {
+            EXPECT_EQ(1, select(100).read);
+        }
+
+        uavcan::CanFrame frame;
+        uavcan::MonotonicTime ts_mono;
+        uavcan::UtcTime ts_utc;
+        uavcan::CanIOFlags flags;
+        ASSERT_EQ(1, iface->receive(frame, ts_mono, ts_utc, flags));
+        EXPECT_EQ((0x1000 + i) | uavcan::CanFrame::FlagEFF, frame.id);
+        EXPECT_EQ(i, frame.data[0]);
+        EXPECT_EQ(0, flags);
+        EXPECT_GE(ts_mono.toUSec(), last_us);
+        EXPECT_LE(ts_mono.toUSec(), AP_HAL::micros64());
+        EXPECT_GE(ts_utc.toUSec(), before_utc_us);
+        EXPECT_LE(ts_utc.toUSec(), utc_usec());
+        last_us = ts_mono.toUSec();
+    }
+    EXPECT_EQ(0, iface->available());
+}
+
+TEST_F(LinuxCAN, send_in_priority_order)
+{
+    EXPECT_EQ(1, iface->send(make_frame(0x300, 3), deadline_in(100), 0));
+    EXPECT_EQ(1, iface->send(make_frame(0x100, 1), deadline_in(100), 0));
+    EXPECT_EQ(1, iface->send(make_frame(0x200, 2), deadline_in(100), 0));
+    EXPECT_EQ(3, iface->tx_pending());
+
+    // the queue is written on the next spin
+    select(0);
+    EXPECT_EQ(0, iface->tx_pending());
+
+    struct can_frame cf;
+    for (uint8_t i = 1; i <= 3; i++) {
+        ASSERT_TRUE(peer_receive(cf));
+        EXPECT_EQ((0x100U * i) | CAN_EFF_FLAG, cf.can_id);
+        EXPECT_EQ(i, cf.data[0]);
+    }
+}
+
+TEST_F(LinuxCAN, loopback)
+{
+    const uint64_t before_us = AP_HAL::micros64();
+    EXPECT_EQ(1, iface->send(make_frame(0x123, 7), deadline_in(100), uavcan::CanIOFlagLoopback));
+    EXPECT_EQ(1, select(100).read);
+
+    uavcan::CanFrame frame;
+    uavcan::MonotonicTime ts_mono;
+    uavcan::UtcTime ts_utc;
+    uavcan::CanIOFlags flags;
+    ASSERT_EQ(1, iface->receive(frame, ts_mono, ts_utc, flags));
+    EXPECT_TRUE(make_frame(0x123, 7) == frame);
+    EXPECT_EQ(uavcan::CanIOFlagLoopback, flags);
+    EXPECT_GE(ts_mono.toUSec(), before_us);
+
+    struct can_frame cf;
+    EXPECT_TRUE(peer_receive(cf));
+}
+
+TEST_F(LinuxCAN, expired_frames_dropped)
+{
+    EXPECT_EQ(1, iface->send(make_frame(0x123, 7),
+                             uavcan::MonotonicTime::fromUSec(AP_HAL::micros64() - 1), 0));
+    select(0);
+    EXPECT_EQ(0, iface->tx_pending());
+    EXPECT_EQ(1U, iface->getErrorCount());
+
+    struct can_frame cf;
+    EXPECT_FALSE(peer_receive(cf, 10));
+}
+
+TEST_F(LinuxCAN, full_queue_refuses_until_flushed)
+{
+    for (unsigned i = 0; i < LINUX_CAN_TX_QUEUE_SIZE; i++) {
+        EXPECT_EQ(1, iface->send(make_frame(0x100 + i, i), deadline_in(100), 0));
+    }
+    EXPECT_EQ(0, iface->send(make_frame(0x100, 0), deadline_in(100), 0));
+
+    // the next spin empties the queue and offers to write again
+    uavcan::CanSelectMasks masks;
+    masks.write = 1;
+    const uavcan::CanFrame frame = make_frame(0x100, 0);
+    const uavcan::CanFrame *pending_tx[uavcan::MaxCanIfaces] = { &frame };
+    mgr.select(masks, pending_tx, deadline_in(0));
+    EXPECT_EQ(1, masks.write);
+    EXPECT_EQ(0, iface->tx_pending());
+}
+
+TEST_F(LinuxCAN, error_frame_aborts_queued_frames)
+{
+    EXPECT_EQ(1, iface->send(make_frame(0x100, 1), deadline_in(100), uavcan::CanIOFlagAbortOnError));
+    EXPECT_EQ(1, iface->send(make_frame(0x200, 2), deadline_in(100), 0));
+
+    struct can_frame err;
+    memset(&err, 0, sizeof(err));
+    err.can_id = CAN_ERR_FLAG | CAN_ERR_BUSERROR;
+    err.can_dlc = CAN_ERR_DLC;
+    peer_write(err);
+
+    // read the error before the queue is next written
+    iface->drain_rx();
+    EXPECT_EQ(1, iface->tx_pending());
+    EXPECT_EQ(0, iface->available());
+    EXPECT_EQ(1U, iface->getErrorCount());
+
+    select(0);
+    struct can_frame cf;
+    ASSERT_TRUE(peer_receive(cf));
+    EXPECT_EQ(0x200U | CAN_EFF_FLAG, cf.can_id);
+    EXPECT_FALSE(peer_receive(cf, 10));
+}
+
+/*
+ * the same on a CAN interface, with a raw socket as the peer
+ */
+class LinuxCANBus : public LinuxCAN {
+protected:
+    void SetUp() override
+    {
+        peer_fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+        if (peer_fd < 0) {
+            return;
+        }
+
+        struct ifreq ifr;
+        memset(&ifr, 0, sizeof(ifr));
+        strncpy(ifr.ifr_name, HAL_LINUX_CAN_IFACE_PREFIX "0", IFNAMSIZ - 1);
+        struct sockaddr_can addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.can_family = AF_CAN;
+        if (ioctl(peer_fd, SIOCGIFINDEX, &ifr) < 0 ||
+            (addr.can_ifindex = ifr.ifr_ifindex,
+             bind(peer_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)) {
+            close(peer_fd);
+            peer_fd = -1;
+            return;
+        }
+
+        ASSERT_TRUE(mgr.begin(1000000, 1));
+        iface = mgr.getIface(0);
+        ASSERT_NE(nullptr, iface);
+    }
+
+    bool have_bus() const
+    {
+        if (peer_fd < 0) {
+            printf("no " HAL_LINUX_CAN_IFACE_PREFIX "0 interface, skipped\n");
+            return false;
+        }
+        return true;
+    }
+};
+
+TEST_F(LinuxCANBus, filters)
+{
+    if (!have_bus()) {
+#ifdef GTEST_SKIP
+        GTEST_SKIP();
+#endif
+        return;
+    }
+
+    uavcan::CanFilterConfig filter;
+    filter.id = 0x500 | uavcan::CanFrame::FlagEFF;
+    filter.mask = uavcan::CanFrame::MaskExtID | uavcan::CanFrame::FlagEFF;
+    ASSERT_EQ(0, iface->configureFilters(&filter, 1));
+
+    peer_send(0x400, 1);
+    peer_send(0x500, 2);
+    EXPECT_EQ(1, select(100).read);
+
+    uavcan::CanFrame frame;
+    uavcan::MonotonicTime ts_mono;
+    uavcan::UtcTime ts_utc;
+    uavcan::CanIOFlags flags;
+    ASSERT_EQ(1, iface->receive(frame, ts_mono, ts_utc, flags));
+    EXPECT_EQ(0x500 | uavcan::CanFrame::FlagEFF, frame.id);
+    EXPECT_EQ(0, iface->receive(frame, ts_mono, ts_utc, flags));
+}
+
+#endif
+
+AP_GTEST_MAIN()
@@ -0,0 +1,125 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <stdlib.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BEBOP ||\
+    CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_MINLURE
+
+#include <AP_HAL_Linux/Flow_PX4.h>
+
+using namespace Linux;
+
+#define IMAGE_SIZE 64
+#define SEARCH_SIZE 4
+
+class FlowPX4Test : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        srand(42);
+        for (unsigned int i = 0; i < sizeof(image1); i++) {
+            image1[i] = rand();
+            /* mostly similar images, as seen between two frames */
+            image2[i] = image1[i] + rand() % 7 - 3;
+        }
+    }
+
+    uint8_t image1[IMAGE_SIZE * IMAGE_SIZE];
+    uint8_t image2[IMAGE_SIZE * IMAGE_SIZE];
+};
+
+/* leave room for the search window and the subpixel neighbours */
+#define FOR_EACH_BLOCK(x, y) \
+    for (uint16_t y = SEARCH_SIZE + 1; y < IMAGE_SIZE - 3 * SEARCH_SIZE - 1; y++) \
+        for (uint16_t x = SEARCH_SIZE + 1; x < IMAGE_SIZE - 3 * SEARCH_SIZE - 1; x++)
+
+TEST_F(FlowPX4Test, ComputeDiff)
+{
+    FOR_EACH_BLOCK(x, y) {
+        EXPECT_EQ(Flow_PX4::compute_diff_scalar(image1, x, y, IMAGE_SIZE, SEARCH_SIZE),
+                  Flow_PX4::compute_diff(image1, x, y, IMAGE_SIZE, SEARCH_SIZE));
+    }
+}
+
+TEST_F(FlowPX4Test, ComputeSad)
+{
+    FOR_EACH_BLOCK(x, y) {
+        for (int dy = -SEARCH_SIZE; dy <= SEARCH_SIZE; dy++) {
+            for (int dx = -SEARCH_SIZE; dx <= SEARCH_SIZE; dx++) {
+                EXPECT_EQ(Flow_PX4::compute_sad_scalar(image1, image2, x, y,
+                                                       x + dx, y + dy,
+                                                       IMAGE_SIZE,
+                                                       2 * SEARCH_SIZE),
+                          Flow_PX4::compute_sad(image1, image2, x, y,
+                                                x + dx, y + dy, IMAGE_SIZE,
+                                                2 * SEARCH_SIZE));
+            }
+        }
+    }
+}
+
+TEST_F(FlowPX4Test, ComputeSubpixel)
+{
+    uint32_t expected[2 * SEARCH_SIZE];
+    uint32_t acc[2 * SEARCH_SIZE];
+
+    FOR_EACH_BLOCK(x, y) {
+        Flow_PX4::compute_subpixel_scalar(image1, image2, x, y, x + 1, y - 1,
+                                          expected, IMAGE_SIZE,
+                                          2 * SEARCH_SIZE);
+        Flow_PX4::compute_subpixel(image1, image2, x, y, x + 1, y - 1,
+                                   acc, IMAGE_SIZE, 2 * SEARCH_SIZE);
+        for (unsigned int k = 0; k < 2 * SEARCH_SIZE; k++) {
+            EXPECT_EQ(expected[k], acc[k]);
+        }
+    }
+}
+
+TEST(FlowPX4, ComputeFlow)
+{
+    uint8_t image1[IMAGE_SIZE * IMAGE_SIZE];
+    uint8_t image2[IMAGE_SIZE * IMAGE_SIZE];
+    float flow_x, flow_y;
+
+    srand(42);
+    for (unsigned int i = 0; i < sizeof(image1); i++) {
+        image1[i] = rand();
+    }
+
+    /* image2 is image1 moved by (-1, -2) pixels */
+    for (unsigned int y = 0; y < IMAGE_SIZE; y++) {
+        for (unsigned int x = 0; x < IMAGE_SIZE; x++) {
+            image2[y * IMAGE_SIZE + x] =
+                image1[((y + 2) % IMAGE_SIZE) * IMAGE_SIZE + (x + 1) % IMAGE_SIZE];
+        }
+    }
+
+    Flow_PX4 flow(IMAGE_SIZE, IMAGE_SIZE, SEARCH_SIZE, 30, 5000);
+    uint8_t qual = flow.compute_flow(image1, image2, 0, &flow_x, &flow_y);
+
+    EXPECT_EQ(255, qual);
+    EXPECT_FLOAT_EQ(-1.0f, flow_x);
+    EXPECT_FLOAT_EQ(-2.0f, flow_y);
+}
+
+#endif
+
+AP_GTEST_MAIN()
@@ -0,0 +1,97 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/Poller.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+class PipePollable : public Pollable {
+public:
+    PipePollable(int fd) : Pollable(fd) { }
+
+    void on_can_read() override { n_read++; }
+
+    int n_read = 0;
+};
+
+class LinuxPoller : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        int fds[2];
+        ASSERT_EQ(0, pipe2(fds, O_NONBLOCK | O_CLOEXEC));
+        rd = new PipePollable(fds[0]);
+        wr_fd = fds[1];
+        ASSERT_TRUE((bool)poller);
+    }
+
+    void TearDown() override
+    {
+        poller.unregister_pollable(rd);
+        delete rd;
+        close(wr_fd);
+    }
+
+    Poller poller;
+    PipePollable *rd;
+    int wr_fd;
+};
+
+TEST_F(LinuxPoller, timeout)
+{
+    ASSERT_TRUE(poller.register_pollable(rd, EPOLLIN));
+
+    EXPECT_EQ(0, poller.poll(0));
+    EXPECT_EQ(0, poller.poll(10));
+    EXPECT_EQ(0, rd->n_read);
+}
+
+TEST_F(LinuxPoller, wakeup)
+{
+    ASSERT_TRUE(poller.register_pollable(rd, EPOLLIN));
+
+    poller.wakeup();
+    EXPECT_EQ(1, poller.poll());
+    EXPECT_EQ(0, rd->n_read);
+}
+
+TEST_F(LinuxPoller, edge_triggered)
+{
+    const uint8_t c = 0x55;
+
+    ASSERT_TRUE(poller.register_pollable(rd, EPOLLIN | EPOLLET));
+
+    ASSERT_EQ(1, write(wr_fd, &c, 1));
+    EXPECT_EQ(1, poller.poll(10));
+    EXPECT_EQ(1, rd->n_read);
+
+    // data not read: no new edge until more arrives
+    EXPECT_EQ(0, poller.poll(0));
+    EXPECT_EQ(1, rd->n_read);
+
+    ASSERT_EQ(1, write(wr_fd, &c, 1));
+    EXPECT_EQ(1, poller.poll(10));
+    EXPECT_EQ(2, rd->n_read);
+}
+
+AP_GTEST_MAIN()
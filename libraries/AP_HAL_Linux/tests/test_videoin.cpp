@@ -0,0 +1,81 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <stdlib.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BEBOP ||\
+    CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_MINLURE
+
+#include <AP_HAL_Linux/VideoIn.h>
+
+using namespace Linux;
+
+#define WIDTH 160
+#define HEIGHT 120
+#define OUTPUT_SIZE 32
+
+struct ShrinkParams {
+    uint32_t scale;
+};
+
+class YuyvToGreyShrinkTest : public ::testing::TestWithParam<ShrinkParams> {};
+
+TEST_P(YuyvToGreyShrinkTest, SameAsTwoPasses)
+{
+    static uint8_t yuyv[WIDTH * HEIGHT * 2];
+    static uint8_t grey[WIDTH * HEIGHT];
+    uint8_t expected[OUTPUT_SIZE * OUTPUT_SIZE];
+    uint8_t output[OUTPUT_SIZE * OUTPUT_SIZE];
+    uint32_t scale = GetParam().scale;
+    uint32_t selection = OUTPUT_SIZE * scale;
+    uint32_t left = (WIDTH - selection) / 2;
+    uint32_t top = (HEIGHT - selection) / 2;
+
+    srand(42);
+    for (unsigned int i = 0; i < sizeof(yuyv); i++) {
+        yuyv[i] = rand();
+    }
+
+    VideoIn::yuyv_to_grey(yuyv, sizeof(yuyv), grey);
+    VideoIn::shrink_8bpp(grey, expected, WIDTH, HEIGHT, left, selection,
+                         top, selection, scale, scale);
+
+    VideoIn::yuyv_to_grey_shrink(yuyv, output, WIDTH, left, selection,
+                                 top, selection, scale, scale);
+
+    for (unsigned int i = 0; i < sizeof(output); i++) {
+        EXPECT_EQ(expected[i], output[i]) << "at pixel " << i;
+    }
+}
+
+AP_GTEST_PRINTATBLE_PARAM_MEMBER(ShrinkParams, scale);
+
+static ShrinkParams shrink_params[] = {
+    { 1 },
+    { 2 },
+    { 3 },
+};
+
+INSTANTIATE_TEST_CASE_P(Scales, YuyvToGreyShrinkTest,
+                        ::testing::ValuesIn(shrink_params));
+
+#endif
+
+AP_GTEST_MAIN()
@@ -259,6 +259,21 @@ int16_t PX4UARTDriver::read()
     return byte;
 }
 
+uint32_t PX4UARTDriver::read(uint8_t *buffer, uint32_t count)
+{
+#if UART_CHECK_PID
+    if (_uart_owner_pid != getpid()){
+        return 0;
+    }
+#endif
+    if (!_initialised) {
+        try_initialise();
+        return 0;
+    }
+
+    return _readbuf.read(buffer, count);
+}
+
 /*
    write one byte to the buffer
  */
@@ -27,6 +27,7 @@
 #include <SITL/SIM_Calibration.h>
 #include <SITL/SIM_XPlane.h>
 #include <SITL/SIM_Submarine.h>
+#include <SITL/SIM_SHM.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -109,6 +110,7 @@ static const struct {
     { "plane",              Plane::create },
     { "calibration",        Calibration::create },
     { "vectored",           Submarine::create },
+    { "shm",                SHM::create },
 };
 
 void SITL_State::_set_signal_handlers(void) const
@@ -131,6 +131,28 @@ int16_t UARTDriver::read(void)
     return c;
 }
 
+uint32_t UARTDriver::read(uint8_t *buffer, uint32_t count)
+{
+    if (available() <= 0) {
+        return 0;
+    }
+    return _readbuffer.read(buffer, count);
+}
+
+const uint8_t *UARTDriver::peek_span(uint32_t &len)
+{
+    if (available() <= 0) {
+        len = 0;
+        return nullptr;
+    }
+    return _readbuffer.readptr(len);
+}
+
+bool UARTDriver::consume(uint32_t len)
+{
+    return _readbuffer.advance(len);
+}
+
 void UARTDriver::flush(void)
 {
 }
@@ -49,6 +49,9 @@ public:
     uint32_t available() override;
     uint32_t txspace() override;
     int16_t read() override;
+    uint32_t read(uint8_t *buffer, uint32_t count) override;
+    const uint8_t *peek_span(uint32_t &len) override;
+    bool consume(uint32_t len) override;
 
     /* Implementations of Print virtual methods */
     size_t write(uint8_t c);
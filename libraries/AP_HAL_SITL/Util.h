@@ -1,6 +1,7 @@
 #pragma once
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/PerfRegistry.h>
 #include "AP_HAL_SITL_Namespace.h"
 #include "Semaphores.h"
 
@@ -21,6 +22,22 @@ public:
         return 0x20000;
     }
 
+    perf_counter_t perf_alloc(enum perf_counter_type t, const char *name) override {
+        return PerfRegistry::get_instance()->add(t, name);
+    }
+    void perf_begin(perf_counter_t perf) override { PerfRegistry::get_instance()->begin(perf); }
+    void perf_end(perf_counter_t perf) override { PerfRegistry::get_instance()->end(perf); }
+    void perf_count(perf_counter_t perf) override { PerfRegistry::get_instance()->count(perf); }
+    uint16_t perf_num_counters(void) override {
+        return PerfRegistry::get_instance()->num_counters();
+    }
+    bool perf_get_info(uint16_t index, perf_info &info) override {
+        return PerfRegistry::get_instance()->get_info(index, info);
+    }
+    uint32_t perf_dropped(void) override {
+        return PerfRegistry::get_instance()->dropped();
+    }
+
     // create a new semaphore
     AP_HAL::Semaphore *new_semaphore(void) override { return new HALSITL::Semaphore; }
 
@@ -9,6 +9,7 @@
 #include <AP_Vehicle/AP_Vehicle.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
 #include <AP_AHRS/AP_AHRS.h>
+#include <AP_Scheduler/LatencyTrace.h>
 
 #include "AP_InertialSensor.h"
 #include "AP_InertialSensor_BMI160.h"
@@ -486,6 +487,10 @@ AP_InertialSensor::AP_InertialSensor() :
 
         _accel_startup_error_count[i] = 0;
         _gyro_startup_error_count[i] = 0;
+
+        // no valid source, so the first update builds the transforms
+        _accel_transform_source[i].orientation = ROTATION_MAX;
+        _gyro_transform_source[i].orientation = ROTATION_MAX;
     }
     for (uint8_t i=0; i<INS_VIBRATION_CHECK_INSTANCES; i++) {
         _accel_vibe_floor_filter[i].set_cutoff_frequency(AP_INERTIAL_SENSOR_ACCEL_VIBE_FLOOR_FILT_HZ);
@@ -493,6 +498,8 @@ AP_InertialSensor::AP_InertialSensor() :
     }
     memset(_delta_velocity_valid,0,sizeof(_delta_velocity_valid));
     memset(_delta_angle_valid,0,sizeof(_delta_angle_valid));
+    memset(_gyro_raw_landed_us,0,sizeof(_gyro_raw_landed_us));
+    memset(_gyro_landed_us,0,sizeof(_gyro_landed_us));
 
     AP_AccelCal::register_client(this);
 }
@@ -538,6 +545,9 @@ uint8_t AP_InertialSensor::register_gyro(uint16_t raw_sample_rate_hz,
     }
 #endif
 
+    // so the first samples are rotated and corrected
+    _update_gyro_transform(_gyro_count);
+
     return _gyro_count++;
 }
 
@@ -575,6 +585,9 @@ uint8_t AP_InertialSensor::register_accel(uint16_t raw_sample_rate_hz,
         _accel_id[_accel_count].save();
 #endif
 
+    // so the first samples are rotated and corrected
+    _update_accel_transform(_accel_count);
+
     return _accel_count++;
 }
 
@@ -1176,6 +1189,48 @@ void AP_InertialSensor::_save_gyro_calibration()
 }
 
 
+/*
+  rebuild the transform of a sensor if its orientation or calibration
+  has changed. Parameters can be changed from anywhere, so this
+  compares against what the transform was built from rather than
+  relying on being told. Called when the sensor is registered, then by
+  its backend holding its semaphore. Returns true if it was rebuilt
+ */
+bool AP_InertialSensor::_update_accel_transform(uint8_t instance)
+{
+    const transform_source source {
+        _accel_orientation[instance], _board_orientation,
+        _accel_offset[instance].get(), _accel_scale[instance].get()
+    };
+    if (source == _accel_transform_source[instance]) {
+        return false;
+    }
+    // accel calibration is done after the sensor is rotated to the
+    // board, and before the board is rotated to the vehicle
+    _accel_transform[instance] = Affine3f::rotation(source.board_orientation) *
+        Affine3f::scale(source.scale) *
+        Affine3f::translation(-source.offset) *
+        Affine3f::rotation(source.orientation);
+    _accel_transform_source[instance] = source;
+    return true;
+}
+
+bool AP_InertialSensor::_update_gyro_transform(uint8_t instance)
+{
+    const transform_source source {
+        _gyro_orientation[instance], _board_orientation,
+        _gyro_offset[instance].get(), Vector3f(1,1,1)
+    };
+    if (source == _gyro_transform_source[instance]) {
+        return false;
+    }
+    _gyro_transform[instance] = Affine3f::rotation(source.board_orientation) *
+        Affine3f::translation(-source.offset) *
+        Affine3f::rotation(source.orientation);
+    _gyro_transform_source[instance] = source;
+    return true;
+}
+
 /*
   update gyro and accel values from backends
  */
@@ -1270,6 +1325,12 @@ void AP_InertialSensor::update(void)
 
     // apply notch filter to primary gyro
     _gyro[_primary_gyro] = _notch_filter.apply(_gyro[_primary_gyro]);
+
+    // trace this loop from the primary gyro's newest sample
+    LatencyTrace *trace = LatencyTrace::get_instance();
+    if (trace != nullptr && !_hil_mode) {
+        trace->imu_sample(_gyro_landed_us[_primary_gyro]);
+    }
     
     _last_update_usec = AP_HAL::micros();
     
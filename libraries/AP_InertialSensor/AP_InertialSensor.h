@@ -21,7 +21,7 @@
 #include <AP_AccelCal/AP_AccelCal.h>
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
-#include <Filter/LowPassFilter2p.h>
+#include <Filter/BiquadFilterBank.h>
 #include <Filter/LowPassFilter.h>
 #include <Filter/NotchFilter.h>
 
@@ -312,9 +312,10 @@ private:
     // time accumulator for delta velocity accumulator
     float _delta_velocity_acc_dt[INS_MAX_INSTANCES];
 
-    // Low Pass filters for gyro and accel
-    LowPassFilter2pVector3f _accel_filter[INS_MAX_INSTANCES];
-    LowPassFilter2pVector3f _gyro_filter[INS_MAX_INSTANCES];
+    // Low Pass filters for gyro and accel, filtering the three axes of
+    // an instance together
+    BiquadFilterBank<3, 1> _accel_filter[INS_MAX_INSTANCES];
+    BiquadFilterBank<3, 1> _gyro_filter[INS_MAX_INSTANCES];
     Vector3f _accel_filtered[INS_MAX_INSTANCES];
     Vector3f _gyro_filtered[INS_MAX_INSTANCES];
     bool _new_accel_data[INS_MAX_INSTANCES];
@@ -366,6 +367,12 @@ private:
     uint64_t _accel_last_sample_us[INS_MAX_INSTANCES];
     uint64_t _gyro_last_sample_us[INS_MAX_INSTANCES];
 
+    // AP_HAL::micros() when the newest raw gyro sample reached the
+    // frontend, and the same for the samples last published, for
+    // LatencyTrace
+    uint32_t _gyro_raw_landed_us[INS_MAX_INSTANCES];
+    uint32_t _gyro_landed_us[INS_MAX_INSTANCES];
+
     // sample times for checking real sensor rate for FIFO sensors
     uint16_t _sample_accel_count[INS_MAX_INSTANCES];
     uint32_t _sample_accel_start_us[INS_MAX_INSTANCES];
@@ -393,6 +400,33 @@ private:
     enum Rotation _gyro_orientation[INS_MAX_INSTANCES];
     enum Rotation _accel_orientation[INS_MAX_INSTANCES];
 
+    // the orientations and calibration of each sensor composed into
+    // the one transform backends apply to every sample. After
+    // registration each is only touched with the semaphore of the
+    // sensor's backend held
+    Affine3f _accel_transform[INS_MAX_INSTANCES];
+    Affine3f _gyro_transform[INS_MAX_INSTANCES];
+
+    // what each transform was last built from
+    struct transform_source {
+        enum Rotation orientation;
+        enum Rotation board_orientation;
+        Vector3f offset;
+        Vector3f scale;
+
+        bool operator ==(const transform_source &s) const {
+            return orientation == s.orientation &&
+                board_orientation == s.board_orientation &&
+                offset == s.offset && scale == s.scale;
+        }
+    };
+    transform_source _accel_transform_source[INS_MAX_INSTANCES];
+    transform_source _gyro_transform_source[INS_MAX_INSTANCES];
+
+    // rebuild the transform of a sensor if its source has changed
+    bool _update_accel_transform(uint8_t instance);
+    bool _update_gyro_transform(uint8_t instance);
+
     // calibrated_ok/id_ok flags
     bool _gyro_cal_ok[INS_MAX_INSTANCES];
     bool _accel_id_ok[INS_MAX_INSTANCES];
@@ -13,6 +13,12 @@ AP_InertialSensor_Backend::AP_InertialSensor_Backend(AP_InertialSensor &imu) :
     _imu(imu)
 {
     _sem = hal.util->new_semaphore();
+
+    // pick up the transforms built when the sensors are registered
+    for (uint8_t i=0; i<INS_MAX_INSTANCES; i++) {
+        _accel_transform_changed[i] = true;
+        _gyro_transform_changed[i] = true;
+    }
 }
 
 /*
@@ -52,14 +58,14 @@ void AP_InertialSensor_Backend::_set_gyro_oversampling(uint8_t instance, uint8_t
   sensor may vary slightly from the system clock. This slowly adjusts
   the rate to the observed rate
 */
-void AP_InertialSensor_Backend::_update_sensor_rate(uint16_t &count, uint32_t &start_us, float &rate_hz)
+void AP_InertialSensor_Backend::_update_sensor_rate(uint16_t &count, uint32_t &start_us, float &rate_hz, uint16_t n)
 {
     uint32_t now = AP_HAL::micros();
     if (start_us == 0) {
-        count = 0;
+        count = n - 1;
         start_us = now;
     } else {
-        count++;
+        count += n;
         if (now - start_us > 1000000UL) {
             float observed_rate_hz = count * 1.0e6 / (now - start_us);
 #if SENSOR_RATE_DEBUG
@@ -82,39 +88,32 @@ void AP_InertialSensor_Backend::_update_sensor_rate(uint16_t &count, uint32_t &s
     }
 }
 
-void AP_InertialSensor_Backend::_rotate_and_correct_accel(uint8_t instance, Vector3f &accel) 
+/*
+  the transforms are applied from our copies, which only the thread
+  reading the sensor touches. update_accel() and update_gyro() rebuild
+  the frontend's transforms from the frontend's thread, so a new one is
+  copied under the semaphore, which is only taken when one has changed
+ */
+void AP_InertialSensor_Backend::_rotate_and_correct_accel(uint8_t instance, Vector3f *accel, uint16_t n)
 {
-    /*
-      accel calibration is always done in sensor frame with this
-      version of the code. That means we apply the rotation after the
-      offsets and scaling.
-     */
-
-    // rotate for sensor orientation
-    accel.rotate(_imu._accel_orientation[instance]);
-    
-    // apply offsets
-    accel -= _imu._accel_offset[instance];
-
-    // apply scaling
-    const Vector3f &accel_scale = _imu._accel_scale[instance].get();
-    accel.x *= accel_scale.x;
-    accel.y *= accel_scale.y;
-    accel.z *= accel_scale.z;
+    if (_accel_transform_changed[instance] && _sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        _accel_transform[instance] = _imu._accel_transform[instance];
+        _accel_transform_changed[instance] = false;
+        _sem->give();
+    }
 
-    // rotate to body frame
-    accel.rotate(_imu._board_orientation);
+    _accel_transform[instance].apply(accel, n);
 }
 
-void AP_InertialSensor_Backend::_rotate_and_correct_gyro(uint8_t instance, Vector3f &gyro) 
+void AP_InertialSensor_Backend::_rotate_and_correct_gyro(uint8_t instance, Vector3f *gyro, uint16_t n)
 {
-    // rotate for sensor orientation
-    gyro.rotate(_imu._gyro_orientation[instance]);
-    
-    // gyro calibration is always assumed to have been done in sensor frame
-    gyro -= _imu._gyro_offset[instance];
+    if (_gyro_transform_changed[instance] && _sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        _gyro_transform[instance] = _imu._gyro_transform[instance];
+        _gyro_transform_changed[instance] = false;
+        _sem->give();
+    }
 
-    gyro.rotate(_imu._board_orientation);
+    _gyro_transform[instance].apply(gyro, n);
 }
 
 /*
@@ -131,87 +130,141 @@ void AP_InertialSensor_Backend::_publish_gyro(uint8_t instance, const Vector3f &
     _imu._delta_angle_valid[instance] = true;
 }
 
-void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
-                                                            const Vector3f &gyro,
-                                                            uint64_t sample_us)
+/*
+  find the deltaT of a sample, returning false if it should be dropped
+ */
+bool AP_InertialSensor_Backend::_sample_dt(uint64_t &last_us, uint64_t sample_us, float rate_hz, float &dt)
 {
-    float dt;
-
-    _update_sensor_rate(_imu._sample_gyro_count[instance], _imu._sample_gyro_start_us[instance],
-                        _imu._gyro_raw_sample_rates[instance]);
-
-    /*
-      we have two classes of sensors. FIFO based sensors produce data
-      at a very predictable overall rate, but the data comes in
-      bunches, so we use the provided sample rate for deltaT. Non-FIFO
-      sensors don't bunch up samples, but also tend to vary in actual
-      rate, so we use the provided sample_us to get the deltaT. The
-      difference between the two is whether sample_us is provided.
-     */
-    if (sample_us != 0 && _imu._gyro_last_sample_us[instance] != 0) {
-        dt = (sample_us - _imu._gyro_last_sample_us[instance]) * 1.0e-6;
-    } else {
+    if (sample_us != 0 && last_us != 0) {
+        dt = (sample_us - last_us) * 1.0e-6;
+    } else if (rate_hz < 100) {
         // don't accept below 100Hz
-        if (_imu._gyro_raw_sample_rates[instance] < 100) {
-            return;
-        }
+        return false;
+    } else {
+        dt = 1.0f / rate_hz;
+    }
+    last_us = sample_us;
+    return true;
+}
 
-        dt = 1.0f / _imu._gyro_raw_sample_rates[instance];
+/*
+  integrate and filter a block of gyro samples, taking the semaphore
+  once for the block
+ */
+void AP_InertialSensor_Backend::_notify_new_gyro_raw_samples(uint8_t instance,
+                                                             const Vector3f *gyro,
+                                                             uint16_t n,
+                                                             const uint64_t *sample_us)
+{
+    while (n > INS_MAX_BLOCK_SAMPLES) {
+        _notify_new_gyro_raw_samples(instance, gyro, INS_MAX_BLOCK_SAMPLES, sample_us);
+        gyro += INS_MAX_BLOCK_SAMPLES;
+        if (sample_us != nullptr) {
+            sample_us += INS_MAX_BLOCK_SAMPLES;
+        }
+        n -= INS_MAX_BLOCK_SAMPLES;
+    }
+    if (n == 0) {
+        return;
     }
-    _imu._gyro_last_sample_us[instance] = sample_us;
 
-    // call gyro_sample hook if any
-    AP_Module::call_hook_gyro_sample(instance, dt, gyro);
+    // the first pass runs the hooks outside the semaphore, the second
+    // repeats the same deltaT sequence from here to integrate
+    const uint64_t first_last_us = _imu._gyro_last_sample_us[instance];
+    uint16_t accepted = 0;
 
-    // push gyros if optical flow present
-    if (hal.opticalflow)
-        hal.opticalflow->push_gyro(gyro.x, gyro.y, dt);
-    
-    // compute delta angle
-    Vector3f delta_angle = (gyro + _imu._last_raw_gyro[instance]) * 0.5f * dt;
-
-    // compute coning correction
-    // see page 26 of:
-    // Tian et al (2010) Three-loop Integration of GPS and Strapdown INS with Coning and Sculling Compensation
-    // Available: http://www.sage.unsw.edu.au/snap/publications/tian_etal2010b.pdf
-    // see also examples/coning.py
-    Vector3f delta_coning = (_imu._delta_angle_acc[instance] +
-                             _imu._last_delta_angle[instance] * (1.0f / 6.0f));
-    delta_coning = delta_coning % delta_angle;
-    delta_coning *= 0.5f;
+    _update_sensor_rate(_imu._sample_gyro_count[instance], _imu._sample_gyro_start_us[instance],
+                        _imu._gyro_raw_sample_rates[instance], n);
+
+    for (uint16_t i = 0; i < n; i++) {
+        /*
+          we have two classes of sensors. FIFO based sensors produce data
+          at a very predictable overall rate, but the data comes in
+          bunches, so we use the provided sample rate for deltaT. Non-FIFO
+          sensors don't bunch up samples, but also tend to vary in actual
+          rate, so we use the provided sample_us to get the deltaT. The
+          difference between the two is whether sample_us is provided.
+         */
+        float dt;
+        if (!_sample_dt(_imu._gyro_last_sample_us[instance], sample_us ? sample_us[i] : 0,
+                        _imu._gyro_raw_sample_rates[instance], dt)) {
+            continue;
+        }
+        accepted |= 1U << i;
+
+        // call gyro_sample hook if any
+        AP_Module::call_hook_gyro_sample(instance, dt, gyro[i]);
+
+        // push gyros if optical flow present
+        if (hal.opticalflow)
+            hal.opticalflow->push_gyro(gyro[i].x, gyro[i].y, dt);
+    }
+    if (accepted == 0) {
+        return;
+    }
 
     if (_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
-        // integrate delta angle accumulator
-        // the angles and coning corrections are accumulated separately in the
-        // referenced paper, but in simulation little difference was found between
-        // integrating together and integrating separately (see examples/coning.py)
-        _imu._delta_angle_acc[instance] += delta_angle + delta_coning;
-        _imu._delta_angle_acc_dt[instance] += dt;
-
-        // save previous delta angle for coning correction
-        _imu._last_delta_angle[instance] = delta_angle;
-        _imu._last_raw_gyro[instance] = gyro;
-
-        _imu._gyro_filtered[instance] = _imu._gyro_filter[instance].apply(gyro);
-        if (_imu._gyro_filtered[instance].is_nan() || _imu._gyro_filtered[instance].is_inf()) {
-            _imu._gyro_filter[instance].reset();
+        uint64_t last_us = first_last_us;
+        for (uint16_t i = 0; i < n; i++) {
+            if (!(accepted & (1U << i))) {
+                continue;
+            }
+            float dt;
+            _sample_dt(last_us, sample_us ? sample_us[i] : 0, _imu._gyro_raw_sample_rates[instance], dt);
+
+            // compute delta angle
+            const Vector3f delta_angle = (gyro[i] + _imu._last_raw_gyro[instance]) * 0.5f * dt;
+
+            // compute coning correction
+            // see page 26 of:
+            // Tian et al (2010) Three-loop Integration of GPS and Strapdown INS with Coning and Sculling Compensation
+            // Available: http://www.sage.unsw.edu.au/snap/publications/tian_etal2010b.pdf
+            // see also examples/coning.py
+            Vector3f delta_coning = (_imu._delta_angle_acc[instance] +
+                                     _imu._last_delta_angle[instance] * (1.0f / 6.0f));
+            delta_coning = delta_coning % delta_angle;
+            delta_coning *= 0.5f;
+
+            // integrate delta angle accumulator
+            // the angles and coning corrections are accumulated separately in the
+            // referenced paper, but in simulation little difference was found between
+            // integrating together and integrating separately (see examples/coning.py)
+            _imu._delta_angle_acc[instance] += delta_angle + delta_coning;
+            _imu._delta_angle_acc_dt[instance] += dt;
+
+            // save previous delta angle for coning correction
+            _imu._last_delta_angle[instance] = delta_angle;
+            _imu._last_raw_gyro[instance] = gyro[i];
+
+            _imu._gyro_filtered[instance] = gyro[i];
+            _imu._gyro_filter[instance].apply(&_imu._gyro_filtered[instance]);
+            if (_imu._gyro_filtered[instance].is_nan() || _imu._gyro_filtered[instance].is_inf()) {
+                _imu._gyro_filter[instance].reset();
+            }
         }
         _imu._new_gyro_data[instance] = true;
+        _imu._gyro_raw_landed_us[instance] = AP_HAL::micros();
         _sem->give();
     }
 
     DataFlash_Class *dataflash = get_dataflash();
     if (dataflash != nullptr) {
         uint64_t now = AP_HAL::micros64();
-        struct log_GYRO pkt = {
-            LOG_PACKET_HEADER_INIT((uint8_t)(LOG_GYR1_MSG+instance)),
-            time_us   : now,
-            sample_us : sample_us?sample_us:now,
-            GyrX      : gyro.x,
-            GyrY      : gyro.y,
-            GyrZ      : gyro.z
-        };
-        dataflash->WriteBlock(&pkt, sizeof(pkt));
+        for (uint16_t i = 0; i < n; i++) {
+            if (!(accepted & (1U << i))) {
+                continue;
+            }
+            const uint64_t us = sample_us ? sample_us[i] : 0;
+            struct log_GYRO pkt = {
+                LOG_PACKET_HEADER_INIT((uint8_t)(LOG_GYR1_MSG+instance)),
+                time_us   : now,
+                sample_us : us?us:now,
+                GyrX      : gyro[i].x,
+                GyrY      : gyro[i].y,
+                GyrZ      : gyro[i].z
+            };
+            dataflash->WriteBlock(&pkt, sizeof(pkt));
+        }
     }
 }
 
@@ -248,53 +301,76 @@ void AP_InertialSensor_Backend::_publish_accel(uint8_t instance, const Vector3f
     }
 }
 
-void AP_InertialSensor_Backend::_notify_new_accel_raw_sample(uint8_t instance,
-                                                             const Vector3f &accel,
-                                                             uint64_t sample_us,
-                                                             bool fsync_set)
+/*
+  integrate and filter a block of accel samples, taking the semaphore
+  once for the block
+ */
+void AP_InertialSensor_Backend::_notify_new_accel_raw_samples(uint8_t instance,
+                                                              const Vector3f *accel,
+                                                              uint16_t n,
+                                                              const uint64_t *sample_us,
+                                                              const bool *fsync_set)
 {
-    float dt;
+    while (n > INS_MAX_BLOCK_SAMPLES) {
+        _notify_new_accel_raw_samples(instance, accel, INS_MAX_BLOCK_SAMPLES, sample_us, fsync_set);
+        accel += INS_MAX_BLOCK_SAMPLES;
+        if (sample_us != nullptr) {
+            sample_us += INS_MAX_BLOCK_SAMPLES;
+        }
+        if (fsync_set != nullptr) {
+            fsync_set += INS_MAX_BLOCK_SAMPLES;
+        }
+        n -= INS_MAX_BLOCK_SAMPLES;
+    }
+    if (n == 0) {
+        return;
+    }
+
+    // see _notify_new_gyro_raw_samples() for why deltaT is found twice
+    const uint64_t first_last_us = _imu._accel_last_sample_us[instance];
+    uint16_t accepted = 0;
 
     _update_sensor_rate(_imu._sample_accel_count[instance], _imu._sample_accel_start_us[instance],
-                        _imu._accel_raw_sample_rates[instance]);
-
-    /*
-      we have two classes of sensors. FIFO based sensors produce data
-      at a very predictable overall rate, but the data comes in
-      bunches, so we use the provided sample rate for deltaT. Non-FIFO
-      sensors don't bunch up samples, but also tend to vary in actual
-      rate, so we use the provided sample_us to get the deltaT. The
-      difference between the two is whether sample_us is provided.
-     */
-    if (sample_us != 0 && _imu._accel_last_sample_us[instance] != 0) {
-        dt = (sample_us - _imu._accel_last_sample_us[instance]) * 1.0e-6;
-    } else {
-        // don't accept below 100Hz
-        if (_imu._accel_raw_sample_rates[instance] < 100) {
-            return;
+                        _imu._accel_raw_sample_rates[instance], n);
+
+    for (uint16_t i = 0; i < n; i++) {
+        float dt;
+        if (!_sample_dt(_imu._accel_last_sample_us[instance], sample_us ? sample_us[i] : 0,
+                        _imu._accel_raw_sample_rates[instance], dt)) {
+            continue;
         }
+        accepted |= 1U << i;
 
-        dt = 1.0f / _imu._accel_raw_sample_rates[instance];
-    }
-    _imu._accel_last_sample_us[instance] = sample_us;
+        // call accel_sample hook if any
+        AP_Module::call_hook_accel_sample(instance, dt, accel[i], fsync_set ? fsync_set[i] : false);
 
-    // call accel_sample hook if any
-    AP_Module::call_hook_accel_sample(instance, dt, accel, fsync_set);
-    
-    _imu.calc_vibration_and_clipping(instance, accel, dt);
+        _imu.calc_vibration_and_clipping(instance, accel[i], dt);
+    }
+    if (accepted == 0) {
+        return;
+    }
 
     if (_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
-        // delta velocity
-        _imu._delta_velocity_acc[instance] += accel * dt;
-        _imu._delta_velocity_acc_dt[instance] += dt;
+        uint64_t last_us = first_last_us;
+        for (uint16_t i = 0; i < n; i++) {
+            if (!(accepted & (1U << i))) {
+                continue;
+            }
+            float dt;
+            _sample_dt(last_us, sample_us ? sample_us[i] : 0, _imu._accel_raw_sample_rates[instance], dt);
 
-        _imu._accel_filtered[instance] = _imu._accel_filter[instance].apply(accel);
-        if (_imu._accel_filtered[instance].is_nan() || _imu._accel_filtered[instance].is_inf()) {
-            _imu._accel_filter[instance].reset();
-        }
+            // delta velocity
+            _imu._delta_velocity_acc[instance] += accel[i] * dt;
+            _imu._delta_velocity_acc_dt[instance] += dt;
 
-        _imu.set_accel_peak_hold(instance, _imu._accel_filtered[instance]);
+            _imu._accel_filtered[instance] = accel[i];
+            _imu._accel_filter[instance].apply(&_imu._accel_filtered[instance]);
+            if (_imu._accel_filtered[instance].is_nan() || _imu._accel_filtered[instance].is_inf()) {
+                _imu._accel_filter[instance].reset();
+            }
 
+            _imu.set_accel_peak_hold(instance, _imu._accel_filtered[instance]);
+        }
         _imu._new_accel_data[instance] = true;
         _sem->give();
     }
@@ -302,15 +378,21 @@ void AP_InertialSensor_Backend::_notify_new_accel_raw_sample(uint8_t instance,
     DataFlash_Class *dataflash = get_dataflash();
     if (dataflash != nullptr) {
         uint64_t now = AP_HAL::micros64();
-        struct log_ACCEL pkt = {
-            LOG_PACKET_HEADER_INIT((uint8_t)(LOG_ACC1_MSG+instance)),
-            time_us   : now,
-            sample_us : sample_us?sample_us:now,
-            AccX      : accel.x,
-            AccY      : accel.y,
-            AccZ      : accel.z
-        };
-        dataflash->WriteBlock(&pkt, sizeof(pkt));
+        for (uint16_t i = 0; i < n; i++) {
+            if (!(accepted & (1U << i))) {
+                continue;
+            }
+            const uint64_t us = sample_us ? sample_us[i] : 0;
+            struct log_ACCEL pkt = {
+                LOG_PACKET_HEADER_INIT((uint8_t)(LOG_ACC1_MSG+instance)),
+                time_us   : now,
+                sample_us : us?us:now,
+                AccX      : accel[i].x,
+                AccY      : accel[i].y,
+                AccZ      : accel[i].z
+            };
+            dataflash->WriteBlock(&pkt, sizeof(pkt));
+        }
     }
 }
 
@@ -375,12 +457,18 @@ void AP_InertialSensor_Backend::update_gyro(uint8_t instance)
 
     if (_imu._new_gyro_data[instance]) {
         _publish_gyro(instance, _imu._gyro_filtered[instance]);
+        _imu._gyro_landed_us[instance] = _imu._gyro_raw_landed_us[instance];
         _imu._new_gyro_data[instance] = false;
     }
 
+    // pick up orientation and calibration changes for the next samples
+    if (_imu._update_gyro_transform(instance)) {
+        _gyro_transform_changed[instance] = true;
+    }
+
     // possibly update filter frequency
     if (_last_gyro_filter_hz[instance] != _gyro_filter_cutoff()) {
-        _imu._gyro_filter[instance].set_cutoff_frequency(_gyro_raw_sample_rate(instance), _gyro_filter_cutoff());
+        _imu._gyro_filter[instance].set_low_pass(0, _gyro_raw_sample_rate(instance), _gyro_filter_cutoff());
         _last_gyro_filter_hz[instance] = _gyro_filter_cutoff();
     }
 
@@ -401,9 +489,14 @@ void AP_InertialSensor_Backend::update_accel(uint8_t instance)
         _imu._new_accel_data[instance] = false;
     }
     
+    // pick up orientation and calibration changes for the next samples
+    if (_imu._update_accel_transform(instance)) {
+        _accel_transform_changed[instance] = true;
+    }
+
     // possibly update filter frequency
     if (_last_accel_filter_hz[instance] != _accel_filter_cutoff()) {
-        _imu._accel_filter[instance].set_cutoff_frequency(_accel_raw_sample_rate(instance), _accel_filter_cutoff());
+        _imu._accel_filter[instance].set_low_pass(0, _accel_raw_sample_rate(instance), _accel_filter_cutoff());
         _last_accel_filter_hz[instance] = _accel_filter_cutoff();
     }
 
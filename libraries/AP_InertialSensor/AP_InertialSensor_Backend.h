@@ -28,6 +28,10 @@
 
 #include "AP_InertialSensor.h"
 
+// samples handled under one take of the semaphore by
+// _notify_new_gyro_raw_samples() and _notify_new_accel_raw_samples()
+#define INS_MAX_BLOCK_SAMPLES 16
+
 class AuxiliaryBus;
 class DataFlash_Class;
 
@@ -101,8 +105,25 @@ protected:
     // semaphore for access to shared frontend data
     AP_HAL::Semaphore *_sem;
 
-    void _rotate_and_correct_accel(uint8_t instance, Vector3f &accel);
-    void _rotate_and_correct_gyro(uint8_t instance, Vector3f &gyro);
+    // apply the sensor and board orientation and the calibration in
+    // one step, see AP_InertialSensor::_update_accel_transform()
+    void _rotate_and_correct_accel(uint8_t instance, Vector3f &accel) {
+        _rotate_and_correct_accel(instance, &accel, 1);
+    }
+    void _rotate_and_correct_gyro(uint8_t instance, Vector3f &gyro) {
+        _rotate_and_correct_gyro(instance, &gyro, 1);
+    }
+
+    // the same for a block of n samples, as read from a FIFO
+    void _rotate_and_correct_accel(uint8_t instance, Vector3f *accel, uint16_t n);
+    void _rotate_and_correct_gyro(uint8_t instance, Vector3f *gyro, uint16_t n);
+
+    // our copies of the frontend's transforms, and whether the
+    // frontend's have been rebuilt since they were copied
+    Affine3f _accel_transform[INS_MAX_INSTANCES];
+    Affine3f _gyro_transform[INS_MAX_INSTANCES];
+    volatile bool _accel_transform_changed[INS_MAX_INSTANCES];
+    volatile bool _gyro_transform_changed[INS_MAX_INSTANCES];
 
     // rotate gyro vector, offset and publish
     void _publish_gyro(uint8_t instance, const Vector3f &gyro);
@@ -113,7 +134,15 @@ protected:
     // corrected (_rotate_and_correct_gyro)
     // The sample_us value must be provided for non-FIFO based
     // sensors, and should be set to zero for FIFO based sensors
-    void _notify_new_gyro_raw_sample(uint8_t instance, const Vector3f &accel, uint64_t sample_us=0);
+    void _notify_new_gyro_raw_sample(uint8_t instance, const Vector3f &gyro, uint64_t sample_us=0) {
+        _notify_new_gyro_raw_samples(instance, &gyro, 1, &sample_us);
+    }
+
+    // the same for a block of n samples read from a FIFO, which takes
+    // the semaphore once for the block. sample_us may be nullptr for
+    // FIFO based sensors
+    void _notify_new_gyro_raw_samples(uint8_t instance, const Vector3f *gyro, uint16_t n,
+                                      const uint64_t *sample_us=nullptr);
 
     // rotate accel vector, scale, offset and publish
     void _publish_accel(uint8_t instance, const Vector3f &accel);
@@ -124,7 +153,14 @@ protected:
     // be rotated and corrected (_rotate_and_correct_accel)
     // The sample_us value must be provided for non-FIFO based
     // sensors, and should be set to zero for FIFO based sensors
-    void _notify_new_accel_raw_sample(uint8_t instance, const Vector3f &accel, uint64_t sample_us=0, bool fsync_set=false);
+    void _notify_new_accel_raw_sample(uint8_t instance, const Vector3f &accel, uint64_t sample_us=0, bool fsync_set=false) {
+        _notify_new_accel_raw_samples(instance, &accel, 1, &sample_us, &fsync_set);
+    }
+
+    // the same for a block of n samples read from a FIFO. sample_us
+    // and fsync_set may be nullptr
+    void _notify_new_accel_raw_samples(uint8_t instance, const Vector3f *accel, uint16_t n,
+                                       const uint64_t *sample_us=nullptr, const bool *fsync_set=nullptr);
 
     // set the amount of oversamping a accel is doing
     void _set_accel_oversampling(uint8_t instance, uint8_t n);
@@ -133,7 +169,11 @@ protected:
     void _set_gyro_oversampling(uint8_t instance, uint8_t n);
     
     // update the sensor rate for FIFO sensors
-    void _update_sensor_rate(uint16_t &count, uint32_t &start_us, float &rate_hz);
+    void _update_sensor_rate(uint16_t &count, uint32_t &start_us, float &rate_hz, uint16_t n=1);
+
+    // find the deltaT of a sample and advance last_us, false if the
+    // sample should be dropped
+    static bool _sample_dt(uint64_t &last_us, uint64_t sample_us, float rate_hz, float &dt);
     
     // set accelerometer max absolute offset for calibration
     void _set_accel_max_abs_offset(uint8_t instance, float offset);
@@ -190,12 +230,20 @@ protected:
     int8_t _last_accel_filter_hz[INS_MAX_INSTANCES];
     int8_t _last_gyro_filter_hz[INS_MAX_INSTANCES];
 
+    // called before the sensor is started, so the transform is
+    // rebuilt here for the first samples
     void set_gyro_orientation(uint8_t instance, enum Rotation rotation) {
         _imu._gyro_orientation[instance] = rotation;
+        if (_imu._update_gyro_transform(instance)) {
+            _gyro_transform_changed[instance] = true;
+        }
     }
 
     void set_accel_orientation(uint8_t instance, enum Rotation rotation) {
         _imu._accel_orientation[instance] = rotation;
+        if (_imu._update_accel_transform(instance)) {
+            _accel_transform_changed[instance] = true;
+        }
     }
 
     // increment clipping counted. Used by drivers that do decimation before supplying
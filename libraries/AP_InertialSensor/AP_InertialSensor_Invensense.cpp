@@ -257,6 +257,8 @@ extern const AP_HAL::HAL& hal;
 #define MPU_FIFO_DOWNSAMPLE_COUNT 8
 #define MPU_FIFO_BUFFER_LEN 16
 
+static_assert(MPU_FIFO_BUFFER_LEN <= INS_MAX_BLOCK_SAMPLES, "a FIFO read must fit in one block");
+
 #define int16_val(v, idx) ((int16_t)(((uint16_t)v[2*idx] << 8) | v[2*idx+1]))
 #define uint16_val(v, idx)(((uint16_t)v[2*idx] << 8) | v[2*idx+1])
 
@@ -580,42 +582,54 @@ void AP_InertialSensor_Invensense::_poll_data()
 
 bool AP_InertialSensor_Invensense::_accumulate(uint8_t *samples, uint8_t n_samples)
 {
-    for (uint8_t i = 0; i < n_samples; i++) {
-        const uint8_t *data = samples + MPU_SAMPLE_SIZE * i;
-        Vector3f accel, gyro;
-        bool fsync_set = false;
+    Vector3f *accel = _block.accel;
+    Vector3f *gyro = _block.gyro;
+    bool *fsync_set = _block.fsync_set;
+    uint8_t n;
+    bool ret = true;
+
+    n_samples = MIN(n_samples, MPU_FIFO_BUFFER_LEN);
+
+    // decode the block, stopping at the first corrupt sample
+    for (n = 0; n < n_samples; n++) {
+        const uint8_t *data = samples + MPU_SAMPLE_SIZE * n;
 
 #if INVENSENSE_EXT_SYNC_ENABLE
-        fsync_set = (int16_val(data, 2) & 1U) != 0;
+        fsync_set[n] = (int16_val(data, 2) & 1U) != 0;
+#else
+        fsync_set[n] = false;
 #endif
-        
-        accel = Vector3f(int16_val(data, 1),
-                         int16_val(data, 0),
-                         -int16_val(data, 2));
-        accel *= _accel_scale;
 
         int16_t t2 = int16_val(data, 3);
         if (!_check_raw_temp(t2)) {
             debug("temp reset %d %d", _raw_temp, t2);
-            _fifo_reset();
-            return false;
+            ret = false;
+            break;
         }
         float temp = t2 * temp_sensitivity + temp_zero;
-        
-        gyro = Vector3f(int16_val(data, 5),
-                        int16_val(data, 4),
-                        -int16_val(data, 6));
-        gyro *= GYRO_SCALE;
+        _temp_filtered = _temp_filter.apply(temp);
 
-        _rotate_and_correct_accel(_accel_instance, accel);
-        _rotate_and_correct_gyro(_gyro_instance, gyro);
+        accel[n] = Vector3f(int16_val(data, 1),
+                            int16_val(data, 0),
+                            -int16_val(data, 2));
+        accel[n] *= _accel_scale;
 
-        _notify_new_accel_raw_sample(_accel_instance, accel, 0, fsync_set);
-        _notify_new_gyro_raw_sample(_gyro_instance, gyro);
+        gyro[n] = Vector3f(int16_val(data, 5),
+                           int16_val(data, 4),
+                           -int16_val(data, 6));
+        gyro[n] *= GYRO_SCALE;
+    }
 
-        _temp_filtered = _temp_filter.apply(temp);
+    _rotate_and_correct_accel(_accel_instance, accel, n);
+    _rotate_and_correct_gyro(_gyro_instance, gyro, n);
+
+    _notify_new_accel_raw_samples(_accel_instance, accel, n, nullptr, fsync_set);
+    _notify_new_gyro_raw_samples(_gyro_instance, gyro, n);
+
+    if (!ret) {
+        _fifo_reset();
     }
-    return true;
+    return ret;
 }
 
 /*
@@ -632,6 +646,11 @@ bool AP_InertialSensor_Invensense::_accumulate_fast_sampling(uint8_t *samples, u
     const int32_t clip_limit = AP_INERTIAL_SENSOR_ACCEL_CLIP_THRESH_MSS / _accel_scale;
     bool clipped = false;
     bool ret = true;
+
+    // downsampled samples to pass on once the block is done
+    Vector3f *accel = _block.accel;
+    Vector3f *gyro = _block.gyro;
+    uint8_t n_out = 0;
     
     for (uint8_t i = 0; i < n_samples; i++) {
         const uint8_t *data = samples + MPU_SAMPLE_SIZE * i;
@@ -640,7 +659,6 @@ bool AP_InertialSensor_Invensense::_accumulate_fast_sampling(uint8_t *samples, u
         int16_t t2 = int16_val(data, 3);
         if (!_check_raw_temp(t2)) {
             debug("temp reset %d %d", _raw_temp, t2);
-            _fifo_reset();
             ret = false;
             break;
         }
@@ -673,18 +691,26 @@ bool AP_InertialSensor_Invensense::_accumulate_fast_sampling(uint8_t *samples, u
             float gscale = GYRO_SCALE / MPU_FIFO_DOWNSAMPLE_COUNT;
             _accum.gyro *= gscale;
             
-            _rotate_and_correct_accel(_accel_instance, _accum.accel);
-            _rotate_and_correct_gyro(_gyro_instance, _accum.gyro);
-            
-            _notify_new_accel_raw_sample(_accel_instance, _accum.accel, 0, false);
-            _notify_new_gyro_raw_sample(_gyro_instance, _accum.gyro);
-            
+            accel[n_out] = _accum.accel;
+            gyro[n_out] = _accum.gyro;
+            n_out++;
+
             _accum.accel.zero();
             _accum.gyro.zero();
             _accum.count = 0;
         }
     }
 
+    _rotate_and_correct_accel(_accel_instance, accel, n_out);
+    _rotate_and_correct_gyro(_gyro_instance, gyro, n_out);
+
+    _notify_new_accel_raw_samples(_accel_instance, accel, n_out);
+    _notify_new_gyro_raw_samples(_gyro_instance, gyro, n_out);
+
+    if (!ret) {
+        _fifo_reset();
+    }
+
     if (clipped) {
         increment_clip_count(_accel_instance);
     }
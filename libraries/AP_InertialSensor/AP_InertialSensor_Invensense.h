@@ -143,6 +143,14 @@ private:
         LowPassFilterVector3f accel_filter{4000, 188};
         LowPassFilterVector3f gyro_filter{8000, 188};
     } _accum;
+
+    // a decoded FIFO read, kept here rather than on the bus thread's
+    // stack until it is passed on as one block
+    struct {
+        Vector3f accel[INS_MAX_BLOCK_SAMPLES];
+        Vector3f gyro[INS_MAX_BLOCK_SAMPLES];
+        bool fsync_set[INS_MAX_BLOCK_SAMPLES];
+    } _block;
 };
 
 class AP_Invensense_AuxiliaryBusSlave : public AuxiliaryBusSlave
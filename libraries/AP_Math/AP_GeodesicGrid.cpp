@@ -184,8 +184,254 @@ const Matrix3f AP_GeodesicGrid::_mid_inverses[10]{
      { 0.618034f,  0.000000f, -1.000000f}},
 };
 
+/* This was generated with
+ * libraries/AP_Math/tools/geodesic_grid/geodesic_grid.py */
+const uint8_t AP_GeodesicGrid::_section_lut[6][16][16]{
+    {
+        { 20, 20, 20, 80, 23, 23, 81, 19, 19, 82, 78, 78, 83, 76, 76, 76},
+        { 20, 20, 20, 80, 23, 23, 81, 81, 82, 82, 78, 78, 83, 76, 76, 76},
+        { 20, 20, 20, 80, 23, 23, 23, 81, 82, 78, 78, 78, 83, 76, 76, 76},
+        { 84, 84, 20, 80, 23, 85, 85,255,255, 86, 86, 78, 83, 76, 87, 87},
+        { 22, 84,255,255, 85, 85, 25, 88, 88, 41, 86, 86,255,255, 87, 79},
+        { 89, 89, 89,255, 90, 25, 25, 88, 88, 41, 41, 91,255, 92, 92, 92},
+        { 89, 26, 26, 93, 90, 90, 90, 88, 88, 91, 91, 91, 94, 42, 42, 92},
+        { 26, 26, 26, 93, 24, 24, 90,255,255, 91, 40, 40, 94, 42, 42, 42},
+        { 26, 26, 26, 93, 24, 24, 95,255,255, 96, 40, 40, 94, 42, 42, 42},
+        { 97, 26, 26, 93, 95, 95, 95, 98, 98, 96, 96, 96, 94, 42, 42, 99},
+        { 97, 97, 97,255, 95, 27, 27, 98, 98, 43, 43, 96,255, 99, 99, 99},
+        { 29,100,255,255,101,101, 27, 98, 98, 43,102,102,255,255,103, 45},
+        {100,100, 28,104, 30,101,101,255,255,102,102, 46,105, 44,103,103},
+        { 28, 28, 28,104, 30, 30, 30,106,107, 46, 46, 46,105, 44, 44, 44},
+        { 28, 28, 28,104, 30, 30,106,106,107,107, 46, 46,105, 44, 44, 44},
+        { 28, 28, 28,104, 30, 30,106, 49, 49,107, 46, 46,105, 44, 44, 44},
+    },
+    {
+        {  4,  4,  4,108,  6,  6,109,  9,  9,110, 70, 70,111, 68, 68, 68},
+        {  4,  4,  4,108,  6,  6,109,109,110,110, 70, 70,111, 68, 68, 68},
+        {  4,  4,  4,108,  6,  6,  6,109,110, 70, 70, 70,111, 68, 68, 68},
+        {112,112,  4,108,  6,113,113,255,255,114,114, 70,111, 68,115,115},
+        {  5,112,255,255,113,113,  3,116,116, 67,114,114,255,255,115, 69},
+        {117,117,117,255,118,  3,  3,116,116, 67, 67,119,255,120,120,120},
+        {117,  2,  2,121,118,118,118,116,116,119,119,119,122, 66, 66,120},
+        {  2,  2,  2,121,  0,  0,118,255,255,119, 64, 64,122, 66, 66, 66},
+        {  2,  2,  2,121,  0,  0,123,255,255,124, 64, 64,122, 66, 66, 66},
+        {125,  2,  2,121,123,123,123,126,126,124,124,124,122, 66, 66,127},
+        {125,125,125,255,123,  1,  1,126,126, 65, 65,124,255,127,127,127},
+        { 39,128,255,255,129,129,  1,126,126, 65,130,130,255,255,131, 62},
+        {128,128, 36,132, 38,129,129,255,255,130,130, 63,133, 60,131,131},
+        { 36, 36, 36,132, 38, 38, 38,134,135, 63, 63, 63,133, 60, 60, 60},
+        { 36, 36, 36,132, 38, 38,134,134,135,135, 63, 63,133, 60, 60, 60},
+        { 36, 36, 36,132, 38, 38,134, 59, 59,135, 63, 63,133, 60, 60, 60},
+    },
+    {
+        { 36, 36, 36,136, 37, 37,137, 34, 34,138, 31, 31,139, 28, 28, 28},
+        { 36, 36, 36,136, 37, 37,137,137,138,138, 31, 31,139, 28, 28, 28},
+        { 36, 36, 36,136, 37, 37, 37,137,138, 31, 31, 31,139, 28, 28, 28},
+        {132,132, 36,136, 37,140,140,255,255,141,141, 31,139, 28,104,104},
+        { 38,132,255,255,140,140, 58,142,142, 51,141,141,255,255,104, 30},
+        {134,134,134,255,143, 58, 58,142,142, 51, 51,144,255,106,106,106},
+        {134, 59, 59,145,143,143,143,142,142,144,144,144,146, 49, 49,106},
+        { 59, 59, 59,145, 56, 56,143,255,255,144, 48, 48,146, 49, 49, 49},
+        { 59, 59, 59,145, 56, 56,147,255,255,148, 48, 48,146, 49, 49, 49},
+        {135, 59, 59,145,147,147,147,149,149,148,148,148,146, 49, 49,107},
+        {135,135,135,255,147, 57, 57,149,149, 50, 50,148,255,107,107,107},
+        { 63,133,255,255,150,150, 57,149,149, 50,151,151,255,255,105, 46},
+        {133,133, 60,152, 61,150,150,255,255,151,151, 47,153, 44,105,105},
+        { 60, 60, 60,152, 61, 61, 61,154,155, 47, 47, 47,153, 44, 44, 44},
+        { 60, 60, 60,152, 61, 61,154,154,155,155, 47, 47,153, 44, 44, 44},
+        { 60, 60, 60,152, 61, 61,154, 54, 54,155, 47, 47,153, 44, 44, 44},
+    },
+    {
+        {  4,  4,  4,156,  7,  7,157, 14, 14,158, 21, 21,159, 20, 20, 20},
+        {  4,  4,  4,156,  7,  7,157,157,158,158, 21, 21,159, 20, 20, 20},
+        {  4,  4,  4,156,  7,  7,  7,157,158, 21, 21, 21,159, 20, 20, 20},
+        {108,108,  4,156,  7,160,160,255,255,161,161, 21,159, 20, 80, 80},
+        {  6,108,255,255,160,160, 10,162,162, 17,161,161,255,255, 80, 23},
+        {109,109,109,255,163, 10, 10,162,162, 17, 17,164,255, 81, 81, 81},
+        {109,  9,  9,165,163,163,163,162,162,164,164,164,166, 19, 19, 81},
+        {  9,  9,  9,165,  8,  8,163,255,255,164, 16, 16,166, 19, 19, 19},
+        {  9,  9,  9,165,  8,  8,167,255,255,168, 16, 16,166, 19, 19, 19},
+        {110,  9,  9,165,167,167,167,169,169,168,168,168,166, 19, 19, 82},
+        {110,110,110,255,167, 11, 11,169,169, 18, 18,168,255, 82, 82, 82},
+        { 70,111,255,255,170,170, 11,169,169, 18,171,171,255,255, 83, 78},
+        {111,111, 68,172, 71,170,170,255,255,171,171, 77,173, 76, 83, 83},
+        { 68, 68, 68,172, 71, 71, 71,174,175, 77, 77, 77,173, 76, 76, 76},
+        { 68, 68, 68,172, 71, 71,174,174,175,175, 77, 77,173, 76, 76, 76},
+        { 68, 68, 68,172, 71, 71,174, 74, 74,175, 77, 77,173, 76, 76, 76},
+    },
+    {
+        { 68, 68, 68,115, 69, 69,120, 66, 66,127, 62, 62,131, 60, 60, 60},
+        { 68, 68, 68,115, 69, 69,120,120,127,127, 62, 62,131, 60, 60, 60},
+        { 68, 68, 68,115, 69, 69, 69,120,127, 62, 62, 62,131, 60, 60, 60},
+        {172,172, 68,115, 69,176,176,255,255,177,177, 62,131, 60,152,152},
+        { 71,172,255,255,176,176, 73,178,178, 55,177,177,255,255,152, 61},
+        {174,174,174,255,179, 73, 73,178,178, 55, 55,180,255,154,154,154},
+        {174, 74, 74,181,179,179,179,178,178,180,180,180,182, 54, 54,154},
+        { 74, 74, 74,181, 72, 72,179,255,255,180, 52, 52,182, 54, 54, 54},
+        { 74, 74, 74,181, 72, 72,183,255,255,184, 52, 52,182, 54, 54, 54},
+        {175, 74, 74,181,183,183,183,185,185,184,184,184,182, 54, 54,155},
+        {175,175,175,255,183, 75, 75,185,185, 53, 53,184,255,155,155,155},
+        { 77,173,255,255,186,186, 75,185,185, 53,187,187,255,255,153, 47},
+        {173,173, 76, 87, 79,186,186,255,255,187,187, 45,103, 44,153,153},
+        { 76, 76, 76, 87, 79, 79, 79, 92, 99, 45, 45, 45,103, 44, 44, 44},
+        { 76, 76, 76, 87, 79, 79, 92, 92, 99, 99, 45, 45,103, 44, 44, 44},
+        { 76, 76, 76, 87, 79, 79, 92, 42, 42, 99, 45, 45,103, 44, 44, 44},
+    },
+    {
+        {  4,  4,  4,112,  5,  5,117,  2,  2,125, 39, 39,128, 36, 36, 36},
+        {  4,  4,  4,112,  5,  5,117,117,125,125, 39, 39,128, 36, 36, 36},
+        {  4,  4,  4,112,  5,  5,  5,117,125, 39, 39, 39,128, 36, 36, 36},
+        {156,156,  4,112,  5,188,188,255,255,189,189, 39,128, 36,136,136},
+        {  7,156,255,255,188,188, 13,190,190, 35,189,189,255,255,136, 37},
+        {157,157,157,255,191, 13, 13,190,190, 35, 35,192,255,137,137,137},
+        {157, 14, 14,193,191,191,191,190,190,192,192,192,194, 34, 34,137},
+        { 14, 14, 14,193, 12, 12,191,255,255,192, 32, 32,194, 34, 34, 34},
+        { 14, 14, 14,193, 12, 12,195,255,255,196, 32, 32,194, 34, 34, 34},
+        {158, 14, 14,193,195,195,195,197,197,196,196,196,194, 34, 34,138},
+        {158,158,158,255,195, 15, 15,197,197, 33, 33,196,255,138,138,138},
+        { 21,159,255,255,198,198, 15,197,197, 33,199,199,255,255,139, 31},
+        {159,159, 20, 84, 22,198,198,255,255,199,199, 29,100, 28,139,139},
+        { 20, 20, 20, 84, 22, 22, 22, 89, 97, 29, 29, 29,100, 28, 28, 28},
+        { 20, 20, 20, 84, 22, 22, 89, 89, 97, 97, 29, 29,100, 28, 28, 28},
+        { 20, 20, 20, 84, 22, 22, 89, 26, 26, 97, 29, 29,100, 28, 28, 28},
+    },
+};
+
+/* This was generated with
+ * libraries/AP_Math/tools/geodesic_grid/geodesic_grid.py */
+const struct AP_GeodesicGrid::section_split
+AP_GeodesicGrid::_section_splits[120]{
+    {{-0.525731f,  0.000000f, -0.850651f}, {20, 23}},
+    {{-0.309017f, -0.500000f,  0.809017f}, {19, 23}},
+    {{-0.309017f, -0.500000f, -0.809017f}, {19, 78}},
+    {{-0.525731f,  0.000000f,  0.850651f}, {76, 78}},
+    {{ 0.000000f, -0.850651f,  0.525731f}, {20, 22}},
+    {{-0.500000f, -0.809017f, -0.309017f}, {23, 25}},
+    {{ 0.500000f,  0.809017f, -0.309017f}, {41, 78}},
+    {{ 0.000000f, -0.850651f, -0.525731f}, {76, 79}},
+    {{ 0.000000f,  0.000000f, -1.000000f}, {25, 41}},
+    {{-0.500000f, -0.809017f, -0.309017f}, {22, 26}},
+    {{ 0.000000f,  0.850651f, -0.525731f}, {24, 25}},
+    {{-0.000000f,  0.850651f,  0.525731f}, {40, 41}},
+    {{ 0.500000f,  0.809017f, -0.309017f}, {42, 79}},
+    {{ 0.525731f,  0.000000f,  0.850651f}, {24, 26}},
+    {{ 0.525731f, -0.000000f, -0.850651f}, {40, 42}},
+    {{ 0.000000f, -0.850651f, -0.525731f}, {24, 27}},
+    {{-0.000000f, -0.850651f,  0.525731f}, {40, 43}},
+    {{ 0.500000f, -0.809017f,  0.309017f}, {26, 29}},
+    {{ 0.000000f,  0.000000f, -1.000000f}, {27, 43}},
+    {{ 0.500000f, -0.809017f, -0.309017f}, {42, 45}},
+    {{-0.000000f,  0.850651f,  0.525731f}, {28, 29}},
+    {{ 0.500000f, -0.809017f,  0.309017f}, {27, 30}},
+    {{ 0.500000f, -0.809017f, -0.309017f}, {43, 46}},
+    {{ 0.000000f,  0.850651f, -0.525731f}, {44, 45}},
+    {{-0.525731f, -0.000000f, -0.850651f}, {28, 30}},
+    {{-0.525731f,  0.000000f,  0.850651f}, {44, 46}},
+    {{ 0.309017f, -0.500000f, -0.809017f}, {30, 49}},
+    {{ 0.309017f, -0.500000f,  0.809017f}, {46, 49}},
+    {{ 0.525731f, -0.000000f, -0.850651f}, { 4,  6}},
+    {{-0.309017f,  0.500000f, -0.809017f}, { 6,  9}},
+    {{ 0.309017f, -0.500000f, -0.809017f}, { 9, 70}},
+    {{ 0.525731f,  0.000000f,  0.850651f}, {68, 70}},
+    {{-0.000000f, -0.850651f,  0.525731f}, { 4,  5}},
+    {{-0.500000f,  0.809017f,  0.309017f}, { 3,  6}},
+    {{-0.500000f,  0.809017f, -0.309017f}, {67, 70}},
+    {{ 0.000000f, -0.850651f, -0.525731f}, {68, 69}},
+    {{-0.000000f,  0.000000f, -1.000000f}, { 3, 67}},
+    {{-0.500000f,  0.809017f,  0.309017f}, { 2,  5}},
+    {{ 0.000000f,  0.850651f, -0.525731f}, { 0,  3}},
+    {{ 0.000000f,  0.850651f,  0.525731f}, {64, 67}},
+    {{-0.500000f,  0.809017f, -0.309017f}, {66, 69}},
+    {{-0.525731f,  0.000000f,  0.850651f}, { 0,  2}},
+    {{-0.525731f, -0.000000f, -0.850651f}, {64, 66}},
+    {{-0.000000f, -0.850651f, -0.525731f}, { 0,  1}},
+    {{-0.000000f, -0.850651f,  0.525731f}, {64, 65}},
+    {{-0.500000f, -0.809017f,  0.309017f}, { 2, 39}},
+    {{ 0.000000f,  0.000000f, -1.000000f}, { 1, 65}},
+    {{ 0.500000f,  0.809017f,  0.309017f}, {62, 66}},
+    {{-0.000000f,  0.850651f,  0.525731f}, {36, 39}},
+    {{-0.500000f, -0.809017f,  0.309017f}, { 1, 38}},
+    {{ 0.500000f,  0.809017f,  0.309017f}, {63, 65}},
+    {{-0.000000f,  0.850651f, -0.525731f}, {60, 62}},
+    {{ 0.525731f, -0.000000f, -0.850651f}, {36, 38}},
+    {{ 0.525731f, -0.000000f,  0.850651f}, {60, 63}},
+    {{-0.309017f, -0.500000f, -0.809017f}, {38, 59}},
+    {{ 0.309017f,  0.500000f, -0.809017f}, {59, 63}},
+    {{-0.850651f, -0.525731f, -0.000000f}, {36, 37}},
+    {{ 0.809017f, -0.309017f, -0.500000f}, {34, 37}},
+    {{ 0.809017f,  0.309017f,  0.500000f}, {31, 34}},
+    {{ 0.850651f, -0.525731f, -0.000000f}, {28, 31}},
+    {{-0.309017f, -0.500000f, -0.809017f}, {37, 58}},
+    {{ 0.309017f, -0.500000f, -0.809017f}, {31, 51}},
+    {{ 1.000000f, -0.000000f, -0.000000f}, {51, 58}},
+    {{-0.525731f,  0.000000f,  0.850651f}, {56, 58}},
+    {{ 0.525731f, -0.000000f,  0.850651f}, {48, 51}},
+    {{ 0.850651f,  0.525731f,  0.000000f}, {56, 59}},
+    {{-0.850651f,  0.525731f, -0.000000f}, {48, 49}},
+    {{-0.525731f,  0.000000f, -0.850651f}, {56, 57}},
+    {{ 0.525731f, -0.000000f, -0.850651f}, {48, 50}},
+    {{ 1.000000f, -0.000000f, -0.000000f}, {50, 57}},
+    {{ 0.309017f,  0.500000f, -0.809017f}, {57, 61}},
+    {{ 0.309017f, -0.500000f,  0.809017f}, {47, 50}},
+    {{-0.850651f, -0.525731f, -0.000000f}, {60, 61}},
+    {{ 0.850651f, -0.525731f,  0.000000f}, {44, 47}},
+    {{ 0.809017f, -0.309017f,  0.500000f}, {54, 61}},
+    {{ 0.809017f,  0.309017f, -0.500000f}, {47, 54}},
+    {{-0.850651f,  0.525731f, -0.000000f}, { 4,  7}},
+    {{-0.809017f, -0.309017f,  0.500000f}, { 7, 14}},
+    {{-0.809017f,  0.309017f, -0.500000f}, {14, 21}},
+    {{ 0.850651f,  0.525731f,  0.000000f}, {20, 21}},
+    {{-0.309017f,  0.500000f, -0.809017f}, { 7, 10}},
+    {{-0.309017f, -0.500000f,  0.809017f}, {17, 21}},
+    {{-1.000000f, -0.000000f,  0.000000f}, {10, 17}},
+    {{-0.525731f,  0.000000f,  0.850651f}, { 8, 10}},
+    {{ 0.525731f,  0.000000f,  0.850651f}, {16, 17}},
+    {{ 0.850651f, -0.525731f,  0.000000f}, { 8,  9}},
+    {{-0.850651f, -0.525731f, -0.000000f}, {16, 19}},
+    {{-0.525731f, -0.000000f, -0.850651f}, { 8, 11}},
+    {{ 0.525731f, -0.000000f, -0.850651f}, {16, 18}},
+    {{-1.000000f,  0.000000f,  0.000000f}, {11, 18}},
+    {{ 0.309017f, -0.500000f, -0.809017f}, {11, 71}},
+    {{-0.309017f, -0.500000f, -0.809017f}, {18, 77}},
+    {{-0.850651f,  0.525731f,  0.000000f}, {68, 71}},
+    {{ 0.850651f,  0.525731f,  0.000000f}, {76, 77}},
+    {{-0.809017f, -0.309017f, -0.500000f}, {71, 74}},
+    {{-0.809017f,  0.309017f,  0.500000f}, {74, 77}},
+    {{-0.809017f, -0.309017f, -0.500000f}, {69, 73}},
+    {{ 0.809017f, -0.309017f,  0.500000f}, {55, 62}},
+    {{ 0.000000f,  1.000000f, -0.000000f}, {55, 73}},
+    {{ 0.850651f, -0.525731f,  0.000000f}, {72, 73}},
+    {{ 0.850651f,  0.525731f, -0.000000f}, {52, 55}},
+    {{ 0.000000f,  0.850651f,  0.525731f}, {72, 74}},
+    {{ 0.000000f, -0.850651f,  0.525731f}, {52, 54}},
+    {{-0.850651f, -0.525731f,  0.000000f}, {72, 75}},
+    {{-0.850651f,  0.525731f,  0.000000f}, {52, 53}},
+    {{ 0.000000f,  1.000000f,  0.000000f}, {53, 75}},
+    {{-0.809017f,  0.309017f,  0.500000f}, {75, 79}},
+    {{ 0.809017f,  0.309017f, -0.500000f}, {45, 53}},
+    {{-0.809017f, -0.309017f,  0.500000f}, { 5, 13}},
+    {{ 0.809017f, -0.309017f, -0.500000f}, {35, 39}},
+    {{-0.000000f, -1.000000f, -0.000000f}, {13, 35}},
+    {{ 0.850651f, -0.525731f, -0.000000f}, {12, 13}},
+    {{ 0.850651f,  0.525731f,  0.000000f}, {32, 35}},
+    {{-0.000000f,  0.850651f, -0.525731f}, {12, 14}},
+    {{-0.000000f, -0.850651f, -0.525731f}, {32, 34}},
+    {{-0.850651f, -0.525731f, -0.000000f}, {12, 15}},
+    {{-0.850651f,  0.525731f, -0.000000f}, {32, 33}},
+    {{-0.000000f, -1.000000f, -0.000000f}, {15, 33}},
+    {{-0.809017f,  0.309017f, -0.500000f}, {15, 22}},
+    {{ 0.809017f,  0.309017f,  0.500000f}, {29, 33}},
+};
+
 int AP_GeodesicGrid::section(const Vector3f &v, bool inclusive)
 {
+    /* Most vectors are away from the edges and their section can be looked
+     * up. The result is then the same regardless of inclusive. */
+    int s = _section_from_lut(v);
+    if (s >= 0) {
+        return s;
+    }
+
     int i = _triangle_index(v, inclusive);
     if (i < 0) {
         return -1;
@@ -199,6 +445,70 @@ int AP_GeodesicGrid::section(const Vector3f &v, bool inclusive)
     return 4 * i + j;
 }
 
+int AP_GeodesicGrid::_section_from_lut(const Vector3f &v)
+{
+    const float ax = fabsf(v.x);
+    const float ay = fabsf(v.y);
+    const float az = fabsf(v.z);
+    int face;
+    float m, p, q;
+
+    /* Find the face of the cube crossed by v, i.e. the one for its largest
+     * coordinate, and v's coordinates on that face scaled by m */
+    if (ax >= ay && ax >= az) {
+        face = v.x < 0 ? 1 : 0;
+        m = ax;
+        p = v.y;
+        q = v.z;
+    } else if (ay >= az) {
+        face = v.y < 0 ? 3 : 2;
+        m = ay;
+        p = v.z;
+        q = v.x;
+    } else {
+        face = v.z < 0 ? 5 : 4;
+        m = az;
+        p = v.x;
+        q = v.y;
+    }
+
+    if (m < SECTION_LUT_MIN_LENGTH) {
+        return -1;
+    }
+
+    /* Rounding may put v in a neighbor cell when it's close to the border,
+     * which is fine because the table keeps a margin around the edges. */
+    const float scale = 0.5f * SECTION_LUT_SIZE / m;
+    const float fi = (p + m) * scale;
+    const float fj = (q + m) * scale;
+
+    /* This also rejects vectors with NaN or infinite coordinates */
+    if (!(fi >= 0 && fi <= SECTION_LUT_SIZE && fj >= 0 && fj <= SECTION_LUT_SIZE)) {
+        return -1;
+    }
+
+    const int i = MIN((int)fi, SECTION_LUT_SIZE - 1);
+    const int j = MIN((int)fj, SECTION_LUT_SIZE - 1);
+    const uint8_t entry = _section_lut[face][i][j];
+
+    if (entry < 80) {
+        return entry;
+    }
+    if (entry == 255) {
+        return -1;
+    }
+
+    const struct section_split &split = _section_splits[entry - 80];
+    const float d = split.normal * v;
+    if (d > SECTION_LUT_MARGIN * m) {
+        return split.sections[0];
+    }
+    if (d < -SECTION_LUT_MARGIN * m) {
+        return split.sections[1];
+    }
+    return -1;
+}
+
 int AP_GeodesicGrid::_neighbor_umbrella_component(int idx, int comp_idx)
 {
     if (idx < 3) {
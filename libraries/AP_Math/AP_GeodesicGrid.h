@@ -178,6 +178,69 @@ private:
      */
     static const Matrix3f _mid_inverses[10];
 
+    /**
+     * Number of cells along each edge of a cube face in #_section_lut.
+     */
+    static const int SECTION_LUT_SIZE = 16;
+
+    /**
+     * Shortest vector, given by its largest absolute coordinate, that is
+     * looked up in #_section_lut. Shorter vectors are left to the full
+     * computation, which treats coefficients close to zero as edges.
+     */
+    static constexpr float SECTION_LUT_MIN_LENGTH = 1e-2f;
+
+    /**
+     * Minimum distance, for a vector of unit length, from the edges of the
+     * sections given by #_section_lut. This must match the margin used by the
+     * script that generates the table.
+     */
+    static constexpr float SECTION_LUT_MARGIN = 1e-3f;
+
+    /**
+     * A pair of sections sharing an edge.
+     */
+    static const struct section_split {
+        /**
+         * Unit normal of the plane containing the shared edge.
+         */
+        Vector3f normal;
+        /**
+         * The value of #sections[0] is the section crossed by vectors on the
+         * side of the plane #normal points to and #sections[1] is the one on
+         * the other side.
+         */
+        uint8_t sections[2];
+    } _section_splits[120];
+
+    /**
+     * Lookup table for the section crossed by a vector, indexed by the face
+     * of the cube the vector crosses and the cell of that face.
+     *
+     * The faces are ordered +x, -x, +y, -y, +z, -z. The cells of the face for
+     * axis k are indexed by the coordinates (k + 1) % 3 and (k + 2) % 3, in
+     * that order, of the vector scaled so that coordinate k is 1 or -1.
+     *
+     * A value v in [0,80) means that every vector crossing the cell crosses
+     * section v, and not close to its edges. A value in [80,200) means that
+     * the cell is split between the two sections of #_section_splits[v - 80].
+     * The value 255 means that the cell crosses more sections than that, which
+     * happens around the grid's vertices.
+     */
+    static const uint8_t _section_lut[6][SECTION_LUT_SIZE][SECTION_LUT_SIZE];
+
+    /**
+     * Find which section is crossed by \p v using #_section_lut.
+     *
+     * @param v[in] The vector to be verified.
+     *
+     * @return The index of the section. The value -1 is returned if the table
+     * can't give an answer for \p v, which happens if \p v is short or close
+     * to an edge or vertex of the grid. In that case #_triangle_index() and
+     * #_subtriangle_index() must be used.
+     */
+    static int _section_from_lut(const Vector3f &v);
+
     /**
      * The representation of the neighbor umbrellas of T_0.
      *
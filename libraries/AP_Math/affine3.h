@@ -0,0 +1,83 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// 3D affine transform, v' = m*v + t
+//
+// Sensor drivers use this to apply a chain of rotations, offsets and
+// scale factors to each sample with one multiply-add, building the
+// transform again only when the parameters behind it change.
+//
+#pragma once
+
+#include "matrix3.h"
+#include "vector3.h"
+
+template <typename T>
+class Affine3 {
+public:
+    Matrix3<T> m;
+    Vector3<T> t;
+
+    // identity
+    Affine3<T>() { m.identity(); }
+
+    Affine3<T>(const Matrix3<T> &m0, const Vector3<T> &t0)
+        : m(m0)
+        , t(t0) {}
+
+    // a pure rotation
+    static Affine3<T> rotation(enum Rotation rotation) {
+        Affine3<T> ret;
+        ret.m.from_rotation(rotation);
+        return ret;
+    }
+
+    // a pure translation
+    static Affine3<T> translation(const Vector3<T> &t0) {
+        Affine3<T> ret;
+        ret.t = t0;
+        return ret;
+    }
+
+    // scale each axis, with no translation
+    static Affine3<T> scale(const Vector3<T> &s) {
+        return Affine3<T>(Matrix3<T>(s.x, 0, 0,
+                                     0, s.y, 0,
+                                     0, 0, s.z), Vector3<T>());
+    }
+
+    // transform a vector
+    Vector3<T> operator *(const Vector3<T> &v) const {
+        return Vector3<T>(m.a.x * v.x + m.a.y * v.y + m.a.z * v.z + t.x,
+                          m.b.x * v.x + m.b.y * v.y + m.b.z * v.z + t.y,
+                          m.c.x * v.x + m.c.y * v.y + m.c.z * v.z + t.z);
+    }
+
+    // the transform which applies a, then this
+    Affine3<T> operator *(const Affine3<T> &a) const {
+        return Affine3<T>(m * a.m, m * a.t + t);
+    }
+
+    // transform n vectors in place
+    void apply(Vector3<T> *v, uint16_t n) const {
+        for (uint16_t i = 0; i < n; i++) {
+            v[i] = *this * v[i];
+        }
+    }
+};
+
+typedef Affine3<float>                  Affine3f;
+typedef Affine3<double>                 Affine3d;
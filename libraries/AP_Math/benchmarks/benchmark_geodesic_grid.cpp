@@ -98,4 +98,25 @@ static void BM_GeodesicGridSections(benchmark::State& state)
 /* Benchmark each section */
 BENCHMARK(BM_GeodesicGridSections)->DenseRange(0, 79);
 
+static void BM_GeodesicGridRandomVectors(benchmark::State& state)
+{
+    /* Vectors spread over the sphere, as compass calibration samples are,
+     * rather than at the centroids of the sections */
+    static Vector3f vectors[1024];
+    unsigned int seed = 1;
+    for (auto &v : vectors) {
+        v = Vector3f(rand_r(&seed) / (float)RAND_MAX - 0.5f,
+                     rand_r(&seed) / (float)RAND_MAX - 0.5f,
+                     rand_r(&seed) / (float)RAND_MAX - 0.5f) * 1000.0f;
+    }
+
+    unsigned int i = 0;
+    while (state.KeepRunning()) {
+        int s = AP_GeodesicGrid::section(vectors[i++ % ARRAY_SIZE(vectors)]);
+        gbenchmark_escape(&s);
+    }
+}
+
+BENCHMARK(BM_GeodesicGridRandomVectors);
+
 BENCHMARK_MAIN()
@@ -0,0 +1,112 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+#define NUM_POINTS 100
+
+static void make_points(const struct Location &origin, struct Location *locs)
+{
+    for (uint16_t i = 0; i < NUM_POINTS; i++) {
+        locs[i] = origin;
+        location_update(locs[i], i * 3.6f, 50.0f * (i + 1));
+    }
+}
+
+static struct Location make_origin()
+{
+    struct Location origin {};
+    origin.lat = -353632610;
+    origin.lng = 1491652300;
+    return origin;
+}
+
+/*
+ * Convert a set of points to offsets from an origin one at a time, as
+ * fence loading and rally point searches do
+ */
+static void BM_LocationDiff(benchmark::State& state)
+{
+    const struct Location origin = make_origin();
+    struct Location locs[NUM_POINTS];
+    Vector2f ne[NUM_POINTS];
+    make_points(origin, locs);
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < NUM_POINTS; i++) {
+            ne[i] = location_diff(origin, locs[i]);
+        }
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_LocalFrameToNE(benchmark::State& state)
+{
+    const struct Location origin = make_origin();
+    struct Location locs[NUM_POINTS];
+    Vector2f ne[NUM_POINTS];
+    make_points(origin, locs);
+
+    while (state.KeepRunning()) {
+        const LocalFrame frame(origin);
+        for (uint16_t i = 0; i < NUM_POINTS; i++) {
+            ne[i] = frame.to_ne(locs[i]);
+        }
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_LocalFrameToNEBatch(benchmark::State& state)
+{
+    const struct Location origin = make_origin();
+    struct Location locs[NUM_POINTS];
+    Vector2f ne[NUM_POINTS];
+    make_points(origin, locs);
+
+    while (state.KeepRunning()) {
+        const LocalFrame frame(origin);
+        frame.to_ne(locs, ne, NUM_POINTS);
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_LocationOffset(benchmark::State& state)
+{
+    const struct Location origin = make_origin();
+    struct Location locs[NUM_POINTS];
+    Vector2f ne[NUM_POINTS];
+    for (uint16_t i = 0; i < NUM_POINTS; i++) {
+        ne[i] = Vector2f(10.0f * i, -5.0f * i);
+    }
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < NUM_POINTS; i++) {
+            locs[i] = origin;
+            location_offset(locs[i], ne[i].x, ne[i].y);
+        }
+        gbenchmark_escape(locs);
+    }
+}
+
+static void BM_LocalFrameFromNEBatch(benchmark::State& state)
+{
+    const struct Location origin = make_origin();
+    struct Location locs[NUM_POINTS];
+    Vector2f ne[NUM_POINTS];
+    for (uint16_t i = 0; i < NUM_POINTS; i++) {
+        ne[i] = Vector2f(10.0f * i, -5.0f * i);
+    }
+
+    while (state.KeepRunning()) {
+        const LocalFrame frame(origin);
+        frame.from_ne(ne, locs, NUM_POINTS);
+        gbenchmark_escape(locs);
+    }
+}
+
+BENCHMARK(BM_LocationDiff);
+BENCHMARK(BM_LocalFrameToNE);
+BENCHMARK(BM_LocalFrameToNEBatch);
+BENCHMARK(BM_LocationOffset);
+BENCHMARK(BM_LocalFrameFromNEBatch);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,66 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+// one FIFO read from an Invensense IMU
+#define NUM_SAMPLES 16
+
+static const Vector3f offset(0.1f, -0.2f, 0.3f);
+static const Vector3f scale(1.01f, 0.98f, 1.02f);
+
+static void make_samples(Vector3f *v)
+{
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        v[i] = Vector3f(0.1f * i, -9.8f + 0.01f * i, 0.5f);
+    }
+}
+
+/*
+ * Rotate and correct each sample with two rotations and the
+ * calibration, as AP_InertialSensor_Backend used to
+ */
+static void BM_RotateAndCorrect(benchmark::State& state)
+{
+    const enum Rotation sensor = (enum Rotation)state.range(0);
+    const enum Rotation board = ROTATION_YAW_90;
+    Vector3f v[NUM_SAMPLES];
+
+    while (state.KeepRunning()) {
+        make_samples(v);
+        for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+            v[i].rotate(sensor);
+            v[i] -= offset;
+            v[i].x *= scale.x;
+            v[i].y *= scale.y;
+            v[i].z *= scale.z;
+            v[i].rotate(board);
+        }
+        gbenchmark_escape(v);
+    }
+}
+
+/*
+ * The same with the rotations and calibration composed into one
+ * transform applied to the block
+ */
+static void BM_Affine3Apply(benchmark::State& state)
+{
+    const enum Rotation sensor = (enum Rotation)state.range(0);
+    const enum Rotation board = ROTATION_YAW_90;
+    const Affine3f transform = Affine3f::rotation(board) *
+        Affine3f::scale(scale) *
+        Affine3f::translation(-offset) *
+        Affine3f::rotation(sensor);
+    Vector3f v[NUM_SAMPLES];
+
+    while (state.KeepRunning()) {
+        make_samples(v);
+        transform.apply(v, NUM_SAMPLES);
+        gbenchmark_escape(v);
+    }
+}
+
+BENCHMARK(BM_RotateAndCorrect)->Arg(ROTATION_NONE)->Arg(ROTATION_ROLL_180_YAW_45)->Arg(ROTATION_ROLL_90_PITCH_68_YAW_293);
+BENCHMARK(BM_Affine3Apply)->Arg(ROTATION_NONE)->Arg(ROTATION_ROLL_180_YAW_45)->Arg(ROTATION_ROLL_90_PITCH_68_YAW_293);
+
+BENCHMARK_MAIN()
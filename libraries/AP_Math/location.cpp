@@ -137,6 +137,75 @@ Vector3f location_3d_diff_NED(const struct Location &loc1, const struct Location
                     (loc1.alt - loc2.alt) * 0.01f);
 }
 
+LocalFrame::LocalFrame() :
+    _origin(),
+    _lng_scale(1.0f)
+{
+}
+
+LocalFrame::LocalFrame(const struct Location &origin)
+{
+    set_origin(origin);
+}
+
+void LocalFrame::set_origin(const struct Location &origin)
+{
+    _origin = origin;
+    _lng_scale = longitude_scale(origin);
+}
+
+Vector2f LocalFrame::to_ne(int32_t lat, int32_t lng) const
+{
+    return Vector2f((lat - _origin.lat) * LOCATION_SCALING_FACTOR,
+                    (lng - _origin.lng) * LOCATION_SCALING_FACTOR * _lng_scale);
+}
+
+struct Location LocalFrame::from_ne(const Vector2f &ne) const
+{
+    struct Location loc = _origin;
+    loc.lat += (int32_t)(ne.x * LOCATION_SCALING_FACTOR_INV);
+    loc.lng += (int32_t)((ne.y * LOCATION_SCALING_FACTOR_INV) / _lng_scale);
+    return loc;
+}
+
+float LocalFrame::get_distance(const struct Location &loc) const
+{
+    float dlat = (float)(loc.lat - _origin.lat);
+    float dlong = ((float)(loc.lng - _origin.lng)) * _lng_scale;
+    return norm(dlat, dlong) * LOCATION_SCALING_FACTOR;
+}
+
+int32_t LocalFrame::get_bearing_cd(const struct Location &loc) const
+{
+    int32_t off_x = loc.lng - _origin.lng;
+    int32_t off_y = (loc.lat - _origin.lat) / _lng_scale;
+    int32_t bearing = 9000 + atan2f(-off_y, off_x) * 5729.57795f;
+    if (bearing < 0) bearing += 36000;
+    return bearing;
+}
+
+void LocalFrame::to_ne(const struct Location *locs, Vector2f *ne, uint16_t count) const
+{
+    // copies, as the compiler can't tell the outputs don't overlap members
+    const int32_t lat0 = _origin.lat;
+    const int32_t lng0 = _origin.lng;
+    const float scale = _lng_scale;
+    for (uint16_t i=0; i<count; i++) {
+        ne[i].x = (locs[i].lat - lat0) * LOCATION_SCALING_FACTOR;
+        ne[i].y = (locs[i].lng - lng0) * LOCATION_SCALING_FACTOR * scale;
+    }
+}
+
+void LocalFrame::from_ne(const Vector2f *ne, struct Location *locs, uint16_t count) const
+{
+    const float scale = _lng_scale;
+    for (uint16_t i=0; i<count; i++) {
+        locs[i] = _origin;
+        locs[i].lat += (int32_t)(ne[i].x * LOCATION_SCALING_FACTOR_INV);
+        locs[i].lng += (int32_t)((ne[i].y * LOCATION_SCALING_FACTOR_INV) / scale);
+    }
+}
+
 /*
   return true if lat and lng match. Ignores altitude and options
  */
@@ -65,6 +65,44 @@ Vector2f    location_diff(const struct Location &loc1, const struct Location &lo
  */
 Vector3f    location_3d_diff_NED(const struct Location &loc1, const struct Location &loc2);
 
+/*
+  a north/east frame about an origin, for converting many points
+  relative to the same place. The longitude scale of the origin is
+  worked out once, and conversions give the same results as
+  location_diff() and location_offset() from the origin
+ */
+class LocalFrame {
+public:
+    LocalFrame();
+    explicit LocalFrame(const struct Location &origin);
+
+    void set_origin(const struct Location &origin);
+    const struct Location &get_origin() const { return _origin; }
+    float get_longitude_scale() const { return _lng_scale; }
+
+    // metres north and east of the origin
+    Vector2f to_ne(const struct Location &loc) const { return to_ne(loc.lat, loc.lng); }
+    Vector2f to_ne(int32_t lat, int32_t lng) const;
+
+    // the origin moved by ne metres north and east
+    struct Location from_ne(const Vector2f &ne) const;
+
+    // distance in metres and bearing in centi-degrees from the
+    // origin. Longitude is scaled at the origin rather than at loc,
+    // so these differ slightly from get_distance() and get_bearing_cd()
+    float get_distance(const struct Location &loc) const;
+    int32_t get_bearing_cd(const struct Location &loc) const;
+
+    // convert count points at once, with no trig or branches in the
+    // loops so that they can be vectorised
+    void to_ne(const struct Location *locs, Vector2f *ne, uint16_t count) const;
+    void from_ne(const Vector2f *ne, struct Location *locs, uint16_t count) const;
+
+private:
+    struct Location _origin;
+    float _lng_scale;
+};
+
 /*
  * check if lat and lng match. Ignore altitude and options
  */
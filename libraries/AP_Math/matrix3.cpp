@@ -253,6 +253,21 @@ void Matrix3<T>::from_axis_angle(const Vector3<T> &v, float theta)
     c.z = t*z*z + C;
 }
 
+template <typename T>
+void Matrix3<T>::from_rotation(enum Rotation rotation)
+{
+    // the columns are the rotated axes
+    Vector3<T> x(1, 0, 0);
+    Vector3<T> y(0, 1, 0);
+    Vector3<T> z(0, 0, 1);
+    x.rotate(rotation);
+    y.rotate(rotation);
+    z.rotate(rotation);
+    a = Vector3<T>(x.x, y.x, z.x);
+    b = Vector3<T>(x.y, y.y, z.y);
+    c = Vector3<T>(x.z, y.z, z.z);
+}
+
 
 // only define for float
 template void Matrix3<float>::zero(void);
@@ -262,6 +277,7 @@ template void Matrix3<float>::from_euler(float roll, float pitch, float yaw);
 template void Matrix3<float>::to_euler(float *roll, float *pitch, float *yaw) const;
 template void Matrix3<float>::from_euler312(float roll, float pitch, float yaw);
 template void Matrix3<float>::from_axis_angle(const Vector3<float> &v, float theta);
+template void Matrix3<float>::from_rotation(enum Rotation rotation);
 template Vector3<float> Matrix3<float>::to_euler312(void) const;
 template Vector3<float> Matrix3<float>::operator *(const Vector3<float> &v) const;
 template Vector3<float> Matrix3<float>::mul_transpose(const Vector3<float> &v) const;
@@ -276,6 +292,7 @@ template void Matrix3<double>::zero(void);
 template void Matrix3<double>::rotate(const Vector3<double> &g);
 template void Matrix3<double>::from_euler(float roll, float pitch, float yaw);
 template void Matrix3<double>::to_euler(float *roll, float *pitch, float *yaw) const;
+template void Matrix3<double>::from_rotation(enum Rotation rotation);
 template Vector3<double> Matrix3<double>::operator *(const Vector3<double> &v) const;
 template Vector3<double> Matrix3<double>::mul_transpose(const Vector3<double> &v) const;
 template Matrix3<double> Matrix3<double>::operator *(const Matrix3<double> &m) const;
@@ -255,6 +255,10 @@ public:
     // See: https://en.wikipedia.org/wiki/Rotation_matrix#General_rotations
     // "Rotation matrix from axis and angle"
     void        from_axis_angle(const Vector3<T> &v, float theta);
+
+    // fill the matrix from a standard rotation, so that m*v gives the
+    // same result as v.rotate(rotation)
+    void        from_rotation(enum Rotation rotation);
     
     // normalize a rotation matrix
     void        normalize(void);
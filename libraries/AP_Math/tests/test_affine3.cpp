@@ -0,0 +1,72 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define EXPECT_VECTOR3F_NEAR(v1, v2, acc) \
+    EXPECT_NEAR(v1.x, v2.x, acc); \
+    EXPECT_NEAR(v1.y, v2.y, acc); \
+    EXPECT_NEAR(v1.z, v2.z, acc);
+
+TEST(Affine3Test, FromRotation)
+{
+    const Vector3f v(1.5f, -2.25f, 3.0f);
+
+    for (uint8_t r = ROTATION_NONE; r < ROTATION_MAX; r++) {
+        Vector3f expected = v;
+        expected.rotate((enum Rotation)r);
+
+        Matrix3f m;
+        m.from_rotation((enum Rotation)r);
+        const Vector3f rotated = m * v;
+
+        EXPECT_VECTOR3F_NEAR(expected, rotated, 1.0e-5f);
+    }
+}
+
+// the chain AP_InertialSensor used to apply to each accel sample
+static Vector3f correct_accel(Vector3f accel, enum Rotation sensor, enum Rotation board,
+                              const Vector3f &offset, const Vector3f &scale)
+{
+    accel.rotate(sensor);
+    accel -= offset;
+    accel.x *= scale.x;
+    accel.y *= scale.y;
+    accel.z *= scale.z;
+    accel.rotate(board);
+    return accel;
+}
+
+TEST(Affine3Test, Compose)
+{
+    const Vector3f offset(0.1f, -0.2f, 0.3f);
+    const Vector3f scale(1.01f, 0.98f, 1.02f);
+    const enum Rotation sensor = ROTATION_YAW_90;
+    const enum Rotation board = ROTATION_ROLL_180_YAW_45;
+
+    const Affine3f transform = Affine3f::rotation(board) *
+        Affine3f::scale(scale) *
+        Affine3f::translation(-offset) *
+        Affine3f::rotation(sensor);
+
+    Vector3f samples[4] {
+        Vector3f(0, 0, -9.8f),
+        Vector3f(1, 2, 3),
+        Vector3f(-4.5f, 0.5f, 7),
+        Vector3f(),
+    };
+    Vector3f expected[4];
+    for (uint8_t i = 0; i < 4; i++) {
+        expected[i] = correct_accel(samples[i], sensor, board, offset, scale);
+        const Vector3f one = transform * samples[i];
+        EXPECT_VECTOR3F_NEAR(expected[i], one, 1.0e-5f);
+    }
+
+    transform.apply(samples, 4);
+    for (uint8_t i = 0; i < 4; i++) {
+        EXPECT_VECTOR3F_NEAR(expected[i], samples[i], 1.0e-5f);
+    }
+}
+
+AP_GTEST_MAIN()
@@ -69,6 +69,29 @@ protected:
             }
         }
     }
+
+public:
+    /**
+     * Find the section crossed by \p v using only the lookup table.
+     */
+    static int section_from_lut(const Vector3f &v) {
+        return AP_GeodesicGrid::_section_from_lut(v);
+    }
+
+    /**
+     * Find the section crossed by \p v without the lookup table.
+     */
+    static int section_full(const Vector3f &v, bool inclusive) {
+        int i = AP_GeodesicGrid::_triangle_index(v, inclusive);
+        if (i < 0) {
+            return -1;
+        }
+        int j = AP_GeodesicGrid::_subtriangle_index(i, v, inclusive);
+        if (j < 0) {
+            return -1;
+        }
+        return AP_GeodesicGrid::NUM_SUBTRIANGLES * i + j;
+    }
 };
 
 static const Vector3f triangles[20][3] = {
@@ -232,4 +255,74 @@ INSTANTIATE_TEST_CASE_P(HardcodedVectors,
                         GeodesicGridTest,
                         ::testing::ValuesIn(hardcoded_vectors));
 
+/* The lookup table must agree with the full computation wherever it gives an
+ * answer, and give one for most vectors */
+TEST(GeodesicGridLUT, MatchesFullComputation)
+{
+    const float lengths[] = {0.02f, 1.0f, 500.0f};
+    unsigned int seed = 1;
+    int found = 0;
+    int total = 0;
+
+    for (int n = 0; n < 20000; n++) {
+        Vector3f u(rand_r(&seed) / (float)RAND_MAX - 0.5f,
+                   rand_r(&seed) / (float)RAND_MAX - 0.5f,
+                   rand_r(&seed) / (float)RAND_MAX - 0.5f);
+        if (u.is_zero()) {
+            continue;
+        }
+        u.normalize();
+        for (float length : lengths) {
+            const Vector3f v = u * length;
+            const int s = GeodesicGridTest::section_from_lut(v);
+            total++;
+            if (s < 0) {
+                continue;
+            }
+            found++;
+            ASSERT_EQ(GeodesicGridTest::section_full(v, false), s) << v;
+            ASSERT_EQ(GeodesicGridTest::section_full(v, true), s) << v;
+        }
+    }
+
+    EXPECT_GT(found, total * 85 / 100);
+}
+
+/* Vectors on the borders of the table's cells are the ones most likely to be
+ * put in the wrong cell by rounding */
+TEST(GeodesicGridLUT, CellBorders)
+{
+    const int n = 4 * 16;
+    for (int axis = 0; axis < 3; axis++) {
+        for (float sign : {1.0f, -1.0f}) {
+            for (int i = 0; i <= n; i++) {
+                for (int j = 0; j <= n; j++) {
+                    Vector3f v;
+                    v[axis] = sign;
+                    v[(axis + 1) % 3] = -1.0f + 2.0f * i / n;
+                    v[(axis + 2) % 3] = -1.0f + 2.0f * j / n;
+                    const int s = GeodesicGridTest::section_from_lut(v);
+                    if (s >= 0) {
+                        ASSERT_EQ(GeodesicGridTest::section_full(v, false), s) << v;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(GeodesicGridLUT, Rejected)
+{
+    /* Short vectors are left to the full computation */
+    EXPECT_EQ(-1, GeodesicGridTest::section_from_lut(Vector3f(0.0f, 0.0f, 0.0f)));
+    EXPECT_EQ(-1, GeodesicGridTest::section_from_lut(Vector3f(1e-3f, 2e-3f, 3e-3f)));
+    EXPECT_EQ(-1, GeodesicGridTest::section_from_lut(Vector3f(NAN, 1.0f, 1.0f)));
+    EXPECT_EQ(-1, GeodesicGridTest::section_from_lut(Vector3f(1.0f, INFINITY, 1.0f)));
+
+    /* So are the icosahedron's vertices */
+    for (const TestParam &p : icosahedron_vertices) {
+        EXPECT_EQ(-1, GeodesicGridTest::section_from_lut(p.v)) << p.v;
+    }
+}
+
 AP_GTEST_MAIN()
@@ -0,0 +1,144 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define NUM_POINTS 64
+
+static struct Location make_location(double lat_deg, double lng_deg)
+{
+    struct Location loc {};
+    loc.lat = lat_deg * 1.0e7;
+    loc.lng = lng_deg * 1.0e7;
+    loc.alt = 12345;
+    return loc;
+}
+
+// points up to about 5km from the origin in all directions
+static void make_points(const struct Location &origin, struct Location *locs)
+{
+    for (uint16_t i = 0; i < NUM_POINTS; i++) {
+        locs[i] = origin;
+        location_update(locs[i], i * (360.0f / NUM_POINTS), 80.0f * (i + 1));
+    }
+}
+
+// great circle distance on a sphere of RADIUS_OF_EARTH
+static double great_circle_distance(const struct Location &loc1, const struct Location &loc2)
+{
+    const double to_rad = 1.0e-7 * M_PI / 180;
+    const double lat1 = loc1.lat * to_rad;
+    const double lat2 = loc2.lat * to_rad;
+    const double dlat = lat2 - lat1;
+    const double dlng = (loc2.lng - loc1.lng) * to_rad;
+    const double a = sq(sin(dlat / 2)) + cos(lat1) * cos(lat2) * sq(sin(dlng / 2));
+    return 2 * RADIUS_OF_EARTH * asin(sqrt(a));
+}
+
+TEST(LocalFrame, MatchesLocationFunctions)
+{
+    for (int16_t lat = -85; lat <= 85; lat += 5) {
+        const struct Location origin = make_location(lat + 0.123456, 149.165230);
+        const LocalFrame frame(origin);
+        EXPECT_EQ(longitude_scale(origin), frame.get_longitude_scale());
+
+        struct Location locs[NUM_POINTS];
+        make_points(origin, locs);
+        for (uint16_t i = 0; i < NUM_POINTS; i++) {
+            const Vector2f expected = location_diff(origin, locs[i]);
+            const Vector2f ne = frame.to_ne(locs[i]);
+            EXPECT_EQ(expected.x, ne.x);
+            EXPECT_EQ(expected.y, ne.y);
+
+            struct Location offset = origin;
+            location_offset(offset, ne.x, ne.y);
+            const struct Location loc = frame.from_ne(ne);
+            EXPECT_EQ(offset.lat, loc.lat);
+            EXPECT_EQ(offset.lng, loc.lng);
+            EXPECT_EQ(origin.alt, loc.alt);
+
+            // these scale longitude at the origin instead of at the
+            // point, which differs by about tan(lat) times the change
+            // in latitude in radians
+            const float scale_error = fabsf(tanf(radians(lat)) * ne.x / RADIUS_OF_EARTH);
+            EXPECT_NEAR(get_distance(origin, locs[i]), frame.get_distance(locs[i]), 2 * scale_error * ne.length() + 0.01f);
+            const int32_t bearing_error = wrap_180_cd(get_bearing_cd(origin, locs[i]) - frame.get_bearing_cd(locs[i]));
+            EXPECT_LE(abs(bearing_error), 2 + 200 * degrees(scale_error));
+        }
+    }
+}
+
+TEST(LocalFrame, Batch)
+{
+    const struct Location origin = make_location(-35.363261, 149.165230);
+    const LocalFrame frame(origin);
+
+    struct Location locs[NUM_POINTS];
+    make_points(origin, locs);
+
+    Vector2f ne[NUM_POINTS];
+    frame.to_ne(locs, ne, NUM_POINTS);
+    for (uint16_t i = 0; i < NUM_POINTS; i++) {
+        const Vector2f expected = frame.to_ne(locs[i]);
+        EXPECT_EQ(expected.x, ne[i].x);
+        EXPECT_EQ(expected.y, ne[i].y);
+    }
+
+    struct Location out[NUM_POINTS];
+    frame.from_ne(ne, out, NUM_POINTS);
+    for (uint16_t i = 0; i < NUM_POINTS; i++) {
+        const struct Location expected = frame.from_ne(ne[i]);
+        EXPECT_EQ(expected.lat, out[i].lat);
+        EXPECT_EQ(expected.lng, out[i].lng);
+        EXPECT_EQ(expected.alt, out[i].alt);
+    }
+}
+
+TEST(LocalFrame, RoundTrip)
+{
+    for (int16_t lat = -85; lat <= 85; lat += 5) {
+        const LocalFrame frame(make_location(lat + 0.5, -120.25));
+
+        // from_ne() truncates to 1e-7 degrees, which in longitude grows
+        // towards the poles
+        const float resolution = LOCATION_SCALING_FACTOR / frame.get_longitude_scale();
+        for (int16_t n = -5000; n <= 5000; n += 250) {
+            for (int16_t e = -5000; e <= 5000; e += 250) {
+                const Vector2f ne(n + 0.123f, e - 0.456f);
+                const Vector2f back = frame.to_ne(frame.from_ne(ne));
+                EXPECT_NEAR(ne.x, back.x, LOCATION_SCALING_FACTOR + 0.001f);
+                EXPECT_NEAR(ne.y, back.y, resolution + 0.001f);
+            }
+        }
+    }
+}
+
+TEST(LocalFrame, AccuracyAcrossLatitudes)
+{
+    for (int16_t lat = -80; lat <= 80; lat += 5) {
+        const struct Location origin = make_location(lat, 10.0);
+        const LocalFrame frame(origin);
+
+        struct Location locs[NUM_POINTS];
+        make_points(origin, locs);
+        for (uint16_t i = 0; i < NUM_POINTS; i++) {
+            // the flat earth error grows with distance and towards the
+            // poles, as the longitude scale changes across the frame
+            const double expected = great_circle_distance(origin, locs[i]);
+            const float tolerance = 0.001f * fabsf(tanf(radians(lat))) * expected + 0.02f;
+            EXPECT_NEAR(expected, frame.get_distance(locs[i]), tolerance);
+        }
+    }
+}
+
+TEST(LocalFrame, DefaultOrigin)
+{
+    const LocalFrame frame;
+    EXPECT_EQ(1.0f, frame.get_longitude_scale());
+    const Vector2f ne = frame.to_ne(make_location(0.001, 0.001));
+    EXPECT_NEAR(111.3f, ne.x, 0.1f);
+    EXPECT_NEAR(111.3f, ne.y, 0.1f);
+}
+
+AP_GTEST_MAIN()
@@ -136,6 +136,25 @@ Generate C++ code for the initialization of members _inverses and _mid_inverses
 declared in AP_GeodesicGrid.h.
 """)
 
+parser.add_argument(
+    '--section-lut-gen',
+    action='store_true',
+    help="""
+Generate C++ code for the initialization of member _section_lut declared in
+AP_GeodesicGrid.h.
+""")
+
+parser.add_argument(
+    '--section-lut-size',
+    type=int,
+    default=16,
+    metavar='N',
+    help="""
+Number of cells along each edge of a cube face for --section-lut-gen. This
+must match AP_GeodesicGrid::SECTION_LUT_SIZE.
+""")
+
+
 
 args = parser.parse_args()
 
@@ -309,6 +328,100 @@ if args.inverses_gen:
     print("};")
 
 
+if args.section_lut_gen:
+    n = args.section_lut_size
+    # minimum distance, for a vector of unit length, from the edges of the
+    # sections a cell maps to
+    margin = 1e-3
+
+    # AP_GeodesicGrid uses the midpoints of the edges without projecting them
+    # to the sphere, which doesn't change the set of vectors crossing a section
+    def section_edges(s):
+        """ Return a dict mapping each edge of section s to the unit normal of
+        the plane containing that edge, pointing into the section """
+        a, b, c = ico.triangles[s // 4]
+        ma, mb, mc = .5 * (a + b), .5 * (b + c), .5 * (c + a)
+        t = ((ma, mb, mc), (a, ma, mc), (ma, b, mb), (mc, mb, c))[s % 4]
+        edges = {}
+        for k in range(3):
+            p, q, r = (np.array(x) for x in (t[k], t[(k + 1) % 3], t[(k + 2) % 3]))
+            normal = np.cross(p, q)
+            normal /= np.linalg.norm(normal)
+            if normal.dot(r) < 0:
+                normal = -normal
+            edges[frozenset((t[k], t[(k + 1) % 3]))] = normal
+        return edges
+
+    edges = [section_edges(s) for s in range(4 * len(ico.triangles))]
+
+    def crosses(normals, p, m):
+        return all(normal.dot(p) >= m for normal in normals)
+
+    lut = []
+    splits = []
+    for face in range(6):
+        axis, sign = face // 2, (1, -1)[face % 2]
+        for i in range(n):
+            for j in range(n):
+                corners = []
+                for ci in (i, i + 1):
+                    for cj in (j, j + 1):
+                        p = np.zeros(3)
+                        p[axis] = sign
+                        p[(axis + 1) % 3] = -1 + 2.0 * ci / n
+                        p[(axis + 2) % 3] = -1 + 2.0 * cj / n
+                        corners.append(p / np.linalg.norm(p))
+
+                sections = set()
+                for p in corners:
+                    sections |= set(
+                        s for s, e in enumerate(edges) if crosses(e.values(), p, -1e-9)
+                    )
+                sections = sorted(sections)
+
+                # the distances are linear along the cell, so if they hold for
+                # all of its corners then they hold for the whole cell
+                entry = 255
+                if len(sections) == 1:
+                    if all(crosses(edges[sections[0]].values(), p, margin) for p in corners):
+                        entry = sections[0]
+                elif len(sections) == 2:
+                    s0, s1 = sections
+                    shared = set(edges[s0]) & set(edges[s1])
+                    if len(shared) == 1:
+                        shared = shared.pop()
+                        outer = [x for e, x in edges[s0].items() if e != shared] + \
+                                [x for e, x in edges[s1].items() if e != shared]
+                        if all(crosses(outer, p, margin) for p in corners):
+                            split = (tuple(edges[s0][shared]), s0, s1)
+                            if split not in splits:
+                                splits.append(split)
+                            entry = 80 + splits.index(split)
+                lut.append(entry)
+
+    print("Header section lookup table code generation:")
+    print_code_gen_notice()
+    print("const uint8_t AP_GeodesicGrid::_section_lut[6][%d][%d]{" % (n, n))
+    for face in range(6):
+        print("    {")
+        for i in range(n):
+            row = lut[(face * n + i) * n:(face * n + i + 1) * n]
+            print("        {%s}," % ",".join("%3d" % x for x in row))
+        print("    },")
+    print("};")
+    print()
+    print_code_gen_notice()
+    print("const struct AP_GeodesicGrid::section_split")
+    print("AP_GeodesicGrid::_section_splits[%d]{" % len(splits))
+    for normal, s0, s1 in splits:
+        print("    {{%9.6ff, %9.6ff, %9.6ff}, {%2d, %2d}}," % (
+            normal[0], normal[1], normal[2], s0, s1))
+    print("};")
+    print("/* %d of %d cells map to a single section and %d are split between"
+          " two */" % (sum(1 for x in lut if x < 80), len(lut),
+                       sum(1 for x in lut if 80 <= x < 255)), file=sys.stderr)
+
+
 if args.icosahedron:
     print('Icosahedron:')
     for i, t in enumerate(ico.triangles):
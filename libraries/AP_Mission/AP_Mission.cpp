@@ -284,6 +284,11 @@ bool AP_Mission::get_next_nav_cmd(uint16_t start_index, Mission_Command& cmd)
 
     // search until the end of the mission command list
     while(cmd_index < (unsigned)_cmd_total) {
+        // skip straight past "do" commands, only navigation and do-jump commands can end the search
+        cmd_index = next_stop_index(cmd_index);
+        if (cmd_index == AP_MISSION_CMD_INDEX_NONE) {
+            return false;
+        }
         // get next command
         if (!get_next_cmd(cmd_index, cmd, false)) {
             // no more commands so return failure
@@ -444,6 +449,14 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
         cmd.p1 = 0;
         cmd.content.location = _ahrs.get_home();
     }else{
+#if AP_MISSION_CACHE_ENABLED
+        // use the decoded copy if we have one
+        if (index < _cache.size && _cache.cmds[index].index == index) {
+            cmd = _cache.cmds[index];
+            return true;
+        }
+#endif
+
         // Find out proper location in memory by using the start_byte position + the index
         // we can load a command, we don't process it yet
         // read WP position
@@ -462,6 +475,12 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
 
         // set command's index to it's position in eeprom
         cmd.index = index;
+
+#if AP_MISSION_CACHE_ENABLED
+        if (index < _cache.size) {
+            _cache.cmds[index] = cmd;
+        }
+#endif
     }
 
     // return success
@@ -493,6 +512,9 @@ bool AP_Mission::write_cmd_to_storage(uint16_t index, Mission_Command& cmd)
         _storage.write_block(pos_in_storage+5, cmd.content.bytes, 10);
     }
 
+    // the decoded copy is re-read on next use as commands above 255 don't store all of their content
+    cache_invalidate(index);
+
     // remember when the mission last changed
     _last_change_time_ms = AP_HAL::millis();
 
@@ -1591,6 +1613,98 @@ void AP_Mission::check_eeprom_version()
     }
 }
 
+///
+/// command cache methods
+///
+
+// cache_reserve - grow the command cache to hold at least count commands
+//     the cache is left as it was if there is not enough memory
+void AP_Mission::cache_reserve(uint16_t count)
+{
+#if AP_MISSION_CACHE_ENABLED
+    if (count <= _cache.size) {
+        return;
+    }
+    // grow in steps so that uploading a mission doesn't reallocate for every command
+    uint16_t size = ((count + AP_MISSION_CACHE_STEP - 1) / AP_MISSION_CACHE_STEP) * AP_MISSION_CACHE_STEP;
+    size = MIN(size, num_commands_max());
+    if (size <= _cache.size) {
+        return;
+    }
+    Mission_Command *cmds = new Mission_Command[size];
+    uint16_t *next_stop = new uint16_t[size];
+    if (cmds == nullptr || next_stop == nullptr) {
+        delete[] cmds;
+        delete[] next_stop;
+        return;
+    }
+    for (uint16_t i=0; i<size; i++) {
+        if (i < _cache.size) {
+            cmds[i] = _cache.cmds[i];
+        } else {
+            cmds[i].index = AP_MISSION_CMD_INDEX_NONE;
+        }
+    }
+    delete[] _cache.cmds;
+    delete[] _cache.next_stop;
+    _cache.cmds = cmds;
+    _cache.next_stop = next_stop;
+    _cache.size = size;
+    _cache.stop_valid = false;
+#endif
+}
+
+// cache_invalidate - forget the cached copy of a command and the stop index
+void AP_Mission::cache_invalidate(uint16_t index)
+{
+#if AP_MISSION_CACHE_ENABLED
+    if (index < _cache.size) {
+        _cache.cmds[index].index = AP_MISSION_CMD_INDEX_NONE;
+    }
+    _cache.stop_valid = false;
+#endif
+}
+
+// next_stop_index - returns the index of the first navigation or do-jump command at or after index
+//     returns AP_MISSION_CMD_INDEX_NONE if there is none before the end of the mission
+uint16_t AP_Mission::next_stop_index(uint16_t index)
+{
+    const uint16_t total = _cmd_total;
+
+#if AP_MISSION_CACHE_ENABLED
+    cache_reserve(total);
+    if (total <= _cache.size) {
+        // rebuild the index after any change to the mission, including
+        // the number of commands being changed through the parameter
+        if (!_cache.stop_valid || _cache.stop_total != total) {
+            uint16_t next = AP_MISSION_CMD_INDEX_NONE;
+            for (int32_t i=total-1; i>=0; i--) {
+                Mission_Command cmd;
+                if (read_cmd_from_storage(i, cmd) && (is_nav_cmd(cmd) || cmd.id == MAV_CMD_DO_JUMP)) {
+                    next = i;
+                }
+                _cache.next_stop[i] = next;
+            }
+            _cache.stop_total = total;
+            _cache.stop_valid = true;
+        }
+        if (index >= total) {
+            return AP_MISSION_CMD_INDEX_NONE;
+        }
+        return _cache.next_stop[index];
+    }
+#endif
+
+    // no cache so search storage
+    for (; index < total; index++) {
+        Mission_Command cmd;
+        if (read_cmd_from_storage(index, cmd) && (is_nav_cmd(cmd) || cmd.id == MAV_CMD_DO_JUMP)) {
+            return index;
+        }
+    }
+    return AP_MISSION_CMD_INDEX_NONE;
+}
+
 /*
   return total number of commands that can fit in storage space
  */
@@ -37,9 +37,16 @@
 
 #define AP_MISSION_RESTART_DEFAULT          0       // resume the mission from the last command run by default
 
+// keep decoded commands in RAM on boards that have the memory for it
+#ifndef AP_MISSION_CACHE_ENABLED
+#define AP_MISSION_CACHE_ENABLED            !HAL_MINIMIZE_FEATURES
+#endif
+#define AP_MISSION_CACHE_STEP               16      // number of commands the cache grows by
+
 /// @class    AP_Mission
 /// @brief    Object managing Mission
 class AP_Mission {
+    friend class AP_Mission_Test;
 
 public:
     // jump command structure
@@ -281,6 +288,14 @@ public:
         _flags.state = MISSION_STOPPED;
         _flags.nav_cmd_loaded = false;
         _flags.do_cmd_loaded = false;
+
+#if AP_MISSION_CACHE_ENABLED
+        _cache.cmds = nullptr;
+        _cache.next_stop = nullptr;
+        _cache.size = 0;
+        _cache.stop_total = 0;
+        _cache.stop_valid = false;
+#endif
     }
 
     ///
@@ -488,6 +503,20 @@ private:
     /// command list will be cleared if they do not match
     void check_eeprom_version();
 
+    ///
+    /// command cache methods
+    ///
+    // cache_reserve - grow the command cache to hold at least count commands
+    //     the cache is left as it was if there is not enough memory
+    void cache_reserve(uint16_t count);
+
+    // cache_invalidate - forget the cached copy of a command and the stop index
+    void cache_invalidate(uint16_t index);
+
+    // next_stop_index - returns the index of the first navigation or do-jump command at or after index
+    //     returns AP_MISSION_CMD_INDEX_NONE if there is none before the end of the mission
+    uint16_t next_stop_index(uint16_t index);
+
     // references to external libraries
     const AP_AHRS&   _ahrs;      // used only for home position
 
@@ -515,4 +544,16 @@ private:
 
     // last time that mission changed
     uint32_t _last_change_time_ms;
+
+#if AP_MISSION_CACHE_ENABLED
+    // decoded copies of the commands in storage, a command is only
+    // valid if its index matches its position in the array
+    struct {
+        Mission_Command *cmds;      // one entry per command in the mission, grown as it is uploaded
+        uint16_t *next_stop;        // first navigation or do-jump command at or after each index
+        uint16_t size;              // number of entries in cmds and next_stop
+        uint16_t stop_total;        // _cmd_total next_stop was built for
+        bool stop_valid;            // true if next_stop is up to date
+    } _cache;
+#endif
 };
@@ -0,0 +1,161 @@
+#include <AP_gtest.h>
+
+#include <AP_Mission/AP_Mission.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static AP_InertialSensor ins;
+static AP_Baro baro;
+static AP_GPS gps;
+static AP_AHRS_DCM ahrs{ins, baro, gps};
+
+class AP_Mission_Test
+{
+public:
+    AP_Mission_Test() :
+        mission{ahrs,
+                FUNCTOR_BIND_MEMBER(&AP_Mission_Test::cmd_fn, bool, const AP_Mission::Mission_Command &),
+                FUNCTOR_BIND_MEMBER(&AP_Mission_Test::cmd_fn, bool, const AP_Mission::Mission_Command &),
+                FUNCTOR_BIND_MEMBER(&AP_Mission_Test::complete_fn, void)}
+    {
+    }
+
+    bool cmd_fn(const AP_Mission::Mission_Command &cmd) { return true; }
+    void complete_fn(void) {}
+
+    uint16_t next_stop_index(uint16_t index) { return mission.next_stop_index(index); }
+#if AP_MISSION_CACHE_ENABLED
+    uint16_t cache_size() const { return mission._cache.size; }
+#endif
+
+    void add(uint16_t id, int32_t alt=0)
+    {
+        AP_Mission::Mission_Command cmd {};
+        cmd.id = id;
+        cmd.content.location.alt = alt;
+        ASSERT_TRUE(mission.add_cmd(cmd));
+    }
+
+    void add_jump(uint16_t target)
+    {
+        AP_Mission::Mission_Command cmd {};
+        cmd.id = MAV_CMD_DO_JUMP;
+        cmd.content.jump.target = target;
+        cmd.content.jump.num_times = 1;
+        ASSERT_TRUE(mission.add_cmd(cmd));
+    }
+
+    // home, WP, do, do, WP, jump, do
+    void load_mission()
+    {
+        ASSERT_TRUE(mission.clear());
+        add(MAV_CMD_NAV_WAYPOINT);
+        add(MAV_CMD_NAV_WAYPOINT, 100);
+        add(MAV_CMD_DO_CHANGE_SPEED);
+        add(MAV_CMD_DO_SET_SERVO);
+        add(MAV_CMD_NAV_WAYPOINT, 400);
+        add_jump(1);
+        add(MAV_CMD_DO_CHANGE_SPEED);
+    }
+
+    AP_Mission mission;
+};
+
+static AP_Mission_Test test;
+
+TEST(AP_Mission, next_stop_index)
+{
+    test.load_mission();
+
+    EXPECT_EQ(0, test.next_stop_index(0));
+    EXPECT_EQ(1, test.next_stop_index(1));
+    EXPECT_EQ(4, test.next_stop_index(2));
+    EXPECT_EQ(4, test.next_stop_index(3));
+    EXPECT_EQ(4, test.next_stop_index(4));
+    EXPECT_EQ(5, test.next_stop_index(5));
+    EXPECT_EQ(AP_MISSION_CMD_INDEX_NONE, test.next_stop_index(6));
+    EXPECT_EQ(AP_MISSION_CMD_INDEX_NONE, test.next_stop_index(7));
+
+    AP_Mission::Mission_Command cmd;
+    ASSERT_TRUE(test.mission.get_next_nav_cmd(2, cmd));
+    EXPECT_EQ(4, cmd.index);
+    EXPECT_EQ(400, cmd.content.location.alt);
+}
+
+TEST(AP_Mission, cache_sized_to_mission)
+{
+    test.load_mission();
+    test.next_stop_index(0);
+
+#if AP_MISSION_CACHE_ENABLED
+    EXPECT_GE(test.cache_size(), test.mission.num_commands());
+    EXPECT_LT(test.cache_size(), test.mission.num_commands() + AP_MISSION_CACHE_STEP);
+#endif
+}
+
+TEST(AP_Mission, cache_invalidated_on_write)
+{
+    test.load_mission();
+
+    AP_Mission::Mission_Command cmd;
+    ASSERT_TRUE(test.mission.read_cmd_from_storage(2, cmd));
+    EXPECT_EQ(MAV_CMD_DO_CHANGE_SPEED, cmd.id);
+    EXPECT_EQ(4, test.next_stop_index(2));
+
+    AP_Mission::Mission_Command wp {};
+    wp.id = MAV_CMD_NAV_WAYPOINT;
+    wp.content.location.alt = 200;
+    ASSERT_TRUE(test.mission.replace_cmd(2, wp));
+
+    ASSERT_TRUE(test.mission.read_cmd_from_storage(2, cmd));
+    EXPECT_EQ(MAV_CMD_NAV_WAYPOINT, cmd.id);
+    EXPECT_EQ(200, cmd.content.location.alt);
+    EXPECT_EQ(2, test.next_stop_index(2));
+    EXPECT_EQ(4, test.next_stop_index(3));
+}
+
+TEST(AP_Mission, cache_invalidated_on_clear)
+{
+    test.load_mission();
+    EXPECT_EQ(4, test.next_stop_index(2));
+
+    ASSERT_TRUE(test.mission.clear());
+    EXPECT_EQ(AP_MISSION_CMD_INDEX_NONE, test.next_stop_index(0));
+
+    // a shorter mission with a do command where a waypoint used to be
+    test.add(MAV_CMD_NAV_WAYPOINT);
+    test.add(MAV_CMD_DO_CHANGE_SPEED);
+    test.add(MAV_CMD_NAV_WAYPOINT, 500);
+
+    AP_Mission::Mission_Command cmd;
+    ASSERT_TRUE(test.mission.read_cmd_from_storage(1, cmd));
+    EXPECT_EQ(MAV_CMD_DO_CHANGE_SPEED, cmd.id);
+    EXPECT_EQ(2, test.next_stop_index(1));
+    EXPECT_EQ(AP_MISSION_CMD_INDEX_NONE, test.next_stop_index(3));
+
+    ASSERT_TRUE(test.mission.get_next_nav_cmd(1, cmd));
+    EXPECT_EQ(2, cmd.index);
+    EXPECT_EQ(500, cmd.content.location.alt);
+}
+
+TEST(AP_Mission, cache_invalidated_on_truncate)
+{
+    test.load_mission();
+    EXPECT_EQ(4, test.next_stop_index(2));
+
+    test.mission.truncate(4);
+    EXPECT_EQ(4, test.mission.num_commands());
+    EXPECT_EQ(AP_MISSION_CMD_INDEX_NONE, test.next_stop_index(2));
+
+    AP_Mission::Mission_Command cmd;
+    EXPECT_FALSE(test.mission.get_next_nav_cmd(2, cmd));
+
+    // commands added after the truncation replace the cached ones
+    test.add(MAV_CMD_DO_SET_SERVO);
+    test.add(MAV_CMD_NAV_WAYPOINT, 600);
+    EXPECT_EQ(5, test.next_stop_index(2));
+    ASSERT_TRUE(test.mission.read_cmd_from_storage(4, cmd));
+    EXPECT_EQ(MAV_CMD_DO_SET_SERVO, cmd.id);
+}
+
+AP_GTEST_MAIN()
@@ -24,8 +24,17 @@
 #endif
 #include <AP_Module/AP_Module.h>
 #include <AP_Module/AP_Module_Structures.h>
+#include <AP_Module/AP_Module_Export.h>
+#if AP_MODULE_EXPORT_SUPPORTED
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 struct AP_Module::hook_list *AP_Module::hooks[NUM_HOOKS];
+struct ap_export_header *AP_Module::export_header;
+char *AP_Module::export_name;
 
 const char *AP_Module::hook_names[AP_Module::NUM_HOOKS] = {
     "ap_hook_setup_start",
@@ -97,6 +106,120 @@ void AP_Module::init(const char *module_path)
     closedir(d);
 }
 
+/*
+  create the shared memory export. The layout is filled in before the
+  magic is set, so readers that open it early wait for the magic
+*/
+bool AP_Module::export_init(const char *name)
+{
+#if AP_MODULE_EXPORT_SUPPORTED
+    if (export_header != nullptr) {
+        return false;
+    }
+
+    struct ap_export_header layout {};
+    layout.layout_version = AP_EXPORT_LAYOUT_VERSION;
+    layout.num_rings = AP_EXPORT_NUM_RINGS;
+
+    // keep slots on their own cache lines from the header
+    uint32_t offset = (sizeof(layout) + 63) & ~63U;
+    for (uint8_t i=0; i<AP_EXPORT_NUM_RINGS; i++) {
+        struct ap_export_ring_header &r = layout.rings[i];
+        if (i == AP_EXPORT_RING_AHRS_STATE) {
+            r.structure_version = AHRS_state_version;
+            r.record_size = sizeof(struct AHRS_state);
+            r.num_slots = AP_EXPORT_AHRS_SLOTS;
+        } else if (i < AP_EXPORT_RING_ACCEL_SAMPLE) {
+            r.structure_version = gyro_sample_version;
+            r.record_size = sizeof(struct gyro_sample);
+            r.num_slots = AP_EXPORT_SAMPLE_SLOTS;
+        } else {
+            r.structure_version = accel_sample_version;
+            r.record_size = sizeof(struct accel_sample);
+            r.num_slots = AP_EXPORT_SAMPLE_SLOTS;
+        }
+        r.slot_size = (sizeof(uint64_t) + r.record_size + 7) & ~7U;
+        r.offset = offset;
+        offset += r.slot_size * r.num_slots;
+    }
+    layout.total_size = offset;
+
+    /*
+      start from a new object rather than resizing an old one, readers
+      still mapping the old one would fault
+     */
+    shm_unlink(name);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        printf("AP_Module: shm_open(%s) -> %s\n", name, strerror(errno));
+        return false;
+    }
+    // the object is zero filled, so all slots start with no record
+    if (ftruncate(fd, layout.total_size) == -1) {
+        printf("AP_Module: ftruncate(%s) -> %s\n", name, strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+    void *p = mmap(nullptr, layout.total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        printf("AP_Module: mmap(%s) -> %s\n", name, strerror(errno));
+        shm_unlink(name);
+        return false;
+    }
+
+    struct ap_export_header *hdr = (struct ap_export_header *)p;
+    memcpy(hdr, &layout, sizeof(layout));
+    __atomic_store_n(&hdr->magic, AP_EXPORT_MAGIC, __ATOMIC_RELEASE);
+
+    export_name = strdup(name);
+    export_header = hdr;
+    printf("AP_Module: Exporting to %s\n", name);
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+  remove the export. This must not be called while hooks may be running
+*/
+void AP_Module::export_close(void)
+{
+#if AP_MODULE_EXPORT_SUPPORTED
+    if (export_header == nullptr) {
+        return;
+    }
+    munmap(export_header, export_header->total_size);
+    export_header = nullptr;
+    shm_unlink(export_name);
+    free(export_name);
+    export_name = nullptr;
+#endif
+}
+
+/*
+  write a record to a ring. Each ring has a single writer, so the head
+  can be read back without atomics
+*/
+void AP_Module::export_record(uint8_t ring, const void *record)
+{
+#if AP_MODULE_EXPORT_SUPPORTED
+    struct ap_export_ring_header &r = export_header->rings[ring];
+    const uint64_t n = r.head;
+    uint8_t *slot = (uint8_t *)export_header + r.offset + (n & (r.num_slots - 1)) * r.slot_size;
+    uint64_t *seq = (uint64_t *)slot;
+
+    // mark the slot as being written before touching the record
+    __atomic_store_n(seq, 2 * n + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(slot + sizeof(uint64_t), record, r.record_size);
+    __atomic_store_n(seq, 2 * n + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&r.head, n + 1, __ATOMIC_RELEASE);
+#endif
+}
+
 
 /*
   call any setup_start hooks
@@ -131,8 +254,8 @@ void AP_Module::call_hook_setup_complete(void)
 */
 void AP_Module::call_hook_AHRS_update(const AP_AHRS_NavEKF &ahrs)
 {
-#if AP_MODULE_SUPPORTED
-    if (hooks[HOOK_AHRS_UPDATE] == nullptr) {
+#if AP_MODULE_SUPPORTED || AP_MODULE_EXPORT_SUPPORTED
+    if (hooks[HOOK_AHRS_UPDATE] == nullptr && export_header == nullptr) {
         // avoid filling in AHRS_state
         return;
     }
@@ -209,6 +332,10 @@ void AP_Module::call_hook_AHRS_update(const AP_AHRS_NavEKF &ahrs)
         state.velocity_ned[1] = vel.y;
         state.velocity_ned[2] = vel.z;
     }
+
+    if (export_header != nullptr) {
+        export_record(AP_EXPORT_RING_AHRS_STATE, &state);
+    }
     
     for (const struct hook_list *h=hooks[HOOK_AHRS_UPDATE]; h; h=h->next) {
         ap_hook_AHRS_update_fn_t fn = reinterpret_cast<ap_hook_AHRS_update_fn_t>(h->symbol);
@@ -223,8 +350,8 @@ void AP_Module::call_hook_AHRS_update(const AP_AHRS_NavEKF &ahrs)
 */
 void AP_Module::call_hook_gyro_sample(uint8_t instance, float dt, const Vector3f &gyro)
 {
-#if AP_MODULE_SUPPORTED
-    if (hooks[HOOK_GYRO_SAMPLE] == nullptr) {
+#if AP_MODULE_SUPPORTED || AP_MODULE_EXPORT_SUPPORTED
+    if (hooks[HOOK_GYRO_SAMPLE] == nullptr && export_header == nullptr) {
         // avoid filling in struct
         return;
     }
@@ -241,6 +368,10 @@ void AP_Module::call_hook_gyro_sample(uint8_t instance, float dt, const Vector3f
     state.gyro[1] = gyro[1];
     state.gyro[2] = gyro[2];
 
+    if (export_header != nullptr && instance < AP_EXPORT_MAX_INSTANCES) {
+        export_record(AP_EXPORT_RING_GYRO_SAMPLE + instance, &state);
+    }
+
     for (const struct hook_list *h=hooks[HOOK_GYRO_SAMPLE]; h; h=h->next) {
         ap_hook_gyro_sample_fn_t fn = reinterpret_cast<ap_hook_gyro_sample_fn_t>(h->symbol);
         fn(&state);
@@ -253,8 +384,8 @@ void AP_Module::call_hook_gyro_sample(uint8_t instance, float dt, const Vector3f
 */
 void AP_Module::call_hook_accel_sample(uint8_t instance, float dt, const Vector3f &accel, bool fsync_set)
 {
-#if AP_MODULE_SUPPORTED
-    if (hooks[HOOK_ACCEL_SAMPLE] == nullptr) {
+#if AP_MODULE_SUPPORTED || AP_MODULE_EXPORT_SUPPORTED
+    if (hooks[HOOK_ACCEL_SAMPLE] == nullptr && export_header == nullptr) {
         // avoid filling in struct
         return;
     }
@@ -272,6 +403,10 @@ void AP_Module::call_hook_accel_sample(uint8_t instance, float dt, const Vector3
     state.accel[2] = accel[2];
     state.fsync_set = fsync_set;
 
+    if (export_header != nullptr && instance < AP_EXPORT_MAX_INSTANCES) {
+        export_record(AP_EXPORT_RING_ACCEL_SAMPLE + instance, &state);
+    }
+
     for (const struct hook_list *h=hooks[HOOK_ACCEL_SAMPLE]; h; h=h->next) {
         ap_hook_accel_sample_fn_t fn = reinterpret_cast<ap_hook_accel_sample_fn_t>(h->symbol);
         fn(&state);
@@ -40,6 +40,14 @@
 #define AP_MODULE_DEFAULT_DIRECTORY "/usr/lib/ardupilot/modules"
 #endif
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#define AP_MODULE_EXPORT_SUPPORTED 1
+#else
+#define AP_MODULE_EXPORT_SUPPORTED 0
+#endif
+
+struct ap_export_header;
+
 class AP_Module {
 public:
 
@@ -60,7 +68,16 @@ public:
 
     // call any accel_sample hooks
     static void call_hook_accel_sample(uint8_t instance, float dt, const Vector3f &accel, bool fsync_set);
-    
+
+    /*
+      publish the structures passed to the hooks in a shared memory
+      object with the given name, see AP_Module_Export.h. Returns
+      false if it couldn't be created
+     */
+    static bool export_init(const char *name);
+
+    // stop publishing and remove the shared memory object
+    static void export_close(void);
     
 private:
 
@@ -89,4 +106,11 @@ private:
     
     // scan a module for hooks
     static void module_scan(const char *path);
+
+    // shared memory export, nullptr when not exporting
+    static struct ap_export_header *export_header;
+    static char *export_name;
+
+    // write a record to a ring of the export
+    static void export_record(uint8_t ring, const void *record);
 };
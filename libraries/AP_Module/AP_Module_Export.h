@@ -0,0 +1,133 @@
+/*
+  this defines the layout of the shared memory export of the module
+  structures in AP_Module_Structures.h
+
+  The export lets processes outside ArduPilot read the same data the
+  module hooks get, without running anything in the sensor path. It is
+  a POSIX shared memory object holding one ring of records per data
+  source. Each ring has a single writer in ArduPilot and any number of
+  readers, and no locks are taken on either side: a reader that falls
+  more than a ring behind loses records rather than stalling the writer.
+
+  Like AP_Module_Structures.h this header doesn't depend on other
+  headers inside ArduPilot, so it can be used to build readers on a
+  companion computer
+ */
+
+#pragma once
+
+#include "AP_Module_Structures.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+// "APMX" in memory
+#define AP_EXPORT_MAGIC 0x584d5041
+#define AP_EXPORT_LAYOUT_VERSION 1
+
+// name passed to shm_open() when no other is given
+#define AP_EXPORT_DEFAULT_NAME "/ardupilot_export"
+
+// IMU instances with their own gyro and accel rings
+#define AP_EXPORT_MAX_INSTANCES 3
+
+// number of records kept in each ring, powers of two
+#define AP_EXPORT_AHRS_SLOTS 64
+#define AP_EXPORT_SAMPLE_SLOTS 1024
+
+/*
+  ring index of each data source. There is one ring per IMU instance
+  so that each ring is only written by one backend thread
+ */
+enum ap_export_ring {
+    AP_EXPORT_RING_AHRS_STATE   = 0,
+    AP_EXPORT_RING_GYRO_SAMPLE  = 1,
+    AP_EXPORT_RING_ACCEL_SAMPLE = AP_EXPORT_RING_GYRO_SAMPLE + AP_EXPORT_MAX_INSTANCES,
+    AP_EXPORT_NUM_RINGS         = AP_EXPORT_RING_ACCEL_SAMPLE + AP_EXPORT_MAX_INSTANCES
+};
+
+struct ap_export_ring_header {
+    // version of the records in this ring (eg. AHRS_state_version)
+    uint32_t structure_version;
+
+    // size of each record in bytes
+    uint32_t record_size;
+
+    // size of each slot in bytes: a 64 bit sequence followed by the record
+    uint32_t slot_size;
+
+    // number of slots, a power of two
+    uint32_t num_slots;
+
+    // offset of the first slot from the start of the export
+    uint32_t offset;
+
+    uint32_t reserved;
+
+    // number of records written to the ring so far
+    uint64_t head;
+};
+
+struct ap_export_header {
+    // AP_EXPORT_MAGIC once the export is ready to be read
+    uint32_t magic;
+
+    // version of this layout (AP_EXPORT_LAYOUT_VERSION)
+    uint32_t layout_version;
+
+    // size of the export in bytes
+    uint32_t total_size;
+
+    // number of rings (AP_EXPORT_NUM_RINGS)
+    uint32_t num_rings;
+
+    struct ap_export_ring_header rings[AP_EXPORT_NUM_RINGS];
+};
+
+/*
+  Each slot starts with a sequence number. The writer of record n sets
+  it to 2n+1 before changing the record and to 2n+2 once it's done, so a
+  reader knows a copy of record n is good if the sequence was 2n+2 both
+  before and after it was taken.
+ */
+
+// number of records written so far to a ring
+static inline uint64_t ap_export_head(const struct ap_export_header *hdr,
+                                      enum ap_export_ring ring)
+{
+    return __atomic_load_n(&hdr->rings[ring].head, __ATOMIC_ACQUIRE);
+}
+
+/*
+  copy record n of a ring into record, which must hold record_size
+  bytes for the ring. Returns 1 on success, 0 if record n hasn't been
+  written yet and -1 if it has already been overwritten, in which case
+  the reader should carry on from a more recent record
+ */
+static inline int ap_export_read(const struct ap_export_header *hdr,
+                                 enum ap_export_ring ring,
+                                 uint64_t n, void *record)
+{
+    const struct ap_export_ring_header *r = &hdr->rings[ring];
+    const uint8_t *slot = (const uint8_t *)hdr + r->offset +
+        (n & (r->num_slots - 1)) * r->slot_size;
+    const uint64_t *seq = (const uint64_t *)slot;
+    const uint64_t expected = 2 * n + 2;
+
+    uint64_t s = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+    if (s != expected) {
+        return s < expected ? 0 : -1;
+    }
+    memcpy(record, slot + sizeof(uint64_t), r->record_size);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    s = __atomic_load_n(seq, __ATOMIC_RELAXED);
+    return s == expected ? 1 : -1;
+}
+
+#ifdef __cplusplus
+}
+#endif
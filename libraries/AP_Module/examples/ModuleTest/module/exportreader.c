@@ -0,0 +1,75 @@
+/*
+  very simple reader of the shared memory export, run as a separate
+  process next to ArduPilot started with --module-export
+
+  build with: gcc -I.. -I../../.. -o exportreader exportreader.c -lrt
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <AP_Module_Export.h>
+
+#define degrees(x) (x * 180.0 / M_PI)
+
+int main(int argc, const char *argv[])
+{
+    const char *name = argc > 1 ? argv[1] : AP_EXPORT_DEFAULT_NAME;
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd == -1) {
+        perror(name);
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror(name);
+        return 1;
+    }
+    const struct ap_export_header *hdr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (hdr == MAP_FAILED) {
+        perror(name);
+        return 1;
+    }
+    while (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != AP_EXPORT_MAGIC) {
+        usleep(10000);
+    }
+    if (hdr->layout_version != AP_EXPORT_LAYOUT_VERSION ||
+        hdr->rings[AP_EXPORT_RING_AHRS_STATE].structure_version != AHRS_state_version) {
+        printf("%s: unsupported version\n", name);
+        return 1;
+    }
+
+    // start from the newest record and print euler angles once per second
+    uint64_t next = ap_export_head(hdr, AP_EXPORT_RING_AHRS_STATE);
+    uint64_t last_print_us = 0;
+    while (true) {
+        struct AHRS_state state;
+        int r = ap_export_read(hdr, AP_EXPORT_RING_AHRS_STATE, next, &state);
+        if (r == 0) {
+            usleep(1000);
+            continue;
+        }
+        if (r < 0) {
+            // we've fallen behind, skip to the newest record
+            next = ap_export_head(hdr, AP_EXPORT_RING_AHRS_STATE);
+            continue;
+        }
+        next++;
+        if (state.time_us - last_print_us < 1000000UL) {
+            continue;
+        }
+        last_print_us = state.time_us;
+        printf("AHRS (%.1f,%.1f,%.1f)\n",
+               degrees(state.eulers[0]),
+               degrees(state.eulers[1]),
+               degrees(state.eulers[2]));
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include <AP_gtest.h>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Module/AP_Module.h>
+#include <AP_Module/AP_Module_Export.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if AP_MODULE_EXPORT_SUPPORTED
+
+/*
+ * Maps the export the way a process on the companion side would
+ */
+class ModuleExport : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        snprintf(name, sizeof(name), "/ap_test_export_%d", (int)getpid());
+        ASSERT_TRUE(AP_Module::export_init(name));
+
+        int fd = shm_open(name, O_RDONLY, 0);
+        ASSERT_NE(-1, fd);
+        struct stat st;
+        ASSERT_EQ(0, fstat(fd, &st));
+        size = st.st_size;
+        void *p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        ASSERT_NE(MAP_FAILED, p);
+        hdr = (const struct ap_export_header *)p;
+    }
+
+    void TearDown() override
+    {
+        if (hdr != nullptr) {
+            munmap((void *)hdr, size);
+        }
+        AP_Module::export_close();
+    }
+
+    char name[64];
+    size_t size;
+    const struct ap_export_header *hdr = nullptr;
+};
+
+TEST_F(ModuleExport, Layout)
+{
+    EXPECT_EQ((uint32_t)AP_EXPORT_MAGIC, hdr->magic);
+    EXPECT_EQ((uint32_t)AP_EXPORT_LAYOUT_VERSION, hdr->layout_version);
+    EXPECT_EQ((uint32_t)AP_EXPORT_NUM_RINGS, hdr->num_rings);
+    EXPECT_EQ(size, hdr->total_size);
+
+    const struct ap_export_ring_header &ahrs = hdr->rings[AP_EXPORT_RING_AHRS_STATE];
+    EXPECT_EQ((uint32_t)AHRS_state_version, ahrs.structure_version);
+    EXPECT_EQ(sizeof(struct AHRS_state), ahrs.record_size);
+
+    for (uint8_t i = 0; i < AP_EXPORT_MAX_INSTANCES; i++) {
+        const struct ap_export_ring_header &gyro = hdr->rings[AP_EXPORT_RING_GYRO_SAMPLE + i];
+        EXPECT_EQ((uint32_t)gyro_sample_version, gyro.structure_version);
+        EXPECT_EQ(sizeof(struct gyro_sample), gyro.record_size);
+        const struct ap_export_ring_header &accel = hdr->rings[AP_EXPORT_RING_ACCEL_SAMPLE + i];
+        EXPECT_EQ((uint32_t)accel_sample_version, accel.structure_version);
+        EXPECT_EQ(sizeof(struct accel_sample), accel.record_size);
+    }
+
+    // rings don't overlap and fit in the export
+    for (uint8_t i = 0; i < AP_EXPORT_NUM_RINGS; i++) {
+        const struct ap_export_ring_header &r = hdr->rings[i];
+        EXPECT_EQ(0U, r.offset % 8);
+        EXPECT_EQ(0U, r.slot_size % 8);
+        EXPECT_GE(r.slot_size, r.record_size + 8);
+        EXPECT_EQ(0U, r.num_slots & (r.num_slots - 1));
+        EXPECT_GE(r.offset, sizeof(struct ap_export_header));
+        if (i + 1 < AP_EXPORT_NUM_RINGS) {
+            EXPECT_EQ(r.offset + r.slot_size * r.num_slots, hdr->rings[i + 1].offset);
+        } else {
+            EXPECT_EQ(r.offset + r.slot_size * r.num_slots, hdr->total_size);
+        }
+    }
+}
+
+TEST_F(ModuleExport, Samples)
+{
+    const enum ap_export_ring ring = (enum ap_export_ring)(AP_EXPORT_RING_GYRO_SAMPLE + 1);
+    struct gyro_sample sample;
+
+    EXPECT_EQ(0U, ap_export_head(hdr, ring));
+    EXPECT_EQ(0, ap_export_read(hdr, ring, 0, &sample));
+
+    AP_Module::call_hook_gyro_sample(1, 0.001f, Vector3f(1, 2, 3));
+    EXPECT_EQ(1U, ap_export_head(hdr, ring));
+    ASSERT_EQ(1, ap_export_read(hdr, ring, 0, &sample));
+    EXPECT_EQ((uint32_t)gyro_sample_version, sample.structure_version);
+    EXPECT_EQ(1, sample.instance);
+    EXPECT_FLOAT_EQ(0.001f, sample.delta_time);
+    EXPECT_FLOAT_EQ(3, sample.gyro[2]);
+
+    // other instances have their own ring
+    EXPECT_EQ(0U, ap_export_head(hdr, AP_EXPORT_RING_GYRO_SAMPLE));
+    AP_Module::call_hook_accel_sample(1, 0.001f, Vector3f(4, 5, 6), true);
+    struct accel_sample accel;
+    ASSERT_EQ(1, ap_export_read(hdr, (enum ap_export_ring)(AP_EXPORT_RING_ACCEL_SAMPLE + 1), 0, &accel));
+    EXPECT_TRUE(accel.fsync_set);
+    EXPECT_FLOAT_EQ(6, accel.accel[2]);
+
+    // a full ring later the first sample is gone
+    const uint32_t slots = hdr->rings[ring].num_slots;
+    for (uint32_t i = 1; i <= slots; i++) {
+        AP_Module::call_hook_gyro_sample(1, 0.001f, Vector3f(i, 0, 0));
+    }
+    EXPECT_EQ(slots + 1, ap_export_head(hdr, ring));
+    EXPECT_EQ(-1, ap_export_read(hdr, ring, 0, &sample));
+    ASSERT_EQ(1, ap_export_read(hdr, ring, 1, &sample));
+    EXPECT_FLOAT_EQ(1, sample.gyro[0]);
+    ASSERT_EQ(1, ap_export_read(hdr, ring, slots, &sample));
+    EXPECT_FLOAT_EQ(slots, sample.gyro[0]);
+    EXPECT_EQ(0, ap_export_read(hdr, ring, slots + 1, &sample));
+}
+
+static void *publish_samples(void *arg)
+{
+    const uint32_t count = *(const uint32_t *)arg;
+    for (uint32_t i = 0; i < count; i++) {
+        AP_Module::call_hook_gyro_sample(0, 0.001f, Vector3f(i, i, i));
+    }
+    return nullptr;
+}
+
+TEST_F(ModuleExport, ConcurrentReader)
+{
+    const enum ap_export_ring ring = AP_EXPORT_RING_GYRO_SAMPLE;
+    uint32_t count = 200000;
+    pthread_t writer;
+
+    ASSERT_EQ(0, pthread_create(&writer, nullptr, publish_samples, &count));
+
+    // every sample read is whole and in order, however far behind the
+    // reader is
+    uint64_t next = 0;
+    uint32_t n_read = 0;
+    uint32_t n_lost = 0;
+    while (next < count) {
+        struct gyro_sample sample;
+        int r = ap_export_read(hdr, ring, next, &sample);
+        if (r == 0) {
+            continue;
+        }
+        if (r < 0) {
+            // skip to the oldest sample still in the ring
+            const uint64_t head = ap_export_head(hdr, ring);
+            const uint64_t oldest = head - hdr->rings[ring].num_slots + 1;
+            ASSERT_GT(oldest, next);
+            n_lost += oldest - next;
+            next = oldest;
+            continue;
+        }
+        ASSERT_EQ(sample.gyro[0], sample.gyro[1]);
+        ASSERT_EQ(sample.gyro[0], sample.gyro[2]);
+        ASSERT_EQ((float)next, sample.gyro[0]);
+        n_read++;
+        next++;
+    }
+
+    pthread_join(writer, nullptr);
+    EXPECT_EQ(count, n_read + n_lost);
+}
+
+#endif // AP_MODULE_EXPORT_SUPPORTED
+
+AP_GTEST_MAIN()
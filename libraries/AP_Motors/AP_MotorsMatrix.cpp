@@ -19,6 +19,7 @@
  *
  */
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Scheduler/LatencyTrace.h>
 #include "AP_MotorsMatrix.h"
 
 extern const AP_HAL::HAL& hal;
@@ -287,6 +288,11 @@ void AP_MotorsMatrix::output_armed_stabilizing()
             _thrust_rpyt_out[i] = constrain_float(_thrust_rpyt_out[i], 0.0f, 1.0f);
         }
     }
+
+    LatencyTrace *trace = LatencyTrace::get_instance();
+    if (trace != nullptr) {
+        trace->mark(LatencyTrace::STAGE_MIX);
+    }
 }
 
 // output_test - spin a motor at the pwm value specified
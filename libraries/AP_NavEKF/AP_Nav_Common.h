@@ -16,6 +16,14 @@
  */
 #pragma once
 
+#include <AP_Math/AP_Math.h>
+#include <AP_Airspeed/AP_Airspeed.h>
+#include <AP_Baro/AP_Baro.h>
+#include <AP_Compass/AP_Compass.h>
+#include <AP_GPS/AP_GPS.h>
+#include <AP_InertialSensor/AP_InertialSensor.h>
+#include <AP_RangeFinder/AP_RangeFinder.h>
+
 union nav_filter_status {
     struct {
         uint16_t attitude           : 1; // 0 - true if attitude estimate is valid
@@ -68,3 +76,287 @@ struct ekf_timing {
     float delVelDT_max;
     float delVelDT_min;
 };
+
+/*
+  snapshot of the IMU data read by the EKFs on each update. Filters given
+  one read it instead of the INS library, letting them consume the IMU
+  stream from a queue away from the main thread
+ */
+struct ekf_imu_sample {
+    uint64_t time_us;
+    float loop_delta_t;
+    uint8_t gyro_count;
+    uint8_t accel_count;
+    uint8_t primary_gyro;
+    uint8_t primary_accel;
+    uint8_t use_gyro_mask;
+    uint8_t use_accel_mask;
+    uint8_t gyro_health_mask;
+    Vector3f gyro[INS_MAX_INSTANCES];
+    Vector3f delta_angle[INS_MAX_INSTANCES];
+    float delta_angle_dt[INS_MAX_INSTANCES];
+    Vector3f delta_velocity[INS_MAX_INSTANCES];
+    float delta_velocity_dt[INS_MAX_INSTANCES];
+
+    // take a snapshot of the latest IMU data
+    void capture(const AP_InertialSensor &ins, uint64_t sample_time_us) {
+        time_us = sample_time_us;
+        loop_delta_t = ins.get_loop_delta_t();
+        gyro_count = ins.get_gyro_count();
+        accel_count = ins.get_accel_count();
+        primary_gyro = ins.get_primary_gyro();
+        primary_accel = ins.get_primary_accel();
+        use_gyro_mask = 0;
+        use_accel_mask = 0;
+        gyro_health_mask = 0;
+        for (uint8_t i=0; i<INS_MAX_INSTANCES; i++) {
+            if (ins.use_gyro(i)) {
+                use_gyro_mask |= 1U<<i;
+            }
+            if (ins.use_accel(i)) {
+                use_accel_mask |= 1U<<i;
+            }
+            if (ins.get_gyro_health(i)) {
+                gyro_health_mask |= 1U<<i;
+            }
+            gyro[i] = ins.get_gyro(i);
+            delta_angle_dt[i] = ins.get_delta_angle_dt(i);
+            delta_velocity_dt[i] = ins.get_delta_velocity_dt(i);
+            if (!ins.get_delta_angle(i, delta_angle[i])) {
+                delta_angle[i].zero();
+            }
+            if (!ins.get_delta_velocity(i, delta_velocity[i])) {
+                delta_velocity[i].zero();
+            }
+        }
+    }
+
+    // fold a newer sample into this one, for when the queue is full
+    void accumulate(const ekf_imu_sample &newer) {
+        time_us = newer.time_us;
+        loop_delta_t += newer.loop_delta_t;
+        gyro_count = newer.gyro_count;
+        accel_count = newer.accel_count;
+        primary_gyro = newer.primary_gyro;
+        primary_accel = newer.primary_accel;
+        use_gyro_mask = newer.use_gyro_mask;
+        use_accel_mask = newer.use_accel_mask;
+        gyro_health_mask = newer.gyro_health_mask;
+        for (uint8_t i=0; i<INS_MAX_INSTANCES; i++) {
+            gyro[i] = newer.gyro[i];
+            delta_angle[i] += newer.delta_angle[i];
+            delta_angle_dt[i] += newer.delta_angle_dt[i];
+            delta_velocity[i] += newer.delta_velocity[i];
+            delta_velocity_dt[i] += newer.delta_velocity_dt[i];
+        }
+    }
+};
+
+/*
+  snapshot of the other sensor data read by the EKFs while updating. The
+  filters take one at the start of each update, or are given the one
+  queued with the IMU data, so they never read the sensor libraries
+  while the main thread is updating them. The accessors match those of
+  the libraries
+ */
+struct ekf_sensor_sample {
+    // primary GPS
+    class GPS {
+    public:
+        uint32_t last_message_time_ms() const { return _last_message_time_ms; }
+        AP_GPS::GPS_Status status() const { return _status; }
+        uint8_t primary_sensor() const { return _primary_sensor; }
+        uint8_t num_sats() const { return _num_sats; }
+        uint16_t get_hdop() const { return _hdop; }
+        bool have_vertical_velocity() const { return _have_vertical_velocity; }
+        bool speed_accuracy(float &sacc) const { sacc = _speed_accuracy; return _have_speed_accuracy; }
+        bool horizontal_accuracy(float &hacc) const { hacc = _horizontal_accuracy; return _have_horizontal_accuracy; }
+        bool vertical_accuracy(float &vacc) const { vacc = _vertical_accuracy; return _have_vertical_accuracy; }
+        bool get_lag(float &lag_sec) const { lag_sec = _lag; return _have_lag; }
+        const Location &location() const { return _location; }
+        const Vector3f &velocity() const { return _velocity; }
+        const Vector3f &get_antenna_offset(uint8_t instance) const { return _antenna_offset[instance]; }
+
+        void capture(const AP_GPS &gps) {
+            _last_message_time_ms = gps.last_message_time_ms();
+            _status = gps.status();
+            _primary_sensor = gps.primary_sensor();
+            _num_sats = gps.num_sats();
+            _hdop = gps.get_hdop();
+            _have_vertical_velocity = gps.have_vertical_velocity();
+            _have_speed_accuracy = gps.speed_accuracy(_speed_accuracy);
+            _have_horizontal_accuracy = gps.horizontal_accuracy(_horizontal_accuracy);
+            _have_vertical_accuracy = gps.vertical_accuracy(_vertical_accuracy);
+            _have_lag = gps.get_lag(_lag);
+            _location = gps.location();
+            _velocity = gps.velocity();
+            for (uint8_t i=0; i<GPS_MAX_INSTANCES; i++) {
+                _antenna_offset[i] = gps.get_antenna_offset(i);
+            }
+        }
+
+    private:
+        uint32_t _last_message_time_ms;
+        AP_GPS::GPS_Status _status;
+        uint8_t _primary_sensor;
+        uint8_t _num_sats;
+        uint16_t _hdop;
+        bool _have_vertical_velocity;
+        bool _have_speed_accuracy;
+        bool _have_horizontal_accuracy;
+        bool _have_vertical_accuracy;
+        bool _have_lag;
+        float _speed_accuracy;
+        float _horizontal_accuracy;
+        float _vertical_accuracy;
+        float _lag;
+        Location _location;
+        Vector3f _velocity;
+        Vector3f _antenna_offset[GPS_MAX_INSTANCES];
+    } gps;
+
+    // compass, if there is one
+    class Compass {
+    public:
+        bool available() const { return _available; }
+        uint8_t get_count() const { return _count; }
+        uint8_t get_primary() const { return _primary; }
+        bool learn_offsets_enabled() const { return _learn_offsets_enabled; }
+        bool consistent() const { return _consistent; }
+        float get_declination() const { return _declination; }
+        bool use_for_yaw(uint8_t i) const { return (_use_for_yaw_mask & (1U<<i)) != 0; }
+        bool healthy(uint8_t i) const { return (_healthy_mask & (1U<<i)) != 0; }
+        uint32_t last_update_usec() const { return _last_update_usec[_primary]; }
+        uint32_t last_update_usec(uint8_t i) const { return _last_update_usec[i]; }
+        const Vector3f &get_field(uint8_t i) const { return _field[i]; }
+        const Vector3f &get_offsets(uint8_t i) const { return _offsets[i]; }
+
+        void capture(const ::Compass *compass) {
+            _available = (compass != nullptr);
+            if (compass == nullptr) {
+                return;
+            }
+            _count = compass->get_count();
+            _primary = compass->get_primary();
+            _learn_offsets_enabled = compass->learn_offsets_enabled();
+            _consistent = compass->consistent();
+            _declination = compass->get_declination();
+            _use_for_yaw_mask = 0;
+            _healthy_mask = 0;
+            for (uint8_t i=0; i<COMPASS_MAX_INSTANCES; i++) {
+                if (compass->use_for_yaw(i)) {
+                    _use_for_yaw_mask |= 1U<<i;
+                }
+                if (compass->healthy(i)) {
+                    _healthy_mask |= 1U<<i;
+                }
+                _last_update_usec[i] = compass->last_update_usec(i);
+                _field[i] = compass->get_field(i);
+                _offsets[i] = compass->get_offsets(i);
+            }
+        }
+
+    private:
+        bool _available;
+        uint8_t _count;
+        uint8_t _primary;
+        bool _learn_offsets_enabled;
+        bool _consistent;
+        float _declination;
+        uint8_t _use_for_yaw_mask;
+        uint8_t _healthy_mask;
+        uint32_t _last_update_usec[COMPASS_MAX_INSTANCES];
+        Vector3f _field[COMPASS_MAX_INSTANCES];
+        Vector3f _offsets[COMPASS_MAX_INSTANCES];
+    } compass;
+
+    // primary barometer
+    class Baro {
+    public:
+        uint32_t get_last_update() const { return _last_update_ms; }
+        float get_altitude() const { return _altitude; }
+
+        void capture(const AP_Baro &baro) {
+            _last_update_ms = baro.get_last_update();
+            _altitude = baro.get_altitude();
+        }
+
+    private:
+        uint32_t _last_update_ms;
+        float _altitude;
+    } baro;
+
+    // airspeed sensor, if there is one
+    class Airspeed {
+    public:
+        bool available() const { return _available; }
+        bool use() const { return _use; }
+        // use() and healthy, as AP_AHRS::airspeed_sensor_enabled()
+        bool enabled() const { return _enabled; }
+        uint32_t last_update_ms() const { return _last_update_ms; }
+        float get_airspeed() const { return _airspeed; }
+        float get_raw_airspeed() const { return _raw_airspeed; }
+        // 1 without a sensor, as AP_AHRS::get_EAS2TAS()
+        float get_EAS2TAS() const { return _EAS2TAS; }
+
+        void capture(const AP_Airspeed *airspeed) {
+            _available = (airspeed != nullptr);
+            _use = _available && airspeed->use();
+            _enabled = _use && airspeed->healthy();
+            _last_update_ms = _available ? airspeed->last_update_ms() : 0;
+            _airspeed = _available ? airspeed->get_airspeed() : 0;
+            _raw_airspeed = _available ? airspeed->get_raw_airspeed() : 0;
+            _EAS2TAS = _available ? airspeed->get_EAS2TAS() : 1.0f;
+        }
+
+    private:
+        bool _available;
+        bool _use;
+        bool _enabled;
+        uint32_t _last_update_ms;
+        float _airspeed;
+        float _raw_airspeed;
+        float _EAS2TAS;
+    } airspeed;
+
+    // range finders, of which the EKFs only use those facing down
+    class RangeFinder {
+    public:
+        int16_t ground_clearance_cm() const { return _ground_clearance_cm; }
+        int16_t max_distance_cm() const { return _max_distance_cm; }
+        // facing down with a good reading
+        bool down_good(uint8_t i) const { return (_down_good_mask & (1U<<i)) != 0; }
+        uint16_t distance_cm(uint8_t i) const { return _distance_cm[i]; }
+        const Vector3f &get_pos_offset(uint8_t i) const { return _pos_offset[i]; }
+
+        void capture(const ::RangeFinder &rng) {
+            _ground_clearance_cm = rng.ground_clearance_cm_orient(ROTATION_PITCH_270);
+            _max_distance_cm = rng.max_distance_cm_orient(ROTATION_PITCH_270);
+            _down_good_mask = 0;
+            for (uint8_t i=0; i<RANGEFINDER_MAX_INSTANCES; i++) {
+                if (rng.get_orientation(i) == ROTATION_PITCH_270 &&
+                    rng.status(i) == ::RangeFinder::RangeFinder_Good) {
+                    _down_good_mask |= 1U<<i;
+                }
+                _distance_cm[i] = rng.distance_cm(i);
+                _pos_offset[i] = rng.get_pos_offset(i);
+            }
+        }
+
+    private:
+        int16_t _ground_clearance_cm;
+        int16_t _max_distance_cm;
+        uint8_t _down_good_mask;
+        uint16_t _distance_cm[RANGEFINDER_MAX_INSTANCES];
+        Vector3f _pos_offset[RANGEFINDER_MAX_INSTANCES];
+    } rng;
+
+    void capture(const AP_GPS &_gps, const ::Compass *_compass, const AP_Baro &_baro,
+                 const ::RangeFinder &_rng, const AP_Airspeed *_airspeed) {
+        gps.capture(_gps);
+        compass.capture(_compass);
+        baro.capture(_baro);
+        rng.capture(_rng);
+        airspeed.capture(_airspeed);
+    }
+};
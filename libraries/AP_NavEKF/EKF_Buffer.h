@@ -0,0 +1,363 @@
+// EKF Buffer models
+
+#pragma once
+
+#include <stdint.h>
+
+// this buffer model is to be used for observation buffers,
+// the data is pushed into buffer like any standard ring buffer
+// return is based on the sample time provided
+//
+// The buffer is kept in time order, so the right sample can be found
+// with a binary search on the timestamps. It holds exactly the length
+// asked for, as it is allocated per sensor and core, and its indices
+// are wrapped with a compare rather than a modulo
+template <typename element_type>
+class obs_ring_buffer_t
+{
+public:
+    ~obs_ring_buffer_t()
+    {
+        delete[] _buffer;
+    }
+
+    // initialise buffer, returns false when allocation has failed
+    bool init(uint32_t size)
+    {
+        delete[] _buffer;
+        _buffer = new element_type[size];
+        if (_buffer == nullptr) {
+            _size = 0;
+            return false;
+        }
+        _size = size;
+        reset();
+        return true;
+    }
+
+    /*
+     * Searches through a ring buffer and return the newest data that is older than the
+     * time specified by sample_time_ms
+     * Removes it and any older data so it cannot be used again
+     * Returns false if no data can be found that is less than 100msec old
+    */
+    bool recall(element_type &element, uint32_t sample_time)
+    {
+        if (_count == 0) {
+            return false;
+        }
+
+        // number of samples at or before sample_time
+        uint32_t low = 0, high = _count;
+        while (low < high) {
+            const uint32_t mid = (low + high) / 2;
+            if (_buffer[index(mid)].time_ms <= sample_time) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (low == 0) {
+            return false;
+        }
+
+        const element_type &newest = _buffer[index(low - 1)];
+        // samples this old will never be in the time horizon window again
+        _tail = index(low);
+        _count -= low;
+        if (sample_time - newest.time_ms >= 100) {
+            return false;
+        }
+        element = newest;
+        return true;
+    }
+
+    /*
+     * Writes data and timestamp to a Ring buffer and advances indices that
+     * define the location of the newest and oldest data
+     * A sample older than the newest stored is inserted in time order.
+     * When full the oldest data is dropped, or the new sample if it is
+     * older than all of it
+    */
+    inline void push(const element_type &element)
+    {
+        if (_count == _size) {
+            if (_size == 0 || element.time_ms < _buffer[_tail].time_ms) {
+                return;
+            }
+            _tail = index(1);
+            _count--;
+        }
+        uint32_t n = _count;
+        while (n != 0 && _buffer[index(n - 1)].time_ms > element.time_ms) {
+            _buffer[index(n)] = _buffer[index(n - 1)];
+            n--;
+        }
+        _buffer[index(n)] = element;
+        _count++;
+    }
+
+    // empties the ring buffer
+    inline void reset()
+    {
+        _tail = 0;
+        _count = 0;
+    }
+
+    // returns the number of samples waiting to be recalled
+    uint32_t available() const
+    {
+        return _count;
+    }
+
+    // returns the memory allocated for the samples in bytes
+    uint32_t allocated_bytes() const
+    {
+        return _size * sizeof(element_type);
+    }
+
+private:
+    // index of the sample n places after the oldest, n < _size
+    uint32_t index(uint32_t n) const
+    {
+        const uint32_t i = _tail + n;
+        return i < _size ? i : i - _size;
+    }
+
+    element_type *_buffer = nullptr;
+    uint32_t _size;
+    // index of the oldest sample stored and the number stored
+    uint32_t _tail;
+    uint32_t _count;
+};
+
+
+// Indices of the buffers below, which delay each sample by their
+// length. The output buffer is indexed with the IMU buffer's indices,
+// so both advance the same way. The length sets the delay and can't be
+// rounded up, so indices are wrapped with a compare rather than a modulo
+class ekf_delay_index_t
+{
+public:
+    // returns the index for the ring buffer oldest data
+    inline uint8_t get_oldest_index() const
+    {
+        return _oldest;
+    }
+
+    // returns the index for the ring buffer youngest data
+    inline uint8_t get_youngest_index() const
+    {
+        return _youngest;
+    }
+
+protected:
+    inline void reset_index()
+    {
+        _youngest = 0;
+        _oldest = 0;
+    }
+
+    // move on to the index for a new youngest sample, returning it
+    inline uint8_t advance()
+    {
+        _youngest = next(_youngest);
+        _oldest = next(_youngest);
+        return _youngest;
+    }
+
+    uint8_t _size = 0;
+    uint8_t _oldest = 0;
+    uint8_t _youngest = 0;
+
+private:
+    inline uint8_t next(uint8_t index) const
+    {
+        return index+1 < _size ? index+1 : 0;
+    }
+};
+
+
+// Following buffer model is for IMU data,
+// it achieves a distance of sample size
+// between youngest and oldest
+//
+// The data is pushed and popped a whole sample at a time, so it is kept
+// as an array of samples
+template <typename element_type>
+class imu_ring_buffer_t : public ekf_delay_index_t
+{
+public:
+    ~imu_ring_buffer_t()
+    {
+        delete[] _buffer;
+    }
+
+    // initialise buffer, returns false when allocation has failed
+    bool init(uint32_t size)
+    {
+        delete[] _buffer;
+        _buffer = new element_type[size];
+        if (_buffer == nullptr) {
+            _size = 0;
+            return false;
+        }
+        _size = size;
+        reset();
+        return true;
+    }
+
+    /*
+     * Writes data to a Ring buffer and advances indices that
+     * define the location of the newest and oldest data
+    */
+    inline void push_youngest_element(const element_type &element)
+    {
+        // push youngest to the buffer
+        _buffer[advance()] = element;
+    }
+
+    // retrieve the oldest data from the ring buffer tail
+    inline const element_type &pop_oldest_element() const
+    {
+        return _buffer[_oldest];
+    }
+
+    // writes the same data to all elements in the ring buffer
+    inline void reset_history(const element_type &element)
+    {
+        for (uint8_t index=0; index<_size; index++) {
+            _buffer[index] = element;
+        }
+    }
+
+    // zeroes all data in the ring buffer
+    inline void reset()
+    {
+        reset_index();
+        for (uint8_t index=0; index<_size; index++) {
+            _buffer[index] = element_type{};
+        }
+    }
+
+    // retrieves data from the ring buffer at a specified index
+    inline element_type& operator[](uint32_t index)
+    {
+        return _buffer[index];
+    }
+
+    // returns the memory allocated for the samples in bytes
+    uint32_t allocated_bytes() const
+    {
+        return _size * sizeof(element_type);
+    }
+
+private:
+    element_type *_buffer = nullptr;
+};
+
+
+// The same delay for the IMU deltas, stored as a struct of arrays with
+// one array per field of the sample. element_type needs delAng, delVel,
+// delAngDT, delVelDT and time_ms
+template <typename element_type>
+class imu_delta_buffer_t : public ekf_delay_index_t
+{
+public:
+    ~imu_delta_buffer_t()
+    {
+        free_arrays();
+    }
+
+    // initialise buffer, returns false when allocation has failed
+    bool init(uint32_t size)
+    {
+        free_arrays();
+        _delAng = new vector_type[size];
+        _delVel = new vector_type[size];
+        _delAngDT = new float[size];
+        _delVelDT = new float[size];
+        _time_ms = new uint32_t[size];
+        if (_delAng == nullptr || _delVel == nullptr || _delAngDT == nullptr ||
+            _delVelDT == nullptr || _time_ms == nullptr) {
+            free_arrays();
+            _size = 0;
+            return false;
+        }
+        _size = size;
+        reset();
+        return true;
+    }
+
+    /*
+     * Writes data to a Ring buffer and advances indices that
+     * define the location of the newest and oldest data
+    */
+    inline void push_youngest_element(const element_type &element)
+    {
+        write(advance(), element);
+    }
+
+    // retrieve the oldest data from the ring buffer tail
+    inline element_type pop_oldest_element() const
+    {
+        element_type element;
+        element.delAng = _delAng[_oldest];
+        element.delVel = _delVel[_oldest];
+        element.delAngDT = _delAngDT[_oldest];
+        element.delVelDT = _delVelDT[_oldest];
+        element.time_ms = _time_ms[_oldest];
+        return element;
+    }
+
+    // writes the same data to all elements in the ring buffer
+    inline void reset_history(const element_type &element)
+    {
+        for (uint8_t index=0; index<_size; index++) {
+            write(index, element);
+        }
+    }
+
+    // zeroes all data in the ring buffer
+    inline void reset()
+    {
+        reset_index();
+        reset_history(element_type{});
+    }
+
+    // returns the memory allocated for the samples in bytes
+    uint32_t allocated_bytes() const
+    {
+        return _size * (2 * sizeof(vector_type) + 2 * sizeof(float) + sizeof(uint32_t));
+    }
+
+private:
+    typedef decltype(element_type::delAng) vector_type;
+
+    inline void write(uint8_t index, const element_type &element)
+    {
+        _delAng[index] = element.delAng;
+        _delVel[index] = element.delVel;
+        _delAngDT[index] = element.delAngDT;
+        _delVelDT[index] = element.delVelDT;
+        _time_ms[index] = element.time_ms;
+    }
+
+    void free_arrays()
+    {
+        delete[] _delAng;
+        delete[] _delVel;
+        delete[] _delAngDT;
+        delete[] _delVelDT;
+        delete[] _time_ms;
+        _delAng = _delVel = nullptr;
+        _delAngDT = _delVelDT = nullptr;
+        _time_ms = nullptr;
+    }
+
+    vector_type *_delAng = nullptr;
+    vector_type *_delVel = nullptr;
+    float *_delAngDT = nullptr;
+    float *_delVelDT = nullptr;
+    uint32_t *_time_ms = nullptr;
+};
@@ -0,0 +1,76 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_NavEKF/EKF_Buffer.h>
+
+struct bm_element {
+    float data[6];
+    uint32_t time_ms;
+};
+
+/*
+ * Push one sample and recall one from the fusion time horizon each
+ * iteration, keeping the buffer full as it is with a long sensor delay
+ */
+static void BM_EKFObsBufferRecall(benchmark::State& state)
+{
+    const uint32_t length = state.range_x();
+    obs_ring_buffer_t<bm_element> buffer;
+    bm_element element {};
+    uint32_t time_ms = 1000;
+
+    buffer.init(length);
+    for (uint32_t i = 0; i < length; i++) {
+        element.time_ms = time_ms++;
+        buffer.push(element);
+    }
+
+    while (state.KeepRunning()) {
+        element.time_ms = time_ms++;
+        buffer.push(element);
+        bool found = buffer.recall(element, time_ms - length);
+        gbenchmark_escape(&found);
+    }
+}
+
+static void BM_EKFIMUBuffer(benchmark::State& state)
+{
+    imu_ring_buffer_t<bm_element> buffer;
+    bm_element element {};
+
+    buffer.init(state.range_x());
+
+    while (state.KeepRunning()) {
+        element.time_ms++;
+        buffer.push_youngest_element(element);
+        bm_element oldest = buffer.pop_oldest_element();
+        gbenchmark_escape(&oldest);
+    }
+}
+
+struct bm_imu_element {
+    struct { float x, y, z; } delAng, delVel;
+    float delAngDT;
+    float delVelDT;
+    uint32_t time_ms;
+};
+
+static void BM_EKFIMUDeltaBuffer(benchmark::State& state)
+{
+    imu_delta_buffer_t<bm_imu_element> buffer;
+    bm_imu_element element {};
+
+    buffer.init(state.range_x());
+
+    while (state.KeepRunning()) {
+        element.time_ms++;
+        buffer.push_youngest_element(element);
+        bm_imu_element oldest = buffer.pop_oldest_element();
+        gbenchmark_escape(&oldest);
+    }
+}
+
+BENCHMARK(BM_EKFObsBufferRecall)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(BM_EKFIMUBuffer)->Arg(10)->Arg(50);
+BENCHMARK(BM_EKFIMUDeltaBuffer)->Arg(10)->Arg(50);
+
+BENCHMARK_MAIN()
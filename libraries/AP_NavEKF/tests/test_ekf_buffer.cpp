@@ -0,0 +1,374 @@
+#include <AP_gtest.h>
+
+#include <algorithm>
+#include <deque>
+#include <stdlib.h>
+#include <string.h>
+
+#include <AP_NavEKF/EKF_Buffer.h>
+
+struct test_element {
+    uint32_t time_ms;
+    uint32_t value;
+};
+
+static bool time_before(const test_element &a, const test_element &b)
+{
+    return a.time_ms < b.time_ms;
+}
+
+/*
+ * Straightforward model of the observation buffer: a time ordered queue
+ * searched from the oldest sample
+ */
+class obs_buffer_model {
+public:
+    obs_buffer_model(uint32_t size) : _size(size) { }
+
+    void push(const test_element &element)
+    {
+        if (_queue.size() == _size) {
+            if (element.time_ms < _queue.front().time_ms) {
+                return;
+            }
+            _queue.pop_front();
+        }
+        _queue.insert(std::upper_bound(_queue.begin(), _queue.end(), element, time_before), element);
+    }
+
+    bool recall(test_element &element, uint32_t sample_time)
+    {
+        bool found = false;
+        test_element newest;
+        while (!_queue.empty() && _queue.front().time_ms <= sample_time) {
+            newest = _queue.front();
+            found = true;
+            _queue.pop_front();
+        }
+        if (!found || sample_time - newest.time_ms >= 100) {
+            return false;
+        }
+        element = newest;
+        return true;
+    }
+
+private:
+    std::deque<test_element> _queue;
+    uint32_t _size;
+};
+
+/*
+ * The observation buffer the EKFs used before, which searched from the
+ * oldest unused sample up to the first newer than the time horizon
+ */
+class baseline_obs_buffer {
+public:
+    bool init(uint32_t size)
+    {
+        buffer = new test_element[size];
+        memset(buffer, 0, size*sizeof(test_element));
+        _size = size;
+        _head = 0;
+        _tail = 0;
+        _new_data = false;
+        return true;
+    }
+
+    ~baseline_obs_buffer() { delete[] buffer; }
+
+    bool recall(test_element &element, uint32_t sample_time)
+    {
+        if (!_new_data) {
+            return false;
+        }
+        bool success = false;
+        uint8_t tail = _tail, bestIndex = 0;
+
+        if (_head == tail) {
+            if (buffer[tail].time_ms != 0 && buffer[tail].time_ms <= sample_time) {
+                if (((sample_time - buffer[tail].time_ms) < 100)) {
+                    bestIndex = tail;
+                    success = true;
+                    _new_data = false;
+                }
+            }
+        } else {
+            while (_head != tail) {
+                if (buffer[tail].time_ms != 0 && buffer[tail].time_ms <= sample_time) {
+                    if (((sample_time - buffer[tail].time_ms) < 100)) {
+                        bestIndex = tail;
+                        success = true;
+                    }
+                } else if (buffer[tail].time_ms > sample_time) {
+                    break;
+                }
+                tail = (tail+1)%_size;
+            }
+        }
+
+        if (!success) {
+            return false;
+        }
+        element = buffer[bestIndex];
+        _tail = (bestIndex+1)%_size;
+        buffer[bestIndex].time_ms = 0;
+        return true;
+    }
+
+    void push(const test_element &element)
+    {
+        _head = (_head+1)%_size;
+        buffer[_head] = element;
+        _new_data = true;
+    }
+
+private:
+    test_element *buffer;
+    uint8_t _size, _head, _tail, _new_data;
+};
+
+TEST(EKFObsBuffer, RecallNewestInWindow)
+{
+    obs_ring_buffer_t<test_element> buffer;
+    test_element e;
+
+    ASSERT_TRUE(buffer.init(6));
+    EXPECT_FALSE(buffer.recall(e, 1000));
+
+    buffer.push({990, 1});
+    buffer.push({995, 2});
+    buffer.push({1005, 3});
+
+    // sample 3 is newer than the time horizon
+    ASSERT_TRUE(buffer.recall(e, 1000));
+    EXPECT_EQ(2U, e.value);
+    EXPECT_EQ(1U, buffer.available());
+
+    // samples are only used once
+    EXPECT_FALSE(buffer.recall(e, 1000));
+
+    ASSERT_TRUE(buffer.recall(e, 1005));
+    EXPECT_EQ(3U, e.value);
+    EXPECT_EQ(0U, buffer.available());
+}
+
+TEST(EKFObsBuffer, DiscardStale)
+{
+    obs_ring_buffer_t<test_element> buffer;
+    test_element e;
+
+    ASSERT_TRUE(buffer.init(4));
+    buffer.push({800, 1});
+    buffer.push({850, 2});
+    buffer.push({1050, 3});
+
+    EXPECT_FALSE(buffer.recall(e, 1000));
+    EXPECT_EQ(1U, buffer.available());
+
+    ASSERT_TRUE(buffer.recall(e, 1100));
+    EXPECT_EQ(3U, e.value);
+}
+
+TEST(EKFObsBuffer, Overflow)
+{
+    obs_ring_buffer_t<test_element> buffer;
+    test_element e;
+
+    // holds exactly the length asked for, keeping the newest samples
+    ASSERT_TRUE(buffer.init(3));
+    for (uint32_t i = 0; i < 6; i++) {
+        buffer.push({1000 + i, i});
+    }
+    EXPECT_EQ(3U, buffer.available());
+
+    EXPECT_FALSE(buffer.recall(e, 1002));
+    ASSERT_TRUE(buffer.recall(e, 1003));
+    EXPECT_EQ(3U, e.value);
+    ASSERT_TRUE(buffer.recall(e, 1010));
+    EXPECT_EQ(5U, e.value);
+}
+
+TEST(EKFObsBuffer, OutOfOrder)
+{
+    obs_ring_buffer_t<test_element> buffer;
+    test_element e;
+
+    // a late sample is put in time order, without losing newer ones
+    ASSERT_TRUE(buffer.init(8));
+    buffer.push({1000, 1});
+    buffer.push({1020, 2});
+    buffer.push({1030, 3});
+    buffer.push({1010, 4});
+    EXPECT_EQ(4U, buffer.available());
+
+    ASSERT_TRUE(buffer.recall(e, 1025));
+    EXPECT_EQ(2U, e.value);
+    ASSERT_TRUE(buffer.recall(e, 1035));
+    EXPECT_EQ(3U, e.value);
+
+    // when full, one older than everything stored is dropped
+    ASSERT_TRUE(buffer.init(2));
+    buffer.push({1000, 1});
+    buffer.push({1020, 2});
+    buffer.push({990, 3});
+    buffer.push({1010, 4});
+    EXPECT_EQ(2U, buffer.available());
+    ASSERT_TRUE(buffer.recall(e, 1015));
+    EXPECT_EQ(4U, e.value);
+    ASSERT_TRUE(buffer.recall(e, 1025));
+    EXPECT_EQ(2U, e.value);
+}
+
+/*
+ * sensors delivering in time order, as they do unless their lag is
+ * changed, give the same samples as the old buffer did at every step.
+ * The old buffer never looked at the newest sample unless it was the
+ * only one unused, so the comparison starts once it has used two
+ * samples and a new one has been pushed. After that the newest is only
+ * inside the time horizon when it is the only one unused, as long as
+ * the sensor lag is less than the EKF delay and at most one sample
+ * arrives per EKF step
+ */
+TEST(EKFObsBuffer, MatchesBaseline)
+{
+    // sensor interval, sensor lag and EKF delay in ms
+    const uint32_t cases[][3] = {
+        { 100, 10, 220 },   // gps
+        { 20, 10, 220 },    // compass
+        { 13, 0, 100 },     // baro
+        { 50, 30, 60 },     // range finder
+        { 40, 60, 250 },    // optical flow
+    };
+
+    srandom(7);
+    for (const auto &c : cases) {
+        const uint32_t interval_ms = c[0], lag_ms = c[1], delay_ms = c[2];
+        // with room for every sample inside the delay, as the old
+        // buffer overwrote unused samples when full
+        const uint32_t size = 2 * (delay_ms + lag_ms) / interval_ms + 4;
+        obs_ring_buffer_t<test_element> buffer;
+        baseline_obs_buffer baseline;
+        ASSERT_TRUE(buffer.init(size));
+        ASSERT_TRUE(baseline.init(size));
+        test_element got { 0, 0 }, expected { 0, 0 };
+        for (uint32_t i = 1; i <= 2; i++) {
+            buffer.push({i, 0});
+            baseline.push({i, 0});
+        }
+        ASSERT_TRUE(baseline.recall(expected, 50));
+        ASSERT_TRUE(baseline.recall(expected, 50));
+        ASSERT_TRUE(buffer.recall(got, 50));
+
+        uint32_t next_ms = 1000;
+        uint32_t recalled = 0;
+        for (uint32_t now_ms = 1000; now_ms < 60000; now_ms += 10) {
+            while (next_ms <= now_ms) {
+                const test_element pushed { next_ms - lag_ms, next_ms };
+                buffer.push(pushed);
+                baseline.push(pushed);
+                // jitter of up to a quarter of the interval, keeping
+                // samples at least one EKF step apart
+                next_ms += interval_ms - interval_ms / 4 + random() % (interval_ms / 2 + 1);
+            }
+            const bool found = buffer.recall(got, now_ms - delay_ms);
+            ASSERT_EQ(baseline.recall(expected, now_ms - delay_ms), found) << now_ms;
+            if (found) {
+                ASSERT_EQ(expected.time_ms, got.time_ms);
+                ASSERT_EQ(expected.value, got.value);
+                recalled++;
+            }
+        }
+        EXPECT_GT(recalled, 59000 / (interval_ms > 10 ? interval_ms : 10) / 2);
+    }
+}
+
+TEST(EKFObsBuffer, MatchesModel)
+{
+    const uint32_t sizes[] = { 1, 2, 5, 8, 13, 50 };
+
+    srandom(42);
+    for (uint32_t size : sizes) {
+        obs_ring_buffer_t<test_element> buffer;
+        ASSERT_TRUE(buffer.init(size));
+        obs_buffer_model model(size);
+
+        uint32_t now_ms = 1000;
+        uint32_t horizon_ms = 800;
+        for (uint32_t i = 0; i < 100000; i++) {
+            now_ms += random() % 10;
+            if (random() % 3 == 0) {
+                // sensor lag changes can step the timestamps back
+                const test_element pushed { now_ms - (uint32_t)(random() % 50), i };
+                buffer.push(pushed);
+                model.push(pushed);
+            }
+            horizon_ms += random() % 12;
+            if (horizon_ms > now_ms) {
+                horizon_ms = now_ms;
+            }
+            test_element got { 0, 0 }, expected { 0, 0 };
+            const bool found = buffer.recall(got, horizon_ms);
+            ASSERT_EQ(model.recall(expected, horizon_ms), found);
+            if (found) {
+                ASSERT_EQ(expected.time_ms, got.time_ms);
+                ASSERT_EQ(expected.value, got.value);
+            }
+        }
+    }
+}
+
+struct test_vector {
+    float x, y, z;
+};
+
+struct test_imu_element {
+    test_vector delAng;
+    test_vector delVel;
+    float delAngDT;
+    float delVelDT;
+    uint32_t time_ms;
+};
+
+// the struct of arrays buffer gives the samples back as pushed
+TEST(EKFIMUBuffer, DeltasMatchSamples)
+{
+    imu_ring_buffer_t<test_imu_element> samples;
+    imu_delta_buffer_t<test_imu_element> deltas;
+
+    ASSERT_TRUE(samples.init(7));
+    ASSERT_TRUE(deltas.init(7));
+    const test_imu_element first { {1, 2, 3}, {4, 5, 6}, 0.1f, 0.2f, 1 };
+    samples.reset_history(first);
+    deltas.reset_history(first);
+    for (uint32_t i = 2; i <= 30; i++) {
+        const float f = i;
+        const test_imu_element element { {f, -f, 2*f}, {3*f, f/2, -f}, f/100, f/50, i };
+        samples.push_youngest_element(element);
+        deltas.push_youngest_element(element);
+        EXPECT_EQ(samples.get_youngest_index(), deltas.get_youngest_index());
+        EXPECT_EQ(samples.get_oldest_index(), deltas.get_oldest_index());
+        const test_imu_element a = samples.pop_oldest_element();
+        const test_imu_element b = deltas.pop_oldest_element();
+        EXPECT_EQ(0, memcmp(&a, &b, sizeof(a)));
+    }
+
+    deltas.reset();
+    EXPECT_EQ(0U, deltas.pop_oldest_element().time_ms);
+    EXPECT_EQ(0.0f, deltas.pop_oldest_element().delVel.z);
+}
+
+TEST(EKFIMUBuffer, Delay)
+{
+    imu_ring_buffer_t<test_element> buffer;
+
+    ASSERT_TRUE(buffer.init(5));
+    buffer.reset_history({0, 0});
+    for (uint32_t i = 1; i <= 20; i++) {
+        buffer.push_youngest_element({i, i});
+        EXPECT_EQ(i, buffer[buffer.get_youngest_index()].value);
+        // the oldest sample is the one pushed size - 1 times ago
+        EXPECT_EQ(i > 4 ? i - 4 : 0, buffer.pop_oldest_element().value);
+    }
+}
+
+AP_GTEST_MAIN()
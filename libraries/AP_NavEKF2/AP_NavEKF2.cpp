@@ -588,12 +588,25 @@ NavEKF2::NavEKF2(const AP_AHRS *ahrs, AP_Baro &baro, const RangeFinder &rng) :
     AP_Param::setup_object_defaults(this, var_info);
 }
 
+/*
+  take a copy of the sensor data read by the cores during this update,
+  unless they are given the data queued with the IMU sample
+ */
+void NavEKF2::capture_sensors(void)
+{
+    if (queuedSensors == nullptr) {
+        sensorsCopy.capture(_ahrs->get_gps(), _ahrs->get_compass(), _baro, _rng, _ahrs->get_airspeed());
+    }
+}
+
 /*
   see if we should log some sensor data
  */
 void NavEKF2::check_log_write(void)
 {
-    if (!have_ekf_logging()) {
+    // a filter run from a queue is behind the sensor libraries and
+    // must not read them, so it can't log its sensor data for replay
+    if (!have_ekf_logging() || imuSample != nullptr) {
         return;
     }
     if (logging.log_compass) {
@@ -628,6 +641,7 @@ bool NavEKF2::InitialiseFilter(void)
     const AP_InertialSensor &ins = _ahrs->get_ins();
 
     imuSampleTime_us = AP_HAL::micros64();
+    capture_sensors();
 
     // remember expected frame time
     _frameTimeUsec = 1e6 / ins.get_sample_rate();
@@ -706,7 +720,12 @@ void NavEKF2::UpdateFilter(void)
         return;
     }
 
-    imuSampleTime_us = AP_HAL::micros64();
+    if (imuSample != nullptr) {
+        imuSampleTime_us = imuSample->time_us;
+    } else {
+        imuSampleTime_us = AP_HAL::micros64();
+    }
+    capture_sensors();
     
     const AP_InertialSensor &ins = _ahrs->get_ins();
 
@@ -715,8 +734,10 @@ void NavEKF2::UpdateFilter(void)
         // if we have not overrun by more than 3 IMU frames, and we
         // have already used more than 1/3 of the CPU budget for this
         // loop then suppress the prediction step. This allows
-        // multiple EKF instances to cooperate on scheduling
-        if (core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
+        // multiple EKF instances to cooperate on scheduling. A filter
+        // fed from a queue runs on its own time and never defers
+        if (imuSample == nullptr &&
+            core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
             (AP_HAL::micros() - ins.get_last_update_usec()) > _frameTimeUsec/3) {
             statePredictEnabled[i] = false;
         } else {
@@ -825,7 +825,7 @@ void NavEKF2_core::fuseEulerYaw()
     // to prevent uncontrolled variance growth whilst on ground without magnetometer
     float measured_yaw;
     if (use_compass() && yawAlignComplete && magStateInitComplete) {
-        measured_yaw = wrap_PI(-atan2f(magMeasNED.y, magMeasNED.x) + _ahrs->get_compass()->get_declination());
+        measured_yaw = wrap_PI(-atan2f(magMeasNED.y, magMeasNED.x) + sensors().compass.get_declination());
     } else {
         measured_yaw = predicted_yaw;
     }
@@ -1003,7 +1003,7 @@ void NavEKF2_core::FuseDeclination(float declErr)
     }
 
     // get the magnetic declination
-    float magDecAng = use_compass() ? _ahrs->get_compass()->get_declination() : 0;
+    float magDecAng = use_compass() ? sensors().compass.get_declination() : 0;
 
     // Calculate the innovation
     float innovation = atan2f(magE , magN) - magDecAng;
@@ -1087,7 +1087,7 @@ void NavEKF2_core::alignMagStateDeclination()
     }
 
     // get the magnetic declination
-    float magDecAng = use_compass() ? _ahrs->get_compass()->get_declination() : 0;
+    float magDecAng = use_compass() ? sensors().compass.get_declination() : 0;
 
     // rotate the NE values so that the declination matches the published value
     Vector3f initMagNED = stateStruct.earth_magfield;
@@ -26,7 +26,7 @@ void NavEKF2_core::readRangeFinder(void)
 
     // get theoretical correct range when the vehicle is on the ground
     // don't allow range to go below 5cm because this can cause problems with optical flow processing
-    rngOnGnd = MAX(frontend->_rng.ground_clearance_cm_orient(ROTATION_PITCH_270) * 0.01f, 0.05f);
+    rngOnGnd = MAX(sensors().rng.ground_clearance_cm() * 0.01f, 0.05f);
 
     // read range finder at 20Hz
     // TODO better way of knowing if it has new data
@@ -39,13 +39,13 @@ void NavEKF2_core::readRangeFinder(void)
         // use data from two range finders if available
 
         for (uint8_t sensorIndex = 0; sensorIndex <= 1; sensorIndex++) {
-            if ((frontend->_rng.get_orientation(sensorIndex) == ROTATION_PITCH_270) && (frontend->_rng.status(sensorIndex) == RangeFinder::RangeFinder_Good)) {
+            if (sensors().rng.down_good(sensorIndex)) {
                 rngMeasIndex[sensorIndex] ++;
                 if (rngMeasIndex[sensorIndex] > 2) {
                     rngMeasIndex[sensorIndex] = 0;
                 }
                 storedRngMeasTime_ms[sensorIndex][rngMeasIndex[sensorIndex]] = imuSampleTime_ms - 25;
-                storedRngMeas[sensorIndex][rngMeasIndex[sensorIndex]] = frontend->_rng.distance_cm(sensorIndex) * 0.01f;
+                storedRngMeas[sensorIndex][rngMeasIndex[sensorIndex]] = sensors().rng.distance_cm(sensorIndex) * 0.01f;
             }
 
             // check for three fresh samples
@@ -183,26 +183,26 @@ void NavEKF2_core::writeOptFlowMeas(uint8_t &rawFlowQuality, Vector2f &rawFlowRa
 // check for new magnetometer data and update store measurements if available
 void NavEKF2_core::readMagData()
 {
-    if (!_ahrs->get_compass()) {
+    if (!sensors().compass.available()) {
         allMagSensorsFailed = true;
         return;        
     }
     // If we are a vehicle with a sideslip constraint to aid yaw estimation and we have timed out on our last avialable
     // magnetometer, then declare the magnetometers as failed for this flight
-    uint8_t maxCount = _ahrs->get_compass()->get_count();
+    uint8_t maxCount = sensors().compass.get_count();
     if (allMagSensorsFailed || (magTimeout && assume_zero_sideslip() && magSelectIndex >= maxCount-1 && inFlight)) {
         allMagSensorsFailed = true;
         return;
     }
 
-    if (_ahrs->get_compass()->learn_offsets_enabled()) {
+    if (sensors().compass.learn_offsets_enabled()) {
         // while learning offsets keep all mag states reset
         InitialiseVariablesMag();
     }
     
     // do not accept new compass data faster than 14Hz (nominal rate is 10Hz) to prevent high processor loading
     // because magnetometer fusion is an expensive step and we could overflow the FIFO buffer
-    if (use_compass() && _ahrs->get_compass()->last_update_usec() - lastMagUpdate_us > 70000) {
+    if (use_compass() && sensors().compass.last_update_usec() - lastMagUpdate_us > 70000) {
         frontend->logging.log_compass = true;
 
         // If the magnetometer has timed out (been rejected too long) we find another magnetometer to use if available
@@ -218,7 +218,7 @@ void NavEKF2_core::readMagData()
                     tempIndex -= maxCount;
                 }
                 // if the magnetometer is allowed to be used for yaw and has a different index, we start using it
-                if (_ahrs->get_compass()->use_for_yaw(tempIndex) && tempIndex != magSelectIndex) {
+                if (sensors().compass.use_for_yaw(tempIndex) && tempIndex != magSelectIndex) {
                     magSelectIndex = tempIndex;
                     GCS_MAVLINK::send_statustext_all(MAV_SEVERITY_INFO, "EKF2 IMU%u switching to compass %u",(unsigned)imu_index,magSelectIndex);
                     // reset the timeout flag and timer
@@ -239,7 +239,7 @@ void NavEKF2_core::readMagData()
         }
 
         // detect changes to magnetometer offset parameters and reset states
-        Vector3f nowMagOffsets = _ahrs->get_compass()->get_offsets(magSelectIndex);
+        Vector3f nowMagOffsets = sensors().compass.get_offsets(magSelectIndex);
         bool changeDetected = lastMagOffsetsValid && (nowMagOffsets != lastMagOffsets);
         if (changeDetected) {
             // Adjust the magnetometer bias states so there is no step change in magnetometer innovations
@@ -252,7 +252,7 @@ void NavEKF2_core::readMagData()
         lastMagOffsetsValid = true;
 
         // store time of last measurement update
-        lastMagUpdate_us = _ahrs->get_compass()->last_update_usec(magSelectIndex);
+        lastMagUpdate_us = sensors().compass.last_update_usec(magSelectIndex);
 
         // estimate of time magnetometer measurement was taken, allowing for delays
         magDataNew.time_ms = imuSampleTime_ms - frontend->magDelay_ms;
@@ -261,10 +261,10 @@ void NavEKF2_core::readMagData()
         magDataNew.time_ms -= localFilterTimeStep_ms/2;
 
         // read compass data and scale to improve numerical conditioning
-        magDataNew.mag = _ahrs->get_compass()->get_field(magSelectIndex) * 0.001f;
+        magDataNew.mag = sensors().compass.get_field(magSelectIndex) * 0.001f;
 
         // check for consistent data between magnetometers
-        consistentMagData = _ahrs->get_compass()->consistent();
+        consistentMagData = sensors().compass.consistent();
 
         // save magnetometer measurement to buffer to be fused later
         storedMag.push(magDataNew);
@@ -285,29 +285,42 @@ void NavEKF2_core::readMagData()
 void NavEKF2_core::readIMUData()
 {
     const AP_InertialSensor &ins = _ahrs->get_ins();
+    const ekf_imu_sample *sample = frontend->imuSample;
+
+    // read from the queued snapshot of the IMU data if we have one
+    const float loop_delta_t = sample ? sample->loop_delta_t : ins.get_loop_delta_t();
+    const bool use_accel = sample ? (sample->use_accel_mask & (1U<<imu_index)) != 0 : ins.use_accel(imu_index);
+    const bool use_gyro = sample ? (sample->use_gyro_mask & (1U<<imu_index)) != 0 : ins.use_gyro(imu_index);
+    const uint8_t primary_accel = sample ? sample->primary_accel : ins.get_primary_accel();
+    const uint8_t primary_gyro = sample ? sample->primary_gyro : ins.get_primary_gyro();
+    const float delAngDT = sample ? sample->delta_angle_dt[imu_index] : ins.get_delta_angle_dt(imu_index);
 
     // average IMU sampling rate
-    dtIMUavg = ins.get_loop_delta_t();
+    dtIMUavg = loop_delta_t;
 
     // the imu sample time is used as a common time reference throughout the filter
-    imuSampleTime_ms = AP_HAL::millis();
+    if (sample != nullptr) {
+        imuSampleTime_ms = sample->time_us / 1000;
+    } else {
+        imuSampleTime_ms = AP_HAL::millis();
+    }
 
     // use the nominated imu or primary if not available
-    if (ins.use_accel(imu_index)) {
+    if (use_accel) {
         readDeltaVelocity(imu_index, imuDataNew.delVel, imuDataNew.delVelDT);
         accelPosOffset = ins.get_imu_pos_offset(imu_index);
     } else {
-        readDeltaVelocity(ins.get_primary_accel(), imuDataNew.delVel, imuDataNew.delVelDT);
-        accelPosOffset = ins.get_imu_pos_offset(ins.get_primary_accel());
+        readDeltaVelocity(primary_accel, imuDataNew.delVel, imuDataNew.delVelDT);
+        accelPosOffset = ins.get_imu_pos_offset(primary_accel);
     }
 
     // Get delta angle data from primary gyro or primary if not available
-    if (ins.use_gyro(imu_index)) {
+    if (use_gyro) {
         readDeltaAngle(imu_index, imuDataNew.delAng);
     } else {
-        readDeltaAngle(ins.get_primary_gyro(), imuDataNew.delAng);
+        readDeltaAngle(primary_gyro, imuDataNew.delAng);
     }
-    imuDataNew.delAngDT = MAX(ins.get_delta_angle_dt(imu_index),1.0e-4f);
+    imuDataNew.delAngDT = MAX(delAngDT,1.0e-4f);
 
     // Get current time stamp
     imuDataNew.time_ms = imuSampleTime_ms;
@@ -394,6 +407,16 @@ void NavEKF2_core::readIMUData()
 // return false if data is not available
 bool NavEKF2_core::readDeltaVelocity(uint8_t ins_index, Vector3f &dVel, float &dVel_dt) {
     const AP_InertialSensor &ins = _ahrs->get_ins();
+    const ekf_imu_sample *sample = frontend->imuSample;
+
+    if (sample != nullptr) {
+        if (ins_index < sample->accel_count) {
+            dVel = sample->delta_velocity[ins_index];
+            dVel_dt = MAX(sample->delta_velocity_dt[ins_index],1.0e-4f);
+            return true;
+        }
+        return false;
+    }
 
     if (ins_index < ins.get_accel_count()) {
         ins.get_delta_velocity(ins_index,dVel);
@@ -412,8 +435,8 @@ void NavEKF2_core::readGpsData()
 {
     // check for new GPS data
     // do not accept data at a faster rate than 14Hz to avoid overflowing the FIFO buffer
-    if (_ahrs->get_gps().last_message_time_ms() - lastTimeGpsReceived_ms > 70) {
-        if (_ahrs->get_gps().status() >= AP_GPS::GPS_OK_FIX_3D) {
+    if (sensors().gps.last_message_time_ms() - lastTimeGpsReceived_ms > 70) {
+        if (sensors().gps.status() >= AP_GPS::GPS_OK_FIX_3D) {
             // report GPS fix status
             gpsCheckStatus.bad_fix = false;
 
@@ -421,7 +444,7 @@ void NavEKF2_core::readGpsData()
             secondLastGpsTime_ms = lastTimeGpsReceived_ms;
 
             // get current fix time
-            lastTimeGpsReceived_ms = _ahrs->get_gps().last_message_time_ms();
+            lastTimeGpsReceived_ms = sensors().gps.last_message_time_ms();
 
             // estimate when the GPS fix was valid, allowing for GPS processing and other delays
             // ideally we should be using a timing signal from the GPS receiver to set this time
@@ -434,17 +457,17 @@ void NavEKF2_core::readGpsData()
             gpsDataNew.time_ms = MAX(gpsDataNew.time_ms,imuDataDelayed.time_ms);
 
             // Get which GPS we are using for position information
-            gpsDataNew.sensor_idx = _ahrs->get_gps().primary_sensor();
+            gpsDataNew.sensor_idx = sensors().gps.primary_sensor();
 
             // read the NED velocity from the GPS
-            gpsDataNew.vel = _ahrs->get_gps().velocity();
+            gpsDataNew.vel = sensors().gps.velocity();
 
             // Use the speed and position accuracy from the GPS if available, otherwise set it to zero.
             // Apply a decaying envelope filter with a 5 second time constant to the raw accuracy data
             float alpha = constrain_float(0.0002f * (lastTimeGpsReceived_ms - secondLastGpsTime_ms),0.0f,1.0f);
             gpsSpdAccuracy *= (1.0f - alpha);
             float gpsSpdAccRaw;
-            if (!_ahrs->get_gps().speed_accuracy(gpsSpdAccRaw)) {
+            if (!sensors().gps.speed_accuracy(gpsSpdAccRaw)) {
                 gpsSpdAccuracy = 0.0f;
             } else {
                 gpsSpdAccuracy = MAX(gpsSpdAccuracy,gpsSpdAccRaw);
@@ -452,7 +475,7 @@ void NavEKF2_core::readGpsData()
             }
             gpsPosAccuracy *= (1.0f - alpha);
             float gpsPosAccRaw;
-            if (!_ahrs->get_gps().horizontal_accuracy(gpsPosAccRaw)) {
+            if (!sensors().gps.horizontal_accuracy(gpsPosAccRaw)) {
                 gpsPosAccuracy = 0.0f;
             } else {
                 gpsPosAccuracy = MAX(gpsPosAccuracy,gpsPosAccRaw);
@@ -460,7 +483,7 @@ void NavEKF2_core::readGpsData()
             }
             gpsHgtAccuracy *= (1.0f - alpha);
             float gpsHgtAccRaw;
-            if (!_ahrs->get_gps().vertical_accuracy(gpsHgtAccRaw)) {
+            if (!sensors().gps.vertical_accuracy(gpsHgtAccRaw)) {
                 gpsHgtAccuracy = 0.0f;
             } else {
                 gpsHgtAccuracy = MAX(gpsHgtAccuracy,gpsHgtAccRaw);
@@ -468,16 +491,16 @@ void NavEKF2_core::readGpsData()
             }
 
             // check if we have enough GPS satellites and increase the gps noise scaler if we don't
-            if (_ahrs->get_gps().num_sats() >= 6 && (PV_AidingMode == AID_ABSOLUTE)) {
+            if (sensors().gps.num_sats() >= 6 && (PV_AidingMode == AID_ABSOLUTE)) {
                 gpsNoiseScaler = 1.0f;
-            } else if (_ahrs->get_gps().num_sats() == 5 && (PV_AidingMode == AID_ABSOLUTE)) {
+            } else if (sensors().gps.num_sats() == 5 && (PV_AidingMode == AID_ABSOLUTE)) {
                 gpsNoiseScaler = 1.4f;
             } else { // <= 4 satellites or in constant position mode
                 gpsNoiseScaler = 2.0f;
             }
 
             // Check if GPS can output vertical velocity and set GPS fusion mode accordingly
-            if (_ahrs->get_gps().have_vertical_velocity() &&
+            if (sensors().gps.have_vertical_velocity() &&
                 frontend->_fusionModeGPS == 0 &&
                 !_ahrs->get_indoor_mode()) {
                 useGpsVertVel = true;
@@ -497,7 +520,7 @@ void NavEKF2_core::readGpsData()
             calcGpsGoodForFlight();
 
             // Read the GPS locaton in WGS-84 lat,long,height coordinates
-            const struct Location &gpsloc = _ahrs->get_gps().location();
+            const struct Location &gpsloc = sensors().gps.location();
 
             // Set the EKF origin and magnetic field declination if not previously set  and GPS checks have passed
             if (gpsGoodToAlign && !validOrigin) {
@@ -537,6 +560,16 @@ void NavEKF2_core::readGpsData()
 // return false if data is not available
 bool NavEKF2_core::readDeltaAngle(uint8_t ins_index, Vector3f &dAng) {
     const AP_InertialSensor &ins = _ahrs->get_ins();
+    const ekf_imu_sample *sample = frontend->imuSample;
+
+    if (sample != nullptr) {
+        if (ins_index < sample->gyro_count) {
+            dAng = sample->delta_angle[ins_index];
+            frontend->logging.log_imu = true;
+            return true;
+        }
+        return false;
+    }
 
     if (ins_index < ins.get_gyro_count()) {
         ins.get_delta_angle(ins_index,dAng);
@@ -556,10 +589,10 @@ void NavEKF2_core::readBaroData()
 {
     // check to see if baro measurement has changed so we know if a new measurement has arrived
     // do not accept data at a faster rate than 14Hz to avoid overflowing the FIFO buffer
-    if (frontend->_baro.get_last_update() - lastBaroReceived_ms > 70) {
+    if (sensors().baro.get_last_update() - lastBaroReceived_ms > 70) {
         frontend->logging.log_baro = true;
 
-        baroDataNew.hgt = frontend->_baro.get_altitude();
+        baroDataNew.hgt = sensors().baro.get_altitude();
 
         // If we are in takeoff mode, the height measurement is limited to be no less than the measurement at start of takeoff
         // This prevents negative baro disturbances due to copter downwash corrupting the EKF altitude during initial ascent
@@ -568,7 +601,7 @@ void NavEKF2_core::readBaroData()
         }
 
         // time stamp used to check for new measurement
-        lastBaroReceived_ms = frontend->_baro.get_last_update();
+        lastBaroReceived_ms = sensors().baro.get_last_update();
 
         // estimate of time height measurement was taken, allowing for delays
         baroDataNew.time_ms = lastBaroReceived_ms - frontend->_hgtDelay_ms;
@@ -647,12 +680,11 @@ void NavEKF2_core::readAirSpdData()
     // if airspeed reading is valid and is set by the user to be used and has been updated then
     // we take a new reading, convert from EAS to TAS and set the flag letting other functions
     // know a new measurement is available
-    const AP_Airspeed *aspeed = _ahrs->get_airspeed();
-    if (aspeed &&
-            aspeed->use() &&
-            aspeed->last_update_ms() != timeTasReceived_ms) {
-        tasDataNew.tas = aspeed->get_airspeed() * aspeed->get_EAS2TAS();
-        timeTasReceived_ms = aspeed->last_update_ms();
+    const ekf_sensor_sample::Airspeed &aspeed = sensors().airspeed;
+    if (aspeed.use() &&
+            aspeed.last_update_ms() != timeTasReceived_ms) {
+        tasDataNew.tas = aspeed.get_airspeed() * aspeed.get_EAS2TAS();
+        timeTasReceived_ms = aspeed.last_update_ms();
         tasDataNew.time_ms = timeTasReceived_ms - frontend->tasDelay_ms;
 
         // Correct for the average intersampling delay due to the filter update rate
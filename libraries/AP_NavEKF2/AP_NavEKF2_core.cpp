@@ -329,8 +329,8 @@ void NavEKF2_core::InitialiseVariablesMag()
 
     yawAlignComplete = false;
 
-    if (_ahrs->get_compass()) {
-        magSelectIndex = _ahrs->get_compass()->get_primary();
+    if (sensors().compass.available()) {
+        magSelectIndex = sensors().compass.get_primary();
     }
     lastMagOffsetsValid = false;
     magStateResetRequest = false;
@@ -349,7 +349,7 @@ void NavEKF2_core::InitialiseVariablesMag()
 bool NavEKF2_core::InitialiseFilterBootstrap(void)
 {
     // If we are a plane and don't have GPS lock then don't initialise
-    if (assume_zero_sideslip() && _ahrs->get_gps().status() < AP_GPS::GPS_OK_FIX_3D) {
+    if (assume_zero_sideslip() && sensors().gps.status() < AP_GPS::GPS_OK_FIX_3D) {
         statesInitialised = false;
         return false;
     }
@@ -1456,7 +1456,7 @@ Quaternion NavEKF2_core::calcQuatAndFieldStates(float roll, float pitch)
         float magHeading = atan2f(initMagNED.y, initMagNED.x);
 
         // get the magnetic declination
-        float magDecAng = use_compass() ? _ahrs->get_compass()->get_declination() : 0;
+        float magDecAng = use_compass() ? sensors().compass.get_declination() : 0;
 
         // calculate yaw angle rel to true north
         yaw = magDecAng - magHeading;
@@ -29,7 +29,7 @@
 #include "AP_NavEKF2.h"
 #include <stdio.h>
 #include <AP_Math/vectorN.h>
-#include <AP_NavEKF2/AP_NavEKF2_Buffer.h>
+#include <AP_NavEKF/EKF_Buffer.h>
 
 // GPS pre-flight check bit locations
 #define MASK_GPS_NSATS      (1<<0)
@@ -312,6 +312,10 @@ public:
 private:
     // Reference to the global EKF frontend for parameters
     NavEKF2 *frontend;
+
+    // sensor data for the current update, see NavEKF2::sensors()
+    const ekf_sensor_sample &sensors(void) const { return frontend->sensors(); }
+
     uint8_t imu_index;
     uint8_t core_index;
     uint8_t imu_buffer_length;
@@ -744,7 +748,7 @@ private:
     Matrix24 KH;                    // intermediate result used for covariance updates
     Matrix24 KHP;                   // intermediate result used for covariance updates
     Matrix24 P;                     // covariance matrix
-    imu_ring_buffer_t<imu_elements> storedIMU;      // IMU data buffer
+    imu_delta_buffer_t<imu_elements> storedIMU;     // IMU data buffer
     obs_ring_buffer_t<gps_elements> storedGPS;      // GPS data buffer
     obs_ring_buffer_t<mag_elements> storedMag;      // Magnetometer data buffer
     obs_ring_buffer_t<baro_elements> storedBaro;    // Baro data buffer
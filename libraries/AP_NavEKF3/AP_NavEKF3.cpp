@@ -587,12 +587,25 @@ NavEKF3::NavEKF3(const AP_AHRS *ahrs, AP_Baro &baro, const RangeFinder &rng) :
     AP_Param::setup_object_defaults(this, var_info);
 }
 
+/*
+  take a copy of the sensor data read by the cores during this update,
+  unless they are given the data queued with the IMU sample
+ */
+void NavEKF3::capture_sensors(void)
+{
+    if (queuedSensors == nullptr) {
+        sensorsCopy.capture(_ahrs->get_gps(), _ahrs->get_compass(), _baro, _rng, _ahrs->get_airspeed());
+    }
+}
+
 /*
   see if we should log some sensor data
  */
 void NavEKF3::check_log_write(void)
 {
-    if (!have_ekf_logging()) {
+    // a filter run from a queue is behind the sensor libraries and
+    // must not read them, so it can't log its sensor data for replay
+    if (!have_ekf_logging() || imuSample != nullptr) {
         return;
     }
     if (logging.log_compass) {
@@ -627,6 +640,7 @@ bool NavEKF3::InitialiseFilter(void)
     const AP_InertialSensor &ins = _ahrs->get_ins();
 
     imuSampleTime_us = AP_HAL::micros64();
+    capture_sensors();
 
     // remember expected frame time
     _frameTimeUsec = 1e6 / ins.get_sample_rate();
@@ -663,7 +677,7 @@ bool NavEKF3::InitialiseFilter(void)
         }
 
         // check if there is enough memory to create the EKF cores
-        if (hal.util->available_memory() < sizeof(NavEKF3_core)*num_cores + 4096) {
+        if (hal.util->available_memory() < sizeof(NavEKF3_core)*num_cores + NavEKF3_core::scratch_bytes() + 4096) {
             GCS_MAVLINK::send_statustext_all(MAV_SEVERITY_CRITICAL, "NavEKF3: not enough memory");
             _enable.set(0);
             return false;
@@ -722,7 +736,12 @@ void NavEKF3::UpdateFilter(void)
         return;
     }
 
-    imuSampleTime_us = AP_HAL::micros64();
+    if (imuSample != nullptr) {
+        imuSampleTime_us = imuSample->time_us;
+    } else {
+        imuSampleTime_us = AP_HAL::micros64();
+    }
+    capture_sensors();
 
     const AP_InertialSensor &ins = _ahrs->get_ins();
 
@@ -731,8 +750,10 @@ void NavEKF3::UpdateFilter(void)
         // if we have not overrun by more than 3 IMU frames, and we
         // have already used more than 1/3 of the CPU budget for this
         // loop then suppress the prediction step. This allows
-        // multiple EKF instances to cooperate on scheduling
-        if (core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
+        // multiple EKF instances to cooperate on scheduling. A filter
+        // fed from a queue runs on its own time and never defers
+        if (imuSample == nullptr &&
+            core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
             (AP_HAL::micros() - ins.get_last_update_usec()) > _frameTimeUsec/3) {
             statePredictEnabled[i] = false;
         } else {
@@ -1538,4 +1559,18 @@ void NavEKF3::getTimingStatistics(int8_t instance, struct ekf_timing &timing)
     }
 }
 
+// report the memory allocated by the filter
+void NavEKF3::getMemoryReport(struct memory_report &report) const
+{
+    memset(&report, 0, sizeof(report));
+    if (core == nullptr) {
+        return;
+    }
+    report.cores = sizeof(NavEKF3_core) * num_cores;
+    for (uint8_t i=0; i<num_cores; i++) {
+        report.buffers += core[i].buffer_bytes();
+    }
+    report.shared = NavEKF3_core::scratch_bytes();
+}
+
 #endif //HAL_CPU_CLASS
@@ -334,7 +334,23 @@ public:
 
     // get timing statistics structure
     void getTimingStatistics(int8_t instance, struct ekf_timing &timing);
+
+    // memory allocated by the filter in bytes
+    struct memory_report {
+        uint32_t cores;     // core objects, including their covariance matrices
+        uint32_t buffers;   // sensor and output buffers of all cores
+        uint32_t shared;    // matrices shared by all cores
+    };
+    void getMemoryReport(struct memory_report &report) const;
     
+    // read IMU and sensor data from the given snapshots instead of the
+    // sensor libraries, to run the filter from a queue away from the
+    // main thread. nullptr reverts to reading the libraries
+    void setIMUSample(const ekf_imu_sample *sample, const ekf_sensor_sample *sensors) {
+        imuSample = sample;
+        queuedSensors = sensors;
+    }
+
 private:
     uint8_t num_cores; // number of allocated cores
     uint8_t primary;   // current primary core
@@ -436,6 +452,23 @@ private:
     // time at start of current filter update
     uint64_t imuSampleTime_us;
 
+    // IMU data to use instead of the INS library's, if not nullptr
+    const ekf_imu_sample *imuSample = nullptr;
+
+    // sensor data to use instead of the libraries', if not nullptr
+    const ekf_sensor_sample *queuedSensors = nullptr;
+
+    // sensor data taken at the start of the current update otherwise
+    ekf_sensor_sample sensorsCopy;
+
+    // sensor data for the current update, read by the cores
+    const ekf_sensor_sample &sensors(void) const {
+        return queuedSensors != nullptr ? *queuedSensors : sensorsCopy;
+    }
+
+    // take a copy of the sensor data for this update, unless queued
+    void capture_sensors(void);
+
     struct {
         uint32_t last_function_call;  // last time getLastYawYawResetAngle was called
         bool core_changed;            // true when a core change happened and hasn't been consumed, false otherwise
@@ -24,6 +24,9 @@ extern const AP_HAL::HAL& hal;
 */
 void NavEKF3_core::FuseAirspeed()
 {
+    Matrix24 &KH = scratch->KH;
+    Matrix24 &KHP = scratch->KHP;
+
     // start performance timer
     hal.util->perf_begin(_perf_FuseAirspeed);
 
@@ -33,7 +36,7 @@ void NavEKF3_core::FuseAirspeed()
     float vd;
     float vwn;
     float vwe;
-    float EAS2TAS = _ahrs->get_EAS2TAS();
+    float EAS2TAS = sensors().airspeed.get_EAS2TAS();
     const float R_TAS = sq(constrain_float(frontend->_easNoise, 0.5f, 5.0f) * constrain_float(EAS2TAS, 0.9f, 10.0f));
     float SH_TAS[3];
     float SK_TAS[2];
@@ -260,6 +263,9 @@ void NavEKF3_core::SelectBetaFusion()
 */
 void NavEKF3_core::FuseSideslip()
 {
+    Matrix24 &KH = scratch->KH;
+    Matrix24 &KHP = scratch->KHP;
+
     // start performance timer
     hal.util->perf_begin(_perf_FuseSideslip);
 
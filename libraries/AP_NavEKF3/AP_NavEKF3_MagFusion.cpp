@@ -314,6 +314,9 @@ void NavEKF3_core::SelectMagFusion()
 */
 void NavEKF3_core::FuseMagnetometer()
 {
+    Matrix24 &KH = scratch->KH;
+    Matrix24 &KHP = scratch->KHP;
+
     // declarations
     ftype &q0 = mag_state.q0;
     ftype &q1 = mag_state.q1;
@@ -751,6 +754,9 @@ void NavEKF3_core::FuseMagnetometer()
 */
 void NavEKF3_core::fuseEulerYaw()
 {
+    Matrix24 &KH = scratch->KH;
+    Matrix24 &KHP = scratch->KHP;
+
     float q0 = stateStruct.quat[0];
     float q1 = stateStruct.quat[1];
     float q2 = stateStruct.quat[2];
@@ -850,7 +856,7 @@ void NavEKF3_core::fuseEulerYaw()
     // to prevent uncontrolled variance growth whilst on ground without magnetometer
     float measured_yaw;
     if (use_compass() && yawAlignComplete) {
-        measured_yaw = wrap_PI(-atan2f(magMeasNED.y, magMeasNED.x) + _ahrs->get_compass()->get_declination());
+        measured_yaw = wrap_PI(-atan2f(magMeasNED.y, magMeasNED.x) + sensors().compass.get_declination());
     } else {
         measured_yaw = predicted_yaw;
     }
@@ -976,6 +982,9 @@ void NavEKF3_core::fuseEulerYaw()
 */
 void NavEKF3_core::FuseDeclination(float declErr)
 {
+    Matrix24 &KH = scratch->KH;
+    Matrix24 &KHP = scratch->KHP;
+
     // declination error variance (rad^2)
     const float R_DECL = sq(declErr);
 
@@ -1079,7 +1088,7 @@ void NavEKF3_core::FuseDeclination(float declErr)
     }
 
     // get the magnetic declination
-    float magDecAng = use_compass() ? _ahrs->get_compass()->get_declination() : 0;
+    float magDecAng = use_compass() ? sensors().compass.get_declination() : 0;
 
     // Calculate the innovation
     float innovation = atan2f(magE , magN) - magDecAng;
@@ -1157,7 +1166,7 @@ void NavEKF3_core::alignMagStateDeclination()
     }
 
     // get the magnetic declination
-    float magDecAng = use_compass() ? _ahrs->get_compass()->get_declination() : 0;
+    float magDecAng = use_compass() ? sensors().compass.get_declination() : 0;
 
     // rotate the NE values so that the declination matches the published value
     Vector3f initMagNED = stateStruct.earth_magfield;
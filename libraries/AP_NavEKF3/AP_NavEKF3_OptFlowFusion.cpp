@@ -265,6 +265,9 @@ void NavEKF3_core::EstimateTerrainOffset()
 */
 void NavEKF3_core::FuseOptFlow()
 {
+    Matrix24 &KH = scratch->KH;
+    Matrix24 &KHP = scratch->KHP;
+
     Vector24 H_LOS;
     Vector3f relVelSensor;
     Vector14 SH_LOS;
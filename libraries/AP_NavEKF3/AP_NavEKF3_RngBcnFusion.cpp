@@ -50,6 +50,9 @@ void NavEKF3_core::SelectRngBcnFusion()
 
 void NavEKF3_core::FuseRngBcn()
 {
+    Matrix24 &KH = scratch->KH;
+    Matrix24 &KHP = scratch->KHP;
+
     // declarations
     float pn;
     float pe;
@@ -284,6 +287,9 @@ https://github.com/priseborough/InertialNav/blob/master/derivations/range_beacon
 */
 void NavEKF3_core::FuseRngBcnStatic()
 {
+    Matrix24 &KH = scratch->KH;
+    Matrix24 &KHP = scratch->KHP;
+
     // get the estimated range measurement variance
     const float R_RNG = sq(MAX(rngBcnDataDelayed.rngErr , 0.1f));
 
@@ -72,7 +72,7 @@ bool NavEKF3_core::setup_core(NavEKF3 *_frontend, uint8_t _imu_index, uint8_t _c
     if (_frontend->_fusionModeGPS != 3) {
         // Wait for the configuration of all GPS units to be confirmed. Until this has occurred the GPS driver cannot provide a correct time delay
         float gps_delay_sec = 0;
-        if (!_ahrs->get_gps().get_lag(gps_delay_sec)) {
+        if (!sensors().gps.get_lag(gps_delay_sec)) {
             if (AP_HAL::millis() - lastInitFailReport_ms > 10000) {
                 lastInitFailReport_ms = AP_HAL::millis();
                 // provide an escalating series of messages
@@ -91,7 +91,7 @@ bool NavEKF3_core::setup_core(NavEKF3 *_frontend, uint8_t _imu_index, uint8_t _c
     }
 
     // airspeed sensing can have large delays and should not be included if disabled
-    if (_ahrs->airspeed_sensor_enabled()) {
+    if (sensors().airspeed.enabled()) {
         maxTimeDelay_ms = MAX(maxTimeDelay_ms , _frontend->tasDelay_ms);
     }
 
@@ -107,6 +107,17 @@ bool NavEKF3_core::setup_core(NavEKF3 *_frontend, uint8_t _imu_index, uint8_t _c
     // limit to be no longer than the IMU buffer (we can't process data faster than the EKF prediction rate)
     obs_buffer_length = MIN(obs_buffer_length,imu_buffer_length);
 
+    // share the scratch matrices of any other core of this filter
+    // already set up
+    for (uint8_t i=0; i<frontend->num_cores && scratch == nullptr; i++) {
+        scratch = frontend->core[i].scratch;
+    }
+    if (scratch == nullptr) {
+        scratch = new scratch_matrices;
+        if (scratch == nullptr) {
+            return false;
+        }
+    }
     if(!storedGPS.init(obs_buffer_length)) {
         return false;
     }
@@ -142,6 +153,27 @@ bool NavEKF3_core::setup_core(NavEKF3 *_frontend, uint8_t _imu_index, uint8_t _c
     GCS_MAVLINK::send_statustext_all(MAV_SEVERITY_INFO, "EKF3 IMU%u buffers, IMU=%u , OBS=%u , dt=%6.4f",(unsigned)imu_index,(unsigned)imu_buffer_length,(unsigned)obs_buffer_length,(double)dtEkfAvg);
     return true;
 }
+
+// return the memory allocated for this core's data buffers in bytes
+uint32_t NavEKF3_core::buffer_bytes(void) const
+{
+    return storedGPS.allocated_bytes() +
+        storedMag.allocated_bytes() +
+        storedBaro.allocated_bytes() +
+        storedTAS.allocated_bytes() +
+        storedOF.allocated_bytes() +
+        storedBodyOdm.allocated_bytes() +
+        storedRange.allocated_bytes() +
+        storedRangeBeacon.allocated_bytes() +
+        storedIMU.allocated_bytes() +
+        storedOutput.allocated_bytes();
+}
+
+// return the memory needed for the matrices shared by all cores in bytes
+uint32_t NavEKF3_core::scratch_bytes(void)
+{
+    return sizeof(scratch_matrices);
+}
     
 
 /********************************************************
@@ -206,7 +238,7 @@ void NavEKF3_core::InitialiseVariables()
     lastKnownPositionNE.zero();
     prevTnb.zero();
     memset(&P[0][0], 0, sizeof(P));
-    memset(&nextP[0][0], 0, sizeof(nextP));
+    memset(&scratch->nextP[0][0], 0, sizeof(scratch->nextP));
     flowDataValid = false;
     rangeDataToFuse  = false;
     fuseOptFlowData = false;
@@ -290,8 +322,8 @@ void NavEKF3_core::InitialiseVariables()
     velResetNE.zero();
     posResetD = 0.0f;
     hgtInnovFiltState = 0.0f;
-    if (_ahrs->get_compass()) {
-        magSelectIndex = _ahrs->get_compass()->get_primary();
+    if (sensors().compass.available()) {
+        magSelectIndex = sensors().compass.get_primary();
     }
     imuDataDownSampledNew.delAng.zero();
     imuDataDownSampledNew.delVel.zero();
@@ -392,7 +424,7 @@ void NavEKF3_core::InitialiseVariables()
 bool NavEKF3_core::InitialiseFilterBootstrap(void)
 {
     // If we are a plane and don't have GPS lock then don't initialise
-    if (assume_zero_sideslip() && _ahrs->get_gps().status() < AP_GPS::GPS_OK_FIX_3D) {
+    if (assume_zero_sideslip() && sensors().gps.status() < AP_GPS::GPS_OK_FIX_3D) {
         statesInitialised = false;
         return false;
     }
@@ -821,6 +853,8 @@ void NavEKF3_core::calcOutputStates()
 */
 void NavEKF3_core::CovariancePrediction()
 {
+    Matrix24 &nextP = scratch->nextP;
+
     hal.util->perf_begin(_perf_CovariancePrediction);
     float daxVar;       // X axis delta angle noise variance rad^2
     float dayVar;       // Y axis delta angle noise variance rad^2
@@ -1539,7 +1573,7 @@ Quaternion NavEKF3_core::calcQuatAndFieldStates(float roll, float pitch)
         float magHeading = atan2f(initMagNED.y, initMagNED.x);
 
         // get the magnetic declination
-        float magDecAng = use_compass() ? _ahrs->get_compass()->get_declination() : 0;
+        float magDecAng = use_compass() ? sensors().compass.get_declination() : 0;
 
         // calculate yaw angle rel to true north
         yaw = magDecAng - magHeading;
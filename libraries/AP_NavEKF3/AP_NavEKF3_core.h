@@ -27,7 +27,7 @@
 #include <AP_Math/AP_Math.h>
 #include "AP_NavEKF3.h"
 #include <AP_Math/vectorN.h>
-#include <AP_NavEKF3/AP_NavEKF3_Buffer.h>
+#include <AP_NavEKF/EKF_Buffer.h>
 
 // GPS pre-flight check bit locations
 #define MASK_GPS_NSATS      (1<<0)
@@ -339,10 +339,20 @@ public:
 
     // get timing statistics structure
     void getTimingStatistics(struct ekf_timing &timing);
+
+    // return the memory allocated for this core's data buffers in bytes
+    uint32_t buffer_bytes(void) const;
+
+    // return the memory needed for the matrices shared by all cores in bytes
+    static uint32_t scratch_bytes(void);
     
 private:
     // Reference to the global EKF frontend for parameters
     NavEKF3 *frontend;
+
+    // sensor data for the current update, see NavEKF3::sensors()
+    const ekf_sensor_sample &sensors(void) const { return frontend->sensors(); }
+
     uint8_t imu_index;
     uint8_t core_index;
     uint8_t imu_buffer_length;
@@ -400,6 +410,18 @@ private:
     typedef uint32_t Vector_u32_50[50];
 #endif
 
+    // matrices only used within a single covariance prediction or
+    // fusion step. The cores of a filter are updated one at a time, so
+    // they share one set instead of each carrying their own. Separate
+    // filters, which may be updated from different threads, each have
+    // their own
+    struct scratch_matrices {
+        Matrix24 KH;                    // intermediate result used for covariance updates
+        Matrix24 KHP;                   // intermediate result used for covariance updates
+        Matrix24 nextP;                 // Predicted covariance matrix before addition of process noise to diagonals
+    };
+    scratch_matrices *scratch = nullptr;
+
     const AP_AHRS *_ahrs;
 
     // the states are available in two forms, either as a Vector24, or
@@ -790,10 +812,8 @@ private:
 
     float gpsNoiseScaler;           // Used to scale the  GPS measurement noise and consistency gates to compensate for operation with small satellite counts
     Vector28 Kfusion;               // Kalman gain vector
-    Matrix24 KH;                    // intermediate result used for covariance updates
-    Matrix24 KHP;                   // intermediate result used for covariance updates
     Matrix24 P;                     // covariance matrix
-    imu_ring_buffer_t<imu_elements> storedIMU;      // IMU data buffer
+    imu_delta_buffer_t<imu_elements> storedIMU;     // IMU data buffer
     obs_ring_buffer_t<gps_elements> storedGPS;      // GPS data buffer
     obs_ring_buffer_t<mag_elements> storedMag;      // Magnetometer data buffer
     obs_ring_buffer_t<baro_elements> storedBaro;    // Baro data buffer
@@ -845,7 +865,6 @@ private:
     bool allMagSensorsFailed;       // true if all magnetometer sensors have timed out on this flight and we are no longer using magnetometer data
     uint32_t lastSynthYawTime_ms;   // time stamp when synthetic yaw measurement was last fused to maintain covariance health (msec)
     uint32_t ekfStartTime_ms;       // time the EKF was started (msec)
-    Matrix24 nextP;                 // Predicted covariance matrix before addition of process noise to diagonals
     Vector2f lastKnownPositionNE;   // last known position
     uint32_t lastDecayTime_ms;      // time of last decay of GPS position offset
     float velTestRatio;             // sum of squares of GPS velocity innovation divided by fail threshold
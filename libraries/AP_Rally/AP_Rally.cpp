@@ -121,6 +121,7 @@ bool AP_Rally::find_nearest_rally_point(const Location &current_loc, RallyLocati
 {
     float min_dis = -1;
     const struct Location &home_loc = _ahrs.get_home();
+    const LocalFrame frame(current_loc);
 
     for (uint8_t i = 0; i < (uint8_t) _rally_point_total_count; i++) {
         RallyLocation next_rally;
@@ -128,7 +129,7 @@ bool AP_Rally::find_nearest_rally_point(const Location &current_loc, RallyLocati
             continue;
         }
         Location rally_loc = rally_location_to_location(next_rally);
-        float dis = get_distance(current_loc, rally_loc);
+        float dis = frame.get_distance(rally_loc);
 
         if (is_valid(rally_loc) && (dis < min_dis || min_dis < 0)) {
             min_dis = dis;
@@ -137,12 +138,12 @@ bool AP_Rally::find_nearest_rally_point(const Location &current_loc, RallyLocati
     }
 
     // if home is included, return false (meaning use home) if it is closer than all rally points
-    if (_rally_incl_home && (get_distance(current_loc, home_loc) < min_dis)) {
+    if (_rally_incl_home && (frame.get_distance(home_loc) < min_dis)) {
         return false;
     }
 
     // if a limit is defined and all rally points are beyond that limit, use home if it is closer
-    if ((_rally_limit_km > 0) && (min_dis > _rally_limit_km*1000.0f) && (get_distance(current_loc, home_loc) < min_dis)) {
+    if ((_rally_limit_km > 0) && (min_dis > _rally_limit_km*1000.0f) && (frame.get_distance(home_loc) < min_dis)) {
         return false; // use home position
     }
 
@@ -31,6 +31,15 @@
 #define SCHEDULER_DEFAULT_LOOP_RATE  50
 #endif
 
+// the Linux and SITL HALs keep perf counters in a lock free registry,
+// so task counters are always on there. Elsewhere a counter costs time
+// on every task, so they are only used with SCHED_DEBUG > 1
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#define SCHEDULER_PERF_ALWAYS_ON 1
+#else
+#define SCHEDULER_PERF_ALWAYS_ON 0
+#endif
+
 extern const AP_HAL::HAL& hal;
 
 int8_t AP_Scheduler::current_task = -1;
@@ -76,6 +85,21 @@ void AP_Scheduler::init(const AP_Scheduler::Task *tasks, uint8_t num_tasks)
     _last_run = new uint16_t[_num_tasks];
     memset(_last_run, 0, sizeof(_last_run[0]) * _num_tasks);
     _tick_counter = 0;
+
+#if SCHEDULER_PERF_ALWAYS_ON
+    perf_alloc_tasks();
+#endif
+}
+
+// allocate a perf counter for each task
+void AP_Scheduler::perf_alloc_tasks(void)
+{
+    _perf_counters = new AP_HAL::Util::perf_counter_t[_num_tasks];
+    if (_perf_counters != nullptr) {
+        for (uint8_t i=0; i<_num_tasks; i++) {
+            _perf_counters[i] = hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, _tasks[i].name);
+        }
+    }
 }
 
 // one tick has passed
@@ -92,16 +116,12 @@ void AP_Scheduler::run(uint32_t time_available)
 {
     uint32_t run_started_usec = AP_HAL::micros();
     uint32_t now = run_started_usec;
+    const bool use_perf = SCHEDULER_PERF_ALWAYS_ON || _debug > 1;
 
-    if (_debug > 1 && _perf_counters == nullptr) {
-        _perf_counters = new AP_HAL::Util::perf_counter_t[_num_tasks];
-        if (_perf_counters != nullptr) {
-            for (uint8_t i=0; i<_num_tasks; i++) {
-                _perf_counters[i] = hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, _tasks[i].name);
-            }
-        }
+    if (use_perf && _perf_counters == nullptr) {
+        perf_alloc_tasks();
     }
-    
+
     for (uint8_t i=0; i<_num_tasks; i++) {
         uint16_t dt = _tick_counter - _last_run[i];
         uint16_t interval_ticks = _loop_rate_hz / _tasks[i].rate_hz;
@@ -128,11 +148,11 @@ void AP_Scheduler::run(uint32_t time_available)
                 // run it
                 _task_time_started = now;
                 current_task = i;
-                if (_debug > 1 && _perf_counters && _perf_counters[i]) {
+                if (use_perf && _perf_counters && _perf_counters[i]) {
                     hal.util->perf_begin(_perf_counters[i]);
                 }
                 _tasks[i].function();
-                if (_debug > 1 && _perf_counters && _perf_counters[i]) {
+                if (use_perf && _perf_counters && _perf_counters[i]) {
                     hal.util->perf_end(_perf_counters[i]);
                 }
                 current_task = -1;
@@ -129,4 +129,5 @@ private:
 
     // performance counters
     AP_HAL::Util::perf_counter_t *_perf_counters;
+    void perf_alloc_tasks(void);
 };
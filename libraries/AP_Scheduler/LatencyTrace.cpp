@@ -0,0 +1,118 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LatencyTrace.h"
+
+extern const AP_HAL::HAL& hal;
+
+LatencyTrace *LatencyTrace::_s_instance = nullptr;
+
+LatencyTrace::LatencyTrace() :
+    _start_us(0),
+    _marked(0),
+    _rc_frame_us(0),
+    _rc_pending(false)
+{
+    if (_s_instance) {
+        AP_HAL::panic("Too many latency traces");
+    }
+    _s_instance = this;
+}
+
+void LatencyTrace::imu_sample(uint32_t landed_us)
+{
+    // a loop which never pushed its outputs is dropped
+    _marked = 0;
+    if (landed_us == 0) {
+        return;
+    }
+    _start_us = landed_us;
+    mark(STAGE_INS);
+}
+
+void LatencyTrace::rc_input(uint32_t frame_us)
+{
+    if (frame_us == 0) {
+        return;
+    }
+    _rc_frame_us = frame_us;
+    _rc_pending = true;
+}
+
+void LatencyTrace::mark(enum trace_stage stage)
+{
+    if (_marked == 0 && stage != STAGE_INS) {
+        return;
+    }
+    // a stage marked twice, as by DCM and then the EKF, takes the
+    // later time
+    _stage_us[stage] = AP_HAL::micros() - _start_us;
+    _marked |= 1U << stage;
+}
+
+void LatencyTrace::output_pushed(void)
+{
+    const uint32_t now = AP_HAL::micros();
+
+    if (_rc_pending) {
+        _stage_us[STAGE_RC_OUTPUT] = now - _rc_frame_us;
+        _current[STAGE_RC_OUTPUT].add(_stage_us[STAGE_RC_OUTPUT]);
+        hal.util->trace_latency(stage_name(STAGE_RC_OUTPUT), _stage_us[STAGE_RC_OUTPUT]);
+        _rc_pending = false;
+    }
+
+    if (_marked == 0) {
+        return;
+    }
+    _stage_us[STAGE_OUTPUT] = now - _start_us;
+    _marked |= 1U << STAGE_OUTPUT;
+
+    for (uint8_t i = 0; i < STAGE_RC_OUTPUT; i++) {
+        if (_marked & (1U << i)) {
+            _current[i].add(_stage_us[i]);
+            hal.util->trace_latency(stage_name((enum trace_stage)i), _stage_us[i]);
+        }
+    }
+    _marked = 0;
+}
+
+void LatencyTrace::update(void)
+{
+    for (uint8_t i = 0; i < STAGE_COUNT; i++) {
+        _last[i] = _current[i];
+        _current[i].reset();
+    }
+}
+
+const char *LatencyTrace::stage_name(enum trace_stage stage)
+{
+    switch (stage) {
+    case STAGE_INS:
+        return "INS";
+    case STAGE_AHRS:
+        return "AHRS";
+    case STAGE_RATE:
+        return "RATE";
+    case STAGE_MIX:
+        return "MIX";
+    case STAGE_OUTPUT:
+        return "OUT";
+    case STAGE_RC_OUTPUT:
+        return "RC";
+    case STAGE_COUNT:
+        break;
+    }
+    return "";
+}
@@ -0,0 +1,91 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  end-to-end latency tracing of the main control loop
+
+  Each loop is traced from the newest gyro sample it uses, timed when
+  the sample reached AP_InertialSensor from the backend. The libraries
+  mark the stages the loop passes through, and when the vehicle has
+  pushed its outputs to RCOutput the time from the sample to each
+  stage goes into a PerfHistogram. RC frames are traced the same way from
+  when the HAL decoded them to the first outputs pushed after the
+  vehicle read them.
+
+  The histograms cover a period ended by update(), which the vehicle
+  calls before logging them. On Linux each latency is also passed to
+  an LTTng tracepoint.
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+class LatencyTrace
+{
+public:
+    LatencyTrace();
+
+    // get singleton instance, or nullptr if the vehicle doesn't trace
+    static LatencyTrace *get_instance(void) { return _s_instance; }
+
+    enum trace_stage {
+        STAGE_INS = 0,      // gyro sample published by AP_InertialSensor::update()
+        STAGE_AHRS,         // AHRS and EKF updated
+        STAGE_RATE,         // rate controller run
+        STAGE_MIX,          // motor outputs mixed
+        STAGE_OUTPUT,       // outputs pushed to RCOutput
+        STAGE_RC_OUTPUT,    // RC frame to outputs pushed to RCOutput
+        STAGE_COUNT
+    };
+
+    /*
+      start tracing a loop from a gyro sample which reached the
+      frontend at landed_us, from AP_HAL::micros(). Zero means no
+      sample time is known and the loop isn't traced
+     */
+    void imu_sample(uint32_t landed_us);
+
+    // the vehicle read an RC frame decoded at frame_us, from AP_HAL::micros()
+    void rc_input(uint32_t frame_us);
+
+    // the loop being traced has reached a stage
+    void mark(enum trace_stage stage);
+
+    // the loop's outputs have been pushed, so record its latencies
+    void output_pushed(void);
+
+    // end the period, keeping its histograms until the next update()
+    void update(void);
+
+    // histogram for the last complete period
+    const PerfHistogram &get_histogram(enum trace_stage stage) const { return _last[stage]; }
+
+    static const char *stage_name(enum trace_stage stage);
+
+private:
+    static LatencyTrace *_s_instance;
+
+    // start of the loop being traced, valid if _marked is non-zero
+    uint32_t _start_us;
+    uint8_t _marked;
+    uint32_t _stage_us[STAGE_COUNT];
+
+    // RC frame read but not yet reflected in the outputs
+    uint32_t _rc_frame_us;
+    bool _rc_pending;
+
+    PerfHistogram _current[STAGE_COUNT];
+    PerfHistogram _last[STAGE_COUNT];
+};
@@ -0,0 +1,64 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Scheduler/LatencyTrace.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static LatencyTrace trace;
+
+TEST(LatencyTrace, StagesRecordedWhenOutputPushed)
+{
+    trace.update();
+
+    trace.imu_sample(AP_HAL::micros() - 1000);
+    trace.mark(LatencyTrace::STAGE_AHRS);
+    trace.mark(LatencyTrace::STAGE_RATE);
+
+    // nothing is recorded until the outputs are pushed
+    trace.update();
+    EXPECT_EQ(0, trace.get_histogram(LatencyTrace::STAGE_INS).count());
+
+    trace.imu_sample(AP_HAL::micros() - 1000);
+    trace.mark(LatencyTrace::STAGE_AHRS);
+    trace.mark(LatencyTrace::STAGE_RATE);
+    trace.output_pushed();
+
+    // marks after the outputs are pushed wait for the next sample
+    trace.mark(LatencyTrace::STAGE_AHRS);
+    trace.output_pushed();
+
+    trace.update();
+    EXPECT_EQ(1, trace.get_histogram(LatencyTrace::STAGE_INS).count());
+    EXPECT_EQ(1, trace.get_histogram(LatencyTrace::STAGE_AHRS).count());
+    EXPECT_EQ(1, trace.get_histogram(LatencyTrace::STAGE_RATE).count());
+    EXPECT_EQ(0, trace.get_histogram(LatencyTrace::STAGE_MIX).count());
+    EXPECT_EQ(1, trace.get_histogram(LatencyTrace::STAGE_OUTPUT).count());
+    EXPECT_EQ(0, trace.get_histogram(LatencyTrace::STAGE_RC_OUTPUT).count());
+
+    const uint32_t ins_us = trace.get_histogram(LatencyTrace::STAGE_INS).max_us();
+    const uint32_t out_us = trace.get_histogram(LatencyTrace::STAGE_OUTPUT).max_us();
+    EXPECT_GE(ins_us, 1000U);
+    EXPECT_GE(out_us, ins_us);
+}
+
+TEST(LatencyTrace, RCFrameToOutput)
+{
+    trace.update();
+
+    // no frame time from the HAL means no trace
+    trace.rc_input(0);
+    trace.output_pushed();
+
+    trace.rc_input(AP_HAL::micros() - 5000);
+    trace.output_pushed();
+    trace.output_pushed();
+
+    trace.update();
+    const PerfHistogram &hist = trace.get_histogram(LatencyTrace::STAGE_RC_OUTPUT);
+    EXPECT_EQ(1, hist.count());
+    EXPECT_GE(hist.min_us(), 5000U);
+    EXPECT_EQ(0, trace.get_histogram(LatencyTrace::STAGE_OUTPUT).count());
+}
+
+AP_GTEST_MAIN()
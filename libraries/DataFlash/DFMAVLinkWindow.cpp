@@ -0,0 +1,238 @@
+/*
+  sliding window of log blocks streamed to a client over MAVLink
+ */
+
+#include "DFMAVLinkWindow.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <AP_Math/AP_Math.h>
+
+// retransmission timeout until the first round trip is measured, and
+// its limit afterwards
+#define DFMAVLINKWINDOW_RTO_INITIAL_MS 100
+#define DFMAVLINKWINDOW_RTO_MAX_MS 1000
+
+// least margin of the timeout over the round trip time. Timed out
+// blocks are looked for at 10Hz, so a shorter margin only resends
+// blocks whose ack is about to arrive
+#define DFMAVLINKWINDOW_RTO_GRANULARITY_MS 50
+
+// fewest blocks allowed in flight after backing off
+#define DFMAVLINKWINDOW_IN_FLIGHT_MIN 2
+
+bool DFMAVLinkWindow::init(uint8_t size)
+{
+    _blocks = (struct block *)calloc(size, sizeof(_blocks[0]));
+    if (_blocks == nullptr) {
+        return false;
+    }
+    _size = size;
+    reset(0);
+    return true;
+}
+
+void DFMAVLinkWindow::reset(uint32_t seqno)
+{
+    for (uint8_t i = 0; i < _size; i++) {
+        _blocks[i].state = BLOCK_FREE;
+        _blocks[i].resent = false;
+    }
+    memset(_count, 0, sizeof(_count));
+    _count[BLOCK_FREE] = _size;
+
+    _oldest = seqno;
+    _next = seqno;
+    _next_unsent = seqno;
+
+    _srtt_ms = 0;
+    _rttvar_ms = 0;
+    _have_rtt = false;
+    _in_flight_limit = MAX(_size / 4, DFMAVLINKWINDOW_IN_FLIGHT_MIN);
+    _acks_since_increase = 0;
+    _slow_start = true;
+    _last_backoff_ms = 0;
+
+    memset(&_counters, 0, sizeof(_counters));
+}
+
+// the block with this seqno, or nullptr if it isn't in the window
+struct DFMAVLinkWindow::block *DFMAVLinkWindow::find(uint32_t seqno) const
+{
+    // unsigned differences, so this holds across seqno wrap
+    if (seqno - _oldest >= _next - _oldest) {
+        return nullptr;
+    }
+    struct block *b = &_blocks[slot(seqno)];
+    if (b->seqno != seqno) {
+        return nullptr;
+    }
+    return b;
+}
+
+void DFMAVLinkWindow::set_state(struct block &b, enum block_state state)
+{
+    _count[b.state]--;
+    _count[state]++;
+    b.state = state;
+}
+
+bool DFMAVLinkWindow::is_state(uint32_t seqno, enum block_state state) const
+{
+    const struct block *b = find(seqno);
+    return b != nullptr && b->state == state;
+}
+
+bool DFMAVLinkWindow::allocate(uint32_t &seqno)
+{
+    if (space() == 0) {
+        return false;
+    }
+    // slots outside the window are always free
+    struct block &b = _blocks[slot(_next)];
+    b.seqno = _next;
+    b.resent = false;
+    set_state(b, BLOCK_FILLING);
+    seqno = _next++;
+    return true;
+}
+
+void DFMAVLinkWindow::filled(uint32_t seqno)
+{
+    struct block *b = find(seqno);
+    if (b != nullptr && b->state == BLOCK_FILLING) {
+        set_state(*b, BLOCK_PENDING);
+    }
+}
+
+bool DFMAVLinkWindow::next_to_send(uint32_t &seqno) const
+{
+    if (_count[BLOCK_SENT] >= _in_flight_limit) {
+        return false;
+    }
+    if (_count[BLOCK_RETRY] > 0) {
+        for (uint32_t s = _oldest; s != _next; s++) {
+            if (_blocks[slot(s)].state == BLOCK_RETRY) {
+                seqno = s;
+                return true;
+            }
+        }
+    }
+    // blocks are filled in order, so pending blocks start at _next_unsent
+    if (_next_unsent != _next && _blocks[slot(_next_unsent)].state == BLOCK_PENDING) {
+        seqno = _next_unsent;
+        return true;
+    }
+    return false;
+}
+
+void DFMAVLinkWindow::sent(uint32_t seqno, uint32_t now_ms)
+{
+    struct block *b = find(seqno);
+    if (b == nullptr) {
+        return;
+    }
+    switch (b->state) {
+    case BLOCK_PENDING:
+        _counters.sent++;
+        if (seqno == _next_unsent) {
+            _next_unsent++;
+        }
+        break;
+    case BLOCK_SENT:
+    case BLOCK_RETRY:
+        _counters.resent++;
+        b->resent = true;
+        break;
+    default:
+        return;
+    }
+    set_state(*b, BLOCK_SENT);
+    b->last_sent_ms = now_ms;
+}
+
+bool DFMAVLinkWindow::timed_out(uint32_t seqno, uint32_t now_ms) const
+{
+    const struct block *b = find(seqno);
+    if (b == nullptr || b->state != BLOCK_SENT) {
+        return false;
+    }
+    return now_ms - b->last_sent_ms >= rto_ms();
+}
+
+void DFMAVLinkWindow::backoff(uint32_t now_ms)
+{
+    // losses within a round trip of the last back off are from the
+    // same burst
+    if (_last_backoff_ms != 0 && now_ms - _last_backoff_ms < rto_ms()) {
+        return;
+    }
+    _last_backoff_ms = now_ms;
+    _in_flight_limit = MAX(_in_flight_limit / 2, DFMAVLINKWINDOW_IN_FLIGHT_MIN);
+    _acks_since_increase = 0;
+    _slow_start = false;
+}
+
+bool DFMAVLinkWindow::ack(uint32_t seqno, uint32_t now_ms)
+{
+    struct block *b = find(seqno);
+    if (b == nullptr || (b->state != BLOCK_SENT && b->state != BLOCK_RETRY)) {
+        return false;
+    }
+    if (b->state == BLOCK_SENT && !b->resent) {
+        update_rtt(now_ms - b->last_sent_ms);
+    }
+    set_state(*b, BLOCK_FREE);
+    _counters.acked++;
+
+    // until the first loss one more block in flight for each ack,
+    // doubling the blocks in flight each round trip. After that one
+    // more for each round trip's worth of acks
+    if (_slow_start || ++_acks_since_increase >= _in_flight_limit) {
+        _acks_since_increase = 0;
+        if (_in_flight_limit < _size) {
+            _in_flight_limit++;
+        }
+    }
+
+    while (_oldest != _next && _blocks[slot(_oldest)].state == BLOCK_FREE) {
+        _oldest++;
+    }
+    return true;
+}
+
+bool DFMAVLinkWindow::nack(uint32_t seqno, uint32_t now_ms)
+{
+    struct block *b = find(seqno);
+    if (b == nullptr || b->state != BLOCK_SENT) {
+        return false;
+    }
+    set_state(*b, BLOCK_RETRY);
+    _counters.nacked++;
+    backoff(now_ms);
+    return true;
+}
+
+// smoothed round trip time and its mean deviation, as in RFC 6298
+void DFMAVLinkWindow::update_rtt(uint32_t sample_ms)
+{
+    const int32_t sample = MIN(sample_ms, (uint32_t)UINT16_MAX);
+    if (!_have_rtt) {
+        _srtt_ms = sample;
+        _rttvar_ms = sample / 2;
+        _have_rtt = true;
+        return;
+    }
+    const int32_t err = abs(sample - (int32_t)_srtt_ms);
+    _rttvar_ms = (3 * (int32_t)_rttvar_ms + err) / 4;
+    _srtt_ms = (7 * (int32_t)_srtt_ms + sample) / 8;
+}
+
+uint16_t DFMAVLinkWindow::rto_ms() const
+{
+    if (!_have_rtt) {
+        return DFMAVLINKWINDOW_RTO_INITIAL_MS;
+    }
+    const int32_t margin = MAX(4 * (int32_t)_rttvar_ms, DFMAVLINKWINDOW_RTO_GRANULARITY_MS);
+    return MIN(_srtt_ms + margin, DFMAVLINKWINDOW_RTO_MAX_MS);
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+/*
+  sliding window of log blocks streamed to a client over MAVLink
+
+  Block n lives in slot n % size, so an ack or nack from the client
+  finds its block without a search. The window spans from the oldest
+  block the client hasn't acked to the newest block handed out for
+  filling; a new block is only handed out while that span is smaller
+  than the window.
+
+  The time from sending a block to its ack gives a smoothed round trip
+  time, and blocks not acked within a timeout derived from it are sent
+  again. The number of blocks in flight doubles each round trip until
+  the first loss and grows by one per round trip after that, and is
+  halved when the client nacks a block or blocks time out.
+
+  This class doesn't know about MAVLink or the block contents; the
+  caller keeps the data of block n in slot(n) of its own buffer.
+ */
+
+#include <inttypes.h>
+
+class DFMAVLinkWindow {
+public:
+    enum block_state {
+        BLOCK_FREE = 0,
+        BLOCK_FILLING,  // handed out, being filled
+        BLOCK_PENDING,  // full, never sent
+        BLOCK_SENT,     // sent, waiting for an ack
+        BLOCK_RETRY,    // nacked by the client, to be sent again
+        BLOCK_STATE_COUNT
+    };
+
+    // allocate a window of size blocks, a power of two. Returns false
+    // if the allocation fails
+    bool init(uint8_t size);
+
+    // free all blocks, the next block handed out is seqno
+    void reset(uint32_t seqno);
+
+    uint8_t size() const { return _size; }
+    uint8_t slot(uint32_t seqno) const { return seqno & (_size - 1); }
+
+    // hand out the next block to be filled, false if the window is full
+    bool allocate(uint32_t &seqno);
+
+    // mark a block handed out by allocate() as ready to send
+    void filled(uint32_t seqno);
+
+    // block to send next, nacked blocks before pending blocks, oldest
+    // first. False if there is nothing to send or too much in flight
+    bool next_to_send(uint32_t &seqno) const;
+
+    // record that a block was sent, or sent again
+    void sent(uint32_t seqno, uint32_t now_ms);
+
+    // true if a block is waiting for an ack for longer than the timeout
+    bool timed_out(uint32_t seqno, uint32_t now_ms) const;
+
+    // halve the blocks allowed in flight, at most once per round trip.
+    // Called on a nack and after resending timed out blocks
+    void backoff(uint32_t now_ms);
+
+    // handle an ack or nack from the client, returns false if the block
+    // isn't waiting for one (eg. it was acked already)
+    bool ack(uint32_t seqno, uint32_t now_ms);
+    bool nack(uint32_t seqno, uint32_t now_ms);
+
+    // oldest block not acked, and the next block to be handed out
+    uint32_t oldest() const { return _oldest; }
+    uint32_t next() const { return _next; }
+
+    // blocks that can be handed out before the window is full
+    uint8_t space() const { return _size - (_next - _oldest); }
+
+    uint8_t count(enum block_state state) const { return _count[state]; }
+    bool is_state(uint32_t seqno, enum block_state state) const;
+
+    // smoothed round trip time and retransmission timeout
+    uint16_t rtt_ms() const { return _srtt_ms; }
+    uint16_t rto_ms() const;
+
+    // blocks allowed in flight at the moment
+    uint8_t in_flight_limit() const { return _in_flight_limit; }
+
+    // counters since the last reset
+    struct counters {
+        uint32_t sent;      // blocks sent for the first time
+        uint32_t resent;    // blocks sent again after a nack or timeout
+        uint32_t acked;
+        uint32_t nacked;
+    };
+    const struct counters &get_counters() const { return _counters; }
+
+private:
+    struct block {
+        uint32_t seqno;
+        uint32_t last_sent_ms;
+        uint8_t state;
+        // sent more than once, its ack can't be timed (Karn's algorithm)
+        bool resent;
+    };
+    struct block *_blocks;
+    uint8_t _size;
+
+    struct block *find(uint32_t seqno) const;
+    void set_state(struct block &b, enum block_state state);
+    void update_rtt(uint32_t sample_ms);
+
+    uint32_t _oldest;
+    uint32_t _next;
+    // oldest block that may still be pending
+    uint32_t _next_unsent;
+    uint8_t _count[BLOCK_STATE_COUNT];
+
+    uint16_t _srtt_ms;
+    uint16_t _rttvar_ms;
+    bool _have_rtt;
+    uint8_t _in_flight_limit;
+    uint8_t _acks_since_increase;
+    bool _slow_start;
+    uint32_t _last_backoff_ms;
+
+    struct counters _counters;
+};
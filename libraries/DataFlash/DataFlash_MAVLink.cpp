@@ -37,7 +37,11 @@ void DataFlash_MAVLink::Init()
     while (_blockcount >= 8) { // 8 is a *magic* number
         _blocks = (struct dm_block *) malloc(_blockcount * sizeof(_blocks[0]));
         if (_blocks != nullptr) {
-            break;
+            if (_window.init(_blockcount)) {
+                break;
+            }
+            free(_blocks);
+            _blocks = nullptr;
         }
         _blockcount /= 2;
     }
@@ -62,7 +66,7 @@ bool DataFlash_MAVLink::logging_failed() const
 }
 
 uint32_t DataFlash_MAVLink::bufferspace_available() {
-    return (_blockcount_free * 200 + remaining_space_in_current_block());
+    return (_window.space() * 200 + remaining_space_in_current_block());
 }
 
 uint8_t DataFlash_MAVLink::remaining_space_in_current_block() {
@@ -70,55 +74,6 @@ uint8_t DataFlash_MAVLink::remaining_space_in_current_block() {
     return (MAVLINK_MSG_REMOTE_LOG_DATA_BLOCK_FIELD_DATA_LEN - _latest_block_len);
 }
 
-void DataFlash_MAVLink::enqueue_block(dm_block_queue_t &queue, struct dm_block *block)
-{
-    if (queue.youngest != nullptr) {
-        queue.youngest->next = block;
-    } else {
-        queue.oldest = block;
-    }
-    queue.youngest = block;
-}
-
-struct DataFlash_MAVLink::dm_block *DataFlash_MAVLink::dequeue_seqno(DataFlash_MAVLink::dm_block_queue_t &queue, uint32_t seqno)
-{
-    struct dm_block *prev = nullptr;
-    for (struct dm_block *block=queue.oldest; block != nullptr; block=block->next) {
-        if (block->seqno == seqno) {
-            if (prev == nullptr) {
-                if (queue.youngest == queue.oldest) {
-                    queue.oldest = nullptr;
-                    queue.youngest = nullptr;
-                } else {
-                    queue.oldest = block->next;
-                }
-            } else {
-                if (queue.youngest == block) {
-                    queue.youngest = prev;
-                }
-                prev->next = block->next;
-            }
-            block->next = nullptr;
-            return block;
-        }
-        prev = block;
-    }
-    return nullptr;
-}
-
-bool DataFlash_MAVLink::free_seqno_from_queue(uint32_t seqno, dm_block_queue_t &queue)
-{
-    struct dm_block *block = dequeue_seqno(queue, seqno);
-    if (block != nullptr) {
-        block->next = _blocks_free;
-        _blocks_free = block;
-        _blockcount_free++; // comment me out to expose a bug!
-        return true;
-    }
-    return false;
-}
-    
-
 bool DataFlash_MAVLink::WritesOK() const
 {
     if (!DataFlash_Backend::WritesOK()) {
@@ -181,7 +136,7 @@ bool DataFlash_MAVLink::WritePrioritisedBlock(const void *pBuffer, uint16_t size
         _latest_block_len += to_copy;
         if (_latest_block_len == MAVLINK_MSG_REMOTE_LOG_DATA_BLOCK_FIELD_DATA_LEN) {
             //block full, mark it to be sent:
-            enqueue_block(_blocks_pending, _current_block);
+            _window.filled(_current_seqno);
             _current_block = next_block();
         }
     }
@@ -194,42 +149,20 @@ bool DataFlash_MAVLink::WritePrioritisedBlock(const void *pBuffer, uint16_t size
 //Get a free block
 struct DataFlash_MAVLink::dm_block *DataFlash_MAVLink::next_block()
 {
-    DataFlash_MAVLink::dm_block *ret = _blocks_free;
-    if (ret != nullptr) {
-        _blocks_free = ret->next;
-        _blockcount_free--;
-        ret->seqno = _next_seq_num++;
-        ret->last_sent = 0;
-        ret->next = nullptr;
-        _latest_block_len = 0;
-    }
-    return ret;
+    uint32_t seqno;
+    if (!_window.allocate(seqno)) {
+        return nullptr;
+    }
+    _current_seqno = seqno;
+    _latest_block_len = 0;
+    return &_blocks[_window.slot(seqno)];
 }
 
 void DataFlash_MAVLink::free_all_blocks()
 {
-    _blocks_free = nullptr;
+    _window.reset(0);
     _current_block = nullptr;
 
-    _blocks_pending.sent_count = 0;
-    _blocks_pending.oldest = _blocks_pending.youngest = nullptr;
-    _blocks_retry.sent_count = 0;
-    _blocks_retry.oldest = _blocks_retry.youngest = nullptr;
-    _blocks_sent.sent_count = 0;
-    _blocks_sent.oldest = _blocks_sent.youngest = nullptr;
-
-    // add blocks to the free stack:
-    for(uint8_t i=0; i < _blockcount; i++) {
-        _blocks[i].next = _blocks_free;
-        _blocks_free = &_blocks[i];
-        // this value doesn't really matter, but it stops valgrind
-        // complaining when acking blocks (we check seqno before
-        // state).  Also, when we receive ACKs we check seqno, and we
-        // want to ack the *real* block zero!
-        _blocks[i].seqno = 9876543;
-    }
-    _blockcount_free = _blockcount;
-
     _latest_block_len = 0;
 }
 
@@ -267,7 +200,6 @@ void DataFlash_MAVLink::handle_ack(mavlink_channel_t chan,
             _target_system_id = msg->sysid;
             _target_component_id = msg->compid;
             _chan = chan;
-            _next_seq_num = 0;
             start_new_log_reset_variables();
             _last_response_time = AP_HAL::millis();
             Debug("Target: (%u/%u)", _target_system_id, _target_component_id);
@@ -275,15 +207,11 @@ void DataFlash_MAVLink::handle_ack(mavlink_channel_t chan,
         return;
     }
 
-    // check SENT blocks (VERY likely to be first on the list):
-    if (free_seqno_from_queue(seqno, _blocks_sent)) {
-        // celebrate
-        _last_response_time = AP_HAL::millis();
-    } else if(free_seqno_from_queue(seqno, _blocks_retry)) {
-        // party
-        _last_response_time = AP_HAL::millis();
+    const uint32_t now = AP_HAL::millis();
+    if (_window.ack(seqno, now)) {
+        _last_response_time = now;
     } else {
-        // probably acked already and put on the free list.
+        // probably acked already and freed
     }
 }
 
@@ -309,10 +237,9 @@ void DataFlash_MAVLink::handle_retry(uint32_t seqno)
         return;
     }
 
-    struct dm_block *victim = dequeue_seqno(_blocks_sent, seqno);
-    if (victim != nullptr) {
-        _last_response_time = AP_HAL::millis();
-        enqueue_block(_blocks_retry, victim);
+    const uint32_t now = AP_HAL::millis();
+    if (_window.nack(seqno, now)) {
+        _last_response_time = now;
     }
 }
 
@@ -324,6 +251,8 @@ void DataFlash_MAVLink::stats_init() {
     dropped = 0;
     internal_errors = 0;
     stats.resends = 0;
+    _stats_last_logged_time = AP_HAL::millis();
+    _stats_last_blocks_sent = 0;
     stats_reset();
 }
 void DataFlash_MAVLink::stats_reset() {
@@ -350,9 +279,9 @@ void DataFlash_MAVLink::Log_Write_DF_MAV(DataFlash_MAVLink &df)
     struct log_DF_MAV_Stats pkt = {
         LOG_PACKET_HEADER_INIT(LOG_DF_MAV_STATS),
         timestamp         : AP_HAL::millis(),
-        seqno             : df._next_seq_num-1,
+        seqno             : df._window.next()-1,
         dropped           : df.dropped,
-        retries           : df._blocks_retry.sent_count,
+        retries           : df._window.get_counters().nacked,
         resends           : df.stats.resends,
         internal_errors   : df.internal_errors,
         state_free_avg    : (uint8_t)(df.stats.state_free/df.stats.collection_count),
@@ -368,6 +297,36 @@ void DataFlash_MAVLink::Log_Write_DF_MAV(DataFlash_MAVLink &df)
     WriteBlock(&pkt,sizeof(pkt));
 }
 
+void DataFlash_MAVLink::Log_Write_DF_MAV_Link()
+{
+    const DFMAVLinkWindow::counters &counters = _window.get_counters();
+    const uint32_t now = AP_HAL::millis();
+    const uint32_t blocks_sent = counters.sent + counters.resent;
+    uint32_t rate = 0;
+    if (now != _stats_last_logged_time) {
+        rate = (uint64_t)(blocks_sent - _stats_last_blocks_sent) *
+            MAVLINK_MSG_REMOTE_LOG_DATA_BLOCK_FIELD_DATA_LEN * 1000 /
+            (now - _stats_last_logged_time);
+    }
+    _stats_last_logged_time = now;
+    _stats_last_blocks_sent = blocks_sent;
+
+    struct log_DF_MAV_Link pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_DF_MAV_LINK),
+        timestamp       : now,
+        rtt             : _window.rtt_ms(),
+        rto             : _window.rto_ms(),
+        in_flight_limit : _window.in_flight_limit(),
+        in_flight       : _window.count(DFMAVLinkWindow::BLOCK_SENT),
+        sent            : counters.sent,
+        resent          : counters.resent,
+        acked           : counters.acked,
+        nacked          : counters.nacked,
+        rate            : rate,
+    };
+    WriteBlock(&pkt,sizeof(pkt));
+}
+
 void DataFlash_MAVLink::stats_log()
 {
     if (!_initialised || !_logging_started) {
@@ -377,10 +336,11 @@ void DataFlash_MAVLink::stats_log()
         return;
     }
     Log_Write_DF_MAV(*this);
+    Log_Write_DF_MAV_Link();
 #if REMOTE_LOG_DEBUGGING
     printf("D:%d Retry:%d Resent:%d E:%d SF:%d/%d/%d SP:%d/%d/%d SS:%d/%d/%d SR:%d/%d/%d\n",
            dropped,
-           _blocks_retry.sent_count,
+           _window.get_counters().nacked,
            stats.resends,
            internal_errors,
            stats.state_free_min,
@@ -400,19 +360,6 @@ void DataFlash_MAVLink::stats_log()
     stats_reset();
 }
 
-uint8_t DataFlash_MAVLink::stack_size(struct dm_block *stack)
-{
-    uint8_t ret = 0;
-    for (struct dm_block *block=stack; block != nullptr; block=block->next) {
-        ret++;
-    }
-    return ret;
-}
-uint8_t DataFlash_MAVLink::queue_size(dm_block_queue_t queue)
-{
-    return stack_size(queue.oldest);
-}
-
 void DataFlash_MAVLink::stats_collect()
 {
     if (!_initialised || !_logging_started) {
@@ -421,12 +368,12 @@ void DataFlash_MAVLink::stats_collect()
     if (!semaphore->take_nonblocking()) {
         return;
     }
-    uint8_t pending = queue_size(_blocks_pending);
-    uint8_t sent = queue_size(_blocks_sent);
-    uint8_t retry = queue_size(_blocks_retry);
-    uint8_t sfree = stack_size(_blocks_free);
+    uint8_t pending = _window.count(DFMAVLinkWindow::BLOCK_PENDING);
+    uint8_t sent = _window.count(DFMAVLinkWindow::BLOCK_SENT);
+    uint8_t retry = _window.count(DFMAVLinkWindow::BLOCK_RETRY);
+    uint8_t sfree = _window.space();
 
-    if (sfree != _blockcount_free) {
+    if (_window.count(DFMAVLinkWindow::BLOCK_FREE) < sfree) {
         internal_error();
     }
     semaphore->give();
@@ -464,30 +411,6 @@ void DataFlash_MAVLink::stats_collect()
     stats.collection_count++;
 }
 
-/* while we "successfully" send log blocks from a queue, move them to
- * the sent list. DO NOT call this for blocks already sent!
-*/
-bool DataFlash_MAVLink::send_log_blocks_from_queue(dm_block_queue_t &queue)
-{
-    uint8_t sent_count = 0;
-    while (queue.oldest != nullptr) {
-        if (sent_count++ > _max_blocks_per_send_blocks) {
-            return false;
-        }
-        if (! send_log_block(*queue.oldest)) {
-            return false;
-        }
-        queue.sent_count++;
-        struct DataFlash_MAVLink::dm_block *tmp = dequeue_seqno(queue,queue.oldest->seqno);
-        if (tmp != nullptr) { // should never be nullptr
-            enqueue_block(_blocks_sent, tmp);
-        } else {
-            internal_error();
-        }
-    }
-    return true;
-}
-
 void DataFlash_MAVLink::push_log_blocks()
 {
     if (!_initialised || !_logging_started ||!_sending_to_client) {
@@ -500,14 +423,16 @@ void DataFlash_MAVLink::push_log_blocks()
         return;
     }
 
-    if (! send_log_blocks_from_queue(_blocks_retry)) {
-        semaphore->give();
-        return;
-    }
-
-    if (! send_log_blocks_from_queue(_blocks_pending)) {
-        semaphore->give();
-        return;
+    // nacked blocks first, then blocks never sent, for as long as the
+    // window allows more in flight and the channel has room
+    uint8_t sent_count = 0;
+    uint32_t seqno;
+    while (sent_count < _max_blocks_per_send_blocks &&
+           _window.next_to_send(seqno)) {
+        if (! send_log_block(seqno)) {
+            break;
+        }
+        sent_count++;
     }
     semaphore->give();
 }
@@ -518,28 +443,30 @@ void DataFlash_MAVLink::do_resends(uint32_t now)
         return;
     }
 
-    uint8_t count_to_send = 5;
-    if (_blockcount < count_to_send) {
-        count_to_send = _blockcount;
+    if (!semaphore->take_nonblocking()) {
+        return;
     }
-    uint32_t oldest = now - 100; // 100 milliseconds before resend.  Hmm.
-    while (count_to_send-- > 0) {
-        if (!semaphore->take_nonblocking()) {
-            return;
+    // blocks not acked within the window's timeout, oldest first
+    uint8_t count_to_send = _max_blocks_per_send_blocks;
+    bool resent = false;
+    for (uint32_t seqno = _window.oldest();
+         seqno != _window.next() && count_to_send > 0;
+         seqno++) {
+        if (!_window.timed_out(seqno, now)) {
+            continue;
         }
-        for (struct dm_block *block=_blocks_sent.oldest; block != nullptr; block=block->next) {
-            // only want to send blocks every now-and-then:
-            if (block->last_sent < oldest) {
-                if (! send_log_block(*block)) {
-                    // failed to send the block; try again later....
-                    semaphore->give();
-                    return;
-                }
-                stats.resends++;
-            }
+        if (! send_log_block(seqno)) {
+            // failed to send the block; try again later....
+            break;
         }
-        semaphore->give();
+        stats.resends++;
+        count_to_send--;
+        resent = true;
+    }
+    if (resent) {
+        _window.backoff(now);
     }
+    semaphore->give();
 }
 
 // NOTE: any functions called from these periodic functions MUST
@@ -568,7 +495,7 @@ void DataFlash_MAVLink::periodic_fullrate(uint32_t now)
 }
 
 //TODO: handle full txspace properly
-bool DataFlash_MAVLink::send_log_block(struct dm_block &block)
+bool DataFlash_MAVLink::send_log_block(uint32_t seqno)
 {
     mavlink_channel_t chan = mavlink_channel_t(_chan - MAVLINK_COMM_0);
     if (!_initialised) {
@@ -597,14 +524,14 @@ bool DataFlash_MAVLink::send_log_block(struct dm_block &block)
     mavlink_status_t *chan_status = mavlink_get_channel_status(chan);
     uint8_t saved_seq = chan_status->current_tx_seq;
     chan_status->current_tx_seq = mavlink_seq++;
-    // Debug("Sending block (%d)", block.seqno);
+    // Debug("Sending block (%d)", seqno);
     mavlink_msg_remote_log_data_block_pack(mavlink_system.sysid,
                                            MAV_COMP_ID_LOG,
                                            &msg,
                                            _target_system_id,
                                            _target_component_id,
-                                           block.seqno,
-                                           block.buf);
+                                           seqno,
+                                           _blocks[_window.slot(seqno)].buf);
 
     hal.util->perf_end(_perf_packing);
 
@@ -612,7 +539,7 @@ bool DataFlash_MAVLink::send_log_block(struct dm_block &block)
     irqrestore(istate);
 #endif
 
-    block.last_sent = AP_HAL::millis();
+    _window.sent(seqno, AP_HAL::millis());
     chan_status->current_tx_seq = saved_seq;
 
     // _last_send_time is set even if we fail to send the packet; if
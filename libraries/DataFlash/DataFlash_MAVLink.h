@@ -12,11 +12,20 @@
 #include <AP_HAL/AP_HAL.h>
 
 #include "DataFlash_Backend.h"
+#include "DFMAVLinkWindow.h"
 
 extern const AP_HAL::HAL& hal;
 
 #define DF_MAVLINK_DISABLE_INTERRUPTS 0
 
+// blocks in the window; boards with plenty of memory keep more in
+// flight to stream over fast links
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define DF_MAVLINK_BLOCKCOUNT 128
+#else
+#define DF_MAVLINK_BLOCKCOUNT 32
+#endif
+
 class DataFlash_MAVLink : public DataFlash_Backend
 {
 public:
@@ -24,7 +33,7 @@ public:
     DataFlash_MAVLink(DataFlash_Class &front, DFMessageWriter_DFLogStart *writer) :
         DataFlash_Backend(front, writer),
         _max_blocks_per_send_blocks(8),
-        _blockcount(32) // this may get reduced in Init if allocation fails
+        _blockcount(DF_MAVLINK_BLOCKCOUNT) // this may get reduced in Init if allocation fails
         ,_perf_packing(hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, "DM_packing"))
         { }
 
@@ -73,37 +82,19 @@ protected:
 
 private:
 
+    // data of the block with seqno n is in _blocks[_window.slot(n)]
     struct dm_block {
-        uint32_t seqno;
         uint8_t buf[MAVLINK_MSG_REMOTE_LOG_DATA_BLOCK_FIELD_DATA_LEN];
-        uint32_t last_sent;
-        struct dm_block *next;
     };
-    bool send_log_block(struct dm_block &block);
+    bool send_log_block(uint32_t seqno);
     void handle_ack(mavlink_channel_t chan, mavlink_message_t* msg, uint32_t seqno);
     void handle_retry(uint32_t block_num);
     void do_resends(uint32_t now);
     void free_all_blocks();
 
-    // a stack for free blocks, queues for pending, sent, retries and sent
-    struct dm_block_queue {
-        uint32_t sent_count;
-        struct dm_block *oldest;
-        struct dm_block *youngest;
-    };
-    typedef struct dm_block_queue dm_block_queue_t ;
-    void enqueue_block(dm_block_queue_t &queue, struct dm_block *block);
-    bool queue_has_block(dm_block_queue_t &queue, struct dm_block *block);
-    struct dm_block *dequeue_seqno(dm_block_queue_t &queue, uint32_t seqno);
-    bool free_seqno_from_queue(uint32_t seqno, dm_block_queue_t &queue);
-    bool send_log_blocks_from_queue(dm_block_queue_t &queue);
-    uint8_t stack_size(struct dm_block *stack);
-    uint8_t queue_size(dm_block_queue_t queue);
-    
-    struct dm_block *_blocks_free;
-    dm_block_queue_t _blocks_sent;
-    dm_block_queue_t _blocks_pending;
-    dm_block_queue_t _blocks_retry;
+    // states of the blocks, their round trip time and how many may be
+    // in flight
+    DFMAVLinkWindow _window;
 
     struct _stats {
         // the following are reset any time we log stats (see "reset_stats")
@@ -134,7 +125,8 @@ private:
     bool _initialised;
 
     // this controls the maximum number of blocks we will push from
-    // the pending and send queues in any call to push_log_blocks.
+    // the window in any call to push_log_blocks, on top of the limit
+    // on blocks in flight the window sets from the acks it gets back.
     // push_log_blocks is called by periodic_tasks.  Each block is 200
     // bytes.  In Plane, at 50Hz, a _max_blocks_per_send_blocks of 2
     // means we will push at most 2*50*200 == 20KB of logs per second
@@ -143,7 +135,6 @@ private:
     // time packing messages in any one loop
     const uint8_t _max_blocks_per_send_blocks;
     
-    uint32_t _next_seq_num;
     uint16_t _latest_block_len;
     bool _logging_started;
     uint32_t _last_response_time;
@@ -152,15 +143,16 @@ private:
     bool _sending_to_client;
 
     void Log_Write_DF_MAV(DataFlash_MAVLink &df);
+    void Log_Write_DF_MAV_Link();
     
     void internal_error();
     uint32_t bufferspace_available() override; // in bytes
     uint8_t remaining_space_in_current_block();
     // write buffer
-    uint8_t _blockcount_free;
     uint8_t _blockcount;
     struct dm_block *_blocks;
     struct dm_block *_current_block;
+    uint32_t _current_seqno;
     struct dm_block *next_block();
 
     void periodic_10Hz(uint32_t now) override;
@@ -173,6 +165,8 @@ private:
     void stats_log();
     uint32_t _stats_last_collected_time;
     uint32_t _stats_last_logged_time;
+    // blocks sent as of the last DML message, for the link rate
+    uint32_t _stats_last_blocks_sent;
     uint8_t mavlink_seq;
 
     /* we currently ignore requests to start a new log.  Notionally we
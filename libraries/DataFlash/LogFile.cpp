@@ -686,12 +686,13 @@ void DataFlash_Class::Log_Write_POS(AP_AHRS &ahrs)
 #if AP_AHRS_NAVEKF_AVAILABLE
 void DataFlash_Class::Log_Write_EKF(AP_AHRS_NavEKF &ahrs, bool optFlowEnabled)
 {
-    // only log EKF2 if enabled
-    if (ahrs.get_NavEKF2().activeCores() > 0) {
+    // only log EKF2 if enabled. An EKF run by the AHRS asynchronous
+    // thread is logged by it, between updates
+    if (ahrs.get_NavEKF2().activeCores() > 0 && !ahrs.async_log(2, optFlowEnabled)) {
         Log_Write_EKF2(ahrs, optFlowEnabled);
     }
     // only log EKF3 if enabled
-    if (ahrs.get_NavEKF3().activeCores() > 0) {
+    if (ahrs.get_NavEKF3().activeCores() > 0 && !ahrs.async_log(3, optFlowEnabled)) {
         Log_Write_EKF3(ahrs, optFlowEnabled);
     }
 }
@@ -1929,3 +1930,63 @@ void DataFlash_Class::Log_Write_Beacon(AP_Beacon &beacon)
     };
     WriteBlock(&pkt_beacon, sizeof(pkt_beacon));
 }
+
+// Write the latency histograms of the last period, one message for
+// each stage which saw any samples. The buckets are those of
+// PerfHistogram, as in PERF messages
+void DataFlash_Class::Log_Write_Latency(const LatencyTrace &trace)
+{
+    static_assert(sizeof(log_Latency::buckets) == HAL_PERF_BUCKETS * sizeof(uint32_t), "LAT buckets must match PerfHistogram");
+
+    const uint64_t now = AP_HAL::micros64();
+    for (uint8_t i = 0; i < LatencyTrace::STAGE_COUNT; i++) {
+        const PerfHistogram &hist = trace.get_histogram((enum LatencyTrace::trace_stage)i);
+        if (hist.count() == 0) {
+            continue;
+        }
+        struct log_Latency pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_LATENCY_MSG),
+            time_us : now,
+            stage   : i,
+            min_us  : hist.min_us(),
+            max_us  : hist.max_us(),
+        };
+        for (uint8_t b = 0; b < HAL_PERF_BUCKETS; b++) {
+            pkt.buckets[b] = hist.bucket_count(b);
+        }
+        WriteBlock(&pkt, sizeof(pkt));
+    }
+}
+
+// Write every perf counter the HAL keeps, with totals since boot. The
+// times are in microseconds. B0 counts times under 64us, each bucket
+// after covers twice the range of the one before, and B7 counts
+// everything over 4.096ms
+void DataFlash_Class::Log_Write_Perf(void)
+{
+    static_assert(sizeof(log_Perf::buckets) == HAL_PERF_BUCKETS * sizeof(uint32_t), "PERF buckets must match PerfHistogram");
+
+    const uint64_t now = AP_HAL::micros64();
+    const uint16_t num_counters = hal.util->perf_num_counters();
+    for (uint16_t i = 0; i < num_counters; i++) {
+        AP_HAL::Util::perf_info info;
+        if (!hal.util->perf_get_info(i, info)) {
+            continue;
+        }
+        struct log_Perf pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_PERF_MSG),
+            time_us : now,
+            name    : {},
+            type    : (uint8_t)info.type,
+            count   : info.count,
+            min_us  : info.hist.min_us(),
+            max_us  : info.hist.max_us(),
+            avg_us  : info.count ? (info.total_ns * 1.0e-3f) / info.count : 0.0f,
+        };
+        strncpy(pkt.name, info.name, sizeof(pkt.name));
+        for (uint8_t b = 0; b < HAL_PERF_BUCKETS; b++) {
+            pkt.buckets[b] = info.hist.bucket_count(b);
+        }
+        WriteBlock(&pkt, sizeof(pkt));
+    }
+}
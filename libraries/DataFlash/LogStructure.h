@@ -737,6 +737,20 @@ struct PACKED log_DF_MAV_Stats {
     // uint8_t state_retry_max;
 };
 
+struct PACKED log_DF_MAV_Link {
+    LOG_PACKET_HEADER;
+    uint32_t timestamp;
+    uint16_t rtt;
+    uint16_t rto;
+    uint8_t in_flight_limit;
+    uint8_t in_flight;
+    uint32_t sent;
+    uint32_t resent;
+    uint32_t acked;
+    uint32_t nacked;
+    uint32_t rate;
+};
+
 struct PACKED log_ORGN {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -838,6 +852,29 @@ struct PACKED log_Beacon {
     float posz;
 };
 
+// latency histogram of one stage of the control loop, see LatencyTrace
+struct PACKED log_Latency {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t stage;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t buckets[8];
+};
+
+// one perf counter, totals since boot, see AP_HAL::Util::perf_info
+struct PACKED log_Perf {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    char name[16];
+    uint8_t type;
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    float avg_us;
+    uint32_t buckets[8];
+};
+
 // #endif // SBP_HW_LOGGING
 
 #define ACC_LABELS "TimeUS,SampleUS,AccX,AccY,AccZ"
@@ -964,8 +1001,14 @@ Format characters in the format string for binary log messages
       "RFND", "QCBCB", "TimeUS,Dist1,Orient1,Dist2,Orient2" }, \
     { LOG_DF_MAV_STATS, sizeof(log_DF_MAV_Stats), \
       "DMS", "IIIIIBBBBBBBBBB",         "TimeMS,N,Dp,RT,RS,Er,Fa,Fmn,Fmx,Pa,Pmn,Pmx,Sa,Smn,Smx" }, \
+    { LOG_DF_MAV_LINK, sizeof(log_DF_MAV_Link), \
+      "DML", "IHHBBIIIII",         "TimeMS,RTT,RTO,W,InF,Snt,Rsn,Ack,Nak,Rate" }, \
     { LOG_BEACON_MSG, sizeof(log_Beacon), \
-      "BCN", "QBBfffffff",  "TimeUS,Health,Cnt,D0,D1,D2,D3,PosX,PosY,PosZ" }
+      "BCN", "QBBfffffff",  "TimeUS,Health,Cnt,D0,D1,D2,D3,PosX,PosY,PosZ" }, \
+    { LOG_LATENCY_MSG, sizeof(log_Latency), \
+      "LAT", "QBIIIIIIIIII", "TimeUS,Stage,Min,Max,B0,B1,B2,B3,B4,B5,B6,B7" }, \
+    { LOG_PERF_MSG, sizeof(log_Perf), \
+      "PERF", "QNBIIIfIIIIIIII", "TimeUS,Name,Type,Cnt,Min,Max,Avg,B0,B1,B2,B3,B4,B5,B6,B7" }
 
 // messages for more advanced boards
 #define LOG_EXTRA_STRUCTURES \
@@ -1255,6 +1298,9 @@ enum LogMessages {
     LOG_VISUALODOM_MSG,
     LOG_AOA_SSA_MSG,
     LOG_BEACON_MSG,
+    LOG_DF_MAV_LINK,
+    LOG_LATENCY_MSG,
+    LOG_PERF_MSG,
 };
 
 enum LogOriginType {
@@ -0,0 +1,307 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <DataFlash/DFMAVLinkWindow.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+TEST(DFMAVLinkWindow, Allocate)
+{
+    DFMAVLinkWindow window;
+    ASSERT_TRUE(window.init(8));
+    EXPECT_EQ(8, window.space());
+
+    uint32_t seqno;
+    for (uint32_t i = 0; i < 8; i++) {
+        ASSERT_TRUE(window.allocate(seqno));
+        EXPECT_EQ(i, seqno);
+        window.filled(seqno);
+    }
+    EXPECT_EQ(0, window.space());
+    EXPECT_FALSE(window.allocate(seqno));
+    EXPECT_EQ(8, window.count(DFMAVLinkWindow::BLOCK_PENDING));
+
+    // send everything the window allows in flight
+    uint8_t sent = 0;
+    while (window.next_to_send(seqno)) {
+        EXPECT_EQ(sent, seqno);
+        window.sent(seqno, 1000);
+        sent++;
+    }
+    EXPECT_EQ(window.in_flight_limit(), sent);
+    EXPECT_EQ(sent, window.count(DFMAVLinkWindow::BLOCK_SENT));
+
+    // an ack past the oldest block frees it but doesn't move the window
+    EXPECT_TRUE(window.ack(1, 1010));
+    EXPECT_FALSE(window.ack(1, 1010));
+    EXPECT_EQ(0U, window.oldest());
+    EXPECT_EQ(0, window.space());
+
+    // acking the oldest block moves the window over both
+    EXPECT_TRUE(window.ack(0, 1010));
+    EXPECT_EQ(2U, window.oldest());
+    EXPECT_EQ(2, window.space());
+    EXPECT_EQ(10, window.rtt_ms());
+
+    // block 8 reuses the slot of block 0
+    ASSERT_TRUE(window.allocate(seqno));
+    EXPECT_EQ(8U, seqno);
+    EXPECT_EQ(window.slot(0), window.slot(8));
+    EXPECT_TRUE(window.is_state(8, DFMAVLinkWindow::BLOCK_FILLING));
+    EXPECT_FALSE(window.is_state(0, DFMAVLinkWindow::BLOCK_FILLING));
+    EXPECT_FALSE(window.ack(0, 1010));
+}
+
+TEST(DFMAVLinkWindow, Nack)
+{
+    DFMAVLinkWindow window;
+    ASSERT_TRUE(window.init(32));
+
+    uint32_t seqno;
+    for (uint8_t i = 0; i < 4; i++) {
+        ASSERT_TRUE(window.allocate(seqno));
+        window.filled(seqno);
+        ASSERT_TRUE(window.next_to_send(seqno));
+        window.sent(seqno, 1000);
+    }
+    const uint8_t limit = window.in_flight_limit();
+
+    // a nacked block is sent again before blocks never sent
+    ASSERT_TRUE(window.allocate(seqno));
+    window.filled(seqno);
+    EXPECT_TRUE(window.nack(2, 1005));
+    EXPECT_FALSE(window.nack(2, 1005));
+    EXPECT_EQ(limit / 2, window.in_flight_limit());
+    ASSERT_TRUE(window.next_to_send(seqno));
+    EXPECT_EQ(2U, seqno);
+    window.sent(seqno, 1010);
+
+    // a second nack within a round trip doesn't back off again
+    EXPECT_TRUE(window.nack(3, 1010));
+    EXPECT_EQ(limit / 2, window.in_flight_limit());
+
+    // the ack of a resent block isn't timed
+    EXPECT_TRUE(window.ack(2, 1500));
+    EXPECT_EQ(0, window.rtt_ms());
+    EXPECT_TRUE(window.ack(0, 1020));
+    EXPECT_EQ(20, window.rtt_ms());
+
+    const DFMAVLinkWindow::counters &counters = window.get_counters();
+    EXPECT_EQ(4U, counters.sent);
+    EXPECT_EQ(1U, counters.resent);
+    EXPECT_EQ(2U, counters.acked);
+    EXPECT_EQ(2U, counters.nacked);
+}
+
+TEST(DFMAVLinkWindow, TimeOut)
+{
+    DFMAVLinkWindow window;
+    ASSERT_TRUE(window.init(8));
+
+    uint32_t seqno;
+    ASSERT_TRUE(window.allocate(seqno));
+    window.filled(seqno);
+    ASSERT_TRUE(window.next_to_send(seqno));
+    window.sent(seqno, 1000);
+
+    EXPECT_EQ(100, window.rto_ms());
+    EXPECT_FALSE(window.timed_out(0, 1099));
+    EXPECT_TRUE(window.timed_out(0, 1100));
+
+    // resending restarts the timeout
+    window.sent(0, 1100);
+    EXPECT_FALSE(window.timed_out(0, 1150));
+    EXPECT_EQ(1U, window.get_counters().resent);
+}
+
+TEST(DFMAVLinkWindow, SeqnoWrap)
+{
+    DFMAVLinkWindow window;
+    ASSERT_TRUE(window.init(8));
+    window.reset(UINT32_MAX - 2);
+
+    uint32_t seqno;
+    for (uint8_t i = 0; i < 6; i++) {
+        ASSERT_TRUE(window.allocate(seqno));
+        window.filled(seqno);
+    }
+    EXPECT_EQ(2U, seqno);
+    EXPECT_EQ(2, window.space());
+    EXPECT_TRUE(window.is_state(0, DFMAVLinkWindow::BLOCK_PENDING));
+    EXPECT_TRUE(window.is_state(UINT32_MAX, DFMAVLinkWindow::BLOCK_PENDING));
+    EXPECT_FALSE(window.is_state(3, DFMAVLinkWindow::BLOCK_PENDING));
+    EXPECT_FALSE(window.is_state(UINT32_MAX - 3, DFMAVLinkWindow::BLOCK_PENDING));
+}
+
+/*
+  a client at the end of a link that delays each message by a fixed
+  time and drops some of them. Like the clients in use it acks every
+  block it gets and nacks blocks it sees it has missed
+ */
+static const uint32_t link_delay_ms = 20;
+static const uint32_t link_blocks = 5000;
+
+class MockLink {
+public:
+    explicit MockLink(uint8_t loss_percent) :
+        _loss_percent(loss_percent)
+    {
+        memset(_received, 0, sizeof(_received));
+    }
+
+    // a block sent now reaches the client at now + delay_ms
+    void send_block(uint32_t seqno, uint32_t now_ms) {
+        if (!lost()) {
+            queue(to_client, seqno, now_ms + link_delay_ms, true);
+        }
+    }
+
+    // run the link and client up to now, handing replies to the window
+    void update(DFMAVLinkWindow &window, uint32_t now_ms) {
+        struct message m;
+        while (dequeue(to_client, now_ms, m)) {
+            if (m.seqno < link_blocks) {
+                _received[m.seqno]++;
+            }
+            for (uint32_t s = _highest + 1; s < m.seqno; s++) {
+                if (!_received[s] && !lost()) {
+                    queue(to_server, s, now_ms + link_delay_ms, false);
+                }
+            }
+            if (m.seqno + 1 > _highest + 1 || _highest == UINT32_MAX) {
+                _highest = m.seqno;
+            }
+            if (!lost()) {
+                queue(to_server, m.seqno, now_ms + link_delay_ms, true);
+            }
+        }
+        while (dequeue(to_server, now_ms, m)) {
+            if (m.ack) {
+                window.ack(m.seqno, now_ms);
+            } else {
+                window.nack(m.seqno, now_ms);
+            }
+        }
+    }
+
+    bool all_received(uint32_t count) const {
+        for (uint32_t i = 0; i < count; i++) {
+            if (!_received[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct message {
+        uint32_t seqno;
+        uint32_t arrive_ms;
+        bool ack;
+    };
+    struct direction {
+        struct message messages[1024];
+        uint16_t head;
+        uint16_t count;
+    } to_client {}, to_server {};
+
+    void queue(struct direction &d, uint32_t seqno, uint32_t arrive_ms, bool ack) {
+        ASSERT_LT(d.count, 1024);
+        d.messages[(d.head + d.count++) % 1024] = { seqno, arrive_ms, ack };
+    }
+    bool dequeue(struct direction &d, uint32_t now_ms, struct message &m) {
+        if (d.count == 0 || d.messages[d.head].arrive_ms > now_ms) {
+            return false;
+        }
+        m = d.messages[d.head];
+        d.head = (d.head + 1) % 1024;
+        d.count--;
+        return true;
+    }
+
+    // deterministic pseudo-random loss
+    bool lost() {
+        _rand = _rand * 1103515245 + 12345;
+        return ((_rand >> 16) % 100) < _loss_percent;
+    }
+
+    uint8_t _loss_percent;
+    uint32_t _rand = 1;
+    uint32_t _highest = UINT32_MAX;
+    uint8_t _received[link_blocks];
+};
+
+// stream blocks over the mock link as DataFlash_MAVLink does, with up
+// to 8 blocks sent each 1ms tick, until the client has every block and
+// every block is acked. Returns the time taken
+static uint32_t stream(DFMAVLinkWindow &window, MockLink &link)
+{
+    uint32_t now_ms = 1;
+    uint32_t produced = 0;
+    while ((!link.all_received(link_blocks) || window.oldest() != window.next()) &&
+           now_ms < 600000) {
+        uint32_t seqno;
+        while (produced < link_blocks && window.allocate(seqno)) {
+            window.filled(seqno);
+            produced++;
+        }
+        uint8_t sent = 0;
+        while (sent < 8 && window.next_to_send(seqno)) {
+            link.send_block(seqno, now_ms);
+            window.sent(seqno, now_ms);
+            sent++;
+        }
+        if (now_ms % 100 == 0) {
+            bool resent = false;
+            for (seqno = window.oldest(); seqno != window.next(); seqno++) {
+                if (window.timed_out(seqno, now_ms)) {
+                    link.send_block(seqno, now_ms);
+                    window.sent(seqno, now_ms);
+                    resent = true;
+                }
+            }
+            if (resent) {
+                window.backoff(now_ms);
+            }
+        }
+        link.update(window, now_ms);
+        now_ms++;
+    }
+    return now_ms;
+}
+
+TEST(DFMAVLinkWindow, LosslessLink)
+{
+    DFMAVLinkWindow window;
+    ASSERT_TRUE(window.init(128));
+    MockLink link(0);
+
+    const uint32_t time_ms = stream(window, link);
+    EXPECT_TRUE(link.all_received(link_blocks));
+
+    // the round trip is two delays, plus up to a tick each way
+    EXPECT_NEAR(2 * link_delay_ms, window.rtt_ms(), 2);
+    EXPECT_EQ(0U, window.get_counters().resent);
+    EXPECT_EQ(link_blocks, window.get_counters().acked);
+
+    // with nothing lost the window opens up to keep the link full: 32
+    // blocks per round trip would take over 6 seconds
+    EXPECT_LT(time_ms, 2500U);
+}
+
+TEST(DFMAVLinkWindow, LossyLink)
+{
+    DFMAVLinkWindow window;
+    ASSERT_TRUE(window.init(128));
+    MockLink link(10);
+
+    stream(window, link);
+    EXPECT_TRUE(link.all_received(link_blocks));
+    EXPECT_EQ(window.oldest(), window.next());
+    EXPECT_GT(window.get_counters().resent, 0U);
+    EXPECT_GT(window.get_counters().nacked, 0U);
+    EXPECT_NEAR(2 * link_delay_ms, window.rtt_ms(), 5);
+    EXPECT_GE(window.in_flight_limit(), 2);
+}
+
+AP_GTEST_MAIN()
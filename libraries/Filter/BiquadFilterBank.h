@@ -0,0 +1,203 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/// @file   BiquadFilterBank.h
+/// @brief  A bank of second order filters applied to a group of channels at once
+
+#include <AP_Math/AP_Math.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "LowPassFilter2p.h"
+#include "NotchFilter.h"
+
+/*
+  Each of the CHANNELS channels (eg. the axes of several IMUs) runs
+  through STAGES biquad filters in series, eg. a low pass filter
+  followed by notch filters. A stage of a channel that isn't set passes
+  samples through unchanged.
+
+  Coefficients and filter state are kept per stage in arrays indexed by
+  channel, so a sample of every channel is filtered with loops over
+  contiguous floats that the compiler can vectorize. All stages use the
+  direct form II of DigitalBiquadFilter, so a low pass stage gives the
+  same output as LowPassFilter2p.
+ */
+template <uint8_t CHANNELS, uint8_t STAGES>
+class BiquadFilterBank {
+public:
+    BiquadFilterBank();
+
+    // set a stage of a channel to the low pass filter of LowPassFilter2p
+    void set_low_pass(uint8_t stage, uint8_t channel, float sample_freq, float cutoff_freq);
+
+    // set a stage of every channel to the same low pass filter
+    void set_low_pass(uint8_t stage, float sample_freq, float cutoff_freq) {
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            set_low_pass(stage, c, sample_freq, cutoff_freq);
+        }
+    }
+
+    // set a stage of a channel to the notch filter of NotchFilter
+    void set_notch(uint8_t stage, uint8_t channel, float sample_freq, float center_freq_hz, float bandwidth_hz, float attenuation_dB);
+
+    // make a stage of a channel pass samples through unchanged
+    void set_pass_through(uint8_t stage, uint8_t channel);
+
+    // clear the state of all stages of a channel
+    void reset(uint8_t channel);
+
+    // clear the state of all channels
+    void reset();
+
+    // filter one sample of every channel in place. As with
+    // LowPassFilter2p a channel given a nan or inf sample keeps
+    // returning nan until it is reset
+    void apply(float samples[CHANNELS]);
+
+    // filter one sample of every channel, with the channels taken three
+    // at a time from CHANNELS/3 vectors
+    void apply(Vector3f samples[CHANNELS/3]) {
+        static_assert(CHANNELS % 3 == 0, "channels must be a multiple of 3");
+        apply(&samples[0].x);
+    }
+
+private:
+    void set_coefficients(uint8_t stage, uint8_t channel, float b0, float b1, float b2, float a1, float a2);
+
+    struct filter_stage {
+        float a1[CHANNELS];
+        float a2[CHANNELS];
+        float b0[CHANNELS];
+        float b1[CHANNELS];
+        float b2[CHANNELS];
+        float delay_element_1[CHANNELS];
+        float delay_element_2[CHANNELS];
+    } _stages[STAGES];
+
+    // stages from this one on pass every channel through and are skipped
+    uint8_t _num_stages;
+};
+
+static_assert(sizeof(Vector3f) == 3 * sizeof(float), "Vector3f must be three packed floats");
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+BiquadFilterBank<CHANNELS, STAGES>::BiquadFilterBank() :
+    _num_stages(0)
+{
+    for (uint8_t s = 0; s < STAGES; s++) {
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            set_pass_through(s, c);
+        }
+    }
+    reset();
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::set_coefficients(uint8_t stage, uint8_t channel, float b0, float b1, float b2, float a1, float a2)
+{
+    if (stage >= STAGES || channel >= CHANNELS) {
+        return;
+    }
+    struct filter_stage &s = _stages[stage];
+    s.b0[channel] = b0;
+    s.b1[channel] = b1;
+    s.b2[channel] = b2;
+    s.a1[channel] = a1;
+    s.a2[channel] = a2;
+    if (stage >= _num_stages) {
+        _num_stages = stage + 1;
+    }
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::set_low_pass(uint8_t stage, uint8_t channel, float sample_freq, float cutoff_freq)
+{
+    if (is_zero(cutoff_freq) || is_zero(sample_freq)) {
+        // LowPassFilter2p passes samples through when it isn't configured
+        set_pass_through(stage, channel);
+        return;
+    }
+    struct DigitalBiquadFilter<float>::biquad_params params;
+    DigitalBiquadFilter<float>::compute_params(sample_freq, cutoff_freq, params);
+    set_coefficients(stage, channel, params.b0, params.b1, params.b2, params.a1, params.a2);
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::set_notch(uint8_t stage, uint8_t channel, float sample_freq, float center_freq_hz, float bandwidth_hz, float attenuation_dB)
+{
+    // NotchFilter uses direct form I and divides by a0 on each sample,
+    // here the coefficients are normalised once instead
+    struct NotchFilter<float>::notch_params params;
+    NotchFilter<float>::compute_params(sample_freq, center_freq_hz, bandwidth_hz, attenuation_dB, params);
+    set_coefficients(stage, channel,
+                     params.b0 * params.a0_inv,
+                     params.b1 * params.a0_inv,
+                     params.b2 * params.a0_inv,
+                     params.a1 * params.a0_inv,
+                     params.a2 * params.a0_inv);
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::set_pass_through(uint8_t stage, uint8_t channel)
+{
+    if (stage >= STAGES || channel >= CHANNELS) {
+        return;
+    }
+    // not counted as a use of the stage, so trailing unused stages stay skipped
+    struct filter_stage &s = _stages[stage];
+    s.b0[channel] = 1.0f;
+    s.b1[channel] = 0.0f;
+    s.b2[channel] = 0.0f;
+    s.a1[channel] = 0.0f;
+    s.a2[channel] = 0.0f;
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::reset(uint8_t channel)
+{
+    if (channel >= CHANNELS) {
+        return;
+    }
+    for (uint8_t s = 0; s < STAGES; s++) {
+        _stages[s].delay_element_1[channel] = 0.0f;
+        _stages[s].delay_element_2[channel] = 0.0f;
+    }
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::reset()
+{
+    for (uint8_t s = 0; s < STAGES; s++) {
+        memset(_stages[s].delay_element_1, 0, sizeof(_stages[s].delay_element_1));
+        memset(_stages[s].delay_element_2, 0, sizeof(_stages[s].delay_element_2));
+    }
+}
+
+template <uint8_t CHANNELS, uint8_t STAGES>
+void BiquadFilterBank<CHANNELS, STAGES>::apply(float samples[CHANNELS])
+{
+    for (uint8_t s = 0; s < _num_stages; s++) {
+        struct filter_stage &st = _stages[s];
+        // same order of operations as DigitalBiquadFilter::apply()
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            const float delay_element_0 = samples[c] - st.delay_element_1[c] * st.a1[c] - st.delay_element_2[c] * st.a2[c];
+            samples[c] = delay_element_0 * st.b0[c] + st.delay_element_1[c] * st.b1[c] + st.delay_element_2[c] * st.b2[c];
+            st.delay_element_2[c] = st.delay_element_1[c];
+            st.delay_element_1[c] = delay_element_0;
+        }
+    }
+}
@@ -100,3 +100,9 @@ template class LowPassFilter2p<long>;
 template class LowPassFilter2p<float>;
 template class LowPassFilter2p<Vector2f>;
 template class LowPassFilter2p<Vector3f>;
+
+template class DigitalBiquadFilter<int>;
+template class DigitalBiquadFilter<long>;
+template class DigitalBiquadFilter<float>;
+template class DigitalBiquadFilter<Vector2f>;
+template class DigitalBiquadFilter<Vector3f>;
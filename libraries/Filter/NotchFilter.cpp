@@ -20,19 +20,35 @@
  */
 template <class T>
 void NotchFilter<T>::init(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB)
+{
+    struct notch_params params;
+    compute_params(sample_freq_hz, center_freq_hz, bandwidth_hz, attenuation_dB, params);
+    b0 = params.b0;
+    b1 = params.b1;
+    b2 = params.b2;
+    a0_inv = params.a0_inv;
+    a1 = params.a1;
+    a2 = params.a2;
+    initialised = true;
+}
+
+/*
+  calculate filter coefficients
+ */
+template <class T>
+void NotchFilter<T>::compute_params(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB, struct notch_params &ret)
 {
     float omega = 2.0 * M_PI * center_freq_hz / sample_freq_hz;
     float octaves = log2f(center_freq_hz  / (center_freq_hz - bandwidth_hz/2)) * 2;
     float A = powf(10, -attenuation_dB/40);
     float Q = sqrtf(powf(2, octaves)) / (powf(2,octaves) - 1);
     float alpha = sinf(omega) / (2 * Q/A);
-    b0 =  1.0 + alpha*A;
-    b1 = -2.0 * cosf(omega);
-    b2 =  1.0 - alpha*A;
-    a0_inv =  1.0/(1.0 + alpha/A);
-    a1 = -2.0 * cosf(omega);
-    a2 =  1.0 - alpha/A;
-    initialised = true;
+    ret.b0 =  1.0 + alpha*A;
+    ret.b1 = -2.0 * cosf(omega);
+    ret.b2 =  1.0 - alpha*A;
+    ret.a0_inv =  1.0/(1.0 + alpha/A);
+    ret.a1 = -2.0 * cosf(omega);
+    ret.a2 =  1.0 - alpha/A;
 }
 
 /*
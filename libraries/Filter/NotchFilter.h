@@ -29,9 +29,14 @@
 template <class T>
 class NotchFilter {
 public:
+    struct notch_params {
+        float b0, b1, b2, a1, a2, a0_inv;
+    };
+
     // set parameters
     void init(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB);
     T apply(const T &sample);
+    static void compute_params(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB, struct notch_params &ret);
 
 private:
     bool initialised;
@@ -0,0 +1,59 @@
+#include <AP_gbenchmark.h>
+
+#include <Filter/BiquadFilterBank.h>
+#include <Filter/LowPassFilter2p.h>
+#include <Filter/NotchFilter.h>
+
+#define SAMPLE_RATE 8000.0f
+#define NUM_INSTANCES 3
+
+/*
+ * Filter one sample of each axis of three IMUs through a low pass filter
+ * followed by a notch
+ */
+static void BM_FilterVector3f(benchmark::State& state)
+{
+    LowPassFilter2pVector3f low_pass[NUM_INSTANCES];
+    NotchFilterVector3f notch[NUM_INSTANCES];
+    Vector3f samples[NUM_INSTANCES];
+
+    for (uint8_t n = 0; n < NUM_INSTANCES; n++) {
+        low_pass[n].set_cutoff_frequency(SAMPLE_RATE, 256.0f);
+        notch[n].init(SAMPLE_RATE, 180.0f, 40.0f, 20.0f);
+        samples[n] = Vector3f(0.1f * n, 0.2f, 0.3f);
+    }
+
+    while (state.KeepRunning()) {
+        Vector3f filtered[NUM_INSTANCES];
+        for (uint8_t n = 0; n < NUM_INSTANCES; n++) {
+            filtered[n] = notch[n].apply(low_pass[n].apply(samples[n]));
+        }
+        gbenchmark_escape(filtered);
+    }
+}
+
+static void BM_FilterBank(benchmark::State& state)
+{
+    BiquadFilterBank<3 * NUM_INSTANCES, 2> bank;
+    Vector3f samples[NUM_INSTANCES];
+
+    for (uint8_t c = 0; c < 3 * NUM_INSTANCES; c++) {
+        bank.set_low_pass(0, c, SAMPLE_RATE, 256.0f);
+        bank.set_notch(1, c, SAMPLE_RATE, 180.0f, 40.0f, 20.0f);
+    }
+    for (uint8_t n = 0; n < NUM_INSTANCES; n++) {
+        samples[n] = Vector3f(0.1f * n, 0.2f, 0.3f);
+    }
+
+    while (state.KeepRunning()) {
+        Vector3f filtered[NUM_INSTANCES];
+        memcpy(filtered, samples, sizeof(filtered));
+        bank.apply(filtered);
+        gbenchmark_escape(filtered);
+    }
+}
+
+BENCHMARK(BM_FilterVector3f);
+BENCHMARK(BM_FilterBank);
+
+BENCHMARK_MAIN()
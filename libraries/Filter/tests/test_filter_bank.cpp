@@ -0,0 +1,151 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <Filter/BiquadFilterBank.h>
+#include <Filter/LowPassFilter2p.h>
+#include <Filter/NotchFilter.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#define SAMPLE_RATE 8000.0f
+#define NUM_INSTANCES 3
+
+/*
+ * Sum of a slow and a fast sine with some offset per channel, so each
+ * channel sees different input
+ */
+static float test_signal(uint16_t i, uint8_t channel)
+{
+    const float t = i / SAMPLE_RATE;
+    return 0.3f * channel + sinf(2 * M_PI * 7.0f * t + channel) +
+        0.5f * sinf(2 * M_PI * 180.0f * t + 2.0f * channel);
+}
+
+TEST(BiquadFilterBank, LowPassMatchesLowPassFilter2p)
+{
+    BiquadFilterBank<3 * NUM_INSTANCES, 1> bank;
+    LowPassFilter2pVector3f filters[NUM_INSTANCES];
+    const float cutoff[NUM_INSTANCES] = { 20.0f, 80.0f, 256.0f };
+
+    for (uint8_t n = 0; n < NUM_INSTANCES; n++) {
+        filters[n].set_cutoff_frequency(SAMPLE_RATE, cutoff[n]);
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            bank.set_low_pass(0, 3 * n + axis, SAMPLE_RATE, cutoff[n]);
+        }
+    }
+
+    for (uint16_t i = 0; i < 4000; i++) {
+        Vector3f samples[NUM_INSTANCES];
+        for (uint8_t n = 0; n < NUM_INSTANCES; n++) {
+            samples[n] = Vector3f(test_signal(i, 3 * n), test_signal(i, 3 * n + 1), test_signal(i, 3 * n + 2));
+        }
+        Vector3f expected[NUM_INSTANCES];
+        for (uint8_t n = 0; n < NUM_INSTANCES; n++) {
+            expected[n] = filters[n].apply(samples[n]);
+        }
+        bank.apply(samples);
+        for (uint8_t n = 0; n < NUM_INSTANCES; n++) {
+            ASSERT_FLOAT_EQ(expected[n].x, samples[n].x);
+            ASSERT_FLOAT_EQ(expected[n].y, samples[n].y);
+            ASSERT_FLOAT_EQ(expected[n].z, samples[n].z);
+        }
+    }
+}
+
+TEST(BiquadFilterBank, LowPassThenNotch)
+{
+    BiquadFilterBank<3 * NUM_INSTANCES, 2> bank;
+    LowPassFilter2pVector3f low_pass[NUM_INSTANCES];
+    NotchFilterVector3f notch[NUM_INSTANCES];
+
+    for (uint8_t n = 0; n < NUM_INSTANCES; n++) {
+        low_pass[n].set_cutoff_frequency(SAMPLE_RATE, 256.0f);
+        notch[n].init(SAMPLE_RATE, 180.0f, 40.0f, 20.0f);
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            bank.set_low_pass(0, 3 * n + axis, SAMPLE_RATE, 256.0f);
+            bank.set_notch(1, 3 * n + axis, SAMPLE_RATE, 180.0f, 40.0f, 20.0f);
+        }
+    }
+
+    // the notch is in direct form II here, so allow for rounding
+    // differences against the direct form I of NotchFilter
+    for (uint16_t i = 0; i < 4000; i++) {
+        Vector3f samples[NUM_INSTANCES];
+        for (uint8_t n = 0; n < NUM_INSTANCES; n++) {
+            samples[n] = Vector3f(test_signal(i, 3 * n), test_signal(i, 3 * n + 1), test_signal(i, 3 * n + 2));
+        }
+        Vector3f expected[NUM_INSTANCES];
+        for (uint8_t n = 0; n < NUM_INSTANCES; n++) {
+            expected[n] = notch[n].apply(low_pass[n].apply(samples[n]));
+        }
+        bank.apply(samples);
+        for (uint8_t n = 0; n < NUM_INSTANCES; n++) {
+            ASSERT_NEAR(expected[n].x, samples[n].x, 1e-4f);
+            ASSERT_NEAR(expected[n].y, samples[n].y, 1e-4f);
+            ASSERT_NEAR(expected[n].z, samples[n].z, 1e-4f);
+        }
+    }
+}
+
+TEST(BiquadFilterBank, PassThrough)
+{
+    BiquadFilterBank<4, 2> bank;
+    float samples[4];
+
+    // nothing set
+    for (uint8_t c = 0; c < 4; c++) {
+        samples[c] = test_signal(1, c);
+    }
+    bank.apply(samples);
+    for (uint8_t c = 0; c < 4; c++) {
+        EXPECT_EQ(test_signal(1, c), samples[c]);
+    }
+
+    // a zero cutoff passes through like LowPassFilter2p, other channels
+    // of the same stage are filtered
+    bank.set_low_pass(1, 0, SAMPLE_RATE, 0.0f);
+    bank.set_low_pass(1, 1, SAMPLE_RATE, 20.0f);
+    bank.set_notch(0, 2, SAMPLE_RATE, 180.0f, 40.0f, 20.0f);
+    for (uint16_t i = 0; i < 100; i++) {
+        for (uint8_t c = 0; c < 4; c++) {
+            samples[c] = test_signal(i, c);
+        }
+        bank.apply(samples);
+        EXPECT_EQ(test_signal(i, 0), samples[0]);
+        EXPECT_EQ(test_signal(i, 3), samples[3]);
+    }
+    EXPECT_NE(test_signal(99, 1), samples[1]);
+    EXPECT_NE(test_signal(99, 2), samples[2]);
+}
+
+TEST(BiquadFilterBank, Reset)
+{
+    BiquadFilterBank<2, 1> bank;
+    bank.set_low_pass(0, 0, SAMPLE_RATE, 20.0f);
+    bank.set_low_pass(0, 1, SAMPLE_RATE, 20.0f);
+
+    float samples[2];
+    for (uint16_t i = 0; i < 100; i++) {
+        samples[0] = 1.0f;
+        samples[1] = 1.0f;
+        bank.apply(samples);
+    }
+
+    // a nan sample only affects its own channel, until it's reset
+    samples[0] = NAN;
+    samples[1] = 1.0f;
+    bank.apply(samples);
+    EXPECT_TRUE(isnan(samples[0]));
+    EXPECT_FALSE(isnan(samples[1]));
+
+    bank.reset(0);
+    LowPassFilter2pFloat filter(SAMPLE_RATE, 20.0f);
+    for (uint16_t i = 0; i < 100; i++) {
+        samples[0] = test_signal(i, 0);
+        samples[1] = 1.0f;
+        bank.apply(samples);
+        EXPECT_FLOAT_EQ(filter.apply(test_signal(i, 0)), samples[0]);
+    }
+}
+
+AP_GTEST_MAIN()
@@ -22,6 +22,10 @@
 #define CHECK_PAYLOAD_SIZE(id) if (comm_get_txspace(chan) < packet_overhead()+MAVLINK_MSG_ID_ ## id ## _LEN) return false
 #define CHECK_PAYLOAD_SIZE2(id) if (!HAVE_PAYLOAD_SPACE(chan, id)) return false
 
+// DATA96 types for reading perf counters, see GCS_Perf.cpp
+#define GCS_PERF_REQUEST_TYPE   44
+#define GCS_PERF_REPLY_TYPE     45
+
 //  GCS Message ID's
 /// NOTE: to ensure we never block on sending MAVLink messages
 /// please keep each MSG_ to a single MAVLink message. If need be
@@ -73,6 +77,7 @@ enum ap_message {
     MSG_BATTERY_STATUS,
     MSG_AOA_SSA,
     MSG_LANDING,
+    MSG_LATENCY,
     MSG_RETRY_DEFERRED // this must be last
 };
 
@@ -161,6 +166,9 @@ public:
     void send_autopilot_version(uint8_t major_version, uint8_t minor_version, uint8_t patch_version, uint8_t version_type) const;
     void send_local_position(const AP_AHRS &ahrs) const;
     void send_vibration(const AP_InertialSensor &ins) const;
+    // send the latency of one stage of the control loop, a different
+    // stage on each call. Returns false if there wasn't room
+    bool send_latency(const LatencyTrace &trace);
     void send_home(const Location &home) const;
     static void send_home_all(const Location &home);
     void send_heartbeat(uint8_t type, uint8_t base_mode, uint32_t custom_mode, uint8_t system_status);
@@ -270,6 +278,7 @@ protected:
     void handle_timesync(mavlink_message_t *msg);
 
     void handle_data_packet(mavlink_message_t *msg);
+    void handle_perf_request(const mavlink_data96_t &m);
     
 private:
 
@@ -293,6 +302,11 @@ private:
                                                          // queued send
     uint32_t                    _queued_parameter_send_time_ms;
 
+    // perf counters requested over DATA96 and not yet sent
+    uint16_t                    _queued_perf_index;
+    uint16_t                    _queued_perf_end;
+    void                        queued_perf_send(void);
+
     /// Count the number of reportable parameters.
     ///
     /// Not all parameters can be reported via MAVlink.  We count the number
@@ -362,6 +376,9 @@ private:
     uint8_t next_deferred_message;
     uint8_t num_deferred_messages;
 
+    // stage send_latency() reports next
+    uint8_t latency_stage;
+
     // time when we missed sending a parameter for GCS
     static uint32_t reserve_param_space_start_ms;
     
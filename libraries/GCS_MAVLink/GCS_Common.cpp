@@ -292,8 +292,7 @@ void GCS_MAVLINK::send_ahrs2(AP_AHRS &ahrs)
     AP_AHRS_NavEKF &_ahrs = reinterpret_cast<AP_AHRS_NavEKF&>(ahrs);
     if (_ahrs.get_NavEKF2().activeCores() > 0 &&
         HAVE_PAYLOAD_SPACE(chan, AHRS3)) {
-        _ahrs.get_NavEKF2().getLLH(loc);
-        _ahrs.get_NavEKF2().getEulerAngles(-1,euler);
+        _ahrs.get_NavEKF2_attitude_position(euler, loc);
         mavlink_msg_ahrs3_send(chan,
                                euler.x,
                                euler.y,
@@ -820,39 +819,69 @@ GCS_MAVLINK::update(run_cli_fn run_cli, uint32_t max_time_us)
 
     status.packet_rx_drop_count = 0;
 
-    // process received bytes
+    // process received bytes. Where the port exposes its receive
+    // buffer the bytes are parsed in place, and consumed before acting
+    // on them as the CLI and packet handlers may use the port themselves
     uint16_t nbytes = comm_get_available(chan);
-    for (uint16_t i=0; i<nbytes; i++)
-    {
-        uint8_t c = comm_receive_ch(chan);
-
-        if (run_cli) {
-            /* allow CLI to be started by hitting enter 3 times, if no
-             *  heartbeat packets have been received */
-            if ((mavlink_active==0) && (AP_HAL::millis() - _cli_timeout) < 20000 && 
-                comm_is_idle(chan)) {
-                if (c == '\n' || c == '\r') {
-                    crlf_count++;
-                } else {
-                    crlf_count = 0;
-                }
-                if (crlf_count == 3) {
-                    run_cli(_port);
+    uint16_t i = 0;
+    bool try_peek = true;
+    while (i < nbytes) {
+        uint8_t rx_byte;
+        uint32_t len = 0;
+        const uint8_t *span = try_peek ? _port->peek_span(len) : nullptr;
+        const bool peeked = (span != nullptr);
+        if (!peeked) {
+            // ports without peek_span() are read a byte at a time, so
+            // don't ask again for each byte
+            try_peek = false;
+            rx_byte = comm_receive_ch(chan);
+            span = &rx_byte;
+            len = 1;
+        }
+        if (len > (uint32_t)(nbytes - i)) {
+            len = nbytes - i;
+        }
+
+        bool start_cli = false;
+        bool parsed_packet = false;
+        uint32_t n = 0;
+        while (n < len && !start_cli && !parsed_packet) {
+            uint8_t c = span[n++];
+
+            if (run_cli) {
+                /* allow CLI to be started by hitting enter 3 times, if no
+                 *  heartbeat packets have been received */
+                if ((mavlink_active==0) && (AP_HAL::millis() - _cli_timeout) < 20000 && 
+                    comm_is_idle(chan)) {
+                    if (c == '\n' || c == '\r') {
+                        crlf_count++;
+                    } else {
+                        crlf_count = 0;
+                    }
+                    start_cli = (crlf_count == 3);
                 }
             }
+
+            // Try to get a new message
+            parsed_packet = mavlink_parse_char(chan, c, &msg, &status);
         }
 
-        bool parsed_packet = false;
-        
-        // Try to get a new message
-        if (mavlink_parse_char(chan, c, &msg, &status)) {
+        if (peeked) {
+            _port->consume(n);
+        }
+        i += n;
+
+        if (start_cli) {
+            run_cli(_port);
+        }
+
+        if (parsed_packet) {
             hal.util->perf_begin(_perf_packet);
             packetReceived(status, msg);
             hal.util->perf_end(_perf_packet);
-            parsed_packet = true;
         }
 
-        if (parsed_packet || i % 100 == 0) {
+        if (peeked || parsed_packet || i % 100 == 0) {
             // make sure we don't spend too much time parsing mavlink messages
             if (AP_HAL::micros() - tstart_us > max_time_us) {
                 break;
@@ -860,6 +889,8 @@ GCS_MAVLINK::update(run_cli_fn run_cli, uint32_t max_time_us)
         }
     }
 
+    queued_perf_send();
+
     if (!waypoint_receiving) {
         hal.util->perf_end(_perf_update);    
         return;
@@ -1448,6 +1479,38 @@ void GCS_MAVLINK::send_vibration(const AP_InertialSensor &ins) const
         ins.get_accel_clip_count(2));
 }
 
+/*
+  send the median and 99th percentile latency of a stage as a pair of
+  NAMED_VALUE_FLOATs named LAT_<stage>50 and LAT_<stage>99, in
+  microseconds. Stages which saw no samples in the last period are
+  skipped
+ */
+bool GCS_MAVLINK::send_latency(const LatencyTrace &trace)
+{
+    if (comm_get_txspace(chan) < 2 * (packet_overhead() + MAVLINK_MSG_ID_NAMED_VALUE_FLOAT_LEN)) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < LatencyTrace::STAGE_COUNT; i++) {
+        const enum LatencyTrace::trace_stage stage = (enum LatencyTrace::trace_stage)latency_stage;
+        latency_stage = (latency_stage + 1) % LatencyTrace::STAGE_COUNT;
+
+        const PerfHistogram &hist = trace.get_histogram(stage);
+        if (hist.count() == 0) {
+            continue;
+        }
+
+        const uint32_t now = AP_HAL::millis();
+        char name[MAVLINK_MSG_NAMED_VALUE_FLOAT_FIELD_NAME_LEN+1];
+        hal.util->snprintf(name, sizeof(name), "LAT_%s50", LatencyTrace::stage_name(stage));
+        mavlink_msg_named_value_float_send(chan, now, name, hist.percentile(50));
+        hal.util->snprintf(name, sizeof(name), "LAT_%s99", LatencyTrace::stage_name(stage));
+        mavlink_msg_named_value_float_send(chan, now, name, hist.percentile(99));
+        break;
+    }
+    return true;
+}
+
 void GCS_MAVLINK::send_home(const Location &home) const
 {
     if (HAVE_PAYLOAD_SPACE(chan, HOME_POSITION)) {
@@ -1681,10 +1744,10 @@ void GCS_MAVLINK::handle_timesync(mavlink_message_t *msg)
  */
 void GCS_MAVLINK::handle_data_packet(mavlink_message_t *msg)
 {
-#ifdef HAL_RCINPUT_WITH_AP_RADIO
     mavlink_data96_t m;
     mavlink_msg_data96_decode(msg, &m);
     switch (m.type) {
+#ifdef HAL_RCINPUT_WITH_AP_RADIO
     case 42:
     case 43: {
         // pass to AP_Radio (for firmware upload and playing test tunes)
@@ -1694,11 +1757,14 @@ void GCS_MAVLINK::handle_data_packet(mavlink_message_t *msg)
         }
         break;
     }
+#endif
+    case GCS_PERF_REQUEST_TYPE:
+        handle_perf_request(m);
+        break;
     default:
         // unknown
         break;
     }
-#endif
 }
 
 
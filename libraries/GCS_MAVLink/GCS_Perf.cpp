@@ -0,0 +1,90 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  read the HAL's perf counters over MAVLink
+
+  A DATA96 of type GCS_PERF_REQUEST_TYPE asks for the counters from the
+  index in its first two bytes, little endian, to the last. Each is
+  sent back as a DATA96 of type GCS_PERF_REPLY_TYPE holding a
+  perf_reply, as fast as the link has room for them.
+ */
+#include <AP_HAL/AP_HAL.h>
+#include "GCS.h"
+#include <string.h>
+
+extern const AP_HAL::HAL& hal;
+
+struct PACKED perf_reply {
+    uint16_t index;
+    uint16_t num_counters;
+    uint8_t type;
+    char name[16];
+    // totals since boot, see AP_HAL::Util::perf_info
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    float avg_us;
+    uint32_t buckets[HAL_PERF_BUCKETS];
+    // events the HAL had no room to count, over all counters
+    uint32_t dropped;
+};
+
+static_assert(sizeof(perf_reply) <= sizeof(mavlink_data96_t::data), "perf_reply must fit in DATA96");
+
+/*
+  handle a request for perf counters
+ */
+void GCS_MAVLINK::handle_perf_request(const mavlink_data96_t &m)
+{
+    if (m.len < 2) {
+        return;
+    }
+    // a new request replaces any still being sent
+    _queued_perf_index = m.data[0] | (m.data[1] << 8);
+    _queued_perf_end = hal.util->perf_num_counters();
+}
+
+/*
+  send requested perf counters while there is room on the link
+ */
+void GCS_MAVLINK::queued_perf_send(void)
+{
+    while (_queued_perf_index < _queued_perf_end &&
+           HAVE_PAYLOAD_SPACE(chan, DATA96)) {
+        const uint16_t index = _queued_perf_index++;
+        AP_HAL::Util::perf_info info;
+        if (!hal.util->perf_get_info(index, info)) {
+            continue;
+        }
+
+        struct perf_reply reply {};
+        reply.index = index;
+        reply.num_counters = _queued_perf_end;
+        reply.type = (uint8_t)info.type;
+        strncpy(reply.name, info.name, sizeof(reply.name));
+        reply.count = info.count;
+        reply.min_us = info.hist.min_us();
+        reply.max_us = info.hist.max_us();
+        reply.avg_us = info.count ? (info.total_ns * 1.0e-3f) / info.count : 0.0f;
+        for (uint8_t b = 0; b < HAL_PERF_BUCKETS; b++) {
+            reply.buckets[b] = info.hist.bucket_count(b);
+        }
+        reply.dropped = hal.util->perf_dropped();
+
+        uint8_t data[sizeof(mavlink_data96_t::data)] {};
+        memcpy(data, &reply, sizeof(reply));
+        mavlink_msg_data96_send(chan, GCS_PERF_REPLY_TYPE, sizeof(reply), data);
+    }
+}
@@ -0,0 +1,107 @@
+#include <AP_gbenchmark.h>
+
+#include <string.h>
+#include <vector>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/RingBuffer.h>
+#include <GCS_MAVLink/GCS_MAVLink.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+ * one second of telemetry at 1.5Mbaud, 8N1
+ */
+#define MAVLINK_PARSE_BAUD 1500000U
+#define MAVLINK_PARSE_STREAM_SIZE (MAVLINK_PARSE_BAUD / 10)
+#define MAVLINK_PARSE_RXSPACE 4096
+
+static std::vector<uint8_t> mavlink_stream()
+{
+    std::vector<uint8_t> stream;
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    uint8_t rtcm[180];
+    mavlink_message_t msg;
+    uint32_t t = 0;
+
+    for (uint16_t i = 0; i < sizeof(rtcm); i++) {
+        rtcm[i] = i * 7;
+    }
+
+    while (stream.size() < MAVLINK_PARSE_STREAM_SIZE) {
+        uint16_t len;
+
+        mavlink_msg_heartbeat_pack(1, 1, &msg, MAV_TYPE_QUADROTOR,
+                                   MAV_AUTOPILOT_ARDUPILOTMEGA, 0, 0, 0);
+        len = mavlink_msg_to_send_buffer(buf, &msg);
+        stream.insert(stream.end(), buf, buf + len);
+
+        mavlink_msg_attitude_pack(1, 1, &msg, t, 0.1f, -0.2f, 1.5f,
+                                  0.01f, 0.02f, -0.03f);
+        len = mavlink_msg_to_send_buffer(buf, &msg);
+        stream.insert(stream.end(), buf, buf + len);
+
+        mavlink_msg_global_position_int_pack(1, 1, &msg, t, -353632610,
+                                             1491652440, 584000, 10000,
+                                             120, -45, 3, 9000);
+        len = mavlink_msg_to_send_buffer(buf, &msg);
+        stream.insert(stream.end(), buf, buf + len);
+
+        mavlink_msg_gps_rtcm_data_pack(255, 190, &msg, 0, sizeof(rtcm), rtcm);
+        len = mavlink_msg_to_send_buffer(buf, &msg);
+        stream.insert(stream.end(), buf, buf + len);
+
+        t += 10;
+    }
+
+    return stream;
+}
+
+/*
+ * Push one second of 1.5Mbaud telemetry through a UART sized receive
+ * buffer and parse it, either one read_byte() at a time as with
+ * UARTDriver::read() or in place through readptr()/advance() as with
+ * UARTDriver::peek_span()/consume().
+ */
+static void BM_MAVLinkParse(benchmark::State &state)
+{
+    const std::vector<uint8_t> stream = mavlink_stream();
+    const bool span = state.range_x();
+    ByteBuffer rxbuf(MAVLINK_PARSE_RXSPACE);
+    mavlink_message_t msg;
+    mavlink_status_t status;
+    uint32_t packets = 0;
+
+    while (state.KeepRunning()) {
+        uint32_t pos = 0;
+
+        while (pos < stream.size()) {
+            pos += rxbuf.write(&stream[pos], stream.size() - pos);
+
+            if (span) {
+                uint32_t len;
+                const uint8_t *p;
+                while ((p = rxbuf.readptr(len)) != nullptr) {
+                    for (uint32_t i = 0; i < len; i++) {
+                        packets += mavlink_parse_char(MAVLINK_COMM_0, p[i],
+                                                      &msg, &status);
+                    }
+                    rxbuf.advance(len);
+                }
+            } else {
+                uint8_t c;
+                while (rxbuf.read_byte(&c)) {
+                    packets += mavlink_parse_char(MAVLINK_COMM_0, c,
+                                                  &msg, &status);
+                }
+            }
+        }
+    }
+
+    gbenchmark_escape(&packets);
+    state.SetBytesProcessed(int64_t(state.iterations()) * stream.size());
+}
+
+BENCHMARK(BM_MAVLinkParse)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN()
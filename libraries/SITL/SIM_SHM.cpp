@@ -0,0 +1,212 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  simulator connection over shared memory, in lockstep with an
+  external simulator
+*/
+
+#include "SIM_SHM.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+extern const AP_HAL::HAL& hal;
+
+namespace SITL {
+
+SHM::SHM(const char *home_str, const char *frame_str) :
+    Aircraft(home_str, frame_str),
+    shm_name(nullptr),
+    hdr(nullptr),
+    shm_frame(0),
+    first_timestamp(0),
+    last_timestamp(0),
+    start_time_us(0),
+    last_wait_message_us(0)
+{
+    // the simulator sets the pace, there is nothing to sync to
+    use_time_sync = false;
+
+    const char *colon = strchr(frame_str, ':');
+    if (colon) {
+        shm_name = colon+1;
+    }
+}
+
+/*
+  create the shared memory object, or take over the one left by an
+  earlier run so that a simulator still attached to it carries on
+ */
+bool SHM::open_shm()
+{
+    char name[32];
+    if (shm_name == nullptr) {
+        // instance is only known once the model is running
+        snprintf(name, sizeof(name), SIM_SHM_NAME_FORMAT, (unsigned)instance);
+        shm_name = strdup(name);
+    }
+
+    int fd = shm_open(shm_name, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        fprintf(stderr, "SHM: shm_open(%s) failed: %s\n", shm_name, strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, sizeof(struct sim_shm_header)) == -1) {
+        fprintf(stderr, "SHM: ftruncate(%s) failed: %s\n", shm_name, strerror(errno));
+        close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, sizeof(struct sim_shm_header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        fprintf(stderr, "SHM: mmap(%s) failed: %s\n", shm_name, strerror(errno));
+        return false;
+    }
+
+    hdr = (struct sim_shm_header *)p;
+    __atomic_store_n(&hdr->magic, 0, __ATOMIC_RELAXED);
+    memset(&hdr->servos, 0, sizeof(hdr->servos));
+    memset(&hdr->fdm, 0, sizeof(hdr->fdm));
+    hdr->version = SIM_SHM_VERSION;
+    hdr->total_size = sizeof(struct sim_shm_header);
+    __atomic_store_n(&hdr->fdm_seq, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&hdr->servo_seq, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&hdr->magic, SIM_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    printf("SHM: Exchanging servos and FDM with simulator on %s\n", shm_name);
+    return true;
+}
+
+/*
+  write the servos of the next frame and hand the turn to the simulator
+*/
+void SHM::send_servos(const struct sitl_input &input)
+{
+    struct sim_shm_servos &servos = hdr->servos;
+
+    shm_frame++;
+    servos.frame = shm_frame;
+    for (uint8_t i = 0; i < SIM_SHM_NUM_SERVOS; i++) {
+        servos.pwm[i] = input.servos[i];
+    }
+    servos.wind_speed = input.wind.speed;
+    servos.wind_direction = input.wind.direction;
+    servos.wind_turbulence = input.wind.turbulence;
+
+    sim_shm_post(&hdr->servo_seq, (uint32_t)shm_frame);
+}
+
+/*
+  wait for the simulator to step with the servos of this frame
+  This is a blocking function
+ */
+void SHM::recv_fdm(const struct sitl_input &input)
+{
+    uint32_t seq = __atomic_load_n(&hdr->fdm_seq, __ATOMIC_ACQUIRE);
+    while (seq != (uint32_t)shm_frame) {
+        const uint32_t last_seq = seq;
+        seq = sim_shm_wait(&hdr->fdm_seq, last_seq, SHM_WAIT_MS);
+        if (seq == last_seq) {
+            const uint64_t now_us = get_wall_time_us();
+            if (now_us - last_wait_message_us > SHM_WAIT_MESSAGE_US) {
+                printf("SHM: Waiting for simulator on %s\n", shm_name);
+                last_wait_message_us = now_us;
+            }
+        }
+    }
+
+    const struct sim_shm_fdm &fdm = hdr->fdm;
+
+    if (shm_frame == 1) {
+        first_timestamp = fdm.timestamp;
+        last_timestamp = fdm.timestamp;
+        start_time_us = time_now_us;
+    }
+    const double deltat = fdm.timestamp - last_timestamp;  // in seconds
+    if (deltat < 0) {
+        // simulator went back in time, don't use the state
+        time_now_us += 1;
+        return;
+    }
+
+    accel_body = Vector3f(static_cast<float>(fdm.accel[0]),
+                          static_cast<float>(fdm.accel[1]),
+                          static_cast<float>(fdm.accel[2]));
+
+    gyro = Vector3f(static_cast<float>(fdm.gyro[0]),
+                    static_cast<float>(fdm.gyro[1]),
+                    static_cast<float>(fdm.gyro[2]));
+
+    Quaternion quat(static_cast<float>(fdm.quaternion[0]),
+                    static_cast<float>(fdm.quaternion[1]),
+                    static_cast<float>(fdm.quaternion[2]),
+                    static_cast<float>(fdm.quaternion[3]));
+    quat.rotation_matrix(dcm);
+
+    velocity_ef = Vector3f(static_cast<float>(fdm.velocity[0]),
+                           static_cast<float>(fdm.velocity[1]),
+                           static_cast<float>(fdm.velocity[2]));
+
+    position = Vector3f(static_cast<float>(fdm.position[0]),
+                        static_cast<float>(fdm.position[1]),
+                        static_cast<float>(fdm.position[2]));
+
+    // velocity relative to air mass, as Aircraft::update_dynamics() does
+    update_wind(input);
+    velocity_air_ef = velocity_ef + wind_ef;
+    velocity_air_bf = dcm.transposed() * velocity_air_ef;
+    if (fdm.airspeed >= 0) {
+        airspeed = static_cast<float>(fdm.airspeed);
+        airspeed_pitot = airspeed;
+    } else {
+        airspeed = velocity_air_ef.length();
+        airspeed_pitot = constrain_float(velocity_air_bf.x, 0.0f, 120.0f);
+    }
+
+    // time from the start rather than summed frame times, which would
+    // drift by the rounding of each at kHz frame rates
+    const uint64_t new_time_us = start_time_us + llround((fdm.timestamp - first_timestamp) * 1.0e6);
+    time_now_us = MAX(new_time_us, time_now_us + 1);
+    if (deltat > 0) {
+        adjust_frame_time(static_cast<float>(1.0/deltat));
+    }
+    last_timestamp = fdm.timestamp;
+}
+
+/*
+  update the simulation by one time step
+ */
+void SHM::update(const struct sitl_input &input)
+{
+    if (hdr == nullptr && !open_shm()) {
+        fprintf(stderr, "Aborting launch...\n");
+        exit(1);
+    }
+
+    send_servos(input);
+    recv_fdm(input);
+    update_position();
+
+    time_advance();
+    // update magnetic field
+    update_mag_field_bf();
+}
+
+}  // namespace SITL
@@ -0,0 +1,62 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  simulator connection over shared memory, in lockstep with an
+  external simulator. See SIM_SHM_Interface.h for the protocol
+*/
+
+#pragma once
+
+#include "SIM_Aircraft.h"
+#include "SIM_SHM_Interface.h"
+
+namespace SITL {
+
+/*
+  external simulator on shared memory
+ */
+class SHM : public Aircraft {
+public:
+    SHM(const char *home_str, const char *frame_str);
+
+    /* update model by one time step */
+    void update(const struct sitl_input &input);
+
+    /* static object creator */
+    static Aircraft *create(const char *home_str, const char *frame_str) {
+        return new SHM(home_str, frame_str);
+    }
+
+private:
+    bool open_shm();
+    void send_servos(const struct sitl_input &input);
+    void recv_fdm(const struct sitl_input &input);
+
+    // name given with the model as shm:NAME, if any
+    const char *shm_name;
+
+    struct sim_shm_header *hdr;
+    // frame number of the last servos sent
+    uint64_t shm_frame;
+    double first_timestamp;
+    double last_timestamp;
+    uint64_t start_time_us;
+    uint64_t last_wait_message_us;
+
+    static const uint32_t SHM_WAIT_MS = 100;
+    static const uint64_t SHM_WAIT_MESSAGE_US = 5000000;
+};
+
+}  // namespace SITL
@@ -0,0 +1,174 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  layout of the shared memory exchange between SITL and an external
+  simulator, used by the "shm" model
+
+  SITL creates a POSIX shared memory object holding one set of servo
+  outputs and one FDM state, and the two sides take turns:
+
+   - SITL writes the servos for frame n and sets servo_seq to n
+   - the simulator steps its physics with those servos, writes the
+     resulting state for frame n and sets fdm_seq to n
+   - SITL waits for fdm_seq to become n before it moves on
+
+  so the simulator runs in lockstep with SITL at whatever rate its
+  physics needs, with no sockets and no packets to lose. On Linux each
+  side sleeps on a futex in the shared object while the other has its
+  turn; elsewhere it polls.
+
+  Frame numbers start from 1 each time SITL starts, so a simulator
+  can stay attached across restarts of SITL by resetting whenever it
+  sees frame 1.
+
+  This header doesn't depend on other headers inside ArduPilot, so it
+  can be used to build simulators outside of it
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+// "APSM" in memory
+#define SIM_SHM_MAGIC 0x4d535041
+#define SIM_SHM_VERSION 1
+
+// name passed to shm_open() by SITL instance n when no other is given
+#define SIM_SHM_NAME_FORMAT "/ardupilot_sim_%u"
+
+#define SIM_SHM_NUM_SERVOS 16
+
+// times a waiting side checks for the other side's turn to end before
+// it goes to sleep. At kHz frame rates a turn is often shorter than a
+// trip through the scheduler
+#define SIM_SHM_SPIN_COUNT 2000
+
+// outputs of SITL for one frame
+struct sim_shm_servos {
+    // frame number, counting up from 1
+    uint64_t frame;
+
+    // servo outputs as PWM in microseconds
+    uint16_t pwm[SIM_SHM_NUM_SERVOS];
+
+    // wind from the SIM_WIND_* parameters
+    float wind_speed;       // m/s
+    float wind_direction;   // degrees 0..360
+    float wind_turbulence;
+
+    uint32_t reserved;
+};
+
+// state of the simulated vehicle after a frame
+struct sim_shm_fdm {
+    // frame of the servos this state was computed with
+    uint64_t frame;
+
+    // simulation time in seconds, increasing each frame
+    double timestamp;
+
+    // body frame rates in rad/s and specific force in m/s/s, as an IMU
+    // would measure them
+    double gyro[3];
+    double accel[3];
+
+    // rotation from body to NED earth frame, w x y z
+    double quaternion[4];
+
+    // m/s in NED and metres NED from the home location
+    double velocity[3];
+    double position[3];
+
+    // m/s as measured by a pitot tube, negative to have SITL work it
+    // out from the velocity and wind
+    double airspeed;
+};
+
+struct sim_shm_header {
+    // SIM_SHM_MAGIC once SITL has set up the object
+    uint32_t magic;
+
+    // version of this layout (SIM_SHM_VERSION)
+    uint32_t version;
+
+    // size of the object in bytes
+    uint32_t total_size;
+
+    uint32_t reserved;
+
+    // low 32 bits of the last frame of servos and state written, each
+    // is the word the other side sleeps on
+    uint32_t servo_seq;
+    uint32_t fdm_seq;
+
+    struct sim_shm_servos servos;
+    struct sim_shm_fdm fdm;
+};
+
+/*
+  wait for up to timeout_ms for *seq to change from value. Returns the
+  value of *seq, with everything the other side wrote before setting
+  it visible
+ */
+static inline uint32_t sim_shm_wait(uint32_t *seq, uint32_t value, uint32_t timeout_ms)
+{
+    uint32_t v;
+    for (uint32_t i = 0; i < SIM_SHM_SPIN_COUNT; i++) {
+        v = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+        if (v != value) {
+            return v;
+        }
+    }
+#if defined(__linux__)
+    struct timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+    // the object is shared between processes, so no FUTEX_PRIVATE_FLAG
+    syscall(SYS_futex, seq, FUTEX_WAIT, value, &ts, NULL, 0);
+#else
+    for (uint32_t i = 0; i < timeout_ms * 10; i++) {
+        usleep(100);
+        if (__atomic_load_n(seq, __ATOMIC_ACQUIRE) != value) {
+            break;
+        }
+    }
+#endif
+    return __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+}
+
+// set *seq to value once everything written before is visible, and
+// wake the other side
+static inline void sim_shm_post(uint32_t *seq, uint32_t value)
+{
+    __atomic_store_n(seq, value, __ATOMIC_RELEASE);
+#if defined(__linux__)
+    syscall(SYS_futex, seq, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif